@@ -0,0 +1,183 @@
+/*
+ * BMO Asset Pack Implementation
+ *
+ * The partition is mapped through the flash cache on the ESP32 and mmap()ed
+ * from a file on the host; everything after begin() is plain pointer reads
+ */
+
+#include "assets.h"
+#include <string.h>
+
+#if defined(ESP32)
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+BMOAssetPack::BMOAssetPack()
+  : base(nullptr)
+  , header(nullptr)
+  , directory(nullptr)
+  , mappedSize(0)
+  , lookups(0)
+  , misses(0)
+#if defined(ESP32)
+  , mapHandle(0)
+#endif
+{
+}
+
+BMOAssetPack::~BMOAssetPack() {
+  end();
+}
+
+#if defined(ESP32)
+BMOAssetStatus BMOAssetPack::begin(const char* label) {
+  end();
+  const esp_partition_t* partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)ASSET_PARTITION_SUBTYPE, label);
+  if (!partition) return ASSET_ERROR_NOT_FOUND;
+
+  // Only the pack is mapped, not the empty rest of the partition (the cache
+  // maps whole 64KB pages, and their number is limited)
+  BMOAssetHeader probe;
+  if (esp_partition_read(partition, 0, &probe, sizeof(probe)) != ESP_OK) return ASSET_ERROR_MAP;
+  if (memcmp(probe.magic, ASSET_MAGIC, 4) != 0 || probe.size < sizeof(probe) ||
+      probe.size > partition->size) {
+    return ASSET_ERROR_HEADER;
+  }
+
+  const void* mapped = nullptr;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_partition_mmap_handle_t handle;
+  esp_err_t err = esp_partition_mmap(partition, 0, probe.size, ESP_PARTITION_MMAP_DATA, &mapped, &handle);
+#else
+  spi_flash_mmap_handle_t handle;
+  esp_err_t err = esp_partition_mmap(partition, 0, probe.size, SPI_FLASH_MMAP_DATA, &mapped, &handle);
+#endif
+  if (err != ESP_OK) return ASSET_ERROR_MAP;
+  mapHandle = (uint32_t)handle;
+  base = static_cast<const uint8_t*>(mapped);
+  mappedSize = probe.size;
+
+  BMOAssetStatus status = check();
+  if (status != ASSET_OK) end();
+  return status;
+}
+
+void BMOAssetPack::end() {
+  if (base) {
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap((esp_partition_mmap_handle_t)mapHandle);
+#else
+    spi_flash_munmap((spi_flash_mmap_handle_t)mapHandle);
+#endif
+  }
+  base = nullptr;
+  header = nullptr;
+  directory = nullptr;
+  mappedSize = 0;
+}
+#else
+BMOAssetStatus BMOAssetPack::begin(const char* path) {
+  end();
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return ASSET_ERROR_NOT_FOUND;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(BMOAssetHeader) || info.st_size > 0x7FFFFFFF) {
+    close(fd);
+    return ASSET_ERROR_HEADER;
+  }
+  void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return ASSET_ERROR_MAP;
+  base = static_cast<const uint8_t*>(mapped);
+  mappedSize = (uint32_t)info.st_size;
+
+  BMOAssetStatus status = check();
+  if (status != ASSET_OK) end();
+  return status;
+}
+
+void BMOAssetPack::end() {
+  if (base) munmap(const_cast<uint8_t*>(base), mappedSize);
+  base = nullptr;
+  header = nullptr;
+  directory = nullptr;
+  mappedSize = 0;
+}
+#endif
+
+BMOAssetStatus BMOAssetPack::check() {
+  const BMOAssetHeader* head = reinterpret_cast<const BMOAssetHeader*>(base);
+  if (memcmp(head->magic, ASSET_MAGIC, 4) != 0 || head->version != ASSET_VERSION ||
+      head->size < sizeof(BMOAssetHeader) || head->size > mappedSize) {
+    return ASSET_ERROR_HEADER;
+  }
+  uint32_t directoryEnd = sizeof(BMOAssetHeader) + (uint32_t)head->count * sizeof(BMOAssetEntry);
+  if (directoryEnd > head->size) return ASSET_ERROR_DIRECTORY;
+
+  // Every entry is checked once here so drawing never has to
+  const BMOAssetEntry* entries = reinterpret_cast<const BMOAssetEntry*>(base + sizeof(BMOAssetHeader));
+  for (uint16_t i = 0; i < head->count; i++) {
+    const BMOAssetEntry& entry = entries[i];
+    if (entry.name[ASSET_NAME_LENGTH - 1] != '\0' || entry.name[0] == '\0') return ASSET_ERROR_DIRECTORY;
+    if (i > 0 && strncmp(entries[i - 1].name, entry.name, ASSET_NAME_LENGTH) >= 0) return ASSET_ERROR_DIRECTORY;
+    if (entry.offset < directoryEnd || entry.offset % ASSET_ALIGN != 0 || entry.offset > head->size ||
+        entry.length > head->size - entry.offset) {
+      return ASSET_ERROR_DIRECTORY;
+    }
+    if (entry.width == 0 || entry.height == 0) return ASSET_ERROR_DIRECTORY;
+    if (entry.format == ASSET_FORMAT_RGB565) {
+      if (entry.length != (uint32_t)entry.width * entry.height * 2) return ASSET_ERROR_DIRECTORY;
+    } else if (entry.format != ASSET_FORMAT_QOI) {
+      return ASSET_ERROR_DIRECTORY;
+    }
+  }
+
+  header = head;
+  directory = entries;
+  return ASSET_OK;
+}
+
+const BMOAssetEntry* BMOAssetPack::find(const char* name) {
+  if (!header) return nullptr;
+  lookups++;
+
+  int low = 0, high = (int)header->count - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int order = strncmp(name, directory[middle].name, ASSET_NAME_LENGTH);
+    if (order == 0) return directory + middle;
+    if (order < 0) {
+      high = middle - 1;
+    } else {
+      low = middle + 1;
+    }
+  }
+  misses++;
+  return nullptr;
+}
+
+const char* BMOAssetPack::statusName(BMOAssetStatus status) {
+  switch (status) {
+    case ASSET_OK:              return "ok";
+    case ASSET_ERROR_NOT_FOUND: return "no asset partition";
+    case ASSET_ERROR_MAP:       return "mapping failed";
+    case ASSET_ERROR_HEADER:    return "not an asset pack";
+    case ASSET_ERROR_DIRECTORY: return "bad directory";
+  }
+  return "unknown";
+}
+
+const char* BMOAssetPack::formatName(uint8_t format) {
+  switch (format) {
+    case ASSET_FORMAT_RGB565: return "RGB565";
+    case ASSET_FORMAT_QOI:    return "QOI";
+  }
+  return "unknown";
+}
@@ -0,0 +1,121 @@
+/*
+ * BMO Asset Pack
+ *
+ * Sprites in their own flash partition ("assets", see config/partitions.csv),
+ * built on the host by tools/asset_pack.py and flashed on its own - new art
+ * never needs a firmware rebuild, and nothing is copied into RAM to show it
+ *
+ * Features:
+ * - Indexed pack: header, a directory sorted by name, then the sprite data
+ * - The partition is memory mapped; the directory and raw sprites are read
+ *   in place, and BMOGraphics::drawSprite() hands mapped rows straight to
+ *   the SPI driver
+ * - Raw RGB565 sprites (stored in panel byte order) or QOI compressed ones
+ *   (decoded with qoi.h from the mapped bytes)
+ * - Lookups by binary search, no index built at startup
+ * - The whole pack is checked when it is mapped: bad offsets, sizes or order
+ *   reject it instead of reading past the partition
+ * - No Arduino dependencies; on the host begin() mmaps the pack file, so
+ *   tools/asset_check.cpp tests the same lookups and data
+ *
+ * Pack layout (little-endian, offsets from the start of the pack):
+ *   header    "BMOA", version, sprite count, pack size, reserved
+ *   directory one BMOAssetEntry per sprite, sorted by name (strcmp order)
+ *   data      sprites, each 4-byte aligned
+ */
+
+#ifndef BMO_ASSETS_H
+#define BMO_ASSETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Sprites from the asset partition (-DBMO_ENABLE_ASSETS=1; flash the pack
+// with the command tools/asset_pack.py prints)
+#ifndef BMO_ENABLE_ASSETS
+#define BMO_ENABLE_ASSETS 0
+#endif
+
+#define ASSET_PARTITION_LABEL   "assets"
+#define ASSET_PARTITION_SUBTYPE 0x40   // Custom data subtype (config/partitions.csv)
+#define ASSET_MAGIC             "BMOA"
+#define ASSET_VERSION           1
+#define ASSET_NAME_LENGTH       16     // Including the terminating NUL
+#define ASSET_ALIGN             4
+
+enum BMOAssetFormat {
+  ASSET_FORMAT_RGB565 = 0,  // width * height big-endian RGB565, what the panel takes
+  ASSET_FORMAT_QOI = 1      // A QOI file (alpha over the background color)
+};
+
+enum BMOAssetStatus {
+  ASSET_OK = 0,
+  ASSET_ERROR_NOT_FOUND,    // No partition (or file) by that name
+  ASSET_ERROR_MAP,          // Mapping failed
+  ASSET_ERROR_HEADER,       // Not a pack, or from another version
+  ASSET_ERROR_DIRECTORY     // An entry points outside the pack or is out of order
+};
+
+// Pack header and directory entries, as laid out in flash
+struct BMOAssetHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t count;
+  uint32_t size;            // Whole pack, header included
+  uint32_t reserved;
+};
+
+struct BMOAssetEntry {
+  char name[ASSET_NAME_LENGTH];
+  uint16_t width;
+  uint16_t height;
+  uint8_t format;           // BMOAssetFormat
+  uint8_t reserved[3];
+  uint32_t offset;
+  uint32_t length;
+};
+
+static_assert(sizeof(BMOAssetHeader) == 16 && sizeof(BMOAssetEntry) == 32,
+              "asset pack layout must match tools/asset_pack.py");
+
+class BMOAssetPack {
+public:
+  BMOAssetPack();
+  ~BMOAssetPack();
+
+  // Maps the partition with this label (on the host: the pack file at this
+  // path) and checks the directory
+  BMOAssetStatus begin(const char* label = ASSET_PARTITION_LABEL);
+  void end();
+  bool isReady() const { return header != nullptr; }
+
+  // nullptr when there is no such sprite
+  const BMOAssetEntry* find(const char* name);
+  const uint8_t* getData(const BMOAssetEntry* entry) const {
+    return base + entry->offset;
+  }
+  uint16_t getCount() const { return header ? header->count : 0; }
+  const BMOAssetEntry* getEntry(uint16_t index) const { return directory + index; }
+  uint32_t getSize() const { return header ? header->size : 0; }
+
+  uint32_t getLookups() const { return lookups; }
+  uint32_t getMisses() const { return misses; }
+  static const char* statusName(BMOAssetStatus status);
+  static const char* formatName(uint8_t format);
+
+private:
+  const uint8_t* base;
+  const BMOAssetHeader* header;
+  const BMOAssetEntry* directory;
+  uint32_t mappedSize;
+  uint32_t lookups;
+  uint32_t misses;
+
+#if defined(ESP32)
+  uint32_t mapHandle;       // spi_flash_mmap_handle_t
+#endif
+
+  BMOAssetStatus check();
+};
+
+#endif // BMO_ASSETS_H
@@ -21,6 +21,9 @@
  * LED        → D7 (GPIO7)    → Backlight Control (PWM)
  * MISO       → D12 (GPIO12)  → SPI Data In (optional)
  * 
+ * Optional status panel (BMO_ENABLE_STATUS_PANEL, TFT_eSPI built with TFT_CS=-1):
+ * shares SCK/MOSI/MISO/DC/RESET, CS → D6 (GPIO6)
+ * 
  * Author: BMO Embedded Project
  * Date: October 19, 2025
  */
@@ -29,31 +32,109 @@
 #include <SPI.h>
 #include "display.h"
 #include "graphics.h"
+#include "memory.h"
+#include "lipsync.h"
+#include "mirror.h"
+#include "events.h"
+#include "protocol.h"
+#include "particles.h"
+#include "quality.h"
+#if BMO_ENABLE_IMAGES
+#include <LittleFS.h>
+#endif
 
-// Display and graphics objects
-TFT_eSPI tft = TFT_eSPI();
+// Display and graphics objects (statically allocated - BMODisplay owns the
+// single TFT_eSPI driver and BMOGraphics draws through it)
 BMODisplay bmoDisplay;
 BMOGraphics bmoGraphics;
+#if BMO_ENABLE_STATUS_PANEL
+BMOGraphicsT<BMOStatusPanel> statusGraphics;
+#endif
+#if BMO_ENABLE_LIPSYNC
+BMOLipSync bmoLipSync;
+#endif
+#if BMO_ENABLE_MIRROR
+BMOMirror bmoMirror;
+#endif
+BMOEventLoop bmoEvents;
+#if BMO_ENABLE_PROTOCOL
+BMOProtocol bmoProtocol;
+#endif
+#if BMO_ENABLE_PARTICLES
+BMOParticles bmoParticles;
+#endif
+#if BMO_ENABLE_ASSETS
+BMOAssetPack bmoAssets;
+#endif
+#if BMO_ENABLE_QUALITY
+BMOQualityGovernor bmoQuality;
+#endif
+
+// Event loop timers
+enum {
+  TIMER_BLINK = 1,
+  TIMER_LIPSYNC,
+  TIMER_MIRROR,
+  TIMER_STATS,
+  TIMER_ANIMATION,
+  TIMER_PARTICLES,
+  TIMER_WATCHDOG,
+  TIMER_GAZE,
+  TIMER_GLANCE
+};
+
+#define STATS_INTERVAL 60000  // Print loop, bus and render statistics every minute
+#define SURPRISE_DURATION 1500  // How long a host-triggered surprise lasts
+#define HEART_BURST 12          // Hearts released by the hearts animation
+#define FADE_DURATION 1500      // Fade out and time dark before the face returns
+#define GLANCE_MIN_INTERVAL 1500  // Idle glances come every 1.5-6 seconds
+#define GLANCE_MAX_INTERVAL 6000
+#define SPLASH_IMAGE "/splash.qoi"  // Shown at boot when it's on LittleFS
+#define SPLASH_DURATION 2000
+#define SPLASH_SPRITE "splash"      // Or this sprite, when it's in the asset pack
 
 // Animation state variables
-unsigned long lastBlinkTime = 0;
-unsigned long blinkInterval = 3000;  // Blink every 3 seconds
+unsigned long blinkInterval = 3000;  // First blink after 3 seconds
 bool eyesOpen = true;
-int animationPhase = 0;
+BMOExpression faceExpression = EXPRESSION_HAPPY;  // Set by the host over the protocol
+EyeState faceEyes = EYES_OPEN;
 
-// BMO color palette (RGB565 format)
-#define BMO_TEAL     0x4E6D    // BMO's signature teal color
-#define BMO_BLACK    0x0000    // Eyes and mouth
-#define BMO_WHITE    0xFFFF    // Eye highlights
-#define BMO_DARK_TEAL 0x2945   // Darker teal for shadows
+#if BMO_ENABLE_QUALITY
+// Every level change, with the reason; particles take their density from it
+void onQualityChange(const BMOQualityChange& change, void* context) {
+  (void)context;
+  Serial.printf("Quality %u -> %u: %s (%u us frame, %u us budget)\n", change.from, change.to,
+                BMOQualityGovernor::reasonName(change.reason), (unsigned)change.frameUs,
+                (unsigned)change.budgetUs);
+#if BMO_ENABLE_PARTICLES
+  bmoParticles.setDensity(BMOQualityGovernor::settingsFor(change.to).effectDensity);
+#endif
+}
+#endif
 
 void setup() {
   // Initialize serial communication for debugging
+#if BMO_ENABLE_PROTOCOL && defined(ESP32)
+  // Room for a whole image chunk while the loop is busy drawing
+  Serial.setRxBufferSize(PROTOCOL_RX_BUFFER);
+#endif
+#if BMO_ENABLE_MIRROR && defined(ESP32)
+  // Mirror packets go out whole, the largest raw tile included
+  Serial.setTxBufferSize(MIRROR_TX_BUFFER);
+#endif
   Serial.begin(115200);
   delay(100);
   
   Serial.println("BMO Smiley Face Display Starting...");
   
+#if BMO_ENABLE_STATUS_PANEL
+  // Face on panel 0, status panel on its own chip select
+  BMOPanelPins facePins = { BMO_FACE_CS, TFT_RST, TFT_LED };
+  BMOPanelPins statusPins = { BMO_STATUS_CS, BMO_STATUS_RST, BMO_STATUS_LED };
+  bmoDisplay.addPanel<BMOActivePanel>(facePins);
+  int statusPanel = bmoDisplay.addPanel<BMOStatusPanel>(statusPins);
+#endif
+  
   // Initialize display
   if (!bmoDisplay.begin()) {
     Serial.println("ERROR: Display initialization failed!");
@@ -63,122 +144,342 @@ void setup() {
   }
   
   // Initialize graphics system
-  bmoGraphics.begin(&tft);
+  bmoGraphics.begin(&bmoDisplay);
+  
+#if BMO_ENABLE_IMAGES
+  // Images live on the LittleFS partition (uploaded from data/)
+  if (!LittleFS.begin()) {
+    Serial.println("LittleFS mount failed - no images");
+  } else if (LittleFS.exists(SPLASH_IMAGE) && bmoGraphics.drawImage(SPLASH_IMAGE, 0, 0)) {
+    delay(SPLASH_DURATION);
+  }
+#endif
+  
+#if BMO_ENABLE_ASSETS
+  // Sprites are mapped from the asset partition (tools/asset_pack.py)
+  BMOAssetStatus assetStatus = bmoAssets.begin();
+  if (assetStatus != ASSET_OK) {
+    Serial.printf("Asset pack: %s - no sprites\n", BMOAssetPack::statusName(assetStatus));
+  } else {
+    Serial.printf("Asset pack: %u sprites\n", bmoAssets.getCount());
+    bmoGraphics.setAssets(&bmoAssets);
+    const BMOAssetEntry* splash = bmoAssets.find(SPLASH_SPRITE);
+    if (splash && bmoGraphics.drawSprite(splash, 0, 0)) {
+      delay(SPLASH_DURATION);
+    }
+  }
+#endif
   
   // Draw initial BMO face
-  drawBMOFace(true);  // Start with eyes open
+  bmoGraphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  
+#if BMO_ENABLE_STATUS_PANEL
+  // A small BMO on the status panel too
+  if (statusPanel >= 0) {
+    statusGraphics.begin(&bmoDisplay, statusPanel);
+    statusGraphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  }
+#endif
+  
+#if BMO_ENABLE_LIPSYNC
+  // Start listening for speech on the I2S input
+  bmoLipSync.begin(LIPSYNC_SOURCE_I2S);
+#endif
+  
+#if BMO_ENABLE_PARTICLES
+  // Sparkles, hearts and Zzz around the face (timer runs only while they do)
+  bmoParticles.begin();
+#endif
+  
+#if BMO_ENABLE_MIRROR
+  // Stream the screen to tools/mirror_viewer.py
+  bmoMirror.begin(bmoDisplay.getTFT());
+#endif
+  
+#if BMO_ENABLE_QUALITY
+  // Trade detail for time when animations stack up (one gaze frame's budget)
+  bmoQuality.begin(QUALITY_BUDGET_US);
+  bmoQuality.setListener(onQualityChange, nullptr);
+  bmoGraphics.setGovernor(&bmoQuality);
+#endif
+  
+  // Timers drive everything from here on; the CPU sleeps in between
+  bmoEvents.begin();
+#if BMO_ENABLE_PROTOCOL
+  // Host commands (tools/bmo_ctl.py) wake the loop as they arrive
+  bmoProtocol.begin(&Serial);
+  bmoEvents.watchSerial(&Serial);
+#endif
+  bmoEvents.startTimer(TIMER_BLINK, blinkInterval);
+  bmoEvents.startTimer(TIMER_STATS, STATS_INTERVAL, STATS_INTERVAL);
+#if BMO_ENABLE_LIPSYNC
+  bmoEvents.startTimer(TIMER_LIPSYNC, LIPSYNC_FRAME_INTERVAL, LIPSYNC_FRAME_INTERVAL);
+#endif
+#if BMO_ENABLE_MIRROR
+  bmoEvents.startTimer(TIMER_MIRROR, MIRROR_SERVICE_INTERVAL, MIRROR_SERVICE_INTERVAL);
+#endif
+#if BMO_ENABLE_GAZE
+  bmoEvents.startTimer(TIMER_GLANCE, random(GLANCE_MIN_INTERVAL, GLANCE_MAX_INTERVAL));
+#endif
+#if BMO_ENABLE_WATCHDOG
+  bmoEvents.startTimer(TIMER_WATCHDOG, BMO_WATCHDOG_INTERVAL, BMO_WATCHDOG_INTERVAL);
+#endif
+  
+  // Everything is allocated - from here on nothing may touch the heap
+  bmoArena.seal();
+  bmoPrintMemoryReport();
   
   Serial.println("BMO is ready! :)");
 }
 
-void loop() {
-  unsigned long currentTime = millis();
-  
-  // Handle blinking animation
-  if (currentTime - lastBlinkTime >= blinkInterval) {
-    eyesOpen = !eyesOpen;
-    drawBMOFace(eyesOpen);
-    lastBlinkTime = currentTime;
-    
-    // Randomize next blink interval (2-5 seconds)
-    blinkInterval = random(2000, 5000);
-    
-    Serial.println(eyesOpen ? "Eyes open" : "Blink!");
+// Queue a redraw of every panel's face
+void showFace(BMOExpression expression, EyeState eyes) {
+  bmoGraphics.requestFace(expression, eyes);
+#if BMO_ENABLE_STATUS_PANEL
+  statusGraphics.requestFace(expression, eyes);
+#endif
+#if BMO_ENABLE_PARTICLES
+  // The redraw wipes the particles; put them back on the next frame
+  bmoParticles.invalidate();
+#endif
+}
+
+// Change only the mouth (the eyes on screen stay as they are)
+void showExpression(BMOExpression expression) {
+  bmoGraphics.requestExpression(expression);
+#if BMO_ENABLE_STATUS_PANEL
+  statusGraphics.requestExpression(expression);
+#endif
+}
+
+#if BMO_ENABLE_PARTICLES
+// Run the particle frame timer (it stops itself once nothing is left)
+void startParticles() {
+  if (!bmoEvents.isTimerActive(TIMER_PARTICLES)) {
+    bmoEvents.startTimer(TIMER_PARTICLES, PARTICLE_FRAME_INTERVAL, PARTICLE_FRAME_INTERVAL);
   }
+}
+
+// Ambient effect that goes with each expression
+void setParticleEffect(BMOExpression expression) {
+  BMOParticleEffect effect = PARTICLE_EFFECT_NONE;
+  if (expression == EXPRESSION_EXCITED) effect = PARTICLE_EFFECT_SPARKLES;
+  if (expression == EXPRESSION_SLEEPY) effect = PARTICLE_EFFECT_SLEEP;
   
-  // Small delay to prevent excessive CPU usage
-  delay(50);
+  bmoParticles.setEffect(effect);
+  if (effect != PARTICLE_EFFECT_NONE) startParticles();
 }
+#endif
 
-/**
- * Draw the complete BMO face
- * @param eyesOpen - true for open eyes, false for closed/blinking
- */
-void drawBMOFace(bool eyesOpen) {
-  // Clear screen with BMO teal background
-  tft.fillScreen(BMO_TEAL);
-  
-  // Calculate face proportions for 240x320 display
-  int centerX = 120;  // Half of 240
-  int centerY = 160;  // Half of 320
-  
-  // Eye parameters
-  int eyeRadius = 25;
-  int eyeY = centerY - 40;
-  int leftEyeX = centerX - 50;
-  int rightEyeX = centerX + 50;
-  
-  // Draw eyes
-  if (eyesOpen) {
-    // Open eyes - black circles with white highlights
-    tft.fillCircle(leftEyeX, eyeY, eyeRadius, BMO_BLACK);
-    tft.fillCircle(rightEyeX, eyeY, eyeRadius, BMO_BLACK);
-    
-    // Add eye highlights for shine effect
-    tft.fillCircle(leftEyeX - 8, eyeY - 8, 6, BMO_WHITE);
-    tft.fillCircle(rightEyeX - 8, eyeY - 8, 6, BMO_WHITE);
-  } else {
-    // Closed eyes - horizontal lines
-    int lineWidth = eyeRadius * 2;
-    int lineThickness = 4;
-    
-    for (int i = 0; i < lineThickness; i++) {
-      tft.drawLine(leftEyeX - lineWidth/2, eyeY + i - lineThickness/2, 
-                   leftEyeX + lineWidth/2, eyeY + i - lineThickness/2, BMO_BLACK);
-      tft.drawLine(rightEyeX - lineWidth/2, eyeY + i - lineThickness/2, 
-                   rightEyeX + lineWidth/2, eyeY + i - lineThickness/2, BMO_BLACK);
+#if BMO_ENABLE_GAZE
+// Look somewhere; the 60 fps gaze timer runs until the eyes get there
+void lookAt(int8_t x, int8_t y) {
+  bmoGraphics.lookAt(x, y);
+#if BMO_ENABLE_STATUS_PANEL
+  statusGraphics.lookAt(x, y);
+#endif
+  if (!bmoEvents.isTimerActive(TIMER_GAZE)) {
+    bmoEvents.startTimer(TIMER_GAZE, GAZE_FRAME_INTERVAL, GAZE_FRAME_INTERVAL);
+  }
+}
+#endif
+
+void handleTimer(uint8_t id) {
+  switch (id) {
+    case TIMER_BLINK:
+      eyesOpen = !eyesOpen;
+      showFace(faceExpression, eyesOpen ? faceEyes : EYES_CLOSED);
+      
+      // Randomize next blink interval (2-5 seconds)
+      blinkInterval = random(2000, 5000);
+      bmoEvents.startTimer(TIMER_BLINK, blinkInterval);
+      
+      Serial.println(eyesOpen ? "Eyes open" : "Blink!");
+      break;
+      
+#if BMO_ENABLE_LIPSYNC
+    case TIMER_LIPSYNC:
+      // Move the mouth with the audio (repaints the mouth box only, and only on change)
+      if (bmoLipSync.update(millis())) {
+        LipSyncMouth mouth = bmoLipSync.getMouth();
+        bmoGraphics.drawTalkingMouth(mouth.open, mouth.width);
+      }
+      break;
+#endif
+      
+#if BMO_ENABLE_MIRROR
+    case TIMER_MIRROR:
+      // Trickle changed tiles out while the face is idle (reads the face panel)
+      bmoDisplay.selectPanel(0);
+      bmoMirror.service();
+      break;
+#endif
+      
+    case TIMER_STATS:
+      bmoEvents.printEventInfo();
+      bmoDisplay.printDisplayInfo();
+      bmoGraphics.printGraphicsInfo();
+#if BMO_ENABLE_PROTOCOL
+      bmoProtocol.printProtocolInfo();
+#endif
+#if BMO_ENABLE_PARTICLES
+      bmoParticles.printParticleInfo();
+#endif
+#if BMO_ENABLE_QUALITY
+      bmoQuality.printQualityInfo();
+#endif
+      break;
+      
+#if BMO_ENABLE_PARTICLES
+    case TIMER_PARTICLES:
+      // Never draw under a face redraw that is still going out
+      if (!bmoDisplay.isPanelBusy(0) && bmoParticles.update()) {
+        bmoGraphics.drawParticles(bmoParticles);
+      }
+      if (bmoParticles.isIdle()) {
+        bmoEvents.stopTimer(TIMER_PARTICLES);
+      }
+      break;
+#endif
+      
+#if BMO_ENABLE_GAZE
+    case TIMER_GLANCE:
+      // Glance around now and then, coming back to look ahead about half the time
+      if (random(2) == 0) {
+        lookAt(0, 0);
+      } else {
+        lookAt(random(-100, 101), random(-60, 61));
+      }
+      bmoEvents.startTimer(TIMER_GLANCE, random(GLANCE_MIN_INTERVAL, GLANCE_MAX_INTERVAL));
+      break;
+      
+    case TIMER_GAZE: {
+      bool moving = bmoGraphics.updateGaze();
+#if BMO_ENABLE_STATUS_PANEL
+      moving = statusGraphics.updateGaze() || moving;
+#endif
+      if (!moving) {
+        bmoEvents.stopTimer(TIMER_GAZE);
+      }
+      break;
+    }
+#endif
+      
+#if BMO_ENABLE_WATCHDOG
+    case TIMER_WATCHDOG: {
+      // A panel that was reinitialized comes back blank; redraw whatever it last showed
+      uint8_t lost = bmoDisplay.checkPanels();
+      if (lost & (1 << bmoGraphics.getPanelIndex())) {
+        bmoGraphics.restoreFace();
+#if BMO_ENABLE_PARTICLES
+        bmoParticles.invalidate();
+#endif
+      }
+#if BMO_ENABLE_STATUS_PANEL
+      if (lost & (1 << statusGraphics.getPanelIndex())) {
+        statusGraphics.restoreFace();
+      }
+#endif
+      break;
     }
+#endif
+      
+    case TIMER_ANIMATION:
+      // Host animation finished, back to the commanded face
+      showFace(faceExpression, faceEyes);
+      break;
   }
-  
-  // Draw mouth - simple curved smile
-  drawBMOSmile(centerX, centerY + 30, 60, 20);
-  
-  // Optional: Add BMO's distinctive rectangular outline
-  drawBMOFrame();
 }
 
-/**
- * Draw BMO's smile using multiple line segments to create a curve
- * @param centerX - center X position of mouth
- * @param centerY - center Y position of mouth  
- * @param width - width of the smile
- * @param height - height/curve of the smile
- */
-void drawBMOSmile(int centerX, int centerY, int width, int height) {
-  // Create a curved smile using multiple short line segments
-  int segments = 20;
-  int startX = centerX - width/2;
-  int endX = centerX + width/2;
-  int segmentWidth = width / segments;
-  
-  for (int i = 0; i < segments; i++) {
-    int x1 = startX + (i * segmentWidth);
-    int x2 = startX + ((i + 1) * segmentWidth);
-    
-    // Calculate Y positions using a parabolic curve
-    float t1 = (float)(x1 - centerX) / (width/2);
-    float t2 = (float)(x2 - centerX) / (width/2);
-    
-    int y1 = centerY + (int)(height * (1 - t1 * t1));
-    int y2 = centerY + (int)(height * (1 - t2 * t2));
-    
-    // Draw thick line segments for visibility
-    for (int thickness = 0; thickness < 3; thickness++) {
-      tft.drawLine(x1, y1 + thickness, x2, y2 + thickness, BMO_BLACK);
+#if BMO_ENABLE_PROTOCOL
+void handleCommand(uint8_t type, uint16_t param) {
+  switch (type) {
+    case CMD_SET_EXPRESSION: {
+      BMOExpression expression = (BMOExpression)(param & 0xFF);
+      EyeState eyes = (param >> 8) == PROTOCOL_EYES_DEFAULT ? BMOGraphics::expressionEyes(expression)
+                                                             : (EyeState)(param >> 8);
+      
+      // Same eyes already on screen: repaint just the mouth
+      bool mouthOnly = eyesOpen && eyes == faceEyes && !bmoEvents.isTimerActive(TIMER_ANIMATION);
+      faceExpression = expression;
+      faceEyes = eyes;
+      eyesOpen = true;
+      if (mouthOnly) {
+        showExpression(faceExpression);
+      } else {
+        showFace(faceExpression, faceEyes);
+      }
+#if BMO_ENABLE_PARTICLES
+      setParticleEffect(faceExpression);
+#endif
+      break;
     }
+      
+    case CMD_ANIMATE:
+      if (param == ANIMATION_BLINK) {
+        eyesOpen = false;
+        showFace(faceExpression, EYES_CLOSED);
+        bmoEvents.startTimer(TIMER_BLINK, BLINK_DURATION);
+      } else if (param == ANIMATION_SURPRISE) {
+        showFace(EXPRESSION_SURPRISED, EYES_WIDE);
+        bmoEvents.startTimer(TIMER_ANIMATION, SURPRISE_DURATION);
+      } else if (param == ANIMATION_FADE) {
+        // Scheduled a band at a time like a redraw; the face comes back on the timer
+        bmoGraphics.fadeTransition(bmoGraphics.backgroundColorAt(BMOFace::CENTER_Y), BMO_BLACK);
+        bmoEvents.startTimer(TIMER_ANIMATION, FADE_DURATION);
+      }
+#if BMO_ENABLE_PARTICLES
+      if (param == ANIMATION_HEARTS) {
+        bmoParticles.burst(PARTICLE_EFFECT_HEARTS, HEART_BURST);
+        startParticles();
+      }
+#endif
+      break;
+      
+    case CMD_BACKLIGHT:
+      bmoDisplay.setBacklight(param);
+      break;
   }
 }
+#endif
 
-/**
- * Draw BMO's rectangular frame outline
- */
-void drawBMOFrame() {
-  // Draw outer frame border
-  int frameThickness = 8;
-  int cornerRadius = 15;
-  
-  // Create rounded rectangle frame effect
-  for (int i = 0; i < frameThickness; i++) {
-    tft.drawRoundRect(i, i, 240 - (i * 2), 320 - (i * 2), cornerRadius, BMO_DARK_TEAL);
+void loop() {
+  // Sleep until a timer or other event is due
+  BMOEvent event;
+  if (!bmoEvents.wait(&event)) return;
+  
+  switch (event.type) {
+    case EVENT_TIMER:
+      handleTimer(event.id);
+      break;
+      
+#if BMO_ENABLE_PROTOCOL
+    case EVENT_SERIAL:
+      // Drain the port; if it couldn't finish, come straight back
+      bmoProtocol.service();
+      if (bmoProtocol.isBusy()) bmoEvents.notifySerial();
+      break;
+      
+    case EVENT_COMMAND:
+      handleCommand(event.id, event.param);
+      break;
+#endif
+      
+    case EVENT_FRAME:
+      // More redraw slices to send (below)
+      break;
+  }
+  
+  // Redraws go out a slice per busy panel per tick, alternating between
+  // panels. With more to send the loop comes straight back, after any timer
+  // or serial event that is already waiting; a full queue means one is.
+  if (bmoDisplay.hasPendingJobs()) {
+    bmoDisplay.serviceJobs();
+    if (bmoDisplay.hasPendingJobs()) bmoEvents.post(EVENT_FRAME);
   }
-}
\ No newline at end of file
+  
+#if BMO_ENABLE_QUALITY
+  // Everything this tick drew is one frame to the governor
+  bmoQuality.endFrame();
+#endif
+}
@@ -2,22 +2,48 @@
  * BMO Display Driver Implementation
  * 
  * Hardware abstraction layer for Waveshare 2.4" LCD display
- * Handles initialization, configuration, and error recovery
+ * Handles initialization, configuration, and error recovery,
+ * for one or more panels sharing the SPI bus
  */
 
 #include "display.h"
 
+// The TFT_eSPI build configuration must describe the same panel. TFT_WIDTH
+// and TFT_HEIGHT are the controller's portrait axes; landscape rotations
+// exchange them.
+#if defined(TFT_WIDTH) && defined(TFT_HEIGHT)
+static_assert((BMOActivePanel::ROTATION & 1 ? TFT_HEIGHT : TFT_WIDTH) == BMOActivePanel::WIDTH,
+              "TFT_WIDTH does not match the selected BMO panel profile");
+static_assert((BMOActivePanel::ROTATION & 1 ? TFT_WIDTH : TFT_HEIGHT) == BMOActivePanel::HEIGHT,
+              "TFT_HEIGHT does not match the selected BMO panel profile");
+#endif
+
 // Global display instance
 BMODisplay* g_bmoDisplay = nullptr;
 
 BMODisplay::BMODisplay() 
-  : tft(nullptr)
+  : tft()
+  , spiQueue()
   , status(DISPLAY_OK)
   , controller(CONTROLLER_UNKNOWN)
   , backlightLevel(255)
   , lastError(nullptr)
   , initialized(false)
+  , sleeping(false)
+  , panels()
+  , panelCount(0)
+  , activePanel(-1)
+  , tftRotation(0)
+  , jobs()
+  , nextJobPanel(0)
+  , writeStart(0)
+#if BMO_BUS_TRACE
+  , trace()
+  , traceHead(0)
+  , traceCount(0)
+#endif
 {
+  resetStats();
 }
 
 BMODisplay::~BMODisplay() {
@@ -27,13 +53,10 @@ BMODisplay::~BMODisplay() {
 bool BMODisplay::begin() {
   Serial.println("Initializing BMO Display...");
   
-  // Create TFT instance if not already created
-  if (!tft) {
-    tft = new TFT_eSPI();
-    if (!tft) {
-      setError(DISPLAY_ERROR_MEMORY, "Failed to allocate TFT object");
-      return false;
-    }
+  // Single-panel builds get the face panel from the pin definitions
+  if (panelCount == 0) {
+    BMOPanelPins facePins = { BMO_FACE_CS, TFT_RST, TFT_LED };
+    addPanel<BMOActivePanel>(facePins);
   }
   
   // Initialize backlight control pin
@@ -45,26 +68,52 @@ bool BMODisplay::begin() {
     return false;
   }
   
-  // Initialize display
-  tft->init();
-  
-  // Detect display controller
-  if (!detectController()) {
-    setError(DISPLAY_ERROR_CONTROLLER, "Controller detection failed");
-    return false;
-  }
+  // Initialize display - TFT_eSPI's init sequence goes to every panel at once
+  for (uint8_t i = 0; i < panelCount; i++) setChipSelect(i, true);
+  tft.init();
+  for (uint8_t i = 0; i < panelCount; i++) setChipSelect(i, false);
+  tftRotation = tft.getRotation();
+  activePanel = -1;
   
-  // Configure display settings
-  if (!configureDisplay()) {
-    setError(DISPLAY_ERROR_INIT, "Display configuration failed");
-    return false;
+  for (uint8_t i = 0; i < panelCount; i++) {
+    selectPanel(i);
+    
+    // Detect display controller
+    if (!detectController(i)) {
+      setError(DISPLAY_ERROR_CONTROLLER, "Controller detection failed");
+      return false;
+    }
+    
+    // Configure display settings
+    if (!configureDisplay(i)) {
+      setError(DISPLAY_ERROR_INIT, "Display configuration failed");
+      return false;
+    }
+    
+    // Test display functionality
+    if (!testDisplay()) {
+      setError(DISPLAY_ERROR_INIT, "Display test failed");
+      return false;
+    }
+    
+    panels[i].ready = true;
+    
+    // Only a panel that reads back healthy now can be judged later
+    panels[i].monitored = (checkPanelHealth(i) == PANEL_HEALTH_OK);
+    if (!panels[i].monitored) {
+      Serial.printf("Panel %d registers don't read back - watchdog disabled for it\n", i);
+    }
   }
-  
-  // Test display functionality
-  if (!testDisplay()) {
-    setError(DISPLAY_ERROR_INIT, "Display test failed");
-    return false;
+  controller = panels[0].controller;
+  selectPanel(0);
+  
+#if BMO_ENABLE_DMA
+  // Queued transfers share TFT_eSPI's pins and clock; blocking writes still
+  // work without them
+  if (!spiQueue.begin(SPI_FREQUENCY, TFT_MOSI, TFT_MISO, TFT_SCK, TFT_DC)) {
+    Serial.println("SPI queue unavailable - using blocking writes");
   }
+#endif
   
   // Turn on backlight
   setBacklight(255);
@@ -84,11 +133,7 @@ bool BMODisplay::begin() {
 void BMODisplay::end() {
   if (initialized) {
     backlightOff();
-    
-    if (tft) {
-      delete tft;
-      tft = nullptr;
-    }
+    spiQueue.end();
     
     initialized = false;
     g_bmoDisplay = nullptr;
@@ -99,9 +144,15 @@ void BMODisplay::end() {
 
 void BMODisplay::setBacklight(uint8_t brightness) {
   backlightLevel = brightness;
+  stats.backlightUpdates++;
   
   // Use PWM for smooth brightness control
-  analogWrite(TFT_LED, brightness);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    panels[i].backlightLevel = brightness;
+    if (panels[i].pins.backlight >= 0) {
+      analogWrite(panels[i].pins.backlight, brightness);
+    }
+  }
   
   Serial.printf("Backlight set to %d/255\n", brightness);
 }
@@ -112,8 +163,14 @@ void BMODisplay::sleep() {
   // Turn off backlight
   backlightOff();
   
-  // Send display to sleep mode
-  tft->writecommand(0x10);  // Sleep In command
+  // Send every panel to sleep mode
+  int8_t previous = activePanel;
+  for (uint8_t i = 0; i < panelCount; i++) {
+    selectPanel(i);
+    sendCommand(0x10);  // Sleep In command
+  }
+  selectPanel(previous);
+  sleeping = true;
   delay(120);  // Wait for sleep mode to activate
   
   Serial.println("Display entered sleep mode");
@@ -122,8 +179,14 @@ void BMODisplay::sleep() {
 void BMODisplay::wakeup() {
   if (!initialized) return;
   
-  // Wake up display
-  tft->writecommand(0x11);  // Sleep Out command
+  // Wake up every panel
+  int8_t previous = activePanel;
+  for (uint8_t i = 0; i < panelCount; i++) {
+    selectPanel(i);
+    sendCommand(0x11);  // Sleep Out command
+  }
+  selectPanel(previous);
+  sleeping = false;
   delay(120);  // Wait for wake up
   
   // Restore backlight
@@ -143,160 +206,427 @@ void BMODisplay::reset() {
   
   // Re-initialize if needed
   if (initialized) {
-    configureDisplay();
+    int8_t previous = activePanel;
+    for (uint8_t i = 0; i < panelCount; i++) {
+      selectPanel(i);
+      configureDisplay(i);
+    }
+    selectPanel(previous);
   }
 }
 
-void BMODisplay::clear(uint16_t color) {
-  if (tft) {
-    tft->fillScreen(color);
+BMOPanelHealth BMODisplay::checkPanelHealth(uint8_t index) {
+  const BMOPanelState& panel = panels[index];
+  selectPanel(index);
+  
+  // Power mode: SLPOUT is bit 4, DISON bit 2
+  uint8_t power = readRegister(0x0A);
+  if (!(power & 0x10) || !(power & 0x04)) return PANEL_HEALTH_ASLEEP;
+  
+  uint8_t madctl = readRegister(0x0B);  // Read Display MADCTL
+  uint8_t expected = panel.controller == CONTROLLER_ST7789 ?
+                     bmoMadctlST7789(panel.rotation, panel.colorOrder) :
+                     bmoMadctlILI9341(panel.rotation, panel.colorOrder);
+  if ((madctl & 0xFC) != expected) return PANEL_HEALTH_MADCTL;
+  
+  uint8_t colmod = readRegister(0x0C);  // Read Display Pixel Format
+  if ((colmod & 0x07) != 0x05) return PANEL_HEALTH_COLMOD;  // 16 bits per pixel
+  
+  return PANEL_HEALTH_OK;
+}
+
+uint8_t BMODisplay::checkPanels() {
+  if (!initialized || sleeping) return 0;
+  
+  static const char* const faultNames[] = { "ok", "asleep", "MADCTL lost", "COLMOD lost" };
+  int8_t previous = activePanel;
+  uint8_t lost = 0;
+  
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (!panels[i].monitored) continue;
+    
+    stats.healthChecks++;
+    BMOPanelHealth health = checkPanelHealth(i);
+    if (health == PANEL_HEALTH_OK) continue;
+    
+    uint32_t start = micros();
+    stats.panelFaults++;
+    Serial.printf("Panel %d fault: %s\n", i, faultNames[health]);
+    
+    // A register that drifted is written back (a few ms). A panel found
+    // asleep was reset or browned out and lost everything the init sequence
+    // set, power and gamma included, so it gets that sequence again - which
+    // resets every panel on the shared reset line - as does one that still
+    // isn't right after its registers were restored.
+    if (health != PANEL_HEALTH_ASLEEP && restorePanel(i)) {
+      stats.quickRecoveries++;
+      lost |= 1 << i;
+    } else {
+      lost |= reinitializeBus();
+      if (checkPanelHealth(i) == PANEL_HEALTH_OK) {
+        stats.fullRecoveries++;
+      } else {
+        stats.failedRecoveries++;
+        setError(DISPLAY_ERROR_INIT, "Panel recovery failed");
+        continue;
+      }
+    }
+    
+    uint32_t elapsed = micros() - start;
+    stats.recoveryTime.record(elapsed);
+    Serial.printf("Panel %d recovered in %lu us\n", i, (unsigned long)elapsed);
   }
+  
+  if (previous >= 0) selectPanel(previous);
+  return lost;
 }
 
-void BMODisplay::startWrite() {
-  if (tft) {
-    tft->startWrite();
+bool BMODisplay::restorePanel(uint8_t index) {
+  selectPanel(index);
+  
+  // Orientation, color order and pixel format, on a panel that is awake
+  configureDisplay(index);
+  sendCommand(0x3A);  // Interface pixel format
+  sendData(0x55);     // 16-bit color
+  
+  return checkPanelHealth(index) == PANEL_HEALTH_OK;
+}
+
+uint8_t BMODisplay::reinitializeBus() {
+  Serial.println("Reinitializing display bus...");
+  
+  // Same sequence as begin(): TFT_eSPI's init to every panel at once
+  // (it pulses the shared reset), then each panel's own configuration
+  spiQueue.drain();
+  if (activePanel >= 0) setChipSelect(activePanel, false);
+  for (uint8_t i = 0; i < panelCount; i++) setChipSelect(i, true);
+  tft.init();
+  for (uint8_t i = 0; i < panelCount; i++) setChipSelect(i, false);
+  tftRotation = tft.getRotation();
+  activePanel = -1;
+  
+  for (uint8_t i = 0; i < panelCount; i++) {
+    selectPanel(i);
+    configureDisplay(i);
+  }
+  setBacklight(backlightLevel);
+  
+  // Every panel came back blank
+  return (uint8_t)((1u << panelCount) - 1);
+}
+
+int BMODisplay::addPanel(const BMOPanelPins& pins, int16_t width, int16_t height, uint8_t rotation) {
+  if (initialized || panelCount >= BMO_MAX_PANELS) {
+    setError(DISPLAY_ERROR_INIT, "Panel table full (raise BMO_MAX_PANELS) or display already started");
+    return -1;
+  }
+#if TFT_CS >= 0
+  // TFT_eSPI would toggle the face panel's CS during every other panel's transfers
+  if (panelCount > 0) {
+    setError(DISPLAY_ERROR_INIT, "Multiple panels need TFT_eSPI built with TFT_CS=-1");
+    return -1;
+  }
+#endif
+  
+  BMOPanelState& panel = panels[panelCount];
+  panel.pins = pins;
+  panel.width = width;
+  panel.height = height;
+  panel.rotation = rotation;
+  panel.colorOrder = BMO_ILI9341_COLOR_ORDER;  // Until the controller is known
+  panel.controller = CONTROLLER_UNKNOWN;
+  panel.backlightLevel = backlightLevel;
+  panel.ready = false;
+  panel.monitored = false;
+  jobs[panelCount].job = nullptr;
+  jobs[panelCount].context = nullptr;
+  
+  Serial.printf("Panel %d: %dx%d, CS=%d\n", panelCount, width, height, pins.cs);
+  return panelCount++;
+}
+
+bool BMODisplay::selectPanel(uint8_t index) {
+  if (index >= panelCount) return false;
+  if (activePanel == index) return true;
+  
+  // Queued pixels belong to the panel selected now
+  spiQueue.drain();
+  
+  // Callers switch panels between transactions, never inside startWrite()
+  if (activePanel >= 0) setChipSelect(activePanel, false);
+  setChipSelect(index, true);
+  activePanel = index;
+  stats.panelSwitches++;
+  recordBus(index, BUS_EVENT_SELECT);
+  
+  // Panels may differ in orientation; TFT_eSPI keeps one rotation
+  const BMOPanelState& panel = panels[index];
+  if (panel.rotation != tftRotation) {
+    tft.setRotation(panel.rotation);
+    tftRotation = panel.rotation;
+    if (panel.ready) {
+      sendCommand(0x36);
+      sendData(panel.controller == CONTROLLER_ST7789 ?
+                    bmoMadctlST7789(panel.rotation, panel.colorOrder) :
+                    bmoMadctlILI9341(panel.rotation, panel.colorOrder));
+    }
+  }
+  
+  // Clip drawing to this panel's visible area
+  tft.setViewport(0, 0, panel.width, panel.height);
+  return true;
+}
+
+void BMODisplay::setChipSelect(uint8_t index, bool active) {
+  if (panels[index].pins.cs >= 0) {
+    digitalWrite(panels[index].pins.cs, active ? LOW : HIGH);
   }
 }
 
+bool BMODisplay::queueJob(uint8_t panel, BMOPanelJob job, void* context) {
+  if (panel >= panelCount || !job) return false;
+  
+  jobs[panel].job = job;
+  jobs[panel].context = context;
+  return true;
+}
+
+void BMODisplay::serviceJobs() {
+  if (!initialized || panelCount == 0) return;
+  
+  // One slice per busy panel; rotate who goes first so no panel is favoured
+  for (uint8_t n = 0; n < panelCount; n++) {
+    uint8_t index = (nextJobPanel + n) % panelCount;
+    PanelJobSlot& slot = jobs[index];
+    if (!slot.job) continue;
+    
+    selectPanel(index);
+    recordBus(index, BUS_EVENT_SLICE_BEGIN);
+    bool done = slot.job(slot.context);
+    recordBus(index, BUS_EVENT_SLICE_END);
+    
+    if (done) {
+      slot.job = nullptr;
+      slot.context = nullptr;
+    }
+  }
+  nextJobPanel = (nextJobPanel + 1) % panelCount;
+}
+
+bool BMODisplay::hasPendingJobs() const {
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (jobs[i].job) return true;
+  }
+  return false;
+}
+
+#if BMO_BUS_TRACE
+void BMODisplay::recordBus(uint8_t panel, BMOBusEvent event) {
+  BMOBusTraceEntry& entry = trace[traceHead];
+  entry.timestamp = micros();
+  entry.panel = panel;
+  entry.event = event;
+  
+  traceHead = (traceHead + 1) % BMO_BUS_TRACE_SIZE;
+  if (traceCount < BMO_BUS_TRACE_SIZE) traceCount++;
+}
+
+uint16_t BMODisplay::getBusTrace(BMOBusTraceEntry* out, uint16_t maxEntries) const {
+  // Oldest first
+  uint16_t count = traceCount < maxEntries ? traceCount : maxEntries;
+  uint16_t start = (traceHead + BMO_BUS_TRACE_SIZE - traceCount) % BMO_BUS_TRACE_SIZE;
+  for (uint16_t i = 0; i < count; i++) {
+    out[i] = trace[(start + i) % BMO_BUS_TRACE_SIZE];
+  }
+  return count;
+}
+
+void BMODisplay::printBusTrace() {
+  static const char* const eventNames[] = { "select", "slice begin", "slice end" };
+  
+  Serial.println("=== BMO Bus Trace ===");
+  uint16_t start = (traceHead + BMO_BUS_TRACE_SIZE - traceCount) % BMO_BUS_TRACE_SIZE;
+  uint32_t first = traceCount ? trace[start].timestamp : 0;
+  for (uint16_t i = 0; i < traceCount; i++) {
+    const BMOBusTraceEntry& entry = trace[(start + i) % BMO_BUS_TRACE_SIZE];
+    Serial.printf("+%8lu us  panel %u  %s\n", (unsigned long)(entry.timestamp - first),
+                  entry.panel, eventNames[entry.event]);
+  }
+  Serial.println("=====================");
+}
+#endif
+
+void BMODisplay::clear(uint16_t color) {
+  spiQueue.drain();
+  tft.fillScreen(color);
+  const BMOPanelState* panel = getPanel(activePanel >= 0 ? activePanel : 0);
+  notePixels(1, panel ? (uint32_t)panel->width * panel->height : DISPLAY_WIDTH * DISPLAY_HEIGHT);
+}
+
+void BMODisplay::startWrite() {
+  tft.startWrite();
+  stats.transactions++;
+  writeStart = micros();
+  if (!writeStart) writeStart = 1;
+}
+
 void BMODisplay::endWrite() {
-  if (tft) {
-    tft->endWrite();
+  spiQueue.drain();
+  tft.endWrite();
+  if (writeStart) {
+    stats.writeTime.record(micros() - writeStart);
+    writeStart = 0;
   }
 }
 
 void BMODisplay::setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-  if (tft) {
-    tft->setAddrWindow(x, y, w, h);
-  }
+  spiQueue.drain();
+  tft.setAddrWindow(x, y, w, h);
+  notePixels(1, 0);
 }
 
 bool BMODisplay::initializeSPI() {
-  // Configure SPI pins
-  pinMode(TFT_CS, OUTPUT);
-  pinMode(TFT_RST, OUTPUT);
+  // Configure SPI pins - every panel deselected, shared DC
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (panels[i].pins.cs >= 0) {
+      pinMode(panels[i].pins.cs, OUTPUT);
+      digitalWrite(panels[i].pins.cs, HIGH);
+    }
+    if (panels[i].pins.rst >= 0) {
+      pinMode(panels[i].pins.rst, OUTPUT);
+      digitalWrite(panels[i].pins.rst, HIGH);
+    }
+  }
   pinMode(TFT_DC, OUTPUT);
-  
-  // Initial pin states
-  digitalWrite(TFT_CS, HIGH);
-  digitalWrite(TFT_RST, HIGH);
   digitalWrite(TFT_DC, HIGH);
   
-  // Hardware reset
-  digitalWrite(TFT_RST, LOW);
+  // Hardware reset (all panels together)
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (panels[i].pins.rst >= 0) digitalWrite(panels[i].pins.rst, LOW);
+  }
   delay(10);
-  digitalWrite(TFT_RST, HIGH);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (panels[i].pins.rst >= 0) digitalWrite(panels[i].pins.rst, HIGH);
+  }
   delay(120);
   
   Serial.println("SPI pins configured and display reset complete");
   return true;
 }
 
-bool BMODisplay::detectController() {
-  // Try to read display ID to detect controller type
+bool BMODisplay::detectController(uint8_t index) {
+  // Try to read display ID to detect controller type (panel already selected)
   uint32_t id = 0;
+  BMOPanelState& panel = panels[index];
   
-  digitalWrite(TFT_CS, LOW);
-  tft->writecommand(0x04);  // Read Display ID command
+  sendCommand(0x04);  // Read Display ID command
   
   // Read 3 bytes of ID
-  id = tft->readcommand8(0x04, 1);
+  id = tft.readcommand8(0x04, 1);
   id <<= 8;
-  id |= tft->readcommand8(0x04, 2);
+  id |= tft.readcommand8(0x04, 2);
   id <<= 8;
-  id |= tft->readcommand8(0x04, 3);
+  id |= tft.readcommand8(0x04, 3);
   
-  digitalWrite(TFT_CS, HIGH);
-  
-  Serial.printf("Display ID: 0x%06X\n", id);
+  Serial.printf("Panel %d Display ID: 0x%06X\n", index, id);
   
   // Identify controller based on ID
   if ((id & 0xFFFF) == 0x9341) {
-    controller = CONTROLLER_ILI9341;
+    panel.controller = CONTROLLER_ILI9341;
     Serial.println("Detected ILI9341 controller");
-    return true;
   } else if ((id & 0xFFFF) == 0x7789 || (id & 0xFF) == 0x85) {
-    controller = CONTROLLER_ST7789;
+    panel.controller = CONTROLLER_ST7789;
     Serial.println("Detected ST7789 controller");
-    return true;
   } else {
     // Default to ILI9341 if detection fails
-    controller = CONTROLLER_ILI9341;
+    panel.controller = CONTROLLER_ILI9341;
     Serial.println("Controller detection uncertain, defaulting to ILI9341");
-    return true;
   }
+  
+  // The glass comes with the controller, and so does its color order
+  panel.colorOrder = panel.controller == CONTROLLER_ST7789 ? BMO_ST7789_COLOR_ORDER : BMO_ILI9341_COLOR_ORDER;
+  return true;
 }
 
-bool BMODisplay::configureDisplay() {
+bool BMODisplay::configureDisplay(uint8_t index) {
+  const BMOPanelState& panel = panels[index];
+  
   // Set display orientation and dimensions
-  tft->setRotation(DISPLAY_ROTATION);
+  tft.setRotation(panel.rotation);
+  tftRotation = panel.rotation;
+  tft.setViewport(0, 0, panel.width, panel.height);
   
-  // Verify dimensions match expected values
-  if (tft->width() != DISPLAY_WIDTH || tft->height() != DISPLAY_HEIGHT) {
+  // Verify the panel fits the controller's addressable area
+  if (tft.width() < panel.width || tft.height() < panel.height) {
     Serial.printf("Warning: Unexpected display dimensions %dx%d (expected %dx%d)\n",
-                  tft->width(), tft->height(), DISPLAY_WIDTH, DISPLAY_HEIGHT);
+                  tft.width(), tft.height(), panel.width, panel.height);
   }
   
   // Controller-specific configuration
-  switch (controller) {
+  switch (panel.controller) {
     case CONTROLLER_ILI9341:
-      return initILI9341();
+      return initILI9341(panel);
     case CONTROLLER_ST7789:
-      return initST7789();
+      return initST7789(panel);
     default:
-      return initILI9341();  // Fallback
+      return initILI9341(panel);  // Fallback
   }
 }
 
-bool BMODisplay::initILI9341() {
+bool BMODisplay::initILI9341(const BMOPanelState& panel) {
   // ILI9341-specific initialization sequence
   Serial.println("Configuring for ILI9341 controller");
   
   // Enable extended command set (if needed)
-  tft->writecommand(0xEF);
-  tft->writedata(0x03);
-  tft->writedata(0x80);
-  tft->writedata(0x02);
+  sendCommand(0xEF);
+  sendData(0x03);
+  sendData(0x80);
+  sendData(0x02);
   
   // Power control settings
-  tft->writecommand(0xCF);
-  tft->writedata(0x00);
-  tft->writedata(0xC1);
-  tft->writedata(0x30);
+  sendCommand(0xCF);
+  sendData(0x00);
+  sendData(0xC1);
+  sendData(0x30);
   
   // Display inversion off
-  tft->writecommand(0x20);
+  sendCommand(0x20);
   
   // Memory access control
-  tft->writecommand(0x36);
-  tft->writedata(0x48);  // Portrait mode, RGB order
+  sendCommand(0x36);
+  sendData(bmoMadctlILI9341(panel.rotation, panel.colorOrder));
   
   return true;
 }
 
-bool BMODisplay::initST7789() {
+bool BMODisplay::initST7789(const BMOPanelState& panel) {
   // ST7789-specific initialization sequence
   Serial.println("Configuring for ST7789 controller");
   
   // Memory access control
-  tft->writecommand(0x36);
-  tft->writedata(0x00);  // Portrait mode, RGB order
+  sendCommand(0x36);
+  sendData(bmoMadctlST7789(panel.rotation, panel.colorOrder));
   
   // Interface pixel format
-  tft->writecommand(0x3A);
-  tft->writedata(0x05);  // 16-bit color
+  sendCommand(0x3A);
+  sendData(0x05);  // 16-bit color
   
   return true;
 }
 
 void BMODisplay::initializeBacklight() {
-  pinMode(TFT_LED, OUTPUT);
-  
-  // Configure PWM for smooth brightness control
-  analogWriteFrequency(TFT_LED, 1000);  // 1kHz PWM frequency
-  
-  // Start with backlight off
-  analogWrite(TFT_LED, 0);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    int8_t pin = panels[i].pins.backlight;
+    if (pin < 0) continue;
+    
+    pinMode(pin, OUTPUT);
+    
+    // Configure PWM for smooth brightness control
+    analogWriteFrequency(pin, 1000);  // 1kHz PWM frequency
+    
+    // Start with backlight off
+    analogWrite(pin, 0);
+  }
   
   Serial.println("Backlight control initialized");
 }
@@ -305,7 +635,7 @@ bool BMODisplay::testDisplay() {
   Serial.println("Running display tests...");
   
   // Test 1: SPI communication
-  if (!testSPIConnection()) {
+  if (!testSPIConnection(activePanel >= 0 ? activePanel : 0)) {
     return false;
   }
   
@@ -315,30 +645,27 @@ bool BMODisplay::testDisplay() {
   }
   
   // Test 3: Basic drawing
-  tft->fillScreen(0x0000);  // Black
+  clear(0x0000);  // Black
   delay(100);
-  tft->fillScreen(0xFFFF);  // White
+  clear(0xFFFF);  // White
   delay(100);
-  tft->fillScreen(0xF800);  // Red
+  clear(0xF800);  // Red
   delay(100);
-  tft->fillScreen(0x07E0);  // Green
+  clear(0x07E0);  // Green
   delay(100);
-  tft->fillScreen(0x001F);  // Blue
+  clear(0x001F);  // Blue
   delay(100);
-  tft->fillScreen(0x0000);  // Black
+  clear(0x0000);  // Black
   
   Serial.println("All display tests passed!");
   return true;
 }
 
-bool BMODisplay::testSPIConnection() {
-  // Try to read display status
-  digitalWrite(TFT_CS, LOW);
-  tft->writecommand(0x09);  // Read Display Status
-  uint8_t status = tft->readcommand8(0x09, 1);
-  digitalWrite(TFT_CS, HIGH);
+bool BMODisplay::testSPIConnection(uint8_t index) {
+  // Try to read display power mode (panel already selected)
+  uint8_t status = readRegister(0x0A);
   
-  Serial.printf("Display status register: 0x%02X\n", status);
+  Serial.printf("Panel %d power mode register: 0x%02X\n", index, status);
   
   // Basic validation - status should not be 0x00 or 0xFF
   return (status != 0x00 && status != 0xFF);
@@ -349,13 +676,35 @@ bool BMODisplay::testDisplayMemory() {
   uint16_t testColor = 0x7E0;  // Green
   
   // Write a test pixel
-  tft->drawPixel(10, 10, testColor);
+  tft.drawPixel(10, 10, testColor);
+  notePixels(1, 1);
   
   // Note: Reading pixels is not always supported
   // This test mainly verifies write operations work
   return true;
 }
 
+uint8_t BMODisplay::readRegister(uint8_t command) {
+  spiQueue.drain();
+  stats.commands++;
+  stats.spiBytes += 2;
+  
+  // TFT_eSPI's readcommand8() picks the byte through 0xD9, which only the
+  // ILI9341 implements; anything else gets a plain read of the first byte
+  BMOPanelState* panel = activePanel >= 0 ? &panels[activePanel] : nullptr;
+  if (!panel || panel->controller == CONTROLLER_ILI9341) return tft.readcommand8(command, 1);
+  
+  SPIClass& spi = tft.getSPIinstance();
+  setChipSelect(activePanel, true);  // TFT_eSPI may have raised a CS it drives itself
+  spi.beginTransaction(SPISettings(SPI_READ_FREQUENCY, MSBFIRST, TFT_SPI_MODE));
+  digitalWrite(TFT_DC, LOW);
+  spi.transfer(command);
+  digitalWrite(TFT_DC, HIGH);
+  uint8_t value = spi.transfer(0x00);
+  spi.endTransaction();
+  return value;
+}
+
 void BMODisplay::setError(DisplayStatus errorStatus, const char* message) {
   status = errorStatus;
   lastError = message;
@@ -370,7 +719,63 @@ void BMODisplay::printDisplayInfo() {
     (controller == CONTROLLER_ST7789) ? "ST7789" : "Unknown");
   Serial.printf("Dimensions: %dx%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
   Serial.printf("Rotation: %d\n", DISPLAY_ROTATION);
+  for (uint8_t i = 1; i < panelCount; i++) {
+    Serial.printf("Panel %d: %dx%d, CS=%d, %s\n", i, panels[i].width, panels[i].height,
+                  panels[i].pins.cs, panels[i].controller == CONTROLLER_ST7789 ? "ST7789" : "ILI9341");
+  }
   Serial.printf("Backlight: %d/255\n", backlightLevel);
   Serial.printf("SPI Frequency: %d Hz\n", SPI_FREQUENCY);
+  Serial.printf("Pixels written: %llu, read: %llu\n",
+                (unsigned long long)stats.pixels, (unsigned long long)stats.pixelsRead);
+  Serial.printf("SPI bytes: %llu\n", (unsigned long long)stats.spiBytes);
+  Serial.printf("Transactions: %u, windows: %u, commands: %u\n",
+                (unsigned)stats.transactions, (unsigned)stats.windows, (unsigned)stats.commands);
+  Serial.printf("Backlight updates: %u, panel switches: %u\n",
+                (unsigned)stats.backlightUpdates, (unsigned)stats.panelSwitches);
+  stats.writeTime.print("Write time");
+  if (stats.healthChecks > 0) {
+    Serial.printf("Health checks: %u, faults: %u\n", (unsigned)stats.healthChecks, (unsigned)stats.panelFaults);
+    Serial.printf("Recoveries: %u quick, %u full, %u failed\n", (unsigned)stats.quickRecoveries,
+                  (unsigned)stats.fullRecoveries, (unsigned)stats.failedRecoveries);
+    stats.recoveryTime.print("Recovery time");
+  }
   Serial.println("==============================");
-}
\ No newline at end of file
+  if (spiQueue.isReady()) spiQueue.printQueueInfo();
+}
+
+void BMODisplay::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+  spiQueue.resetStats();
+}
+
+uint32_t BMOHistogram::percentileUs(uint8_t percent) const {
+  if (count == 0) return 0;
+  
+  // Walk the buckets until the running count covers the percentile
+  uint32_t target = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+  uint32_t seen = 0;
+  for (int i = 0; i < BMO_HISTOGRAM_BUCKETS - 1; i++) {
+    seen += buckets[i];
+    if (seen >= target) return (uint32_t)BMO_HISTOGRAM_BASE_US << i;
+  }
+  return maxUs;
+}
+
+void BMOHistogram::print(const char* label) const {
+  if (count == 0) {
+    Serial.printf("%s: no samples\n", label);
+    return;
+  }
+  // In pieces under the core's 64-byte printf buffer, so a report never
+  // takes one from the heap
+  Serial.printf("%s: %u samples, mean %u us, ", label, (unsigned)count, (unsigned)(totalUs / count));
+  Serial.printf("p50 <%u us, p99 <%u us, max %u us\n",
+                (unsigned)percentileUs(50), (unsigned)percentileUs(99), (unsigned)maxUs);
+  
+  // Bucket counts, fastest first
+  Serial.print("  ");
+  for (int i = 0; i < BMO_HISTOGRAM_BUCKETS; i++) {
+    Serial.printf("%s%u", i ? " " : "", (unsigned)buckets[i]);
+  }
+  Serial.println("");
+}
@@ -10,6 +10,14 @@
  * - Backlight control
  * - Error handling and recovery
  * - Performance optimization
+ * - Several panels on one SPI bus (per-panel CS, reset and backlight)
+ * - Round-robin scheduling of drawing work across panels
+ * - Always-on bus metrics: pixels, SPI bytes, transactions, address windows
+ *   and a histogram of time spent inside startWrite()/endWrite()
+ * - Panel health watchdog: status, MADCTL and COLMOD read back and a panel
+ *   that lost them (ESD, brown-out) reinitialized in place
+ * - Optional queued DMA transfers (see spi_queue.h) for drawing code that
+ *   renders while the bus is busy
  */
 
 #ifndef BMO_DISPLAY_H
@@ -18,14 +26,18 @@
 #include <Arduino.h>
 #include <TFT_eSPI.h>
 #include <SPI.h>
+#include "panel.h"
+#include "spi_queue.h"
 
-// Display specifications
-#define DISPLAY_WIDTH  240
-#define DISPLAY_HEIGHT 320
-#define DISPLAY_ROTATION 0  // Portrait mode
+// Display specifications (from the compile-time panel profile, see panel.h)
+#define DISPLAY_WIDTH  (BMOActivePanel::WIDTH)
+#define DISPLAY_HEIGHT (BMOActivePanel::HEIGHT)
+#define DISPLAY_ROTATION (BMOActivePanel::ROTATION)  // 0 = portrait
 
 // Pin definitions (matching hardware wiring plan)
-#define TFT_CS    10  // GPIO10 - Chip Select
+#ifndef TFT_CS
+#define TFT_CS    10  // GPIO10 - Chip Select (-1 = BMODisplay drives CS, multi-panel)
+#endif
 #define TFT_RST   9   // GPIO9  - Reset
 #define TFT_DC    8   // GPIO8  - Data/Command
 #define TFT_MOSI  11  // GPIO11 - SPI Data Out
@@ -33,9 +45,60 @@
 #define TFT_LED   7   // GPIO7  - Backlight Control
 #define TFT_MISO  12  // GPIO12 - SPI Data In (optional)
 
+// Multi-panel configuration
+// Extra panels share SCK/MOSI/MISO and the DC line with the face panel and
+// get their own CS. TFT_eSPI must be built with TFT_CS=-1 so it leaves chip
+// select to BMODisplay. All panels must use TFT_eSPI's controller family.
+#ifndef BMO_MAX_PANELS
+#define BMO_MAX_PANELS 2
+#endif
+
+#ifndef BMO_FACE_CS
+#define BMO_FACE_CS (TFT_CS >= 0 ? TFT_CS : 10)  // Face panel chip select
+#endif
+
+#ifndef BMO_ENABLE_STATUS_PANEL
+#define BMO_ENABLE_STATUS_PANEL 0  // Second small panel next to the face
+#endif
+
+#ifndef BMO_STATUS_CS
+#define BMO_STATUS_CS   6   // GPIO6 - Status panel Chip Select
+#endif
+#ifndef BMO_STATUS_RST
+#define BMO_STATUS_RST  -1  // -1 = reset wired to TFT_RST
+#endif
+#ifndef BMO_STATUS_LED
+#define BMO_STATUS_LED  -1  // -1 = backlight tied on
+#endif
+
+// Record panel selects and job slices for printBusTrace()
+#ifndef BMO_BUS_TRACE
+#define BMO_BUS_TRACE 0
+#endif
+#define BMO_BUS_TRACE_SIZE 64
+
+// Panel health watchdog (needs MISO wired - panels that can't be read back
+// are left alone)
+#ifndef BMO_ENABLE_WATCHDOG
+#define BMO_ENABLE_WATCHDOG 0
+#endif
+#define BMO_WATCHDOG_INTERVAL  2000  // ms between health checks
+
 // SPI configuration
 #define SPI_FREQUENCY  27000000  // 27MHz - safe speed for ESP32
 #define SPI_READ_FREQUENCY 20000000  // Slower for read operations
+#ifndef TFT_SPI_MODE
+#define TFT_SPI_MODE SPI_MODE0  // Set by TFT_eSPI's driver setup where a controller needs another
+#endif
+
+// Bus cost model for the metrics (MIPI DCS, as TFT_eSPI drives it)
+#define BMO_WINDOW_SPI_BYTES  11  // CASET + 4, RASET + 4, RAMWR
+#define BMO_READ_SPI_BYTES    2   // RAMRD + dummy byte, then 3 bytes per pixel
+
+// Latency histograms: bucket 0 is under BASE, bucket i under BASE << i,
+// the last bucket catches everything slower (65ms and up)
+#define BMO_HISTOGRAM_BUCKETS  12
+#define BMO_HISTOGRAM_BASE_US  64
 
 // Display controller types
 enum DisplayController {
@@ -44,6 +107,95 @@ enum DisplayController {
   CONTROLLER_ST7789
 };
 
+// Pins owned by one panel (-1 = not connected / shared)
+struct BMOPanelPins {
+  int8_t cs;
+  int8_t rst;
+  int8_t backlight;
+};
+
+// Per-panel state
+struct BMOPanelState {
+  BMOPanelPins pins;
+  int16_t width;
+  int16_t height;
+  uint8_t rotation;
+  BMOColorOrder colorOrder;       // The controller's (see detectController())
+  DisplayController controller;
+  uint8_t backlightLevel;
+  bool ready;
+  bool monitored;   // Registers read back after init, so checkPanels() can trust them
+};
+
+// Result of a panel health check
+enum BMOPanelHealth {
+  PANEL_HEALTH_OK = 0,
+  PANEL_HEALTH_ASLEEP,      // Sleep-in or display off - what a reset leaves behind
+  PANEL_HEALTH_MADCTL,      // Orientation or color order lost
+  PANEL_HEALTH_COLMOD       // Pixel format lost
+};
+
+// One bounded slice of drawing for a panel; returns true when the work is done
+typedef bool (*BMOPanelJob)(void* context);
+
+// Bus trace entry
+enum BMOBusEvent {
+  BUS_EVENT_SELECT = 0,
+  BUS_EVENT_SLICE_BEGIN,
+  BUS_EVENT_SLICE_END
+};
+
+struct BMOBusTraceEntry {
+  uint32_t timestamp;  // micros()
+  uint8_t panel;
+  uint8_t event;       // BMOBusEvent
+};
+
+// Fixed-bucket latency histogram (power-of-two buckets, recording is a few
+// integer ops so it stays on in production)
+struct BMOHistogram {
+  uint32_t buckets[BMO_HISTOGRAM_BUCKETS];
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  
+  void record(uint32_t us) {
+    int bucket = 0;
+    if (us >= BMO_HISTOGRAM_BASE_US) {
+      bucket = (31 - __builtin_clz(us)) - (31 - __builtin_clz(BMO_HISTOGRAM_BASE_US)) + 1;
+      if (bucket >= BMO_HISTOGRAM_BUCKETS) bucket = BMO_HISTOGRAM_BUCKETS - 1;
+    }
+    buckets[bucket]++;
+    count++;
+    totalUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+  void reset() { memset(this, 0, sizeof(*this)); }
+  uint32_t percentileUs(uint8_t percent) const;  // Upper bound of the bucket holding it
+  void print(const char* label) const;
+};
+
+// Bus metrics (see getStats())
+struct BMODisplayStats {
+  uint64_t pixels;            // Pixels written to panel memory
+  uint64_t pixelsRead;        // Pixels read back (mirror)
+  uint64_t spiBytes;          // Bytes on the bus, from the cost model above
+  uint32_t transactions;      // Chip-select assertions
+  uint32_t windows;           // Address window changes
+  uint32_t commands;          // Controller commands outside pixel writes
+  uint32_t backlightUpdates;
+  uint32_t panelSwitches;
+  BMOHistogram writeTime;     // Time inside startWrite()/endWrite()
+  
+  // Watchdog
+  uint32_t healthChecks;      // Panels checked
+  uint32_t panelFaults;       // Checks that failed
+  uint32_t quickRecoveries;   // Fixed by restoring the registers
+  uint32_t fullRecoveries;    // Needed the whole init sequence again
+  uint32_t failedRecoveries;
+  BMOHistogram recoveryTime;  // Fault detected to panel verified
+};
+
 // Display status codes
 enum DisplayStatus {
   DISPLAY_OK = 0,
@@ -64,6 +216,26 @@ public:
   DisplayStatus getStatus() const { return status; }
   DisplayController getController() const { return controller; }
   
+  // Panels (call addPanel before begin(); without it the face panel is added
+  // from the pin definitions above). Returns the panel index or -1.
+  int addPanel(const BMOPanelPins& pins, int16_t width, int16_t height, uint8_t rotation);
+  template <class Panel>
+  int addPanel(const BMOPanelPins& pins) {
+    return addPanel(pins, Panel::WIDTH, Panel::HEIGHT, Panel::ROTATION);
+  }
+  bool selectPanel(uint8_t index);
+  int getActivePanel() const { return activePanel; }
+  uint8_t getPanelCount() const { return panelCount; }
+  const BMOPanelState* getPanel(uint8_t index) const { return index < panelCount ? &panels[index] : nullptr; }
+  
+  // Drawing work scheduled across panels. Each panel holds one job (queueing
+  // again restarts it); serviceJobs() runs one slice per busy panel in turn,
+  // so a long redraw on one panel never holds off the others.
+  bool queueJob(uint8_t panel, BMOPanelJob job, void* context);
+  void serviceJobs();
+  bool isPanelBusy(uint8_t panel) const { return panel < panelCount && jobs[panel].job != nullptr; }
+  bool hasPendingJobs() const;
+  
   // Backlight control
   void setBacklight(uint8_t brightness);  // 0-255
   uint8_t getBacklight() const { return backlightLevel; }
@@ -76,11 +248,34 @@ public:
   void reset();
   void clear(uint16_t color = 0x0000);
   
-  // Performance optimization
+  // Health watchdog. checkPanels() verifies every monitored panel and
+  // recovers the ones that fail; it returns a bitmask of panels whose
+  // contents were lost and must be redrawn. Call it between transactions.
+  BMOPanelHealth checkPanelHealth(uint8_t index);
+  uint8_t checkPanels();
+  
+  // Performance optimization (startWrite/endWrite are timed for the metrics)
   void startWrite();
   void endWrite();
   void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
   
+  // Metrics. Drawing code reports what it sends through the shared driver:
+  // windows opened and pixels written (one transaction each outside startWrite)
+  const BMODisplayStats& getStats() const { return stats; }
+  void resetStats();
+  void notePixels(uint32_t windows, uint32_t pixels) {
+    stats.windows += windows;
+    stats.pixels += pixels;
+    stats.spiBytes += (uint64_t)windows * BMO_WINDOW_SPI_BYTES + (uint64_t)pixels * 2;
+    if (!writeStart) stats.transactions++;
+  }
+  void noteReadback(uint32_t pixels) {
+    stats.windows++;
+    stats.pixelsRead += pixels;
+    stats.spiBytes += BMO_WINDOW_SPI_BYTES + BMO_READ_SPI_BYTES + (uint64_t)pixels * 3;
+    if (!writeStart) stats.transactions++;
+  }
+  
   // Error handling
   const char* getLastError() const { return lastError; }
   void clearError() { lastError = nullptr; status = DISPLAY_OK; }
@@ -88,30 +283,90 @@ public:
   // Hardware information
   void printDisplayInfo();
   bool testDisplay();
+#if BMO_BUS_TRACE
+  void printBusTrace();
+  uint16_t getBusTrace(BMOBusTraceEntry* out, uint16_t maxEntries) const;
+#endif
+  
+  // Shared driver instance (used by BMOGraphics and friends)
+  TFT_eSPI* getTFT() { return &tft; }
+  
+  // Queued transfers on the same bus, or nullptr when they are off. Use
+  // them inside startWrite()/endWrite() only; whatever is still queued is
+  // drained before BMODisplay or TFT_eSPI send anything else.
+  BMOSpiQueue* getSpiQueue() { return spiQueue.isReady() ? &spiQueue : nullptr; }
   
 private:
-  TFT_eSPI* tft;
+  TFT_eSPI tft;  // The one and only driver object, statically allocated with BMODisplay
+  BMOSpiQueue spiQueue;
   DisplayStatus status;
   DisplayController controller;
   uint8_t backlightLevel;
   const char* lastError;
   bool initialized;
+  bool sleeping;  // Put to sleep on purpose - not a fault
+  
+  // Panels on the bus
+  BMOPanelState panels[BMO_MAX_PANELS];
+  uint8_t panelCount;
+  int8_t activePanel;
+  uint8_t tftRotation;
+  
+  // Pending job per panel and round-robin position
+  struct PanelJobSlot {
+    BMOPanelJob job;
+    void* context;
+  };
+  PanelJobSlot jobs[BMO_MAX_PANELS];
+  uint8_t nextJobPanel;
+  
+  // Metrics
+  BMODisplayStats stats;
+  uint32_t writeStart;  // micros() at startWrite(), 0 outside a transaction
+  
+#if BMO_BUS_TRACE
+  BMOBusTraceEntry trace[BMO_BUS_TRACE_SIZE];
+  uint16_t traceHead;
+  uint16_t traceCount;
+  void recordBus(uint8_t panel, BMOBusEvent event);
+#else
+  void recordBus(uint8_t, BMOBusEvent) {}
+#endif
   
   // Initialization helpers
   bool initializeSPI();
-  bool detectController();
-  bool configureDisplay();
+  bool detectController(uint8_t index);
+  bool configureDisplay(uint8_t index);
   void initializeBacklight();
+  void setChipSelect(uint8_t index, bool active);
   
   // Controller-specific initialization
-  bool initILI9341();
-  bool initST7789();
+  bool initILI9341(const BMOPanelState& panel);
+  bool initST7789(const BMOPanelState& panel);
+  
+  // Watchdog recovery
+  bool restorePanel(uint8_t index);
+  uint8_t reinitializeBus();
+  
+  // Metered controller access
+  void sendCommand(uint8_t command) {
+    spiQueue.drain();
+    tft.writecommand(command);
+    stats.commands++;
+    stats.spiBytes++;
+  }
+  void sendData(uint8_t data) {
+    spiQueue.drain();
+    tft.writedata(data);
+    stats.spiBytes++;
+  }
+  uint8_t readRegister(uint8_t command);  // One-byte read registers (RDDPM, RDDMADCTL, RDDCOLMOD)
   
   // Error handling
   void setError(DisplayStatus errorStatus, const char* message);
   
   // Hardware test functions
-  bool testSPIConnection();
+  bool testSPIConnection(uint8_t index);
   bool testDisplayMemory();
 };
 
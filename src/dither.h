@@ -0,0 +1,134 @@
+/*
+ * BMO Ordered Dithering
+ *
+ * RGB565 has 32 levels of red and blue, so a slow ramp like the background
+ * gradient or a fade shows as bands a few rows wide. Colors that are worked
+ * out at higher precision (gradients, blends, fades, anti-aliased edges) can
+ * instead be converted a scanline at a time through an ordered dither, which
+ * breaks each band edge up into a fine fixed pattern.
+ *
+ * Features:
+ * - BMOColorQ8: the RGB565 channels with 8 more fraction bits
+ * - 4x4 or 8x8 Bayer threshold table built at compile time
+ * - Integer adds and shifts only. The threshold is added to the fraction and
+ *   the sum truncated, which can never carry out of a channel.
+ * - Exact colors stay exact: a channel without a fraction never dithers
+ * - Spans of one color (a gradient row, a fade) work out one tile row of
+ *   pixels and repeat it
+ * - No Arduino dependencies, so tools/dither_bench.cpp builds it on the host
+ *
+ * The pattern is tied to screen coordinates, not to what is drawn, so a
+ * partial repaint reproduces exactly the pixels that were there
+ */
+
+#ifndef BMO_DITHER_H
+#define BMO_DITHER_H
+
+#include <stdint.h>
+
+// The dithered output stage is optional, enable with -DBMO_ENABLE_DITHER=1
+// (without it these colors are truncated to RGB565 as before)
+#ifndef BMO_ENABLE_DITHER
+#define BMO_ENABLE_DITHER 0
+#endif
+
+#ifndef DITHER_SIZE
+#define DITHER_SIZE       8    // Threshold tile, 4 or 8 pixels square
+#endif
+#define DITHER_MASK       (DITHER_SIZE - 1)
+
+static_assert(DITHER_SIZE == 4 || DITHER_SIZE == 8, "DITHER_SIZE must be 4 or 8");
+
+// A color between RGB565 values: red and blue are 5.8 fixed point, green 6.8
+struct BMOColorQ8 {
+  uint16_t r;
+  uint16_t g;
+  uint16_t b;
+};
+
+// Thresholds 0-255, one per pixel of the tile, spread evenly so that a
+// fraction f rounds up on f/256 of the tile
+struct BMODitherTable {
+  uint8_t threshold[DITHER_SIZE][DITHER_SIZE];
+
+  // Bayer index: the bits of x ^ y and y interleaved, in reverse order
+  static constexpr uint8_t bayer(int x, int y) {
+    uint8_t index = 0;
+    for (int bit = 1; bit < DITHER_SIZE; bit <<= 1) {
+      index = (uint8_t)(index << 2 | ((x ^ y) & bit ? 2 : 0) | (y & bit ? 1 : 0));
+    }
+    return index;
+  }
+
+  constexpr BMODitherTable() : threshold{} {
+    for (int y = 0; y < DITHER_SIZE; y++) {
+      for (int x = 0; x < DITHER_SIZE; x++) {
+        // Centered in each step, so no threshold is 0 and none reaches 256
+        threshold[y][x] = (uint8_t)((2 * bayer(x, y) + 1) * 128 / (DITHER_SIZE * DITHER_SIZE));
+      }
+    }
+  }
+};
+
+static constexpr BMODitherTable DITHER_TABLE{};
+
+// The tile row for screen row y
+static inline const uint8_t* bmoDitherRow(int y) {
+  return DITHER_TABLE.threshold[y & DITHER_MASK];
+}
+
+static inline BMOColorQ8 bmoColorQ8(uint16_t color) {
+  BMOColorQ8 q = { (uint16_t)((color >> 11) << 8), (uint16_t)(((color >> 5) & 0x3F) << 8),
+                   (uint16_t)((color & 0x1F) << 8) };
+  return q;
+}
+
+// from towards to, alpha 0 (from) to 65536 (to)
+static inline BMOColorQ8 bmoMixQ8(uint16_t from, uint16_t to, uint32_t alpha) {
+  BMOColorQ8 a = bmoColorQ8(from);
+  BMOColorQ8 b = bmoColorQ8(to);
+  if (alpha > 65536) alpha = 65536;
+  // A channel difference times alpha still fits in 31 bits
+  BMOColorQ8 q = { (uint16_t)(a.r + (((int32_t)b.r - a.r) * (int32_t)alpha >> 16)),
+                   (uint16_t)(a.g + (((int32_t)b.g - a.g) * (int32_t)alpha >> 16)),
+                   (uint16_t)(a.b + (((int32_t)b.b - a.b) * (int32_t)alpha >> 16)) };
+  return q;
+}
+
+// The blend565() mix of two colors, alpha 0 (from) to 256 (to), before
+// its final shift drops the fraction
+static inline BMOColorQ8 bmoBlendQ8(uint16_t from, uint16_t to, uint32_t alpha) {
+  if (alpha > 256) alpha = 256;
+  BMOColorQ8 q = { (uint16_t)((from >> 11) * (256 - alpha) + (to >> 11) * alpha),
+                   (uint16_t)(((from >> 5) & 0x3F) * (256 - alpha) + ((to >> 5) & 0x3F) * alpha),
+                   (uint16_t)((from & 0x1F) * (256 - alpha) + (to & 0x1F) * alpha) };
+  return q;
+}
+
+// One pixel against its threshold
+static inline uint16_t bmoDither565(const BMOColorQ8& color, uint8_t threshold) {
+  return (uint16_t)(((color.r + threshold) >> 8) << 11 | ((color.g + threshold) >> 8) << 5 |
+                    ((color.b + threshold) >> 8));
+}
+
+// The fraction dropped, as blend565() and RGB565 conversion do without dithering
+static inline uint16_t bmoTruncate565(const BMOColorQ8& color) {
+  return (uint16_t)((color.r >> 8) << 11 | (color.g >> 8) << 5 | (color.b >> 8));
+}
+
+// width pixels of one color starting at screen x, y
+static inline void bmoDitherSpan(uint16_t* out, int x, int y, int width, const BMOColorQ8& color) {
+  const uint8_t* row = bmoDitherRow(y);
+  uint16_t tile[DITHER_SIZE];
+  for (int i = 0; i < DITHER_SIZE; i++) tile[i] = bmoDither565(color, row[(x + i) & DITHER_MASK]);
+  for (int i = 0; i < width; i++) out[i] = tile[i & DITHER_MASK];
+}
+
+// blend565() with the fraction dithered instead of dropped
+static inline uint16_t bmoDitherBlend(uint16_t from, uint16_t to, uint32_t alpha, uint8_t threshold) {
+  if (alpha == 0) return from;
+  if (alpha >= 256) return to;
+  return bmoDither565(bmoBlendQ8(from, to, alpha), threshold);
+}
+
+#endif // BMO_DITHER_H
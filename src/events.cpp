@@ -0,0 +1,280 @@
+/*
+ * BMO Event Loop Implementation
+ *
+ * Event queue, timers, serial wake-up and sleep between deadlines
+ */
+
+#include "events.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_sleep.h>
+
+// Guards the queue against posts from the USB/serial event task
+static portMUX_TYPE eventLock = portMUX_INITIALIZER_UNLOCKED;
+#define EVENT_LOCK()   portENTER_CRITICAL(&eventLock)
+#define EVENT_UNLOCK() portEXIT_CRITICAL(&eventLock)
+
+// Native USB CDC raises an event when bytes arrive, so the loop can sleep
+// without polling the port
+#if ARDUINO_USB_CDC_ON_BOOT
+#if ARDUINO_USB_MODE
+#define BMO_SERIAL_RX_EVENT ARDUINO_HW_CDC_RX_EVENT
+#else
+#define BMO_SERIAL_RX_EVENT ARDUINO_USB_CDC_RX_EVENT
+#endif
+#endif
+#else
+#define EVENT_LOCK()
+#define EVENT_UNLOCK()
+#endif
+
+// Global event loop pointer
+BMOEventLoop* g_bmoEvents = nullptr;
+
+#ifdef BMO_SERIAL_RX_EVENT
+static void serialReceiveHandler(void*, esp_event_base_t, int32_t, void*) {
+  if (g_bmoEvents) g_bmoEvents->notifySerial();
+}
+#endif
+
+BMOEventLoop::BMOEventLoop()
+  : queue()
+  , head(0)
+  , count(0)
+  , timers()
+  , serial(nullptr)
+  , serialNotified(false)
+  , serialPending(false)
+  , busySince(0)
+  , loopTask(nullptr)
+  , stats()
+  , started(false)
+{
+}
+
+void BMOEventLoop::begin() {
+#if defined(ESP32)
+  loopTask = xTaskGetCurrentTaskHandle();
+#endif
+  resetStats();
+  started = true;
+  g_bmoEvents = this;
+  
+  Serial.printf("Event loop started (%s between events)\n",
+                BMO_EVENT_LIGHT_SLEEP ? "light sleep" : "task wait");
+}
+
+bool BMOEventLoop::post(uint8_t type, uint8_t id, uint16_t param) {
+  return postAt(type, id, param, millis());
+}
+
+bool BMOEventLoop::postAt(uint8_t type, uint8_t id, uint16_t param, uint32_t timestamp) {
+  bool queued = false;
+  
+  EVENT_LOCK();
+  if (count < BMO_EVENT_QUEUE_SIZE) {
+    BMOEvent& event = queue[(head + count) % BMO_EVENT_QUEUE_SIZE];
+    event.type = type;
+    event.id = id;
+    event.param = param;
+    event.timestamp = timestamp;
+    count = count + 1;
+    queued = true;
+  } else {
+    stats.dropped++;
+  }
+  EVENT_UNLOCK();
+  
+#if defined(ESP32) && !BMO_EVENT_LIGHT_SLEEP
+  // Cut the loop's wait short
+  if (queued && loopTask && loopTask != xTaskGetCurrentTaskHandle()) {
+    xTaskNotifyGive((TaskHandle_t)loopTask);
+  }
+#endif
+  return queued;
+}
+
+bool BMOEventLoop::pop(BMOEvent* event) {
+  bool popped = false;
+  
+  EVENT_LOCK();
+  if (count > 0) {
+    *event = queue[head];
+    head = (head + 1) % BMO_EVENT_QUEUE_SIZE;
+    count = count - 1;
+    popped = true;
+  }
+  EVENT_UNLOCK();
+  
+  if (popped && event->type == EVENT_SERIAL) {
+    serialPending = false;
+  }
+  return popped;
+}
+
+bool BMOEventLoop::startTimer(uint8_t id, uint32_t delayMs, uint32_t periodMs) {
+  // Restart an existing timer with the same id, otherwise take a free slot
+  Timer* slot = nullptr;
+  for (int i = 0; i < BMO_MAX_TIMERS; i++) {
+    if (timers[i].active && timers[i].id == id) {
+      slot = &timers[i];
+      break;
+    }
+    if (!timers[i].active && !slot) {
+      slot = &timers[i];
+    }
+  }
+  if (!slot) {
+    Serial.printf("Event Error: no free timer for id %d (raise BMO_MAX_TIMERS)\n", id);
+    return false;
+  }
+  
+  slot->id = id;
+  slot->deadline = millis() + delayMs;
+  slot->period = periodMs;
+  slot->active = true;
+  return true;
+}
+
+void BMOEventLoop::stopTimer(uint8_t id) {
+  for (int i = 0; i < BMO_MAX_TIMERS; i++) {
+    if (timers[i].active && timers[i].id == id) {
+      timers[i].active = false;
+    }
+  }
+}
+
+bool BMOEventLoop::isTimerActive(uint8_t id) const {
+  for (int i = 0; i < BMO_MAX_TIMERS; i++) {
+    if (timers[i].active && timers[i].id == id) return true;
+  }
+  return false;
+}
+
+void BMOEventLoop::watchSerial(Stream* stream) {
+  serial = stream;
+  serialNotified = false;
+  
+#ifdef BMO_SERIAL_RX_EVENT
+  if (stream == &Serial) {
+    Serial.onEvent(BMO_SERIAL_RX_EVENT, serialReceiveHandler);
+    serialNotified = true;
+  }
+#endif
+}
+
+void BMOEventLoop::notifySerial() {
+  // One EVENT_SERIAL in the queue at a time; the handler drains the stream
+  if (!serialPending) {
+    serialPending = true;
+    if (!post(EVENT_SERIAL)) serialPending = false;
+  }
+}
+
+void BMOEventLoop::fireTimers(uint32_t now) {
+  for (int i = 0; i < BMO_MAX_TIMERS; i++) {
+    Timer& timer = timers[i];
+    if (!timer.active || (int32_t)(now - timer.deadline) < 0) continue;
+    
+    uint32_t late = now - timer.deadline;
+    if (late > stats.maxTimerLateMs) stats.maxTimerLateMs = late;
+    stats.timerFires++;
+    
+    postAt(EVENT_TIMER, timer.id, 0, timer.deadline);
+    
+    if (timer.period) {
+      // Keep the cadence; skip missed periods rather than firing a burst
+      timer.deadline += timer.period;
+      if ((int32_t)(now - timer.deadline) >= 0) {
+        timer.deadline = now + timer.period;
+      }
+    } else {
+      timer.active = false;
+    }
+  }
+}
+
+uint32_t BMOEventLoop::msUntilNextDeadline(uint32_t now) const {
+  uint32_t next = UINT32_MAX;
+  for (int i = 0; i < BMO_MAX_TIMERS; i++) {
+    if (!timers[i].active) continue;
+    int32_t remaining = (int32_t)(timers[i].deadline - now);
+    if (remaining <= 0) return 0;
+    if ((uint32_t)remaining < next) next = remaining;
+  }
+  return next;
+}
+
+void BMOEventLoop::sleepFor(uint32_t ms) {
+  if (ms == 0) return;
+  
+#if defined(ESP32) && BMO_EVENT_LIGHT_SLEEP
+  // Light sleep wakes on the timer only; cap it so nothing waits forever
+  if (ms > 1000) ms = 1000;
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+  esp_light_sleep_start();
+#elif defined(ESP32)
+  // Blocked here the core runs the idle task (WAITI) until the deadline or a post()
+  ulTaskNotifyTake(pdTRUE, ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(ms));
+#else
+  delay(ms > 1000 ? 1000 : ms);
+#endif
+}
+
+bool BMOEventLoop::wait(BMOEvent* event) {
+  if (!started) return false;
+  
+  // Everything since the last event was handed out was spent handling it
+  uint32_t nowUs = micros();
+  if (busySince) stats.busyUs += nowUs - busySince;
+  
+  while (true) {
+    uint32_t now = millis();
+    fireTimers(now);
+    
+    // Polled serial (no RX callback on this stream)
+    if (serial && !serialNotified && !serialPending && serial->available() > 0) {
+      notifySerial();
+    }
+    
+    if (pop(event)) {
+      stats.events++;
+      busySince = micros();
+      if (!busySince) busySince = 1;
+      return true;
+    }
+    
+    uint32_t sleepMs = msUntilNextDeadline(now);
+    if (serial && !serialNotified && sleepMs > BMO_SERIAL_POLL_MS) {
+      sleepMs = BMO_SERIAL_POLL_MS;
+    }
+    
+    uint32_t sleepStart = micros();
+    sleepFor(sleepMs);
+    stats.idleUs += micros() - sleepStart;
+    stats.wakes++;
+  }
+}
+
+uint8_t BMOEventLoop::getIdlePercent() const {
+  uint64_t total = stats.idleUs + stats.busyUs;
+  return total ? (uint8_t)(stats.idleUs * 100 / total) : 0;
+}
+
+void BMOEventLoop::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+  busySince = 0;
+}
+
+void BMOEventLoop::printEventInfo() {
+  Serial.println("=== BMO Event Loop ===");
+  Serial.printf("Wakes: %u, events: %u, dropped: %u\n",
+                (unsigned)stats.wakes, (unsigned)stats.events, (unsigned)stats.dropped);
+  Serial.printf("Timer fires: %u, worst lateness: %u ms\n",
+                (unsigned)stats.timerFires, (unsigned)stats.maxTimerLateMs);
+  Serial.printf("Idle: %u%% (%lu ms asleep, %lu ms busy)\n", getIdlePercent(),
+                (unsigned long)(stats.idleUs / 1000), (unsigned long)(stats.busyUs / 1000));
+  Serial.println("======================");
+}
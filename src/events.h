@@ -0,0 +1,120 @@
+/*
+ * BMO Event Loop
+ *
+ * Tickless main loop: timers, serial input and animation ticks are posted
+ * to a queue and the CPU sleeps until the next deadline instead of polling
+ *
+ * Features:
+ * - Fixed-size event queue (no heap), safe to post from callbacks
+ * - One-shot and periodic timers with lateness tracking
+ * - Serial receive events (USB CDC RX callback, or a polling fallback)
+ * - Sleep until the next deadline (FreeRTOS wait or ESP32 light sleep)
+ * - Wake count, idle percentage and duty statistics
+ */
+
+#ifndef BMO_EVENTS_H
+#define BMO_EVENTS_H
+
+#include <Arduino.h>
+
+// Queue and timer table sizes
+#define BMO_EVENT_QUEUE_SIZE   16
+#define BMO_MAX_TIMERS         8
+
+// Sleep strategy between events:
+//   0 = block the loop task (FreeRTOS idles the core until a deadline or a post)
+//   1 = ESP32 light sleep - lowest power, but suspends the native USB link,
+//       so only for builds that don't talk over USB CDC
+#ifndef BMO_EVENT_LIGHT_SLEEP
+#define BMO_EVENT_LIGHT_SLEEP  0
+#endif
+
+// Longest the loop sleeps when serial input has no RX callback to wake it
+#define BMO_SERIAL_POLL_MS     20
+
+// Event types
+enum BMOEventType {
+  EVENT_NONE = 0,
+  EVENT_TIMER,      // id = timer id
+  EVENT_SERIAL,     // Bytes are waiting on the watched stream
+  EVENT_FRAME,      // Something changed, produce a frame (id = caller's reason)
+  EVENT_COMMAND,    // Host command (id = command type, param = arguments)
+  EVENT_USER        // Application defined
+};
+
+struct BMOEvent {
+  uint8_t type;         // BMOEventType
+  uint8_t id;
+  uint16_t param;
+  uint32_t timestamp;   // millis() when posted (timers: the deadline)
+};
+
+// Loop statistics
+struct BMOEventStats {
+  uint32_t wakes;              // Times the loop woke from sleep
+  uint32_t events;             // Events dispatched
+  uint32_t dropped;            // Posts lost to a full queue
+  uint32_t timerFires;
+  uint32_t maxTimerLateMs;     // Worst dispatch delay past a timer's deadline
+  uint64_t idleUs;             // Time spent sleeping
+  uint64_t busyUs;             // Time spent handling events
+};
+
+class BMOEventLoop {
+public:
+  BMOEventLoop();
+
+  void begin();
+
+  // Post an event (safe from callbacks and other tasks); false if the queue is full
+  bool post(uint8_t type, uint8_t id = 0, uint16_t param = 0);
+
+  // Timers (ids are the caller's; periodMs = 0 for one-shot)
+  bool startTimer(uint8_t id, uint32_t delayMs, uint32_t periodMs = 0);
+  void stopTimer(uint8_t id);
+  bool isTimerActive(uint8_t id) const;
+
+  // Post EVENT_SERIAL when bytes arrive on this stream
+  void watchSerial(Stream* stream);
+  void notifySerial();  // From a receive callback
+
+  // Sleep until an event is ready and return it
+  bool wait(BMOEvent* event);
+
+  // Statistics
+  const BMOEventStats& getStats() const { return stats; }
+  uint8_t getIdlePercent() const;
+  void resetStats();
+  void printEventInfo();
+
+private:
+  struct Timer {
+    uint32_t deadline;
+    uint32_t period;
+    uint8_t id;
+    bool active;
+  };
+
+  BMOEvent queue[BMO_EVENT_QUEUE_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t count;
+  Timer timers[BMO_MAX_TIMERS];
+  Stream* serial;
+  bool serialNotified;        // An RX callback wakes us, no polling needed
+  volatile bool serialPending;
+  uint32_t busySince;         // micros() when the last event was handed out
+  void* loopTask;             // Task blocked in wait(), woken by post()
+  BMOEventStats stats;
+  bool started;
+
+  bool postAt(uint8_t type, uint8_t id, uint16_t param, uint32_t timestamp);
+  bool pop(BMOEvent* event);
+  void fireTimers(uint32_t now);
+  uint32_t msUntilNextDeadline(uint32_t now) const;
+  void sleepFor(uint32_t ms);
+};
+
+// Global event loop instance
+extern BMOEventLoop* g_bmoEvents;
+
+#endif // BMO_EVENTS_H
@@ -0,0 +1,60 @@
+/*
+ * BMO Expression Bytecode
+ *
+ * Expressions are data: expressions/expressions.txt is compiled on the host
+ * by tools/expression_compiler.py into a display list per expression
+ * (src/expressions.h, src/expressions.cpp) that BMOGraphics interprets.
+ *
+ * Features:
+ * - One byte opcodes followed by fixed-size operands, in flash
+ * - Signed 8-bit coordinates in design pixels (240x320) relative to the
+ *   mouth center, scaled per panel when drawn
+ * - Built-in span tables, filled shapes, thick lines, Bezier strokes and
+ *   filled vector paths (see path.h)
+ * - Per-expression bounds worked out by the compiler, so changing only the
+ *   expression repaints just the mouth it replaces
+ */
+
+#ifndef BMO_EXPRESSION_OPS_H
+#define BMO_EXPRESSION_OPS_H
+
+#include <Arduino.h>
+
+// Bumped whenever the encoding changes; the generated tables must match
+#define EXPRESSION_FORMAT_VERSION 1
+
+// Opcodes (operands in brackets; c = int8 coordinate, u = uint8 size)
+enum BMOExpressionOp {
+  EXPRESSION_OP_END = 0,     // End of the list
+  EXPRESSION_OP_COLOR,       // [lo hi] Pen color, RGB565 (starts black)
+  EXPRESSION_OP_SHAPE,       // [id] Built-in span table, see BMOExpressionShape
+  EXPRESSION_OP_RECT,        // [c x, c y, u w, u h]
+  EXPRESSION_OP_ELLIPSE,     // [c cx, c cy, u rx, u ry] Filled
+  EXPRESSION_OP_LINE,        // [c x0, c y0, c x1, c y1, u thickness]
+  EXPRESSION_OP_CURVE,       // [c x0, c y0, c cx, c cy, c x1, c y1, u width] Quadratic stroke
+  EXPRESSION_OP_MOVE,        // [c x, c y] Path: start a contour
+  EXPRESSION_OP_LINE_TO,     // [c x, c y]
+  EXPRESSION_OP_QUAD_TO,     // [c cx, c cy, c x, c y]
+  EXPRESSION_OP_CUBIC_TO,    // [c c1x, c c1y, c c2x, c c2y, c x, c y]
+  EXPRESSION_OP_CLOSE,       // Close the current contour
+  EXPRESSION_OP_FILL,        // [rule] Fill the path with the pen and clear it
+  EXPRESSION_OP_COUNT
+};
+
+// Span tables from shapes.h reachable from EXPRESSION_OP_SHAPE
+enum BMOExpressionShape {
+  EXPRESSION_SHAPE_SMILE = 0,
+  EXPRESSION_SHAPE_GRIN,
+  EXPRESSION_SHAPE_SURPRISED,
+  EXPRESSION_SHAPE_COUNT
+};
+
+// Table entry per expression (bounds in design pixels, mouth center relative)
+struct BMOExpressionInfo {
+  uint16_t offset;          // Start of the display list in the program
+  int8_t left, top;         // Every pixel the list can touch
+  uint8_t width, height;
+  uint8_t eyes;             // Default EyeState
+};
+
+#endif // BMO_EXPRESSION_OPS_H
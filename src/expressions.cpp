@@ -0,0 +1,41 @@
+// Generated by tools/expression_compiler.py from expressions/expressions.txt - do not edit.
+// Rerun the compiler after changing the expressions.
+
+#include "expressions.h"
+
+const uint8_t bmoExpressionProgram[] = {
+  // happy
+  0x02, 0x00, 0x00,
+  // surprised
+  0x02, 0x02, 0x00,
+  // sleepy
+  0x05, 0xEC, 0x00, 0x14, 0x00, 0x03, 0x00,
+  // excited
+  0x02, 0x01, 0x00,
+  // confused
+  0x05, 0xE2, 0xFB, 0xE9, 0x05, 0x02, 0x05, 0xE9, 0x05, 0xF0, 0xFB, 0x02, 0x05, 0xF0, 0xFB, 0xF7,
+  0x05, 0x02, 0x05, 0xF7, 0x05, 0xFE, 0xFB, 0x02, 0x05, 0xFE, 0xFB, 0x05, 0x05, 0x02, 0x05, 0x05,
+  0x05, 0x0C, 0xFB, 0x02, 0x05, 0x0C, 0xFB, 0x13, 0x05, 0x02, 0x05, 0x13, 0x05, 0x1A, 0xFB, 0x02,
+  0x00,
+  // sad
+  0x06, 0xE8, 0x0C, 0x00, 0xF4, 0x18, 0x0C, 0x03, 0x00,
+  // smirk
+  0x06, 0xEA, 0x04, 0x08, 0x0C, 0x1A, 0xFC, 0x03, 0x00,
+  // tongue
+  0x07, 0xE4, 0x00, 0x0A, 0xE6, 0x1A, 0x1A, 0x1A, 0x1C, 0x00, 0x0B, 0x0C, 0x00, 0x01, 0xB7, 0xF9,
+  0x04, 0x00, 0x0F, 0x0A, 0x07, 0x00,
+};
+
+const uint16_t bmoExpressionProgramSize = sizeof(bmoExpressionProgram);
+
+const BMOExpressionInfo bmoExpressionTable[EXPRESSION_COUNT] = {
+  // offset, left, top, width, height, eyes
+  {    0,  -31,   -1,  63,  23, 0 },  // happy
+  {    3,  -15,  -20,  31,  41, 3 },  // surprised
+  {    6,  -23,   -3,  47,   7, 2 },  // sleepy
+  {   13,  -41,   -1,  83,  33, 3 },  // excited
+  {   16,  -32,   -7,  61,  15, 0 },  // confused
+  {   65,  -27,   -3,  55,  19, 2 },  // sad
+  {   74,  -25,   -7,  55,  18, 0 },  // smirk
+  {   83,  -28,    0,  57,  23, 3 },  // tongue
+};
@@ -0,0 +1,30 @@
+// Generated by tools/expression_compiler.py from expressions/expressions.txt - do not edit.
+// Rerun the compiler after changing the expressions.
+
+#ifndef BMO_EXPRESSIONS_H
+#define BMO_EXPRESSIONS_H
+
+#include <Arduino.h>
+#include "expression_ops.h"
+
+#define EXPRESSION_FORMAT 1
+
+// Expression types (in expressions.txt order)
+enum BMOExpression {
+  EXPRESSION_HAPPY = 0,
+  EXPRESSION_SURPRISED,
+  EXPRESSION_SLEEPY,
+  EXPRESSION_EXCITED,
+  EXPRESSION_CONFUSED,
+  EXPRESSION_SAD,
+  EXPRESSION_SMIRK,
+  EXPRESSION_TONGUE,
+  EXPRESSION_COUNT
+};
+
+// Display lists, back to back, and where each one starts (const, so in flash)
+extern const uint8_t bmoExpressionProgram[];
+extern const uint16_t bmoExpressionProgramSize;
+extern const BMOExpressionInfo bmoExpressionTable[EXPRESSION_COUNT];
+
+#endif // BMO_EXPRESSIONS_H
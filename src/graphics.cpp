@@ -5,52 +5,236 @@
  */
 
 #include "graphics.h"
+#include <new>
+
+#if BMO_ENABLE_IMAGES && defined(ESP32)
+#include <LittleFS.h>
+#elif BMO_ENABLE_IMAGES
+#include <stdio.h>
+#endif
 
 // Global graphics instance
 BMOGraphics* g_bmoGraphics = nullptr;
 
-BMOGraphics::BMOGraphics()
+// Only the face panel's renderer is published as g_bmoGraphics
+static void registerGraphics(BMOGraphics* graphics) {
+  g_bmoGraphics = graphics;
+}
+
+template <class Other>
+static void registerGraphics(BMOGraphicsT<Other>*) {
+}
+
+// shapes.h bakes these into its tables
+static_assert(BMOShapeTables<BMOActivePanel>::TEAL == BMO_TEAL &&
+              BMOShapeTables<BMOActivePanel>::DARK_TEAL == BMO_DARK_TEAL &&
+              BMOShapeTables<BMOActivePanel>::LIGHT_TEAL == BMO_LIGHT_TEAL,
+              "shape table palette out of sync with graphics.h");
+
+// expressions.h comes from tools/expression_compiler.py
+static_assert(EXPRESSION_FORMAT == EXPRESSION_FORMAT_VERSION,
+              "expressions.h is from another bytecode format - rerun tools/expression_compiler.py");
+
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+// Image decoding state and band buffer, carved from the arena by the first
+// begin() and shared by every panel's renderer (so an image of any size
+// never touches the heap or the stack)
+static BMOQoiDecoder* imageDecoder = nullptr;
+static uint16_t* imageBand = nullptr;
+#endif
+
+#if BMO_ENABLE_IMAGES
+// drawImage(path) reads LittleFS on the device, stdio on the host
+#if defined(ESP32)
+static int32_t readImageFile(uint8_t* buffer, uint32_t length, void* context) {
+  return (int32_t)static_cast<File*>(context)->read(buffer, length);
+}
+#else
+static int32_t readImageFile(uint8_t* buffer, uint32_t length, void* context) {
+  size_t got = fread(buffer, 1, length, static_cast<FILE*>(context));
+  return ferror(static_cast<FILE*>(context)) ? -1 : (int32_t)got;
+}
+#endif
+#endif
+
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+// QOI sprites are read straight out of the mapped asset partition
+struct BMOMappedRead {
+  const uint8_t* data;
+  uint32_t length;
+  uint32_t pos;
+};
+
+static int32_t readMapped(uint8_t* buffer, uint32_t length, void* context) {
+  BMOMappedRead* mapped = static_cast<BMOMappedRead*>(context);
+  uint32_t count = mapped->length - mapped->pos;
+  if (count > length) count = length;
+  memcpy(buffer, mapped->data + mapped->pos, count);
+  mapped->pos += count;
+  return (int32_t)count;
+}
+#endif
+
+#if !BMO_ENABLE_DITHER
+// Mix two RGB565 colors, alpha 0 (from) to 256 (to); the dither build
+// mixes with bmoDitherBlend() instead
+static uint16_t blend565(uint16_t from, uint16_t to, uint32_t alpha) {
+  if (alpha == 0) return from;
+  if (alpha >= 256) return to;
+  uint32_t r = ((from >> 11) * (256 - alpha) + (to >> 11) * alpha) >> 8;
+  uint32_t g = (((from >> 5) & 0x3F) * (256 - alpha) + ((to >> 5) & 0x3F) * alpha) >> 8;
+  uint32_t b = ((from & 0x1F) * (256 - alpha) + (to & 0x1F) * alpha) >> 8;
+  return (uint16_t)((r << 11) | (g << 5) | b);
+}
+#endif
+
+// Coverage (0-256) of a pixel by a disc with a one-pixel soft edge.
+// dx, dy from the pixel center to the disc center and radius in 1/256 pixel.
+static uint32_t discCoverage(int32_t dx, int32_t dy, int32_t radius) {
+  uint32_t distance2 = (uint32_t)(dx * dx) + (uint32_t)(dy * dy);
+  uint32_t inner = radius > 128 ? (uint32_t)(radius - 128) * (radius - 128) : 0;
+  if (distance2 <= inner) return 256;
+  if (distance2 >= (uint32_t)(radius + 128) * (radius + 128)) return 0;
+  return radius + 128 - bmoSqrt(distance2);  // Only edge pixels pay for the root
+}
+
+// The same disc with a hard edge (anti-aliasing off): in or out at the radius
+static uint32_t discSolid(int32_t dx, int32_t dy, int32_t radius) {
+  return (uint32_t)(dx * dx) + (uint32_t)(dy * dy) < (uint32_t)radius * radius ? 256 : 0;
+}
+
+// Ease one gaze axis towards its target; true if it moved
+static bool stepGaze(int16_t& position, int16_t target) {
+  int32_t remaining = target - position;
+  if (remaining == 0) return false;
+  
+  int32_t step = remaining * GAZE_SMOOTHING / 256;
+  if (remaining > -16 && remaining < 16) {
+    step = remaining;  // Within 1/16 pixel - land on it
+  } else if (step == 0) {
+    step = remaining > 0 ? 1 : -1;
+  }
+  position += step;
+  return true;
+}
+
+// One disc of a round eye, relative to the eye center (pixels)
+struct BMOEyeDisc {
+  int16_t x, y, radius;
+  uint16_t color;
+};
+
+template <class Panel>
+BMOGraphicsT<Panel>::BMOGraphicsT()
   : tft(nullptr)
+  , display(nullptr)
+  , panelIndex(0)
   , initialized(false)
   , currentExpression(EXPRESSION_HAPPY)
   , currentEyeState(EYES_OPEN)
+  , drawnExpression(EXPRESSION_COUNT)
+  , assets(nullptr)
+  , governor(nullptr)
+  , drawnGradientStep(4)
+  , drawnAntiAlias(true)
+  , drawnCurveTolerance(PATH_TOLERANCE)
   , fastDrawMode(false)
-  , drawRegionX(0)
-  , drawRegionY(0)
-  , drawRegionW(240)
-  , drawRegionH(320)
+  , flushUs(0)
+  , clipStack()
+  , clipDepth(1)
+  , viewportClipped(false)
+  , gazeTargetX(0)
+  , gazeTargetY(0)
+  , gazeX(0)
+  , gazeY(0)
+  , drawnGazeX(0)
+  , drawnGazeY(0)
+  , faceStage(FACE_STAGE_IDLE)
+  , faceRow(0)
+  , faceRenderUs(0)
+  , facePartial(false)
+  , fadeFrom(BMO_TEAL)
+  , fadeTo(BMO_TEAL)
+  , fadeSteps(0)
+  , fadeStep(0)
+  , fadeRow(0)
 {
+  setDrawRegion(0, 0, Panel::WIDTH, Panel::HEIGHT);
+  resetStats();
 }
 
-BMOGraphics::~BMOGraphics() {
+template <class Panel>
+BMOGraphicsT<Panel>::~BMOGraphicsT() {
   end();
 }
 
-void BMOGraphics::begin(TFT_eSPI* display) {
-  tft = display;
-  initialized = (tft != nullptr);
+template <class Panel>
+uint16_t* BMOGraphicsT<Panel>::eyeRows = nullptr;
+
+template <class Panel>
+uint16_t* BMOGraphicsT<Panel>::ditherLine = nullptr;
+
+template <class Panel>
+void BMOGraphicsT<Panel>::begin(BMODisplay* display, uint8_t panel) {
+  this->display = display;
+  panelIndex = panel;
+  tft = display ? display->getTFT() : nullptr;
+  
+  // Row buffers come from the static arena (once per panel type)
+  if (!eyeRows) eyeRows = bmoArena.allocateArray<uint16_t>(EYE_ROWS * GAZE_SPAN, "graphics");
+  bool buffers = eyeRows != nullptr;
+#if BMO_ENABLE_DITHER
+  if (!ditherLine) ditherLine = bmoArena.allocateArray<uint16_t>(Panel::WIDTH, "graphics");
+  buffers = buffers && ditherLine;
+#endif
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+  // The image decoder and band (once for every panel)
+  if (!imageDecoder) {
+    BMOQoiDecoder* slot = bmoArena.allocateArray<BMOQoiDecoder>(1, "images");
+    if (slot) imageDecoder = new (slot) BMOQoiDecoder();
+  }
+  if (!imageBand) imageBand = bmoArena.allocateArray<uint16_t>(IMAGE_BAND_PIXELS, "images");
+  buffers = buffers && imageDecoder && imageBand;
+#endif
+  initialized = (tft != nullptr) && buffers;
   
   if (initialized) {
-    g_bmoGraphics = this;
+    const BMOPanelState* state = display->getPanel(panel);
+    if (state && (state->width != Panel::WIDTH || state->height != Panel::HEIGHT)) {
+      Serial.printf("Warning: panel %d is %dx%d, graphics built for %dx%d\n", panel,
+                    state->width, state->height, Panel::WIDTH, Panel::HEIGHT);
+    }
+    // Rendered rows (eyes, gradient, images, fades) are native RGB565 and go
+    // out through pushImage(), so TFT_eSPI swaps them to panel byte order.
+    // Buffers already in panel order (raw sprites) turn it off around
+    // themselves.
+    tft->setSwapBytes(true);
+    if (panel == 0) registerGraphics(this);
     Serial.println("BMO Graphics initialized successfully");
+  } else if (!buffers) {
+    Serial.println("ERROR: BMO Graphics initialization failed - row buffers unavailable");
   } else {
     Serial.println("ERROR: BMO Graphics initialization failed - no display provided");
   }
 }
 
-void BMOGraphics::end() {
+template <class Panel>
+void BMOGraphicsT<Panel>::end() {
   if (initialized) {
     tft = nullptr;
+    display = nullptr;
     initialized = false;
-    g_bmoGraphics = nullptr;
+    if (g_bmoGraphics == (void*)this) g_bmoGraphics = nullptr;
     Serial.println("BMO Graphics shutdown complete");
   }
 }
 
-void BMOGraphics::drawBMOFace(BMOExpression expression, EyeState eyeState) {
+template <class Panel>
+void BMOGraphicsT<Panel>::drawBMOFace(BMOExpression expression, EyeState eyeState) {
   if (!initialized) return;
   
   Serial.printf("Drawing BMO face - Expression: %d, Eyes: %d\n", expression, eyeState);
+  uint32_t start = micros();
   
   // Store current state
   currentExpression = expression;
@@ -63,182 +247,749 @@ void BMOGraphics::drawBMOFace(BMOExpression expression, EyeState eyeState) {
   drawBackground();
   drawFrame();
   drawEyes(eyeState);
+  drawnCurveTolerance = getQuality().curveTolerance;
   drawMouth(expression);
+  drawnExpression = expression;
   
   endFastDraw();
+  stats.frames++;
+  uint32_t elapsed = micros() - start;
+  stats.frameTime.record(elapsed);
+  governFrame(elapsed);
 }
 
-void BMOGraphics::clearScreen(uint16_t color) {
+template <class Panel>
+bool BMOGraphicsT<Panel>::requestFace(BMOExpression expression, EyeState eyeState) {
+  if (!initialized) return false;
+  
+  currentExpression = expression;
+  currentEyeState = eyeState;
+  faceStage = FACE_STAGE_BACKGROUND;
+  faceRow = 0;
+  faceRenderUs = 0;
+  facePartial = false;
+  return display->queueJob(panelIndex, faceJob, this);
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::requestExpression(BMOExpression expression) {
+  if (!initialized) return false;
+  
+  currentExpression = expression;
+  if (faceStage != FACE_STAGE_IDLE) return true;  // The queued redraw picks it up
+  if (expression == drawnExpression) return true;
+  
+  faceStage = FACE_STAGE_MOUTH_AREA;
+  faceRenderUs = 0;
+  facePartial = true;
+  if (!display->queueJob(panelIndex, faceJob, this)) {
+    faceStage = FACE_STAGE_IDLE;
+    return false;
+  }
+  return true;
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::faceJob(void* context) {
+  return static_cast<BMOGraphicsT<Panel>*>(context)->stepFace();
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::stepFace() {
+  if (!initialized || faceStage == FACE_STAGE_IDLE) return true;
+  
+  // Same layers as drawBMOFace, the background split into bands
+  uint32_t start = micros();
+  startFastDraw();
+  switch (faceStage) {
+    case FACE_STAGE_BACKGROUND: {
+      if (faceRow == 0) drawnGradientStep = getQuality().gradientStep;
+      int rows = Panel::HEIGHT - faceRow < FACE_BAND_ROWS ? Panel::HEIGHT - faceRow : FACE_BAND_ROWS;
+      restoreBackground(0, faceRow, Panel::WIDTH, rows);
+      faceRow += rows;
+      if (faceRow >= Panel::HEIGHT) faceStage = FACE_STAGE_FRAME;
+      break;
+    }
+    case FACE_STAGE_FRAME:
+      drawFrame();
+      faceStage = FACE_STAGE_EYES;
+      break;
+    case FACE_STAGE_EYES:
+      drawEyes(currentEyeState);
+      faceStage = FACE_STAGE_MOUTH;
+      break;
+    case FACE_STAGE_MOUTH_AREA:
+      restoreExpressionBounds(drawnExpression);
+      faceStage = FACE_STAGE_MOUTH;
+      break;
+    case FACE_STAGE_MOUTH:
+      drawnCurveTolerance = getQuality().curveTolerance;
+      drawMouth(currentExpression);
+      drawnExpression = currentExpression;
+      faceStage = FACE_STAGE_IDLE;
+      break;
+    default:
+      faceStage = FACE_STAGE_IDLE;
+      break;
+  }
+  endFastDraw();
+  
+  // Slices count toward the tick they run in, with whatever else it drew
+  uint32_t elapsed = micros() - start;
+  governFrame(elapsed);
+  faceRenderUs += elapsed;
+  if (faceStage == FACE_STAGE_IDLE) {
+    if (facePartial) stats.updates++;
+    else stats.frames++;
+    stats.frameTime.record(faceRenderUs);
+  }
+  return faceStage == FACE_STAGE_IDLE;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::clearScreen(uint16_t color) {
   if (initialized) {
-    tft->fillScreen(color);
+    display->selectPanel(panelIndex);
+    fillRectClipped(0, 0, Panel::WIDTH, Panel::HEIGHT, color);
   }
 }
 
-void BMOGraphics::drawBackground() {
-  // Fill entire screen with BMO teal
-  tft->fillScreen(BMO_TEAL);
+template <class Panel>
+void BMOGraphicsT<Panel>::drawBackground() {
+  // BMO teal with a subtle gradient on every 4th row (fewer at lower
+  // quality), within the clip
+  drawnGradientStep = getQuality().gradientStep;
+  restoreBackground(0, 0, Panel::WIDTH, Panel::HEIGHT);
+}
+
+template <class Panel>
+uint16_t BMOGraphicsT<Panel>::backgroundColorAt(int y) {
+  // Gradient lines sit on every drawnGradientStep-th row, the rest is plain teal
+  if (drawnGradientStep == 0 || y % drawnGradientStep != 0) return BMO_TEAL;
+  return blendColors(BMO_TEAL, BMO_LIGHT_TEAL, (float)y / Panel::HEIGHT * 0.1f);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::renderBackgroundRow(uint16_t* out, int x0, int width, int y) {
+#if BMO_ENABLE_DITHER
+  // Gradient rows keep the blend's fraction for the dither (the same 10% of
+  // the way to light teal at the bottom as backgroundColorAt())
+  if (drawnGradientStep != 0 && y % drawnGradientStep == 0) {
+    uint32_t alpha = (uint32_t)y * 65536 / (Panel::HEIGHT * 10);
+    bmoDitherSpan(out, x0, y, width, bmoMixQ8(BMO_TEAL, BMO_LIGHT_TEAL, alpha));
+    return;
+  }
+#else
+  (void)x0;  // Plain rows look the same wherever they start
+#endif
+  uint16_t color = backgroundColorAt(y);
+  for (int i = 0; i < width; i++) out[i] = color;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::restoreBackground(int x, int y, int width, int height) {
+  // Repaint a region exactly as drawBackground() left it, trimmed to the
+  // clip first so the fill and the gradient rows stay inside it
+  const BMOClipRect& clip = getClip();
+  int x0 = x > clip.x0 ? x : clip.x0;
+  int y0 = y > clip.y0 ? y : clip.y0;
+  int x1 = x + width < clip.x1 ? x + width : clip.x1;
+  int y1 = y + height < clip.y1 ? y + height : clip.y1;
+  if (x0 >= x1 || y0 >= y1) {
+    stats.clipRejects++;
+    return;
+  }
+  x = x0;
+  y = y0;
+  width = x1 - x0;
+  height = y1 - y0;
   
-  // Add subtle gradient effect (optional)
-  for (int y = 0; y < 320; y += 4) {
-    uint16_t gradientColor = blendColors(BMO_TEAL, BMO_LIGHT_TEAL, (float)y / 320.0f * 0.1f);
-    tft->drawFastHLine(0, y, 240, gradientColor);
+  tft->fillRect(x, y, width, height, BMO_TEAL);
+  meter(1, (uint32_t)width * height);
+  
+  int step = drawnGradientStep;
+  if (step == 0) return;
+  for (int row = y + ((step - (y % step)) % step); row < y + height; row += step) {
+#if BMO_ENABLE_DITHER
+    renderBackgroundRow(ditherLine, x, width, row);
+    tft->pushImage(x, row, width, 1, ditherLine);
+    stats.ditherRows++;
+#else
+    tft->drawFastHLine(x, row, width, backgroundColorAt(row));
+#endif
+    meter(1, width);
   }
 }
 
-void BMOGraphics::drawEyes(EyeState state) {
-  int leftEyeX = FACE_CENTER_X - EYE_SEPARATION / 2;
-  int rightEyeX = FACE_CENTER_X + EYE_SEPARATION / 2;
-  int eyeY = FACE_CENTER_Y + EYE_Y_OFFSET;
+template <class Panel>
+void BMOGraphicsT<Panel>::drawEyes(EyeState state) {
+  int leftEyeX = Face::CENTER_X - Face::EYE_SEPARATION / 2;
+  int rightEyeX = Face::CENTER_X + Face::EYE_SEPARATION / 2;
+  int eyeY = Face::CENTER_Y + Face::EYE_Y_OFFSET;
+  
+  // Eyes go down wherever the gaze is now, at the current quality
+  drawnGazeX = gazeX;
+  drawnGazeY = gazeY;
+  drawnAntiAlias = getQuality().antiAlias;
   
   drawEye(leftEyeX, eyeY, state, true);   // Left eye
   drawEye(rightEyeX, eyeY, state, false); // Right eye
 }
 
-void BMOGraphics::drawEye(int centerX, int centerY, EyeState state, bool isLeft) {
+template <class Panel>
+void BMOGraphicsT<Panel>::drawEye(int centerX, int centerY, EyeState state, bool isLeft) {
+  // Shapes without sub-pixel rendering follow the gaze to the nearest pixel
+  int gazeCenterX = centerX + ((drawnGazeX + 128) >> 8);
+  int gazeCenterY = centerY + ((drawnGazeY + 128) >> 8);
+  
   switch (state) {
     case EYES_OPEN:
-      // Draw main eye circle
-      drawSmoothCircle(centerX, centerY, EYE_RADIUS, BMO_BLACK);
-      
-      // Add eye highlight for shine effect
-      drawEyeHighlight(centerX, centerY);
+    case EYES_WIDE:
+      // Eye circle and highlights, anti-aliased at the exact gaze offset
+      drawRoundEye(centerX, centerY, state);
       break;
       
     case EYES_CLOSED:
       // Draw closed eye as horizontal line
-      drawClosedEye(centerX, centerY, EYE_RADIUS * 2);
+      drawClosedEye(gazeCenterX, gazeCenterY, Face::EYE_RADIUS * 2);
       break;
       
     case EYES_HALF_CLOSED:
       // Draw half-height oval
-      tft->fillEllipse(centerX, centerY, EYE_RADIUS, EYE_RADIUS / 2, BMO_BLACK);
-      drawEyeHighlight(centerX, centerY - EYE_RADIUS / 4);
+      drawSpans(Shapes::HALF_EYE, gazeCenterX, gazeCenterY);
+      drawEyeHighlight(gazeCenterX, gazeCenterY - Face::EYE_RADIUS / 4);
       break;
+  }
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::renderEyeRow(uint16_t* out, int x0, int width, int y, int centerX, int centerY,
+                                       EyeState state, int16_t offsetX, int16_t offsetY) {
+  // Eye, main and small highlight, and the extra highlight of wide eyes -
+  // painted in order over the background, each blended by its coverage
+  const BMOEyeDisc discs[] = {
+    { 0, 0, (int16_t)(state == EYES_WIDE ? Face::EYE_RADIUS + Face::scale(5) : Face::EYE_RADIUS), BMO_BLACK },
+    { (int16_t)-Face::scale(8), (int16_t)-Face::scale(8), (int16_t)Face::scale(6), BMO_WHITE },
+    { (int16_t)-Face::scale(5), (int16_t)-Face::scale(12), (int16_t)Face::scale(2), BMO_WHITE },
+    { (int16_t)Face::scale(5), (int16_t)-Face::scale(5), (int16_t)Face::scale(3), BMO_WHITE }
+  };
+  const int discCount = state == EYES_WIDE ? 4 : 3;
+  
+  renderBackgroundRow(out, x0, width, y);
+#if BMO_ENABLE_DITHER
+  const uint8_t* thresholds = bmoDitherRow(y);  // Soft edges dithered rather than truncated
+#endif
+  
+  for (int d = 0; d < discCount; d++) {
+    const BMOEyeDisc& disc = discs[d];
+    int32_t radius = disc.radius * 256 + 128;  // fillCircle's r covers r + 1/2 pixel
+    int32_t dy = (y - centerY - disc.y) * 256 - offsetY;
+    if (dy <= -(radius + 128) || dy >= radius + 128) continue;
+    
+    int32_t dx = (x0 - centerX - disc.x) * 256 - offsetX;
+    for (int i = 0; i < width; i++, dx += 256) {
+      if (dx <= -(radius + 128)) continue;
+      if (dx >= radius + 128) break;
+      uint32_t coverage = drawnAntiAlias ? discCoverage(dx, dy, radius) : discSolid(dx, dy, radius);
+#if BMO_ENABLE_DITHER
+      out[i] = bmoDitherBlend(out[i], disc.color, coverage, thresholds[(x0 + i) & DITHER_MASK]);
+#else
+      out[i] = blend565(out[i], disc.color, coverage);
+#endif
+    }
+  }
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawRoundEye(int centerX, int centerY, EyeState state) {
+  int reach = (state == EYES_WIDE ? Face::EYE_RADIUS + Face::scale(5) : Face::EYE_RADIUS) + 2;
+  int x0 = centerX + (drawnGazeX >> 8) - reach;
+  int y0 = centerY + (drawnGazeY >> 8) - reach;
+  int size = 2 * reach + 1;
+  if (!isVisible(x0, y0, size, size)) {
+    stats.clipRejects++;
+    return;
+  }
+  
+  // Only the rows and columns inside the clip are rendered
+  const BMOClipRect& clip = getClip();
+  int left = x0 > clip.x0 ? x0 : clip.x0;
+  int right = x0 + size < clip.x1 ? x0 + size : clip.x1;
+  int top = y0 > clip.y0 ? y0 : clip.y0;
+  int bottom = y0 + size < clip.y1 ? y0 + size : clip.y1;
+  
+  // Background included, so the eye can be redrawn over an old one. With
+  // queued transfers one row renders while the other is on the wire.
+  BMOSpiQueue* queue = fastDrawMode ? display->getSpiQueue() : nullptr;
+  BMOSpiFence fences[2] = { 0, 0 };
+  for (int y = top; y < bottom; y++) {
+    uint16_t* row = eyeRows + (y & 1) * GAZE_SPAN;
+    if (queue) queue->wait(fences[y & 1]);
+    renderEyeRow(row, left, right - left, y, centerX, centerY, state, drawnGazeX, drawnGazeY);
+    if (queue) {
+      // Rendered rows are native RGB565: the queue swaps them to panel order
+      fences[y & 1] = queue->pushImage(left, y, right - left, 1, row, true);
+    } else {
+      tft->pushImage(left, y, right - left, 1, row);
+    }
+    meter(1, right - left);
+  }
+  if (queue) queue->drain();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::repaintGazeEye(int centerX, int centerY, EyeState state) {
+  // Both positions' bounds; rows are rendered at the old and new offsets and
+  // only the runs that differ are sent
+  int reach = (state == EYES_WIDE ? Face::EYE_RADIUS + Face::scale(5) : Face::EYE_RADIUS) + 2;
+  int oldX = drawnGazeX >> 8, oldY = drawnGazeY >> 8;
+  int newX = gazeX >> 8, newY = gazeY >> 8;
+  int x0 = centerX + (oldX < newX ? oldX : newX) - reach;
+  int x1 = centerX + (oldX > newX ? oldX : newX) + reach;
+  int y0 = centerY + (oldY < newY ? oldY : newY) - reach;
+  int y1 = centerY + (oldY > newY ? oldY : newY) + reach;
+  
+  const BMOClipRect& clip = getClip();
+  if (x0 < clip.x0) x0 = clip.x0;
+  if (y0 < clip.y0) y0 = clip.y0;
+  if (x1 >= clip.x1) x1 = clip.x1 - 1;
+  if (y1 >= clip.y1) y1 = clip.y1 - 1;
+  if (x0 > x1 || y0 > y1) {
+    stats.clipRejects++;
+    return;
+  }
+  int width = x1 - x0 + 1;
+  
+  // Runs are sent from the new row, so with queued transfers it is double
+  // buffered like drawRoundEye()'s
+  BMOSpiQueue* queue = fastDrawMode ? display->getSpiQueue() : nullptr;
+  uint16_t* before = eyeRows;
+  BMOSpiFence fences[2] = { 0, 0 };
+  for (int y = y0; y <= y1; y++) {
+    uint16_t* after = eyeRows + (1 + (y & 1)) * GAZE_SPAN;
+    if (queue) queue->wait(fences[y & 1]);
+    renderEyeRow(before, x0, width, y, centerX, centerY, state, drawnGazeX, drawnGazeY);
+    renderEyeRow(after, x0, width, y, centerX, centerY, state, gazeX, gazeY);
+    
+    int i = 0;
+    while (i < width) {
+      if (before[i] == after[i]) {
+        i++;
+        continue;
+      }
       
-    case EYES_WIDE:
-      // Draw larger eyes for surprise
-      drawSmoothCircle(centerX, centerY, EYE_RADIUS + 5, BMO_BLACK);
-      drawEyeHighlight(centerX, centerY);
-      // Add extra highlight
-      tft->fillCircle(centerX + 5, centerY - 5, 3, BMO_WHITE);
-      break;
+      // Grow the run across short unchanged gaps
+      int start = i;
+      int end = i;
+      for (i++; i < width && i - end <= GAZE_RUN_GAP; i++) {
+        if (before[i] != after[i]) end = i;
+      }
+      i = end + 1;
+      if (queue) {
+        fences[y & 1] = queue->pushImage(x0 + start, y, end - start + 1, 1, after + start, true);
+      } else {
+        tft->pushImage(x0 + start, y, end - start + 1, 1, after + start);
+      }
+      meter(1, end - start + 1);
+    }
+  }
+  if (queue) queue->drain();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::lookAt(int8_t x, int8_t y) {
+  int32_t gx = x < -100 ? -100 : (x > 100 ? 100 : x);
+  int32_t gy = y < -100 ? -100 : (y > 100 ? 100 : y);
+  
+  // Keep diagonals on the circle, so the eyes never leave their travel radius
+  int32_t length2 = gx * gx + gy * gy;
+  if (length2 > 100 * 100) {
+    int32_t length = bmoSqrt(length2);
+    gx = gx * 100 / length;
+    gy = gy * 100 / length;
   }
+  
+  gazeTargetX = (int16_t)(gx * Face::GAZE_RANGE * 256 / 100);
+  gazeTargetY = (int16_t)(gy * Face::GAZE_RANGE * 256 / 100);
 }
 
-void BMOGraphics::drawEyeHighlight(int centerX, int centerY) {
+template <class Panel>
+bool BMOGraphicsT<Panel>::updateGaze() {
+  if (!initialized) return false;
+  
+  bool movedX = stepGaze(gazeX, gazeTargetX);
+  bool movedY = stepGaze(gazeY, gazeTargetY);
+  bool moving = movedX || movedY;
+  
+  // Closed and half-closed eyes pick the gaze up on their next full draw
+  if (currentEyeState != EYES_OPEN && currentEyeState != EYES_WIDE) return moving;
+  if (gazeX == drawnGazeX && gazeY == drawnGazeY) return moving;
+  
+  // A face redraw in progress will draw the eyes itself, or has already
+  // drawn them where drawnGaze says - catch up once it is done
+  if (display->isPanelBusy(panelIndex)) return true;
+  
+  uint32_t start = micros();
+  startFastDraw();
+  int eyeY = Face::CENTER_Y + Face::EYE_Y_OFFSET;
+  repaintGazeEye(Face::CENTER_X - Face::EYE_SEPARATION / 2, eyeY, currentEyeState);
+  repaintGazeEye(Face::CENTER_X + Face::EYE_SEPARATION / 2, eyeY, currentEyeState);
+  endFastDraw();
+  drawnGazeX = gazeX;
+  drawnGazeY = gazeY;
+  stats.updates++;
+  uint32_t elapsed = micros() - start;
+  stats.frameTime.record(elapsed);
+  governFrame(elapsed);
+  
+  return moving;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawEyeHighlight(int centerX, int centerY) {
   // Main highlight
-  tft->fillCircle(centerX - 8, centerY - 8, 6, BMO_WHITE);
+  int x = centerX - Face::scale(8), y = centerY - Face::scale(8), radius = Face::scale(6);
+  if (beginClip(x - radius, y - radius, 2 * radius + 1, 2 * radius + 1)) {
+    tft->fillCircle(x, y, radius, BMO_WHITE);
+    meterDisc(radius, radius);
+    endClip();
+  }
   
   // Small secondary highlight
-  tft->fillCircle(centerX - 5, centerY - 12, 2, BMO_WHITE);
+  x = centerX - Face::scale(5);
+  y = centerY - Face::scale(12);
+  radius = Face::scale(2);
+  if (beginClip(x - radius, y - radius, 2 * radius + 1, 2 * radius + 1)) {
+    tft->fillCircle(x, y, radius, BMO_WHITE);
+    meterDisc(radius, radius);
+    endClip();
+  }
 }
 
-void BMOGraphics::drawClosedEye(int centerX, int centerY, int width) {
-  int thickness = 4;
+template <class Panel>
+void BMOGraphicsT<Panel>::drawClosedEye(int centerX, int centerY, int width) {
+  int thickness = Face::scale(4);
   int halfWidth = width / 2;
+  if (!beginClip(centerX - halfWidth - thickness, centerY - thickness,
+                 2 * (halfWidth + thickness) + 1, 2 * thickness + 1)) return;
   
   // Draw thick horizontal line with rounded ends
   for (int i = 0; i < thickness; i++) {
     tft->drawLine(centerX - halfWidth, centerY + i - thickness/2,
                   centerX + halfWidth, centerY + i - thickness/2, BMO_BLACK);
+    meter(1, 2 * halfWidth + 1);
   }
   
   // Add rounded ends
   tft->fillCircle(centerX - halfWidth, centerY, thickness/2, BMO_BLACK);
   tft->fillCircle(centerX + halfWidth, centerY, thickness/2, BMO_BLACK);
+  meterDisc(thickness/2, thickness/2);
+  meterDisc(thickness/2, thickness/2);
+  endClip();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawMouth(BMOExpression expression) {
+  if (expression >= EXPRESSION_COUNT) expression = EXPRESSION_HAPPY;
+  drawExpression(expression, Face::CENTER_X, Face::CENTER_Y + Face::MOUTH_Y_OFFSET);
+}
+
+template <class Panel>
+EyeState BMOGraphicsT<Panel>::expressionEyes(BMOExpression expression) {
+  if (expression >= EXPRESSION_COUNT) return EYES_OPEN;
+  return (EyeState)bmoExpressionTable[expression].eyes;
 }
 
-void BMOGraphics::drawMouth(BMOExpression expression) {
-  int mouthX = FACE_CENTER_X;
-  int mouthY = FACE_CENTER_Y + MOUTH_Y_OFFSET;
+template <class Panel>
+void BMOGraphicsT<Panel>::drawExpression(BMOExpression expression, int centerX, int centerY) {
+  if (expression >= EXPRESSION_COUNT) return;
+  int boundsX, boundsY, boundsWidth, boundsHeight;
+  expressionBounds(expression, centerX, centerY, boundsX, boundsY, boundsWidth, boundsHeight);
+  if (!isVisible(boundsX, boundsY, boundsWidth, boundsHeight)) {
+    stats.clipRejects++;
+    return;
+  }
   
-  switch (expression) {
-    case EXPRESSION_HAPPY:
-      drawHappyMouth(mouthX, mouthY);
-      break;
-      
-    case EXPRESSION_SURPRISED:
-      drawSurprisedMouth(mouthX, mouthY);
-      break;
-      
-    case EXPRESSION_SLEEPY:
-      drawSleepyMouth(mouthX, mouthY);
-      break;
-      
-    case EXPRESSION_EXCITED:
-      drawExcitedMouth(mouthX, mouthY);
-      break;
-      
-    case EXPRESSION_CONFUSED:
-      drawConfusedMouth(mouthX, mouthY);
-      break;
-      
-    default:
-      drawHappyMouth(mouthX, mouthY);
-      break;
+  // Operands are design pixels around the mouth center; path points go
+  // through the pixel centers like drawBezierCurve's
+  const uint8_t* pc = bmoExpressionProgram + bmoExpressionTable[expression].offset;
+  const int pathX = PATH_PX(centerX) + PATH_ONE / 2;
+  const int pathY = PATH_PX(centerY) + PATH_ONE / 2;
+  auto coord = [&pc]() { return Face::scale((int8_t)*pc++); };
+  auto length = [&pc]() { return Face::scale(*pc++); };
+  auto pathCoord = [&pc](int origin) { return origin + (int32_t)(int8_t)*pc++ * Face::SCALE_Q8 * PATH_ONE / 256; };
+  
+  uint16_t color = BMO_BLACK;
+  BMOPath path;
+  path.setTolerance(drawnCurveTolerance);
+  for (;;) {
+    switch (*pc++) {
+      case EXPRESSION_OP_END:
+        return;
+        
+      case EXPRESSION_OP_COLOR:
+        color = pc[0] | (pc[1] << 8);
+        pc += 2;
+        break;
+        
+      case EXPRESSION_OP_SHAPE:
+        switch (*pc++) {
+          case EXPRESSION_SHAPE_SMILE:
+            drawSpans(Shapes::SMILE, centerX, centerY);
+            break;
+          case EXPRESSION_SHAPE_GRIN:
+            drawSpans(Shapes::GRIN, centerX, centerY);
+            break;
+          case EXPRESSION_SHAPE_SURPRISED:
+            drawSpans(Shapes::SURPRISED, centerX, centerY);
+            break;
+        }
+        break;
+        
+      case EXPRESSION_OP_RECT: {
+        int x = centerX + coord(), y = centerY + coord();
+        int w = length(), h = length();
+        fillRectClipped(x, y, w, h, color);
+        break;
+      }
+        
+      case EXPRESSION_OP_ELLIPSE: {
+        int x = centerX + coord(), y = centerY + coord();
+        int rx = length(), ry = length();
+        if (beginClip(x - rx, y - ry, 2 * rx + 1, 2 * ry + 1)) {
+          tft->fillEllipse(x, y, rx, ry, color);
+          meterDisc(rx, ry);
+          endClip();
+        }
+        break;
+      }
+        
+      case EXPRESSION_OP_LINE: {
+        int x1 = centerX + coord(), y1 = centerY + coord();
+        int x2 = centerX + coord(), y2 = centerY + coord();
+        drawThickLine(x1, y1, x2, y2, length(), color);
+        break;
+      }
+        
+      case EXPRESSION_OP_CURVE: {
+        int32_t x0 = pathCoord(pathX), y0 = pathCoord(pathY);
+        int32_t cx = pathCoord(pathX), cy = pathCoord(pathY);
+        int32_t x1 = pathCoord(pathX), y1 = pathCoord(pathY);
+        path.clear();
+        path.strokeQuad(x0, y0, cx, cy, x1, y1, PATH_PX(length()));
+        fillPath(path, 0, 0, color);
+        break;
+      }
+        
+      case EXPRESSION_OP_MOVE: {
+        int32_t x = pathCoord(pathX), y = pathCoord(pathY);
+        path.moveTo(x, y);
+        break;
+      }
+        
+      case EXPRESSION_OP_LINE_TO: {
+        int32_t x = pathCoord(pathX), y = pathCoord(pathY);
+        path.lineTo(x, y);
+        break;
+      }
+        
+      case EXPRESSION_OP_QUAD_TO: {
+        int32_t cx = pathCoord(pathX), cy = pathCoord(pathY);
+        int32_t x = pathCoord(pathX), y = pathCoord(pathY);
+        path.quadTo(cx, cy, x, y);
+        break;
+      }
+        
+      case EXPRESSION_OP_CUBIC_TO: {
+        int32_t c1x = pathCoord(pathX), c1y = pathCoord(pathY);
+        int32_t c2x = pathCoord(pathX), c2y = pathCoord(pathY);
+        int32_t x = pathCoord(pathX), y = pathCoord(pathY);
+        path.cubicTo(c1x, c1y, c2x, c2y, x, y);
+        break;
+      }
+        
+      case EXPRESSION_OP_CLOSE:
+        path.close();
+        break;
+        
+      case EXPRESSION_OP_FILL:
+        fillPath(path, 0, 0, color, (BMOFillRule)*pc++);
+        path.clear();
+        break;
+        
+      default:
+        // Program from a newer compiler - stop rather than misread operands
+        Serial.printf("Expression %d: bad opcode 0x%02X\n", expression, pc[-1]);
+        return;
+    }
   }
 }
 
-void BMOGraphics::drawHappyMouth(int centerX, int centerY) {
-  // Draw curved smile using multiple line segments
-  drawCurve(centerX, centerY, MOUTH_WIDTH, MOUTH_HEIGHT, BMO_BLACK, true);
+template <class Panel>
+void BMOGraphicsT<Panel>::expressionBounds(BMOExpression expression, int centerX, int centerY,
+                                           int& x, int& y, int& width, int& height) {
+  if (expression >= EXPRESSION_COUNT) {
+    x = centerX + Face::MOUTH_BOX_LEFT;
+    y = centerY + Face::MOUTH_BOX_TOP;
+    width = Face::MOUTH_BOX_WIDTH;
+    height = Face::MOUTH_BOX_HEIGHT;
+    return;
+  }
+  
+  // Compiler bounds are design pixels; scaling may round a pixel either way
+  const BMOExpressionInfo& info = bmoExpressionTable[expression];
+  int left = Face::scale(info.left) - 1;
+  int top = Face::scale(info.top) - 1;
+  int right = Face::scale(info.left + info.width) + 1;
+  int bottom = Face::scale(info.top + info.height) + 1;
+  x = centerX + left;
+  y = centerY + top;
+  width = right - left;
+  height = bottom - top;
 }
 
-void BMOGraphics::drawSurprisedMouth(int centerX, int centerY) {
-  // Draw small oval
-  tft->fillEllipse(centerX, centerY, 15, 20, BMO_BLACK);
-  // Interior highlight
-  tft->fillEllipse(centerX, centerY, 10, 15, BMO_TEAL);
+template <class Panel>
+void BMOGraphicsT<Panel>::restoreExpressionBounds(BMOExpression expression) {
+  int x, y, width, height;
+  expressionBounds(expression, Face::CENTER_X, Face::CENTER_Y + Face::MOUTH_Y_OFFSET, x, y, width, height);
+  restoreBackground(x, y, width, height);
 }
 
-void BMOGraphics::drawSleepyMouth(int centerX, int centerY) {
-  // Draw small horizontal line
-  drawThickLine(centerX - 20, centerY, centerX + 20, centerY, 3, BMO_BLACK);
+template <class Panel>
+void BMOGraphicsT<Panel>::drawTalkingMouth(uint8_t open, uint8_t width) {
+  if (!initialized) return;
+  
+  int centerX = Face::CENTER_X;
+  int centerY = Face::CENTER_Y + Face::MOUTH_Y_OFFSET;
+  
+  // Only the mouth box is touched so a lip-sync frame stays tiny
+  uint32_t start = micros();
+  startFastDraw();
+  restoreBackground(centerX + Face::MOUTH_BOX_LEFT, centerY + Face::MOUTH_BOX_TOP,
+                    Face::MOUTH_BOX_WIDTH, Face::MOUTH_BOX_HEIGHT);
+  drawnExpression = EXPRESSION_COUNT;
+  
+  // Map lip-sync parameters onto the mouth box
+  int halfWidth = Face::scale(12) + (width * Face::scale(18)) / 255;   // 12-30 pixels
+  int halfHeight = Face::scale(2) + (open * Face::scale(20)) / 255;    // 2-22 pixels
+  int mouthY = centerY + Face::scale(8);
+  
+  if (halfHeight < Face::scale(4)) {
+    // Nearly closed - a short flat line reads better than a sliver
+    drawThickLine(centerX - halfWidth, mouthY, centerX + halfWidth, mouthY, Face::scale(3), BMO_BLACK);
+  } else if (beginClip(centerX - halfWidth, mouthY - halfHeight, 2 * halfWidth + 1, 2 * halfHeight + 1)) {
+    tft->fillEllipse(centerX, mouthY, halfWidth, halfHeight, BMO_BLACK);
+    meterDisc(halfWidth, halfHeight);
+    endClip();
+  }
+  endFastDraw();
+  stats.updates++;
+  uint32_t elapsed = micros() - start;
+  stats.frameTime.record(elapsed);
+  governFrame(elapsed);
 }
 
-void BMOGraphics::drawExcitedMouth(int centerX, int centerY) {
-  // Draw wide open smile with visible "teeth"
-  drawCurve(centerX, centerY, MOUTH_WIDTH + 20, MOUTH_HEIGHT + 10, BMO_BLACK, true);
+template <class Panel>
+void BMOGraphicsT<Panel>::drawParticles(const BMOParticles& particles) {
+  if (!initialized) return;
   
-  // Add tooth highlights
-  for (int i = 0; i < 4; i++) {
-    int toothX = centerX - 20 + (i * 13);
-    tft->fillRect(toothX, centerY + 8, 3, 8, BMO_WHITE);
+  // Restore every dirty rect (background and whatever face layer it
+  // touches) before drawing anything, so a restore can't clip a neighbour
+  // drawn earlier in the same frame
+  uint32_t start = micros();
+  startFastDraw();
+  for (uint8_t i = 0; i < particles.getDirtyCount(); i++) {
+    const BMOParticleRect& rect = particles.getDirty(i);
+    restoreRegion(rect.x, rect.y, rect.w, rect.h);
+  }
+  for (uint8_t i = 0; i < particles.getLiveCount(); i++) {
+    if (particles.needsDraw(i)) {
+      drawParticleSprite(particles.getX(i), particles.getY(i), particles.getSprite(i));
+    }
   }
+  endFastDraw();
+  stats.updates++;
+  uint32_t elapsed = micros() - start;
+  stats.frameTime.record(elapsed);
+  governFrame(elapsed);
 }
 
-void BMOGraphics::drawConfusedMouth(int centerX, int centerY) {
-  // Draw wavy line
-  int segments = 8;
-  int segmentWidth = MOUTH_WIDTH / segments;
+template <class Panel>
+void BMOGraphicsT<Panel>::drawParticleSprite(int x, int y, uint8_t sprite) {
+  if (sprite >= PARTICLE_SPRITE_COUNT) return;
+  if (!isVisible(x, y, PARTICLE_SPRITE_SIZE, PARTICLE_SPRITE_SIZE)) {
+    stats.clipRejects++;
+    return;
+  }
+  const BMOParticleSpriteDef& def = PARTICLE_SPRITES[sprite];
   
-  for (int i = 0; i < segments; i++) {
-    int x1 = centerX - MOUTH_WIDTH/2 + (i * segmentWidth);
-    int x2 = x1 + segmentWidth;
-    int y1 = centerY + ((i % 2 == 0) ? -5 : 5);
-    int y2 = centerY + ((i % 2 == 0) ? 5 : -5);
-    
-    drawThickLine(x1, y1, x2, y2, 2, BMO_BLACK);
+  // One horizontal run per stretch of set bits
+  for (int row = 0; row < PARTICLE_SPRITE_SIZE; row++) {
+    uint8_t bits = def.rows[row];
+    int col = 0;
+    while (bits) {
+      if (bits & 0x80) {
+        int start = col;
+        while (bits & 0x80) {
+          bits <<= 1;
+          col++;
+        }
+        fillSpan(x + start, x + col - 1, y + row, def.color);
+      } else {
+        bits <<= 1;
+        col++;
+      }
+    }
   }
 }
 
-void BMOGraphics::drawFrame() {
-  // Draw BMO's characteristic rectangular border
-  int frameThickness = 6;
-  int cornerRadius = 12;
+template <class Panel>
+void BMOGraphicsT<Panel>::drawFrame() {
+  // Draw BMO's characteristic rectangular border: nested dark rounded
+  // rectangles plus an inner highlight, from the corner span table
+  const int corner = Shapes::FRAME_CORNER;
+  const int right = Panel::WIDTH - 1;
+  const int bottom = Panel::HEIGHT - 1;
+  
+  bool ownWrite = !fastDrawMode;
+  if (ownWrite) startFastDraw();
   
-  // Outer frame
-  for (int i = 0; i < frameThickness; i++) {
-    drawRoundedRect(i, i, 240 - (i * 2), 320 - (i * 2), cornerRadius, BMO_DARK_TEAL);
+  // Corners, mirrored four ways. Spans touching the corner's inner edge are
+  // the straight top/bottom lines and run across to their mirror image.
+  // They all sit in the top and bottom bands.
+  if (isVisible(0, 0, Panel::WIDTH, corner) || isVisible(0, Panel::HEIGHT - corner, Panel::WIDTH, corner)) {
+    for (int i = 0; i < Shapes::FRAME.COUNT; i++) {
+      const BMOSpan& span = Shapes::FRAME.spans[i];
+      if (span.x1 == corner - 1) {
+        fillSpan(span.x0, right - span.x0, span.y, span.color);
+        fillSpan(span.x0, right - span.x0, bottom - span.y, span.color);
+      } else {
+        fillSpan(span.x0, span.x1, span.y, span.color);
+        fillSpan(right - span.x1, right - span.x0, span.y, span.color);
+        fillSpan(span.x0, span.x1, bottom - span.y, span.color);
+        fillSpan(right - span.x1, right - span.x0, bottom - span.y, span.color);
+      }
+    }
+  } else {
+    stats.clipRejects++;
+  }
+  
+  // Straight left/right edges between the corners
+  int edgeHeight = Panel::HEIGHT - (corner * 2);
+  if (edgeHeight > 0) {
+    for (int i = 0; i < Shapes::FRAME_EDGE.COUNT; i++) {
+      const BMOSpan& span = Shapes::FRAME_EDGE.spans[i];
+      int width = span.x1 - span.x0 + 1;
+      fillRectClipped(span.x0, corner, width, edgeHeight, span.color);
+      fillRectClipped(right - span.x1, corner, width, edgeHeight, span.color);
+    }
   }
   
-  // Inner highlight
-  drawRoundedRect(frameThickness, frameThickness, 
-                  240 - (frameThickness * 2), 320 - (frameThickness * 2), 
-                  cornerRadius - 2, BMO_LIGHT_TEAL);
+  if (ownWrite) endFastDraw();
 }
 
-void BMOGraphics::animateBlink() {
+template <class Panel>
+void BMOGraphicsT<Panel>::animateBlink() {
   if (!initialized) return;
   
   // Close eyes
@@ -251,61 +1002,480 @@ void BMOGraphics::animateBlink() {
   Serial.println("Blink animation complete");
 }
 
-void BMOGraphics::drawSmoothCircle(int centerX, int centerY, int radius, uint16_t color) {
+template <class Panel>
+bool BMOGraphicsT<Panel>::fadeTransition(uint16_t fromColor, uint16_t toColor, int steps) {
+  if (!initialized) return false;
+  
+  // Replaces any queued face redraw; what it would have drawn is faded over
+  fadeFrom = fromColor;
+  fadeTo = toColor;
+  fadeSteps = (uint8_t)(steps < 1 ? 1 : (steps > FADE_MAX_STEPS ? FADE_MAX_STEPS : steps));
+  fadeStep = 1;
+  fadeRow = 0;
+  faceStage = FACE_STAGE_IDLE;
+  drawnExpression = EXPRESSION_COUNT;
+  return display->queueJob(panelIndex, fadeJob, this);
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::fadeJob(void* context) {
+  return static_cast<BMOGraphicsT<Panel>*>(context)->stepFade();
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::stepFade() {
+  if (!initialized || fadeStep == 0) return true;
+  
+  // A band of rows a slice, so the fade's pace is the bus's and the loop
+  // keeps running between bands
+  uint32_t start = micros();
+  startFastDraw();
+  fillBlended(0, fadeRow, Panel::WIDTH, FACE_BAND_ROWS, fadeFrom, fadeTo,
+              (uint32_t)fadeStep * 65536 / fadeSteps);
+  endFastDraw();
+  governFrame(micros() - start);
+  
+  fadeRow += FACE_BAND_ROWS;
+  if (fadeRow < Panel::HEIGHT) return false;
+  fadeRow = 0;
+  if (++fadeStep <= fadeSteps) return false;
+  fadeStep = 0;
+  return true;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawSmoothCircle(int centerX, int centerY, int radius, uint16_t color) {
   // Use anti-aliased circle for smooth edges
   drawAntiAliasedCircle(centerX, centerY, radius, color);
 }
 
-void BMOGraphics::drawThickLine(int x1, int y1, int x2, int y2, int thickness, uint16_t color) {
+template <class Panel>
+void BMOGraphicsT<Panel>::drawThickLine(int x1, int y1, int x2, int y2, int thickness, uint16_t color) {
+  int left = (x1 < x2 ? x1 : x2) - thickness, top = (y1 < y2 ? y1 : y2) - thickness;
+  if (!beginClip(left, top, abs(x2 - x1) + 2 * thickness + 1, abs(y2 - y1) + 2 * thickness + 1)) return;
+  
   for (int i = 0; i < thickness; i++) {
     for (int j = 0; j < thickness; j++) {
       tft->drawLine(x1 + i - thickness/2, y1 + j - thickness/2,
                     x2 + i - thickness/2, y2 + j - thickness/2, color);
+      meterLine(x1, y1, x2, y2);
     }
   }
+  endClip();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawCurve(int centerX, int centerY, int width, int height, uint16_t color, bool upward) {
+  // The parabola through both ends and the apex is exactly a quadratic
+  // Bezier whose control point sits twice as far out as the apex
+  int bend = (upward ? 1 : -1) * height * 2;
+  drawBezierCurve(centerX - width/2, centerY, centerX, centerY + bend, centerX + width/2, centerY, color);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawBezierCurve(int x1, int y1, int x2, int y2, int x3, int y3, uint16_t color) {
+  // Stroke outline through the pixel centers, filled as spans
+  const int center = PATH_ONE / 2;
+  BMOPath path;
+  path.setTolerance(drawnCurveTolerance);
+  path.strokeQuad(PATH_PX(x1) + center, PATH_PX(y1) + center, PATH_PX(x2) + center, PATH_PX(y2) + center,
+                  PATH_PX(x3) + center, PATH_PX(y3) + center, PATH_PX(Face::scale(3)));
+  fillPath(path, 0, 0, color);
 }
 
-void BMOGraphics::drawCurve(int centerX, int centerY, int width, int height, uint16_t color, bool upward) {
-  // Draw smooth curve using multiple line segments
-  int segments = 20;
-  int startX = centerX - width/2;
-  int segmentWidth = width / segments;
+template <class Panel>
+void BMOGraphicsT<Panel>::fillPath(const BMOPath& path, int originX, int originY, uint16_t color,
+                                   BMOFillRule rule) {
+  int x, y, width, height;
+  if (!path.getBounds(x, y, width, height)) return;
+  if (!isVisible(originX + x, originY + y, width, height)) {
+    stats.clipRejects++;
+    return;
+  }
   
-  for (int i = 0; i < segments; i++) {
-    int x1 = startX + (i * segmentWidth);
-    int x2 = startX + ((i + 1) * segmentWidth);
-    
-    // Calculate Y positions using parabolic curve
-    float t1 = (float)(x1 - centerX) / (width/2);
-    float t2 = (float)(x2 - centerX) / (width/2);
-    
-    int y1 = centerY + (upward ? 1 : -1) * (int)(height * (1 - t1 * t1));
-    int y2 = centerY + (upward ? 1 : -1) * (int)(height * (1 - t2 * t2));
+  bool ownWrite = !fastDrawMode;
+  if (ownWrite) startFastDraw();
+  path.fill(pathSpan, this, color, rule, originX, originY);
+  if (ownWrite) endFastDraw();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::pathSpan(const BMOSpan& span, void* context) {
+  static_cast<BMOGraphicsT<Panel>*>(context)->fillSpan(span.x0, span.x1, span.y, span.color);
+}
+
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+template <class Panel>
+bool BMOGraphicsT<Panel>::drawImage(BMOImageRead read, void* context, int x, int y, uint16_t background) {
+  if (!initialized) return false;
+  
+  uint32_t start = micros();
+  BMOQoiStatus status = imageDecoder->begin(read, context);
+  const BMOQoiInfo& info = imageDecoder->getInfo();
+  if (status == QOI_OK && info.width > IMAGE_BAND_PIXELS) {
+    Serial.printf("Image: %ux%u is wider than the %u pixel band\n", (unsigned)info.width,
+                  (unsigned)info.height, (unsigned)IMAGE_BAND_PIXELS);
+    return false;
+  }
+  if (status != QOI_OK) {
+    Serial.printf("Image: %s\n", BMOQoiDecoder::statusName(status));
+    return false;
+  }
+  imageDecoder->setBackground(background);
+  
+  int width = (int)info.width;
+  int height = (int)info.height;
+  if (!isVisible(x, y, width, height)) {
+    stats.clipRejects++;
+    return true;
+  }
+  int bandRows = IMAGE_BAND_PIXELS / width;
+  const BMOClipRect& clip = getClip();
+  bool whole = x >= clip.x0 && y >= clip.y0 && x + width <= clip.x1 && y + height <= clip.y1;
+  
+  bool ownWrite = !fastDrawMode;
+  if (ownWrite) startFastDraw();
+  
+  // Inside the clip the image is one address window, filled a band at a time.
+  // Bands are native RGB565, swapped to panel order by TFT_eSPI (see begin()).
+  if (whole) {
+    tft->setAddrWindow(x, y, width, height);
+    meter(1, 0);
+  }
+  
+  for (int row = 0; row < height && !imageDecoder->isDone(); row += bandRows) {
+    int rows = height - row < bandRows ? height - row : bandRows;
+    uint32_t count = imageDecoder->decode(imageBand, (uint32_t)rows * width);
+    if (whole) {
+      tft->pushPixels(imageBand, count);
+      meter(0, count);
+      continue;
+    }
     
-    drawThickLine(x1, y1, x2, y2, 3, color);
+    // Straddling the clip: every band is decoded, the visible ones sent
+    rows = (int)(count / width);
+    int top = y + row;
+    if (rows == 0 || !isVisible(x, top, width, rows)) continue;
+    beginClip(x, top, width, rows);
+    tft->pushImage(x, top, width, rows, imageBand);
+    endClip();
+    int visibleW = (x + width < clip.x1 ? x + width : clip.x1) - (x > clip.x0 ? x : clip.x0);
+    int visibleH = (top + rows < clip.y1 ? top + rows : clip.y1) - (top > clip.y0 ? top : clip.y0);
+    meter(1, (uint32_t)visibleW * visibleH);
+  }
+  
+  if (ownWrite) endFastDraw();
+  
+  stats.images++;
+  stats.imagePixels += imageDecoder->getPixelsDecoded();
+  stats.imageBytes += imageDecoder->getBytesRead();
+  stats.imageTime.record(micros() - start);
+  
+  status = imageDecoder->getStatus();
+  if (status != QOI_OK) {
+    Serial.printf("Image: %s after %u of %u pixels\n", BMOQoiDecoder::statusName(status),
+                  (unsigned)imageDecoder->getPixelsDecoded(), (unsigned)(info.width * info.height));
+    return false;
+  }
+  return true;
+}
+#endif
+
+#if BMO_ENABLE_IMAGES
+template <class Panel>
+bool BMOGraphicsT<Panel>::drawImage(const char* path, int x, int y, uint16_t background) {
+#if defined(ESP32)
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    Serial.printf("Image: %s not found\n", path);
+    return false;
+  }
+  bool drawn = drawImage(readImageFile, &file, x, y, background);
+  file.close();
+#else
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    Serial.printf("Image: %s not found\n", path);
+    return false;
+  }
+  bool drawn = drawImage(readImageFile, file, x, y, background);
+  fclose(file);
+#endif
+  return drawn;
+}
+#endif
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::drawSprite(const char* name, int x, int y, uint16_t background) {
+  const BMOAssetEntry* sprite = assets ? assets->find(name) : nullptr;
+  if (!sprite) {
+    stats.sprites++;
+    Serial.printf("Sprite: %s %s\n", name, assets && assets->isReady() ? "not found" : "- no asset pack");
+    return false;
   }
+  return drawSprite(sprite, x, y, background);
 }
 
-void BMOGraphics::drawRoundedRect(int x, int y, int width, int height, int radius, uint16_t color) {
+template <class Panel>
+bool BMOGraphicsT<Panel>::drawSprite(const BMOAssetEntry* sprite, int x, int y, uint16_t background) {
+  if (!initialized || !sprite || !assets || !assets->isReady()) return false;
+  
+  uint32_t start = micros();
+  stats.sprites++;
+  const uint8_t* data = assets->getData(sprite);
+  if (sprite->format == ASSET_FORMAT_QOI) {
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+    BMOMappedRead mapped = { data, sprite->length, 0 };
+    bool drawn = drawImage(readMapped, &mapped, x, y, background);
+    stats.spriteTime.record(micros() - start);
+    return drawn;
+#else
+    (void)background;
+    Serial.println("Sprite: QOI needs -DBMO_ENABLE_ASSETS=1");
+    return false;
+#endif
+  }
+  
+  int width = sprite->width;
+  int height = sprite->height;
+  if (!beginClip(x, y, width, height)) return true;
+  
+  const BMOClipRect& clip = getClip();
+  int cutX = x < clip.x0 ? clip.x0 - x : 0;
+  int cutY = y < clip.y0 ? clip.y0 - y : 0;
+  int visibleW = (x + width < clip.x1 ? x + width : clip.x1) - (x > clip.x0 ? x : clip.x0);
+  int visibleH = (y + height < clip.y1 ? y + height : clip.y1) - (y > clip.y0 ? y : clip.y0);
+  
+  // Raw sprites are stored in panel byte order, so TFT_eSPI is told not to
+  // swap and streams the mapped rows into the SPI FIFO as they are. The
+  // FIFO is loaded a 32-bit word at a time, so that only works while every
+  // row sent starts word aligned: the pack aligns each sprite, but a clip
+  // that cuts an odd number of pixels off the left, or the rows of an
+  // odd-width sprite cut narrower, would start mid-word. Those go through
+  // the const overload, which copies each row into an aligned line buffer
+  // first (as for PROGMEM). The DMA queue isn't used: it can't read
+  // flash-mapped memory and would bounce through a RAM buffer.
+  const uint16_t* first = reinterpret_cast<const uint16_t*>(data) + cutX + (uint32_t)cutY * width;
+  bool aligned = ((uintptr_t)first & 3) == 0 && (visibleW == width || (width & 1) == 0);
+  bool swapBytes = tft->getSwapBytes();
+  bool ownWrite = !fastDrawMode;
+  if (ownWrite) startFastDraw();
+  tft->setSwapBytes(false);
+  if (aligned) {
+    tft->pushImage(x, y, width, height, const_cast<uint16_t*>(reinterpret_cast<const uint16_t*>(data)));
+  } else {
+    tft->pushImage(x, y, width, height, reinterpret_cast<const uint16_t*>(data));
+  }
+  tft->setSwapBytes(swapBytes);
+  if (ownWrite) endFastDraw();
+  endClip();
+  
+  meter(1, (uint32_t)visibleW * visibleH);
+  stats.spritePixels += (uint32_t)visibleW * visibleH;
+  stats.spriteTime.record(micros() - start);
+  return true;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawRoundedRect(int x, int y, int width, int height, int radius, uint16_t color) {
   // Draw rounded rectangle outline
+  if (!beginClip(x, y, width, height)) return;
   tft->drawRoundRect(x, y, width, height, radius, color);
+  meter(4 + 4 * radius, 2 * (width + height));  // Edges, then corner arcs pixel by pixel
+  endClip();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawSpans(const BMOSpan* spans, int count, int originX, int originY) {
+  // Tables are sorted top to bottom; one horizontal fill per run, and the
+  // rows above and below the clip are skipped
+  const BMOClipRect& clip = getClip();
+  bool ownWrite = !fastDrawMode;
+  if (ownWrite) startFastDraw();
+  for (int i = 0; i < count; i++) {
+    const BMOSpan& span = spans[i];
+    int y = originY + span.y;
+    if (y < clip.y0) continue;
+    if (y >= clip.y1) break;
+    fillSpan(originX + span.x0, originX + span.x1, y, span.color);
+  }
+  if (ownWrite) endFastDraw();
 }
 
-void BMOGraphics::startFastDraw() {
+template <class Panel>
+void BMOGraphicsT<Panel>::startFastDraw() {
   if (initialized) {
-    tft->startWrite();
+    display->selectPanel(panelIndex);
+    display->startWrite();
     fastDrawMode = true;
+    flushUs = 0;
   }
 }
 
-void BMOGraphics::endFastDraw() {
+template <class Panel>
+void BMOGraphicsT<Panel>::endFastDraw() {
   if (initialized && fastDrawMode) {
-    tft->endWrite();
+    // Whatever is still queued for the bus is waited for here
+    uint32_t start = micros();
+    display->endWrite();
+    flushUs += micros() - start;
     fastDrawMode = false;
   }
 }
 
-uint16_t BMOGraphics::blendColors(uint16_t color1, uint16_t color2, float ratio) {
+template <class Panel>
+void BMOGraphicsT<Panel>::governFrame(uint32_t us) {
+  // The governor sums the tick's draw calls and judges them as one frame
+  // at endFrame(); the flush is taken so the next call doesn't count it again
+  uint32_t flush = flushUs < us ? flushUs : us;
+  flushUs = 0;
+  if (governor) governor->addTime(us - flush, flush);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::setDrawRegion(int x, int y, int width, int height) {
+  // Clamped to the panel; pushed clips are dropped
+  BMOClipRect& region = clipStack[0];
+  region.x0 = x < 0 ? 0 : (x > Panel::WIDTH ? Panel::WIDTH : x);
+  region.y0 = y < 0 ? 0 : (y > Panel::HEIGHT ? Panel::HEIGHT : y);
+  region.x1 = x + width < region.x0 ? region.x0 : (x + width > Panel::WIDTH ? Panel::WIDTH : x + width);
+  region.y1 = y + height < region.y0 ? region.y0 : (y + height > Panel::HEIGHT ? Panel::HEIGHT : y + height);
+  clipDepth = 1;
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::pushClip(int x, int y, int width, int height) {
+  if (clipDepth >= CLIP_STACK_DEPTH) return false;
+  
+  // Intersection with the current clip (possibly empty)
+  const BMOClipRect& outer = clipStack[clipDepth - 1];
+  BMOClipRect& inner = clipStack[clipDepth++];
+  inner.x0 = x > outer.x0 ? x : outer.x0;
+  inner.y0 = y > outer.y0 ? y : outer.y0;
+  inner.x1 = x + width < outer.x1 ? x + width : outer.x1;
+  inner.y1 = y + height < outer.y1 ? y + height : outer.y1;
+  if (inner.x1 < inner.x0) inner.x1 = inner.x0;
+  if (inner.y1 < inner.y0) inner.y1 = inner.y0;
+  return true;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::popClip() {
+  if (clipDepth > 1) clipDepth--;
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::isVisible(int x, int y, int width, int height) const {
+  const BMOClipRect& clip = getClip();
+  return width > 0 && height > 0 &&
+         x < clip.x1 && x + width > clip.x0 && y < clip.y1 && y + height > clip.y0;
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::isInDrawRegion(int x, int y) {
+  const BMOClipRect& clip = getClip();
+  return x >= clip.x0 && x < clip.x1 && y >= clip.y0 && y < clip.y1;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawPixelSafe(int x, int y, uint16_t color) {
+  if (!isInDrawRegion(x, y)) return;
+  tft->drawPixel(x, y, color);
+  meter(1, 1);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::fillSpan(int x0, int x1, int y, uint16_t color) {
+  const BMOClipRect& clip = getClip();
+  if (y < clip.y0 || y >= clip.y1) return;
+  if (x0 < clip.x0) x0 = clip.x0;
+  if (x1 >= clip.x1) x1 = clip.x1 - 1;
+  if (x0 > x1) return;
+  tft->drawFastHLine(x0, y, x1 - x0 + 1, color);
+  meter(1, x1 - x0 + 1);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::fillRectClipped(int x, int y, int width, int height, uint16_t color) {
+  const BMOClipRect& clip = getClip();
+  int x0 = x > clip.x0 ? x : clip.x0;
+  int y0 = y > clip.y0 ? y : clip.y0;
+  int x1 = x + width < clip.x1 ? x + width : clip.x1;
+  int y1 = y + height < clip.y1 ? y + height : clip.y1;
+  if (x0 >= x1 || y0 >= y1) {
+    stats.clipRejects++;
+    return;
+  }
+  tft->fillRect(x0, y0, x1 - x0, y1 - y0, color);
+  meter(1, (uint32_t)(x1 - x0) * (y1 - y0));
+}
+
+template <class Panel>
+bool BMOGraphicsT<Panel>::beginClip(int x, int y, int width, int height) {
+  if (!isVisible(x, y, width, height)) {
+    stats.clipRejects++;
+    return false;
+  }
+  
+  // Straddling the edge: TFT_eSPI trims its own spans to the viewport
+  // (screen coordinates kept, vpDatum false)
+  const BMOClipRect& clip = getClip();
+  if (x < clip.x0 || y < clip.y0 || x + width > clip.x1 || y + height > clip.y1) {
+    tft->setViewport(clip.x0, clip.y0, clip.x1 - clip.x0, clip.y1 - clip.y0, false);
+    viewportClipped = true;
+  }
+  return true;
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::endClip() {
+  if (viewportClipped) {
+    tft->setViewport(0, 0, Panel::WIDTH, Panel::HEIGHT);  // As BMODisplay::selectPanel() left it
+    viewportClipped = false;
+  }
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::restoreRegion(int x, int y, int width, int height) {
+  // Background and the face layers over it, with everything outside the
+  // rect rejected by the clip (a full stack just restores the background)
+  if (!pushClip(x, y, width, height)) {
+    restoreBackground(x, y, width, height);
+    return;
+  }
+  restoreBackground(x, y, width, height);
+  drawFaceLayers();
+  popClip();
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawFaceLayers() {
+  // What drawBMOFace() puts over the background, as it is on screen now:
+  // eyes where the gaze was last drawn, and the last drawn mouth (a lip-sync
+  // mouth is left to its next frame)
+  int eyeY = Face::CENTER_Y + Face::EYE_Y_OFFSET;
+  drawFrame();
+  drawEye(Face::CENTER_X - Face::EYE_SEPARATION / 2, eyeY, currentEyeState, true);
+  drawEye(Face::CENTER_X + Face::EYE_SEPARATION / 2, eyeY, currentEyeState, false);
+  if (drawnExpression < EXPRESSION_COUNT) drawMouth(drawnExpression);
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::repaintRegion(int x, int y, int width, int height) {
+  if (!initialized) return;
+  
+  uint32_t start = micros();
+  startFastDraw();
+  restoreRegion(x, y, width, height);
+  endFastDraw();
+  stats.updates++;
+  uint32_t elapsed = micros() - start;
+  stats.frameTime.record(elapsed);
+  governFrame(elapsed);
+}
+
+template <class Panel>
+uint16_t BMOGraphicsT<Panel>::blendColors(uint16_t color1, uint16_t color2, float ratio) {
   // Extract RGB components
   uint8_t r1 = RED_FROM_565(color1);
   uint8_t g1 = GREEN_FROM_565(color1);
@@ -323,16 +1493,54 @@ uint16_t BMOGraphics::blendColors(uint16_t color1, uint16_t color2, float ratio)
   return RGB565(r, g, b);
 }
 
-void BMOGraphics::drawAntiAliasedCircle(int centerX, int centerY, int radius, uint16_t color) {
+template <class Panel>
+void BMOGraphicsT<Panel>::fillBlended(int x, int y, int width, int height, uint16_t color1, uint16_t color2,
+                                      uint32_t alpha) {
+  BMOColorQ8 color = bmoMixQ8(color1, color2, alpha);
+#if BMO_ENABLE_DITHER
+  // A mix that lands on an RGB565 color needs no pattern
+  if (((color.r | color.g | color.b) & 0xFF) == 0) {
+    fillRectClipped(x, y, width, height, bmoTruncate565(color));
+    return;
+  }
+  
+  const BMOClipRect& clip = getClip();
+  int x0 = x > clip.x0 ? x : clip.x0;
+  int y0 = y > clip.y0 ? y : clip.y0;
+  int x1 = x + width < clip.x1 ? x + width : clip.x1;
+  int y1 = y + height < clip.y1 ? y + height : clip.y1;
+  if (x0 >= x1 || y0 >= y1) {
+    stats.clipRejects++;
+    return;
+  }
+  
+  for (int row = y0; row < y1; row++) {
+    bmoDitherSpan(ditherLine, x0, row, x1 - x0, color);
+    tft->pushImage(x0, row, x1 - x0, 1, ditherLine);
+  }
+  meter(y1 - y0, (uint32_t)(x1 - x0) * (y1 - y0));
+  stats.ditherRows += y1 - y0;
+#else
+  fillRectClipped(x, y, width, height, bmoTruncate565(color));
+#endif
+}
+
+template <class Panel>
+void BMOGraphicsT<Panel>::drawAntiAliasedCircle(int centerX, int centerY, int radius, uint16_t color) {
   // For now, use standard filled circle
   // Anti-aliasing would require more complex pixel blending
+  if (!beginClip(centerX - radius - 1, centerY - radius - 1, 2 * radius + 3, 2 * radius + 3)) return;
   tft->fillCircle(centerX, centerY, radius, color);
+  meterDisc(radius, radius);
   
   // Add subtle outline for smoothness
   tft->drawCircle(centerX, centerY, radius, darkenColor(color, 0.2f));
+  meter((radius * 1608) >> 8, (radius * 1608) >> 8);  // ~2*pi*r single pixels
+  endClip();
 }
 
-uint16_t BMOGraphics::darkenColor(uint16_t color, float amount) {
+template <class Panel>
+uint16_t BMOGraphicsT<Panel>::darkenColor(uint16_t color, float amount) {
   uint8_t r = RED_FROM_565(color);
   uint8_t g = GREEN_FROM_565(color);
   uint8_t b = BLUE_FROM_565(color);
@@ -344,11 +1552,47 @@ uint16_t BMOGraphics::darkenColor(uint16_t color, float amount) {
   return RGB565(r, g, b);
 }
 
-void BMOGraphics::printGraphicsInfo() {
+template <class Panel>
+void BMOGraphicsT<Panel>::printGraphicsInfo() {
   Serial.println("=== BMO Graphics Information ===");
   Serial.printf("Status: %s\n", initialized ? "Initialized" : "Not Initialized");
-  Serial.printf("Current Expression: %d\n", currentExpression);
+  Serial.printf("Panel: %dx%d (face scale %d/256)\n", Panel::WIDTH, Panel::HEIGHT, (int)Face::SCALE_Q8);
+  Serial.printf("Current Expression: %d of %d (%u bytes of bytecode)\n", currentExpression,
+                EXPRESSION_COUNT, (unsigned)bmoExpressionProgramSize);
   Serial.printf("Current Eye State: %d\n", currentEyeState);
   Serial.printf("Fast Draw Mode: %s\n", fastDrawMode ? "Active" : "Inactive");
+  Serial.printf("Gaze: %d,%d px (target %d,%d)\n", gazeX >> 8, gazeY >> 8, gazeTargetX >> 8, gazeTargetY >> 8);
+  Serial.printf("Frames: %u, partial updates: %u\n", (unsigned)stats.frames, (unsigned)stats.updates);
+  const BMOClipRect& clip = getClip();
+  Serial.printf("Clip: %d,%d-%d,%d (depth %u), rejected primitives: %u\n", clip.x0, clip.y0, clip.x1, clip.y1,
+                clipDepth, (unsigned)stats.clipRejects);
+  stats.frameTime.print("Render time");
+  if (stats.images > 0) {
+    uint64_t imageUs = stats.imageTime.totalUs ? stats.imageTime.totalUs : 1;
+    Serial.printf("Images: %u, %llu pixels from %llu bytes, %llu pixels/ms\n", (unsigned)stats.images,
+                  (unsigned long long)stats.imagePixels, (unsigned long long)stats.imageBytes,
+                  (unsigned long long)(stats.imagePixels * 1000 / imageUs));
+    stats.imageTime.print("Image time");
+  }
+  if (assets && assets->isReady()) {
+    Serial.printf("Assets: %u sprites, %u bytes mapped, %u lookups (%u missed)\n", assets->getCount(),
+                  (unsigned)assets->getSize(), (unsigned)assets->getLookups(), (unsigned)assets->getMisses());
+  }
+  if (stats.sprites > 0) {
+    Serial.printf("Sprites: %u, %llu raw pixels sent\n", (unsigned)stats.sprites,
+                  (unsigned long long)stats.spritePixels);
+    stats.spriteTime.print("Sprite time");
+  }
+#if BMO_ENABLE_DITHER
+  Serial.printf("Dither: %dx%d ordered, %u rows dithered\n", DITHER_SIZE, DITHER_SIZE, (unsigned)stats.ditherRows);
+#endif
   Serial.println("================================");
-}
\ No newline at end of file
+}
+
+// Instantiate the renderer for the panel selected at build time
+template class BMOGraphicsT<BMOActivePanel>;
+
+#if BMO_ENABLE_STATUS_PANEL
+// ...and for the status panel next to it
+template class BMOGraphicsT<BMOStatusPanel>;
+#endif
@@ -2,13 +2,35 @@
  * BMO Graphics Functions
  * 
  * Specialized drawing functions for BMO character elements
- * Optimized for 240x320 TFT display with 16-bit color
+ * Specialized at compile time for the panel profile (see panel.h),
+ * 240x320 16-bit color by default
  * 
  * Features:
  * - BMO face rendering (eyes, mouth, expressions)
  * - Animation support (blinking, expression changes)
- * - Efficient drawing algorithms
+ * - Efficient drawing algorithms (compile-time span tables, see shapes.h,
+ *   and runtime vector paths, see path.h)
  * - Color palette management
+ * - Any panel on the bus, with sliced redraws for BMODisplay::serviceJobs()
+ * - Always-on render metrics (frame counts, render time histogram) and
+ *   pixel/window accounting into BMODisplay's bus metrics
+ * - Smoothed eye gaze: anti-aliased eyes at sub-pixel offsets, repainting
+ *   only the pixels that changed between two frames
+ * - Data-driven expressions: mouths are bytecode display lists compiled from
+ *   expressions/expressions.txt (see expression_ops.h), run by one interpreter
+ * - Clip stack honored by every primitive: shapes missing the clip are
+ *   rejected by their bounds, the rest trimmed to it span by span
+ * - Eye rows double buffered over queued DMA transfers when BMODisplay has
+ *   them (-DBMO_ENABLE_DMA=1), rendering one row while the last is sent
+ * - QOI images streamed from LittleFS a band of rows at a time (see qoi.h),
+ *   through a fixed buffer whatever the image size
+ * - Sprites blitted straight from the memory-mapped asset partition (see
+ *   assets.h), with no copy between flash and the SPI driver
+ * - Frame times reported to a quality governor (see quality.h), whose knobs
+ *   each layer takes up the next time it is drawn whole
+ * - Optional ordered dither (-DBMO_ENABLE_DITHER=1, see dither.h) on the
+ *   background gradient, fades and anti-aliased eye edges, so they are
+ *   converted to RGB565 without banding
  */
 
 #ifndef BMO_GRAPHICS_H
@@ -16,6 +38,17 @@
 
 #include <Arduino.h>
 #include <TFT_eSPI.h>
+#include "display.h"
+#include "panel.h"
+#include "shapes.h"
+#include "path.h"
+#include "expressions.h"
+#include "particles.h"
+#include "qoi.h"
+#include "assets.h"
+#include "quality.h"
+#include "dither.h"
+#include "memory.h"
 
 // BMO Color Palette (RGB565 format)
 #define BMO_TEAL          0x4E6D    // Primary teal color
@@ -26,29 +59,39 @@
 #define BMO_GRAY          0x7BEF    // Neutral elements
 #define BMO_BLUE_TINT     0x4E7D    // Slight blue variation
 
-// Face element dimensions (scaled for 240x320 display)
-#define FACE_CENTER_X     120       // Horizontal center
-#define FACE_CENTER_Y     160       // Vertical center
-#define EYE_RADIUS        25        // Standard eye size
-#define EYE_SEPARATION    100       // Distance between eye centers
-#define EYE_Y_OFFSET      -40       // Eyes above center
-#define MOUTH_Y_OFFSET    30        // Mouth below center
-#define MOUTH_WIDTH       60        // Standard mouth width
-#define MOUTH_HEIGHT      20        // Mouth curve height
+// Face element dimensions live in BMOFaceGeometry (panel.h) and are derived
+// at compile time from the panel profile; BMOFace is the active panel's set
 
 // Animation parameters
 #define BLINK_DURATION    150       // Milliseconds for blink
 #define EXPRESSION_FADE   300       // Milliseconds for expression change
+#define FADE_MAX_STEPS    32        // Most steps fadeTransition() takes
+#define FACE_BAND_ROWS    40        // Background rows per scheduled redraw slice
+#define CLIP_STACK_DEPTH  6         // Nested pushClip() levels, including the draw region
 
-// Expression types
-enum BMOExpression {
-  EXPRESSION_HAPPY = 0,
-  EXPRESSION_SURPRISED,
-  EXPRESSION_SLEEPY,
-  EXPRESSION_EXCITED,
-  EXPRESSION_CONFUSED,
-  EXPRESSION_COUNT
-};
+// Images from the LittleFS partition (-DBMO_ENABLE_IMAGES=1; upload the
+// data/ folder with `pio run -t uploadfs`). drawImage() with a read callback
+// is there with this or with BMO_ENABLE_ASSETS, which bring in the decoder.
+#ifndef BMO_ENABLE_IMAGES
+#define BMO_ENABLE_IMAGES 0
+#endif
+#define IMAGE_BAND_PIXELS 1024      // Decode buffer (whole rows; wider images are refused)
+
+// Arena bytes for the image decoder and band, shared by every panel (see memory.h)
+#define IMAGE_ARENA_BYTES \
+  (bmoArenaBytes(sizeof(BMOQoiDecoder), alignof(BMOQoiDecoder)) + \
+   bmoArenaBytes(IMAGE_BAND_PIXELS * sizeof(uint16_t)))
+
+// Gaze animation (idle glancing in the sketch is optional, -DBMO_ENABLE_GAZE=1)
+#ifndef BMO_ENABLE_GAZE
+#define BMO_ENABLE_GAZE 0
+#endif
+#define GAZE_FPS            60
+#define GAZE_FRAME_INTERVAL (1000 / GAZE_FPS)  // 16ms per frame
+#define GAZE_SMOOTHING      56    // Share of the remaining distance covered per frame (of 256)
+#define GAZE_RUN_GAP        6     // Unchanged pixels cheaper to resend than a new address window
+
+// Expression types (BMOExpression) are generated into expressions.h
 
 // Eye states
 enum EyeState {
@@ -58,17 +101,59 @@ enum EyeState {
   EYES_WIDE
 };
 
-class BMOGraphics {
+// Clip rectangle in panel pixels (x0 <= x < x1, y0 <= y < y1)
+struct BMOClipRect {
+  int16_t x0, y0, x1, y1;
+};
+
+// Render metrics (see getStats())
+struct BMOGraphicsStats {
+  uint32_t frames;          // Complete faces drawn
+  uint32_t updates;         // Partial repaints (talking mouth, particles)
+  uint32_t clipRejects;     // Primitives skipped whole because they missed the clip
+  BMOHistogram frameTime;   // Render time per face or update (a scheduled face sums its slices)
+  uint32_t images;          // Images drawn (failed ones included)
+  uint64_t imagePixels;     // Pixels decoded from them
+  uint64_t imageBytes;      // File bytes read
+  BMOHistogram imageTime;   // Read, decode and send per image
+  uint32_t sprites;         // Sprites drawn from the asset pack (missing ones included)
+  uint64_t spritePixels;    // Pixels sent from raw sprites
+  BMOHistogram spriteTime;  // Lookup and send per sprite
+  uint32_t ditherRows;      // Scanlines sent through the ordered dither (gradient rows, fades)
+};
+
+template <class Panel>
+class BMOGraphicsT {
 public:
-  BMOGraphics();
-  ~BMOGraphics();
+  typedef BMOFaceGeometry<Panel> Face;
+  typedef BMOShapeTables<Panel> Shapes;
   
-  // Initialization
-  void begin(TFT_eSPI* display);
+  BMOGraphicsT();
+  ~BMOGraphicsT();
+  
+  // Initialization (draws through the display's shared TFT_eSPI instance,
+  // on the given panel - Panel must match that panel's size)
+  void begin(BMODisplay* display, uint8_t panel = 0);
   void end();
   
   // Main drawing functions
   void drawBMOFace(BMOExpression expression = EXPRESSION_HAPPY, EyeState eyeState = EYES_OPEN);
+  
+  // Scheduled redraw: queued on the display, drawn a slice per serviceJobs()
+  bool requestFace(BMOExpression expression = EXPRESSION_HAPPY, EyeState eyeState = EYES_OPEN);
+  bool stepFace();  // One slice; true when the face is complete
+  bool restoreFace() { return requestFace(currentExpression, currentEyeState); }  // After a panel reinit
+  bool requestExpression(BMOExpression expression);  // Same eyes - repaints the old and new mouth only
+  void repaintRegion(int x, int y, int width, int height);  // Every face layer, clipped to a rect
+  uint8_t getPanelIndex() const { return panelIndex; }
+  
+  // Gaze: x and y from -100 to 100 of the eyes' travel (0, 0 looks straight
+  // ahead). lookAt() sets the target; each updateGaze() moves a step towards
+  // it and repaints what changed around open eyes. Returns true while there
+  // is still movement to draw.
+  void lookAt(int8_t x, int8_t y);
+  bool updateGaze();
+  bool isGazeSettled() const { return gazeX == gazeTargetX && gazeY == gazeTargetY; }
   void clearScreen(uint16_t color = BMO_TEAL);
   
   // Face components
@@ -82,33 +167,97 @@ public:
   void drawEyeHighlight(int centerX, int centerY);
   void drawClosedEye(int centerX, int centerY, int width);
   
-  // Mouth variations
-  void drawHappyMouth(int centerX, int centerY);
-  void drawSurprisedMouth(int centerX, int centerY);
-  void drawSleepyMouth(int centerX, int centerY);
-  void drawExcitedMouth(int centerX, int centerY);
-  void drawConfusedMouth(int centerX, int centerY);
+  // Mouths: an expression's display list, or the lip-sync mouth
+  void drawExpression(BMOExpression expression, int centerX, int centerY);
+  static EyeState expressionEyes(BMOExpression expression);  // Its default eyes
+  void drawTalkingMouth(uint8_t open, uint8_t width);  // Lip-sync, repaints mouth box only
+  
+  // Particle layer (repaints the frame's dirty rects and changed sprites only)
+  void drawParticles(const BMOParticles& particles);
+  void drawParticleSprite(int x, int y, uint8_t sprite);
   
   // Animation helpers
   void animateBlink();
   void animateExpressionChange(BMOExpression from, BMOExpression to);
-  void fadeTransition(uint16_t fromColor, uint16_t toColor, int steps = 10);
+  
+  // Fade the draw region from one color to another, scheduled like
+  // requestFace(): each slice fills a band of rows one step further on
+  // (dithered with BMO_ENABLE_DITHER). The face is gone afterwards, so
+  // redraw it with requestFace().
+  bool fadeTransition(uint16_t fromColor, uint16_t toColor, int steps = 10);
+  bool stepFade();  // One slice; true when the last step is on screen
   
   // Utility functions
   void drawSmoothCircle(int centerX, int centerY, int radius, uint16_t color);
   void drawThickLine(int x1, int y1, int x2, int y2, int thickness, uint16_t color);
   void drawCurve(int centerX, int centerY, int width, int height, uint16_t color, bool upward = true);
   void drawRoundedRect(int x, int y, int width, int height, int radius, uint16_t color);
+  void drawSpans(const BMOSpan* spans, int count, int originX, int originY);
+  template <int N>
+  void drawSpans(const BMOSpanTable<N>& table, int originX, int originY) {
+    if (!isVisible(originX + table.left, originY + table.top,
+                   table.right - table.left + 1, table.bottom - table.top + 1)) {
+      stats.clipRejects++;
+      return;
+    }
+    drawSpans(table.spans, N, originX, originY);
+  }
+  void fillPath(const BMOPath& path, int originX, int originY, uint16_t color,
+                BMOFillRule rule = FILL_NONZERO);
+  void drawBezierCurve(int x1, int y1, int x2, int y2, int x3, int y3, uint16_t color);  // Quadratic, 3px pen
+  void restoreBackground(int x, int y, int width, int height);
+  uint16_t backgroundColorAt(int y);
+  void renderBackgroundRow(uint16_t* out, int x0, int width, int y);  // As restoreBackground() paints it
+  
+  // QOI images at x, y (top left), clipped like every primitive; transparent
+  // pixels show the background color. False if the file is missing or bad -
+  // whatever decoded before the error stays on screen.
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+  bool drawImage(BMOImageRead read, void* context, int x, int y, uint16_t background = BMO_TEAL);
+#endif
+#if BMO_ENABLE_IMAGES
+  // From LittleFS (mounted by the sketch); the driver allocates per open file
+  bool drawImage(const char* path, int x, int y, uint16_t background = BMO_TEAL);
+#endif
+  
+  // Sprites from a mapped asset pack, clipped like every primitive. Raw
+  // sprites go from flash to the panel as they are; QOI ones are drawn as
+  // images. False if there is no pack or no such sprite.
+  void setAssets(BMOAssetPack* pack) { assets = pack; }
+  bool drawSprite(const char* name, int x, int y, uint16_t background = BMO_TEAL);
+  bool drawSprite(const BMOAssetEntry* sprite, int x, int y, uint16_t background = BMO_TEAL);
   
   // Color utilities
   uint16_t blendColors(uint16_t color1, uint16_t color2, float ratio);
+  // A rect of color1 mixed towards color2 (alpha 0-65536), dithered when
+  // BMO_ENABLE_DITHER is on
+  void fillBlended(int x, int y, int width, int height, uint16_t color1, uint16_t color2, uint32_t alpha);
   uint16_t darkenColor(uint16_t color, float amount);
   uint16_t lightenColor(uint16_t color, float amount);
   
   // Performance optimization
   void startFastDraw();
   void endFastDraw();
-  void setDrawRegion(int x, int y, int width, int height);
+  void setDrawRegion(int x, int y, int width, int height);  // Base clip; empties the clip stack
+  
+  // Clipping. pushClip() narrows the clip to its intersection with the
+  // rect; it returns false when the stack is full (and must not be popped).
+  bool pushClip(int x, int y, int width, int height);
+  void popClip();
+  bool isVisible(int x, int y, int width, int height) const;  // Touches the clip at all
+  const BMOClipRect& getClip() const { return clipStack[clipDepth - 1]; }
+  
+  // Quality governor: fed every draw call's render and flush time (the loop
+  // closes each frame with endFrame()), its knobs
+  // applied as layers are redrawn whole (nullptr: always full quality)
+  void setGovernor(BMOQualityGovernor* governor) { this->governor = governor; }
+  const BMOQualitySettings& getQuality() const {
+    return governor ? governor->getSettings() : BMOQualityGovernor::settingsFor(QUALITY_LEVELS - 1);
+  }
+  
+  // Metrics
+  const BMOGraphicsStats& getStats() const { return stats; }
+  void resetStats() { memset(&stats, 0, sizeof(stats)); }
   
   // Debug and testing
   void drawColorTest();
@@ -117,21 +266,107 @@ public:
   
 private:
   TFT_eSPI* tft;
+  BMODisplay* display;
+  uint8_t panelIndex;
   bool initialized;
   BMOExpression currentExpression;
   EyeState currentEyeState;
+  BMOExpression drawnExpression;  // Mouth on screen (EXPRESSION_COUNT: unknown, assume the whole box)
+  BMOAssetPack* assets;
+  BMOQualityGovernor* governor;
+  
+  // Quality each layer was last drawn whole at, so repaints match the screen
+  uint8_t drawnGradientStep;
+  bool drawnAntiAlias;
+  uint16_t drawnCurveTolerance;
   
   // Optimization state
   bool fastDrawMode;
-  int drawRegionX, drawRegionY, drawRegionW, drawRegionH;
+  uint32_t flushUs;  // Spent in BMODisplay::endWrite() since startFastDraw()
+  BMOClipRect clipStack[CLIP_STACK_DEPTH];  // [0] is the draw region
+  uint8_t clipDepth;
+  bool viewportClipped;  // TFT_eSPI's viewport narrowed to the clip (see beginClip())
+  
+  // Gaze offsets in 1/256 pixel: target, current, and what is on screen
+  int16_t gazeTargetX, gazeTargetY;
+  int16_t gazeX, gazeY;
+  int16_t drawnGazeX, drawnGazeY;
+  
+  // Scheduled redraw progress
+  enum FaceStage { FACE_STAGE_IDLE = 0, FACE_STAGE_BACKGROUND, FACE_STAGE_FRAME,
+                   FACE_STAGE_EYES, FACE_STAGE_MOUTH, FACE_STAGE_MOUTH_AREA };
+  FaceStage faceStage;
+  int faceRow;
+  uint32_t faceRenderUs;  // Slice time spent on the scheduled face so far
+  bool facePartial;       // Only the mouth is being redrawn
+  static bool faceJob(void* context);
+  
+  // Scheduled fade progress
+  uint16_t fadeFrom, fadeTo;
+  uint8_t fadeSteps, fadeStep;  // fadeStep runs 1..fadeSteps
+  int fadeRow;
+  static bool fadeJob(void* context);
+  
+  BMOGraphicsStats stats;
+  void governFrame(uint32_t us);  // A draw call's (or slice's) time, split into render and flush
+  
+  // Bus accounting for BMODisplay's metrics. Curves count their nominal
+  // coverage, since TFT_eSPI doesn't report what it actually sent.
+  void meter(uint32_t windows, uint32_t pixels) { display->notePixels(windows, pixels); }
+  void meterDisc(int rx, int ry) { meter(2 * ry + 1, (uint32_t)(rx * ry * 804) >> 8); }  // ~pi*rx*ry
+  void meterLine(int x1, int y1, int x2, int y2) {
+    int dx = abs(x2 - x1), dy = abs(y2 - y1);
+    meter((dx < dy ? dx : dy) + 1, (dx > dy ? dx : dy) + 1);  // One window per run
+  }
   
   // Internal drawing helpers
   void drawPixelSafe(int x, int y, uint16_t color);
   bool isInDrawRegion(int x, int y);
+  
+  // Clipped output. Our own rasterizers trim each span or row to the clip;
+  // a primitive TFT_eSPI rasterizes itself is bracketed by beginClip(), which
+  // rejects it by its bounds, and narrows the viewport only when it straddles
+  // the clip edge, until endClip().
+  void fillSpan(int x0, int x1, int y, uint16_t color);  // x0..x1 inclusive
+  void fillRectClipped(int x, int y, int width, int height, uint16_t color);
+  bool beginClip(int x, int y, int width, int height);
+  void endClip();
+  void restoreRegion(int x, int y, int width, int height);
+  void drawFaceLayers();
   void drawAntiAliasedCircle(int centerX, int centerY, int radius, uint16_t color);
-  void drawBezierCurve(int x1, int y1, int x2, int y2, int x3, int y3, uint16_t color);
+  void restoreExpressionBounds(BMOExpression expression);  // Background under a mouth
+  void expressionBounds(BMOExpression expression, int centerX, int centerY,
+                        int& x, int& y, int& width, int& height);
+  
+  // Round eyes (open, wide) at a sub-pixel gaze offset
+  static constexpr int EYE_REACH = Face::EYE_RADIUS + Face::scale(5) + 2;  // Widest eye and its soft edge
+  static constexpr int GAZE_SPAN = 2 * (EYE_REACH + Face::GAZE_RANGE) + 2;  // Old and new bounds together
+  void drawRoundEye(int centerX, int centerY, EyeState state);
+  void repaintGazeEye(int centerX, int centerY, EyeState state);
+  void renderEyeRow(uint16_t* out, int x0, int width, int y, int centerX, int centerY,
+                    EyeState state, int16_t offsetX, int16_t offsetY);
+  
+  // BMOPath span sink
+  static void pathSpan(const BMOSpan& span, void* context);
+  
+  // Row buffers, carved from the arena by the first begin() and shared by
+  // every renderer for this panel (a draw call is done with them before it
+  // returns): eye rows at the old offset and two at the new one, and the
+  // dither line
+  static constexpr int EYE_ROWS = 3;
+  static uint16_t* eyeRows;
+  static uint16_t* ditherLine;
+  
+public:
+  // Arena bytes the renderers for this panel take (see memory.h)
+  static constexpr size_t ARENA_BYTES =
+    bmoArenaBytes(EYE_ROWS * GAZE_SPAN * sizeof(uint16_t)) +
+    (BMO_ENABLE_DITHER ? bmoArenaBytes(Panel::WIDTH * sizeof(uint16_t)) : 0);
 };
 
+// Graphics for the panel selected at build time
+typedef BMOGraphicsT<BMOActivePanel> BMOGraphics;
+
 // Global graphics instance
 extern BMOGraphics* g_bmoGraphics;
 
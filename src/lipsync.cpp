@@ -0,0 +1,361 @@
+/*
+ * BMO Lip-Sync Implementation
+ *
+ * Converts audio amplitude or viseme streams into mouth shapes
+ * Everything on the sample path is integer math so it keeps up with I2S
+ */
+
+#include "lipsync.h"
+
+#if defined(ESP32)
+#include <driver/i2s.h>
+#endif
+
+// Global lip-sync instance
+BMOLipSync* g_bmoLipSync = nullptr;
+
+// Mouth shape for each viseme {open, width}
+static const LipSyncMouth VISEME_SHAPES[VISEME_COUNT] = {
+  {   0, 170 },  // VISEME_REST
+  {   0, 150 },  // VISEME_MBP
+  {  70, 255 },  // VISEME_EE
+  { 255, 210 },  // VISEME_AA
+  { 190, 120 },  // VISEME_OH
+  { 110,  70 },  // VISEME_OO
+  {  30, 190 }   // VISEME_FV
+};
+
+// Scratch block for sample conversion, from the arena (once - it outlives
+// end()/begin() and is shared by every instance)
+static int16_t* sampleBlock = nullptr;
+
+// Little-endian readers for WAV headers (data may be unaligned in flash)
+static uint16_t readLE16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLE32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+BMOLipSync::BMOLipSync()
+  : active(false)
+  , source(LIPSYNC_SOURCE_NONE)
+  , envelope(0)
+  , blockPending(false)
+  , blockTime(0)
+  , lastFrameTime(0)
+  , nextFrameTime(0)
+  , wavSamples(nullptr)
+  , wavSampleCount(0)
+  , wavPosition(0)
+  , wavSampleRate(LIPSYNC_SAMPLE_RATE)
+  , wavChannels(1)
+  , wavStartTime(0)
+{
+  mouth.open = 0;
+  mouth.width = VISEME_SHAPES[VISEME_REST].width;
+  drawnMouth = mouth;
+  resetStats();
+}
+
+BMOLipSync::~BMOLipSync() {
+  end();
+}
+
+bool BMOLipSync::begin(LipSyncSource inputSource) {
+  if (!sampleBlock) sampleBlock = bmoArena.allocateArray<int16_t>(LIPSYNC_BLOCK_SAMPLES, "lipsync");
+  if (!sampleBlock) {
+    Serial.println("ERROR: Lip-sync sample block unavailable");
+    return false;
+  }
+  source = inputSource;
+
+  if (source == LIPSYNC_SOURCE_I2S && !beginI2S()) {
+    Serial.println("ERROR: Lip-sync I2S initialization failed");
+    source = LIPSYNC_SOURCE_NONE;
+    return false;
+  }
+
+  envelope = 0;
+  blockPending = false;
+  lastFrameTime = millis();
+  nextFrameTime = lastFrameTime + LIPSYNC_FRAME_INTERVAL;
+  active = true;
+  g_bmoLipSync = this;
+
+  Serial.printf("Lip-sync started (source %d, %d fps)\n", source, LIPSYNC_FPS);
+  return true;
+}
+
+void BMOLipSync::end() {
+  if (active) {
+    if (source == LIPSYNC_SOURCE_I2S) {
+      endI2S();
+    }
+    wavSamples = nullptr;
+    active = false;
+    g_bmoLipSync = nullptr;
+    Serial.println("Lip-sync stopped");
+  }
+}
+
+void BMOLipSync::feedSamples(const int16_t* samples, size_t count) {
+  if (!active || samples == nullptr || count == 0) return;
+  analyseBlock(samples, count, 1, millis());
+}
+
+void BMOLipSync::setViseme(BMOViseme viseme) {
+  if (!active || source != LIPSYNC_SOURCE_VISEME) return;
+  if (viseme >= VISEME_COUNT) {
+    viseme = VISEME_REST;
+  }
+  mouth = VISEME_SHAPES[viseme];
+  blockPending = true;
+  blockTime = millis();
+}
+
+bool BMOLipSync::playWav(const uint8_t* wav, size_t length) {
+  // RIFF header: "RIFF" <size> "WAVE" followed by chunks
+  if (wav == nullptr || length < 12 ||
+      memcmp(wav, "RIFF", 4) != 0 || memcmp(wav + 8, "WAVE", 4) != 0) {
+    Serial.println("Lip-sync: not a RIFF/WAVE image");
+    return false;
+  }
+
+  bool formatOk = false;
+  size_t offset = 12;
+
+  while (offset + 8 <= length) {
+    const uint8_t* chunk = wav + offset;
+    uint32_t chunkSize = readLE32(chunk + 4);
+    const uint8_t* body = chunk + 8;
+
+    if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16) {
+      uint16_t audioFormat = readLE16(body);
+      wavChannels = readLE16(body + 2);
+      wavSampleRate = readLE32(body + 4);
+      uint16_t bitsPerSample = readLE16(body + 14);
+      formatOk = (audioFormat == 1 && bitsPerSample == 16 && wavChannels > 0 && wavSampleRate > 0);
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!formatOk) break;
+      uint32_t available = (uint32_t)(length - (offset + 8));
+      if (chunkSize > available) chunkSize = available;
+
+      wavSamples = body;
+      wavSampleCount = chunkSize / (2 * wavChannels);
+      wavPosition = 0;
+      wavStartTime = millis();
+      if (source == LIPSYNC_SOURCE_I2S) {
+        endI2S();
+      }
+      source = LIPSYNC_SOURCE_WAV;
+
+      Serial.printf("Lip-sync: playing %u samples @ %u Hz (%u ch)\n",
+                    (unsigned)wavSampleCount, (unsigned)wavSampleRate, wavChannels);
+      return true;
+    }
+
+    // Chunks are word aligned
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+
+  Serial.println("Lip-sync: WAV must be 16-bit PCM with a data chunk");
+  return false;
+}
+
+bool BMOLipSync::update(unsigned long now) {
+  if (!active) return false;
+
+  // Pull any audio that has arrived since the last call
+  if (source == LIPSYNC_SOURCE_I2S) {
+    pollI2S();
+  } else if (source == LIPSYNC_SOURCE_WAV) {
+    pollWav(now);
+  }
+
+  // Wait for the next frame slot
+  if ((long)(now - nextFrameTime) < 0) return false;
+
+  // Frame timing bookkeeping
+  uint32_t interval = now - lastFrameTime;
+  if (interval > stats.maxIntervalMs) stats.maxIntervalMs = interval;
+  if (interval > LIPSYNC_FRAME_INTERVAL + LIPSYNC_FRAME_INTERVAL / 2) stats.lateFrames++;
+  stats.frames++;
+  lastFrameTime = now;
+
+  // Keep the cadence fixed; resynchronise if we fell a whole frame behind
+  nextFrameTime += LIPSYNC_FRAME_INTERVAL;
+  if ((long)(now - nextFrameTime) >= 0) {
+    nextFrameTime = now + LIPSYNC_FRAME_INTERVAL;
+  }
+
+  if (blockPending) {
+    uint32_t latency = now - blockTime;
+    if (latency > stats.maxLatencyMs) stats.maxLatencyMs = latency;
+    blockPending = false;
+  } else if (source != LIPSYNC_SOURCE_VISEME) {
+    // No new audio this frame - let the mouth relax towards closed
+    envelope -= envelope >> LIPSYNC_RELEASE_SHIFT;
+  }
+
+  if (source != LIPSYNC_SOURCE_VISEME) {
+    mouth.open = levelToOpen(envelope);
+    // Mouth narrows slightly as it opens, like real speech
+    mouth.width = 200 - (mouth.open >> 2);
+  }
+
+  // Only repaint when the shape visibly changed
+  int openDelta = (int)mouth.open - (int)drawnMouth.open;
+  int widthDelta = (int)mouth.width - (int)drawnMouth.width;
+  if (abs(openDelta) < LIPSYNC_REDRAW_STEP && abs(widthDelta) < LIPSYNC_REDRAW_STEP &&
+      !(mouth.open == 0 && drawnMouth.open != 0)) {
+    return false;
+  }
+
+  drawnMouth = mouth;
+  return true;
+}
+
+void BMOLipSync::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void BMOLipSync::printLipSyncInfo() {
+  Serial.println("=== BMO Lip-Sync Information ===");
+  Serial.printf("Status: %s\n", active ? "Active" : "Inactive");
+  Serial.printf("Source: %d\n", source);
+  Serial.printf("Frames: %u (late: %u)\n", (unsigned)stats.frames, (unsigned)stats.lateFrames);
+  Serial.printf("Max frame interval: %u ms (target %d ms)\n",
+                (unsigned)stats.maxIntervalMs, LIPSYNC_FRAME_INTERVAL);
+  Serial.printf("Max audio-to-mouth latency: %u ms\n", (unsigned)stats.maxLatencyMs);
+  Serial.printf("Samples analysed: %u\n", (unsigned)stats.samples);
+  Serial.println("================================");
+}
+
+void BMOLipSync::analyseBlock(const int16_t* samples, size_t count, size_t stride, unsigned long capturedAt) {
+  // Mean absolute amplitude - cheap and close enough to RMS for speech
+  uint32_t sum = 0;
+  size_t n = 0;
+  for (size_t i = 0; i < count; i += stride, n++) {
+    int32_t s = samples[i];
+    sum += (uint32_t)(s < 0 ? -s : s);
+  }
+  if (n == 0) return;
+
+  uint32_t level = sum / n;
+  if (level > 32767) level = 32767;
+  stats.samples += n;
+
+  // Asymmetric envelope follower: open quickly, close gently
+  if (level > envelope) {
+    envelope += (level - envelope) >> LIPSYNC_ATTACK_SHIFT;
+  } else {
+    envelope -= (envelope - level) >> LIPSYNC_RELEASE_SHIFT;
+  }
+
+  // Latency runs from when the audio was captured, not when it was analysed
+  if (!blockPending) {
+    blockPending = true;
+    blockTime = capturedAt;
+  }
+}
+
+void BMOLipSync::pollWav(unsigned long now) {
+  if (!isPlaying()) return;
+
+  // Consume the samples that "played" since the last poll in whole blocks,
+  // as I2S delivers them (the tail of the data as a short one)
+  uint32_t target = (uint32_t)((uint64_t)(now - wavStartTime) * wavSampleRate / 1000);
+  if (target > wavSampleCount) target = wavSampleCount;
+
+  while (wavPosition < target) {
+    size_t count = target - wavPosition;
+    if (count > LIPSYNC_BLOCK_SAMPLES) count = LIPSYNC_BLOCK_SAMPLES;
+    if (count < LIPSYNC_BLOCK_SAMPLES && target < wavSampleCount) break;
+
+    // Downmix to the first channel
+    const uint8_t* frame = wavSamples + (size_t)wavPosition * 2 * wavChannels;
+    for (size_t i = 0; i < count; i++) {
+      sampleBlock[i] = (int16_t)readLE16(frame);
+      frame += 2 * wavChannels;
+    }
+
+    // Captured when its last sample played
+    wavPosition += count;
+    unsigned long capturedAt = wavStartTime + (unsigned long)((uint64_t)wavPosition * 1000 / wavSampleRate);
+    analyseBlock(sampleBlock, count, 1, capturedAt);
+  }
+}
+
+#if defined(ESP32)
+
+bool BMOLipSync::beginI2S() {
+  i2s_config_t config = {};
+  config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX);
+  config.sample_rate = LIPSYNC_SAMPLE_RATE;
+  config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  config.intr_alloc_flags = 0;
+  config.dma_buf_count = 4;
+  config.dma_buf_len = LIPSYNC_BLOCK_SAMPLES;  // One block = 16ms, well under a frame
+
+  i2s_pin_config_t pins = {};
+  pins.mck_io_num = I2S_PIN_NO_CHANGE;
+  pins.bck_io_num = LIPSYNC_I2S_BCLK;
+  pins.ws_io_num = LIPSYNC_I2S_WS;
+  pins.data_out_num = I2S_PIN_NO_CHANGE;
+  pins.data_in_num = LIPSYNC_I2S_DIN;
+
+  if (i2s_driver_install(I2S_NUM_0, &config, 0, NULL) != ESP_OK) {
+    return false;
+  }
+  if (i2s_set_pin(I2S_NUM_0, &pins) != ESP_OK) {
+    i2s_driver_uninstall(I2S_NUM_0);
+    return false;
+  }
+
+  Serial.println("Lip-sync I2S capture configured");
+  return true;
+}
+
+void BMOLipSync::endI2S() {
+  i2s_driver_uninstall(I2S_NUM_0);
+}
+
+void BMOLipSync::pollI2S() {
+  // Drain whatever DMA blocks are ready without waiting. The last one read
+  // finished capturing about now and the ones before it a block apart, so
+  // the first is dated back by what followed it.
+  unsigned long now = millis();
+  bool wasPending = blockPending;
+  size_t firstSamples = 0, samples = 0;
+  size_t bytesRead = 0;
+  while (i2s_read(I2S_NUM_0, sampleBlock, LIPSYNC_BLOCK_SAMPLES * sizeof(int16_t), &bytesRead, 0) == ESP_OK &&
+         bytesRead > 0) {
+    size_t count = bytesRead / sizeof(int16_t);
+    analyseBlock(sampleBlock, count, 1, now);
+    if (samples == 0) firstSamples = count;
+    samples += count;
+  }
+  if (!wasPending && blockPending) {
+    blockTime = now - (unsigned long)((samples - firstSamples) * 1000 / LIPSYNC_SAMPLE_RATE);
+  }
+}
+
+#else
+
+// Host builds have no I2S peripheral - use PCM or WAV input instead
+bool BMOLipSync::beginI2S() { return false; }
+void BMOLipSync::endI2S() {}
+void BMOLipSync::pollI2S() {}
+
+#endif
+
+uint8_t BMOLipSync::levelToOpen(uint16_t level) const {
+  if (level <= LIPSYNC_NOISE_GATE) return 0;
+  uint32_t scaled = (uint32_t)(level - LIPSYNC_NOISE_GATE) * 255 /
+                    (LIPSYNC_FULL_SCALE - LIPSYNC_NOISE_GATE);
+  return (uint8_t)(scaled > 255 ? 255 : scaled);
+}
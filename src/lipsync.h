@@ -0,0 +1,144 @@
+/*
+ * BMO Lip-Sync Engine
+ *
+ * Drives BMO's mouth from speech audio so the face "talks"
+ *
+ * Features:
+ * - Amplitude envelope follower over 16-bit PCM (integer only)
+ * - Viseme input for pre-analysed speech streams
+ * - I2S microphone/line capture on the ESP32
+ * - WAV replay from memory (flash asset or host-side file image)
+ * - Fixed frame pacing (30 fps) with latency tracking
+ */
+
+#ifndef BMO_LIPSYNC_H
+#define BMO_LIPSYNC_H
+
+#include <Arduino.h>
+#include "memory.h"
+
+// Lip-sync is optional, enable with -DBMO_ENABLE_LIPSYNC=1
+#ifndef BMO_ENABLE_LIPSYNC
+#define BMO_ENABLE_LIPSYNC 0
+#endif
+
+// Frame pacing
+#define LIPSYNC_FPS              30
+#define LIPSYNC_FRAME_INTERVAL   (1000 / LIPSYNC_FPS)  // 33ms per frame
+
+// Audio input configuration
+#define LIPSYNC_SAMPLE_RATE      16000   // 16kHz is plenty for speech envelopes
+#define LIPSYNC_BLOCK_SAMPLES    256     // 16ms per I2S DMA block at 16kHz
+#define LIPSYNC_ARENA_BYTES      bmoArenaBytes(LIPSYNC_BLOCK_SAMPLES * sizeof(int16_t))  // The sample block
+#define LIPSYNC_I2S_BCLK         2       // GPIO2 - I2S bit clock
+#define LIPSYNC_I2S_WS           3       // GPIO3 - I2S word select (LRCLK)
+#define LIPSYNC_I2S_DIN          4       // GPIO4 - I2S data in
+
+// Envelope shaping (amplitudes are 0-32767)
+#define LIPSYNC_NOISE_GATE       600     // Ignore room noise below this level
+#define LIPSYNC_FULL_SCALE       12000   // Level that opens the mouth fully
+#define LIPSYNC_ATTACK_SHIFT     1       // Fast attack: move 1/2 of the way per block
+#define LIPSYNC_RELEASE_SHIFT    3       // Slow release: move 1/8 of the way per block
+#define LIPSYNC_REDRAW_STEP      8       // Minimum openness change worth a repaint
+
+// Input source types
+enum LipSyncSource {
+  LIPSYNC_SOURCE_NONE = 0,
+  LIPSYNC_SOURCE_PCM,      // Samples pushed with feedSamples()
+  LIPSYNC_SOURCE_I2S,      // Samples pulled from the I2S peripheral
+  LIPSYNC_SOURCE_WAV,      // Samples replayed from a WAV image
+  LIPSYNC_SOURCE_VISEME    // Mouth shapes pushed with setViseme()
+};
+
+// Viseme set (simplified Preston Blair mouth chart)
+enum BMOViseme {
+  VISEME_REST = 0,   // Closed, relaxed
+  VISEME_MBP,        // Lips pressed
+  VISEME_EE,         // Wide, slightly open
+  VISEME_AA,         // Wide open
+  VISEME_OH,         // Round, open
+  VISEME_OO,         // Small round
+  VISEME_FV,         // Nearly closed
+  VISEME_COUNT
+};
+
+// Mouth shape produced each frame
+struct LipSyncMouth {
+  uint8_t open;    // 0 = closed, 255 = fully open
+  uint8_t width;   // 0 = narrowest, 255 = widest
+};
+
+// Frame timing statistics
+struct LipSyncStats {
+  uint32_t frames;          // Frames produced
+  uint32_t lateFrames;      // Frames that missed their slot by more than half an interval
+  uint32_t maxIntervalMs;   // Longest gap between frames
+  uint32_t maxLatencyMs;    // Longest audio-to-mouth delay observed
+  uint32_t samples;         // Samples analysed
+};
+
+class BMOLipSync {
+public:
+  BMOLipSync();
+  ~BMOLipSync();
+
+  // Initialization
+  bool begin(LipSyncSource source = LIPSYNC_SOURCE_PCM);
+  void end();
+  bool isActive() const { return active; }
+  LipSyncSource getSource() const { return source; }
+
+  // Audio input
+  void feedSamples(const int16_t* samples, size_t count);
+  void setViseme(BMOViseme viseme);
+  bool playWav(const uint8_t* wav, size_t length);
+  bool isPlaying() const { return wavSamples != nullptr && wavPosition < wavSampleCount; }
+
+  // Frame production - returns true when the mouth should be repainted
+  bool update(unsigned long now);
+  LipSyncMouth getMouth() const { return mouth; }
+
+  // Statistics
+  const LipSyncStats& getStats() const { return stats; }
+  void resetStats();
+  void printLipSyncInfo();
+
+private:
+  bool active;
+  LipSyncSource source;
+
+  // Envelope state
+  uint16_t envelope;
+  bool blockPending;
+  unsigned long blockTime;  // When the oldest block not yet shown was captured
+
+  // Frame state
+  LipSyncMouth mouth;
+  LipSyncMouth drawnMouth;
+  unsigned long lastFrameTime;
+  unsigned long nextFrameTime;
+  LipSyncStats stats;
+
+  // WAV replay state
+  const uint8_t* wavSamples;
+  uint32_t wavSampleCount;
+  uint32_t wavPosition;
+  uint32_t wavSampleRate;
+  uint16_t wavChannels;
+  unsigned long wavStartTime;
+
+  // Input helpers
+  bool beginI2S();
+  void endI2S();
+  void pollI2S();
+  void pollWav(unsigned long now);
+  void analyseBlock(const int16_t* samples, size_t count, size_t stride, unsigned long capturedAt);
+
+  // Mapping helpers
+  uint8_t levelToOpen(uint16_t level) const;
+};
+
+// Global lip-sync instance
+extern BMOLipSync* g_bmoLipSync;
+
+#endif // BMO_LIPSYNC_H
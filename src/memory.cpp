@@ -0,0 +1,282 @@
+/*
+ * BMO Static Memory Arena Implementation
+ *
+ * Fixed arena, heap allocation tracking and memory reporting
+ */
+
+#include "memory.h"
+#include <new>
+#include "graphics.h"
+#include "lipsync.h"
+#include "mirror.h"
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_heap_caps.h>
+#endif
+
+// Global arena instance
+BMOArena bmoArena;
+
+// What the enabled features carve out, from their owners' budgets
+#ifdef BMO_ARENA_SIZE
+static constexpr size_t ARENA_CAPACITY = BMO_ARENA_SIZE;
+#else
+static constexpr size_t ARENA_CAPACITY =
+  BMOGraphics::ARENA_BYTES +
+  (BMO_ENABLE_STATUS_PANEL ? BMOGraphicsT<BMOStatusPanel>::ARENA_BYTES : 0) +
+  (BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS ? IMAGE_ARENA_BYTES : 0) +
+  (BMO_ENABLE_LIPSYNC ? LIPSYNC_ARENA_BYTES : 0) +
+  (BMO_ENABLE_MIRROR ? MIRROR_ARENA_BYTES : 0);
+#endif
+
+// Backing storage - internal DRAM, so buffers can also feed SPI DMA
+alignas(BMO_ARENA_ALIGN) static uint8_t arenaStorage[ARENA_CAPACITY];
+
+// Heap allocation counters
+static volatile uint32_t heapAllocations = 0;
+static uint32_t heapAllocationsAtSeal = 0;
+
+BMOArena::BMOArena()
+  : used(0)
+  , sealed(false)
+  , failedAllocations(0)
+{
+}
+
+void* BMOArena::allocate(size_t size, size_t align, const char* owner) {
+  if (sealed) {
+    failedAllocations++;
+    Serial.printf("Arena Error: %s allocated %u bytes after setup\n", owner, (unsigned)size);
+    return nullptr;
+  }
+
+  // Round the offset up to the requested alignment
+  size_t offset = (used + align - 1) & ~(align - 1);
+  if (offset + size > ARENA_CAPACITY) {
+    failedAllocations++;
+    Serial.printf("Arena Error: %s needs %u bytes, only %u left\n",
+                  owner, (unsigned)size, (unsigned)(ARENA_CAPACITY - used));
+    return nullptr;
+  }
+
+  used = offset + size;
+  return arenaStorage + offset;
+}
+
+size_t BMOArena::getCapacity() const {
+  return ARENA_CAPACITY;
+}
+
+void BMOArena::seal() {
+  sealed = true;
+  heapAllocationsAtSeal = heapAllocations;
+}
+
+uint32_t bmoHeapAllocationCount() {
+  return heapAllocations;
+}
+
+uint32_t bmoHeapAllocationsSinceSeal() {
+  return bmoArena.isSealed() ? heapAllocations - heapAllocationsAtSeal : 0;
+}
+
+void bmoGetMemoryReport(BMOMemoryReport* report) {
+  report->arenaUsed = bmoArena.getUsed();
+  report->arenaCapacity = bmoArena.getCapacity();
+#if defined(ESP32)
+  report->heapFree = ESP.getFreeHeap();
+  report->heapMinFree = ESP.getMinFreeHeap();
+  report->heapLargestBlock = ESP.getMaxAllocHeap();
+  report->stackMinFree = uxTaskGetStackHighWaterMark(NULL);
+#else
+  report->heapFree = 0;
+  report->heapMinFree = 0;
+  report->heapLargestBlock = 0;
+  report->stackMinFree = 0;
+#endif
+  report->heapAllocations = heapAllocations;
+  report->heapAllocationsSinceSeal = bmoHeapAllocationsSinceSeal();
+}
+
+void bmoPrintMemoryReport() {
+  BMOMemoryReport report;
+  bmoGetMemoryReport(&report);
+
+  Serial.println("=== BMO Memory Report ===");
+  Serial.printf("Arena: %u/%u bytes (%s)\n", (unsigned)report.arenaUsed,
+                (unsigned)report.arenaCapacity, bmoArena.isSealed() ? "sealed" : "open");
+  Serial.printf("Heap free: %u bytes (low-water %u, largest block %u)\n",
+                (unsigned)report.heapFree, (unsigned)report.heapMinFree,
+                (unsigned)report.heapLargestBlock);
+  Serial.printf("Stack high-water mark: %u bytes free\n", (unsigned)report.stackMinFree);
+#if BMO_TRACK_HEAP
+  Serial.printf("Heap allocations: %u total, %u since setup\n",
+                (unsigned)report.heapAllocations, (unsigned)report.heapAllocationsSinceSeal);
+#endif
+  Serial.println("=========================");
+}
+
+#if BMO_TRACK_MALLOC
+// The linker sends every malloc/calloc/realloc call here (--wrap); the
+// __real_ names are the allocator's own
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  heapAllocations++;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  heapAllocations++;
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  // Growing may move the block, so every resize counts
+  if (size) heapAllocations++;
+  return __real_realloc(ptr, size);
+}
+
+#if defined(ESP32)
+// newlib's reentrant entry points, used inside libc (printf, stdio buffers)
+void* __real__malloc_r(struct _reent* reent, size_t size);
+void* __real__calloc_r(struct _reent* reent, size_t count, size_t size);
+void* __real__realloc_r(struct _reent* reent, void* ptr, size_t size);
+
+void* __wrap__malloc_r(struct _reent* reent, size_t size) {
+  heapAllocations++;
+  return __real__malloc_r(reent, size);
+}
+
+void* __wrap__calloc_r(struct _reent* reent, size_t count, size_t size) {
+  heapAllocations++;
+  return __real__calloc_r(reent, count, size);
+}
+
+void* __wrap__realloc_r(struct _reent* reent, void* ptr, size_t size) {
+  if (size) heapAllocations++;
+  return __real__realloc_r(reent, ptr, size);
+}
+#endif
+}
+
+#define heapMalloc   __real_malloc
+#else
+#define heapMalloc   malloc
+#endif
+
+#if BMO_TRACK_HEAP
+
+// Replacement allocation functions - counting only, storage still comes
+// from the heap (uncounted underneath, so nothing is counted twice).
+// nullptr when the heap is exhausted.
+static void* countedAlloc(size_t size, size_t align) {
+  heapAllocations++;
+  if (size == 0) size = 1;
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return heapMalloc(size);
+#if defined(ESP32)
+  return heap_caps_aligned_alloc(align, size, MALLOC_CAP_8BIT);
+#else
+  return aligned_alloc(align, (size + align - 1) & ~(align - 1));
+#endif
+}
+
+static void* countedNew(size_t size, size_t align) {
+  void* ptr = countedAlloc(size, align);
+  if (!ptr) {
+#if defined(__cpp_exceptions)
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return ptr;
+}
+
+void* operator new(size_t size) {
+  return countedNew(size, 0);
+}
+
+void* operator new[](size_t size) {
+  return countedNew(size, 0);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+  return countedNew(size, (size_t)align);
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+  return countedNew(size, (size_t)align);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, (size_t)align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return countedAlloc(size, (size_t)align);
+}
+
+// Every form frees the same way (aligned blocks included)
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+#endif
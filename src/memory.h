@@ -0,0 +1,107 @@
+/*
+ * BMO Static Memory Arena
+ *
+ * The long-lived render and transfer buffers - eye rows, the dither line,
+ * the image decoder and band, the lip-sync sample block, the mirror's tiles
+ * and packet - are carved from one fixed block, sized at compile time to
+ * what the enabled features take, so memory use is known up front and
+ * nothing touches the heap once setup() has finished. Scratch that lives
+ * for one call (path edge tables) stays on the stack.
+ *
+ * Features:
+ * - Bump allocator over a static, DMA-capable block
+ * - Seal after setup() - later allocations are refused and reported
+ * - Heap allocation counter to prove zero-heap operation: every form of
+ *   operator new, and with BMO_TRACK_MALLOC the malloc family too
+ * - Heap, arena and stack high-water-mark report
+ *
+ * What the counter sees: operator new in all its forms (plain, array,
+ * nothrow, aligned) always. malloc/calloc/realloc only with
+ * BMO_TRACK_MALLOC=1 and the linker wraps that go with it (see
+ * config/platformio.ini); that covers Arduino String, the core's
+ * Print::printf() buffer for output over 64 bytes, and newlib's own
+ * buffers (_malloc_r). What it can't see: ROM code and IDF components
+ * that call heap_caps_malloc() directly (WiFi, FreeRTOS task creation).
+ * Those still show in the heap low-water mark of the report.
+ */
+
+#ifndef BMO_MEMORY_H
+#define BMO_MEMORY_H
+
+#include <Arduino.h>
+
+// Arena size: by default the sum of each enabled owner's budget (its
+// header's ARENA_BYTES, added up in memory.cpp). Define BMO_ARENA_SIZE to
+// set it outright.
+
+// Count heap allocations made through operator new (disable with -DBMO_TRACK_HEAP=0)
+#ifndef BMO_TRACK_HEAP
+#define BMO_TRACK_HEAP    1
+#endif
+
+// Count malloc/calloc/realloc as well; needs the link to wrap them
+// (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, plus _malloc_r,
+// _calloc_r and _realloc_r on the ESP32), or it won't link
+#ifndef BMO_TRACK_MALLOC
+#define BMO_TRACK_MALLOC  0
+#endif
+
+#define BMO_ARENA_ALIGN   4   // Word alignment keeps buffers DMA friendly
+
+// Most arena bytes one allocation can take, alignment padding included
+constexpr size_t bmoArenaBytes(size_t size, size_t align = BMO_ARENA_ALIGN) {
+  return ((size + BMO_ARENA_ALIGN - 1) & ~(size_t)(BMO_ARENA_ALIGN - 1)) +
+         (align > BMO_ARENA_ALIGN ? align - BMO_ARENA_ALIGN : 0);
+}
+
+class BMOArena {
+public:
+  BMOArena();
+
+  // Allocation - returns nullptr when exhausted or sealed
+  void* allocate(size_t size, size_t align = BMO_ARENA_ALIGN, const char* owner = "unknown");
+  template <typename T>
+  T* allocateArray(size_t count, const char* owner) {
+    return static_cast<T*>(allocate(sizeof(T) * count, alignof(T) < BMO_ARENA_ALIGN ? BMO_ARENA_ALIGN : alignof(T), owner));
+  }
+
+  // Lock the arena once setup() is done
+  void seal();
+  bool isSealed() const { return sealed; }
+
+  // Usage
+  size_t getUsed() const { return used; }
+  size_t getCapacity() const;
+  size_t getFree() const { return getCapacity() - used; }
+  uint32_t getFailedAllocations() const { return failedAllocations; }
+
+private:
+  size_t used;
+  bool sealed;
+  uint32_t failedAllocations;
+};
+
+// Memory report snapshot
+struct BMOMemoryReport {
+  size_t arenaUsed;
+  size_t arenaCapacity;
+  uint32_t heapFree;
+  uint32_t heapMinFree;          // Heap low-water mark since boot
+  uint32_t heapLargestBlock;
+  uint32_t stackMinFree;         // Stack high-water mark of the calling task (bytes)
+  uint32_t heapAllocations;      // Counted allocations since boot (see above)
+  uint32_t heapAllocationsSinceSeal;
+};
+
+// Global arena instance
+extern BMOArena bmoArena;
+
+// Heap accounting
+uint32_t bmoHeapAllocationCount();
+uint32_t bmoHeapAllocationsSinceSeal();
+
+// Reporting
+void bmoGetMemoryReport(BMOMemoryReport* report);
+void bmoPrintMemoryReport();
+
+#endif // BMO_MEMORY_H
@@ -0,0 +1,278 @@
+/*
+ * BMO Display Mirror Implementation
+ *
+ * Reads the panel back one tile at a time, detects changes by hash and
+ * sends RLE-compressed tiles whenever the serial buffer has room for a
+ * whole packet. Nothing here ever waits on the serial port.
+ */
+
+#include "mirror.h"
+#include "display.h"
+
+// Packets are only written whole, so the largest must fit the TX buffer
+static_assert(MIRROR_PACKET_SIZE <= MIRROR_TX_BUFFER, "MIRROR_TX_BUFFER can't hold a raw tile packet");
+
+// Global mirror instance
+BMOMirror* g_bmoMirror = nullptr;
+
+BMOMirror::BMOMirror()
+  : tft(nullptr)
+  , port(nullptr)
+  , active(false)
+  , tileCursor(0)
+  , scanDirty(false)
+  , helloPending(false)
+  , frameEndPending(false)
+  , lastKeyframe(0)
+  , tileHash(nullptr)
+  , tileValid(nullptr)
+  , pendingTile(-1)
+  , pendingHash(0)
+  , packet(nullptr)
+  , packetLength(0)
+  , packetOffset(0)
+  , sequence(0)
+  , tilePixels(nullptr)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+BMOMirror::~BMOMirror() {
+  end();
+}
+
+bool BMOMirror::begin(TFT_eSPI* display, Stream* serialPort) {
+  tft = display;
+  port = serialPort;
+
+  if (!tft || !port) {
+    Serial.println("ERROR: Display mirror needs a display and a serial port");
+    return false;
+  }
+
+  // Buffers come from the static arena (once - they survive end()/begin())
+  if (!packet) {
+    tileHash = bmoArena.allocateArray<uint32_t>(MIRROR_TILE_COUNT, "mirror");
+    tileValid = bmoArena.allocateArray<uint8_t>(MIRROR_VALID_BYTES, "mirror");
+    packet = bmoArena.allocateArray<uint8_t>(MIRROR_PACKET_SIZE, "mirror");
+    tilePixels = bmoArena.allocateArray<uint16_t>(MIRROR_TILE_PIXELS, "mirror");
+  }
+  if (!tileHash || !tileValid || !packet || !tilePixels) {
+    Serial.println("ERROR: Display mirror buffers unavailable");
+    return false;
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  packetLength = 0;
+  packetOffset = 0;
+  pendingTile = -1;
+  tileCursor = 0;
+  frameEndPending = false;
+  requestKeyframe();
+
+  active = true;
+  g_bmoMirror = this;
+
+  Serial.printf("Display mirror started (%dx%d tiles of %dpx)\n",
+                MIRROR_TILES_X, MIRROR_TILES_Y, MIRROR_TILE_SIZE);
+  return true;
+}
+
+void BMOMirror::end() {
+  if (active) {
+    active = false;
+    tft = nullptr;
+    port = nullptr;
+    g_bmoMirror = nullptr;
+    Serial.println("Display mirror stopped");
+  }
+}
+
+void BMOMirror::requestKeyframe() {
+  // Forget every tile hash so the next scan resends the whole screen
+  memset(tileValid, 0, MIRROR_VALID_BYTES);
+  pendingTile = -1;
+  helloPending = true;
+  lastKeyframe = millis();
+}
+
+void BMOMirror::service() {
+  if (!active) return;
+
+  // Finish the packet in flight before producing another one
+  if (!drainPacket()) {
+    stats.stalls++;
+    return;
+  }
+
+  if (millis() - lastKeyframe >= MIRROR_KEYFRAME_INTERVAL) {
+    requestKeyframe();
+  }
+
+  if (helloPending) {
+    queueHello();
+    helloPending = false;
+    drainPacket();
+    return;
+  }
+
+  if (frameEndPending) {
+    queueFrameEnd();
+    frameEndPending = false;
+    drainPacket();
+    return;
+  }
+
+  // Hash a few tiles; stop as soon as one needs sending
+  for (int checked = 0; checked < MIRROR_TILES_PER_SERVICE && packetLength == 0; checked++) {
+    uint8_t tileX = tileCursor % MIRROR_TILES_X;
+    uint8_t tileY = tileCursor / MIRROR_TILES_X;
+    int x = tileX * MIRROR_TILE_SIZE;
+    int y = tileY * MIRROR_TILE_SIZE;
+    int width = (MIRROR_WIDTH - x < MIRROR_TILE_SIZE) ? MIRROR_WIDTH - x : MIRROR_TILE_SIZE;
+    int height = (MIRROR_HEIGHT - y < MIRROR_TILE_SIZE) ? MIRROR_HEIGHT - y : MIRROR_TILE_SIZE;
+
+    tft->readRect(x, y, width, height, tilePixels);
+    if (g_bmoDisplay) g_bmoDisplay->noteReadback(width * height);
+    stats.tilesChecked++;
+
+    uint32_t hash = hashPixels(tilePixels, width * height);
+    uint8_t mask = 1 << (tileCursor & 7);
+    bool valid = (tileValid[tileCursor >> 3] & mask) != 0;
+
+    if (!valid || tileHash[tileCursor] != hash) {
+      queueTile(tileX, tileY, width, height);
+      pendingTile = tileCursor;
+      pendingHash = hash;
+      scanDirty = true;
+    }
+
+    if (++tileCursor >= MIRROR_TILE_COUNT) {
+      tileCursor = 0;
+      stats.scans++;
+      // Tell the viewer a consistent picture is complete
+      if (scanDirty) {
+        frameEndPending = true;
+        scanDirty = false;
+      }
+    }
+  }
+
+  drainPacket();
+}
+
+bool BMOMirror::drainPacket() {
+  // The rest of the packet in one write, once the TX buffer has room for
+  // it: anything else on the port (logs, protocol replies) then falls
+  // between packets, never inside one
+  while (packetOffset < packetLength) {
+    size_t remaining = packetLength - packetOffset;
+    if (port->availableForWrite() < (int)remaining) return false;
+
+    size_t written = port->write(packet + packetOffset, remaining);
+    if (written == 0) return false;
+
+    packetOffset += written;
+    stats.bytesSent += written;
+  }
+
+  // The viewer has the tile now; until here a dropped packet means resending
+  if (pendingTile >= 0) {
+    tileHash[pendingTile] = pendingHash;
+    tileValid[pendingTile >> 3] |= 1 << (pendingTile & 7);
+    pendingTile = -1;
+  }
+  packetLength = 0;
+  packetOffset = 0;
+  return true;
+}
+
+void BMOMirror::queueHello() {
+  uint8_t* payload = packet + BMO_FRAME_HEADER_SIZE;
+  payload[0] = MIRROR_WIDTH & 0xFF;
+  payload[1] = MIRROR_WIDTH >> 8;
+  payload[2] = MIRROR_HEIGHT & 0xFF;
+  payload[3] = MIRROR_HEIGHT >> 8;
+  payload[4] = MIRROR_TILE_SIZE;
+
+  packetLength = bmoFrameSeal(packet, FRAME_MIRROR_HELLO, sequence++, 5);
+  packetOffset = 0;
+}
+
+void BMOMirror::queueFrameEnd() {
+  uint8_t* payload = packet + BMO_FRAME_HEADER_SIZE;
+  payload[0] = (uint8_t)(stats.scans);
+  payload[1] = (uint8_t)(stats.scans >> 8);
+  payload[2] = (uint8_t)(stats.scans >> 16);
+  payload[3] = (uint8_t)(stats.scans >> 24);
+
+  packetLength = bmoFrameSeal(packet, FRAME_MIRROR_FRAME_END, sequence++, 4);
+  packetOffset = 0;
+}
+
+void BMOMirror::queueTile(uint8_t tileX, uint8_t tileY, int width, int height) {
+  uint8_t* payload = packet + BMO_FRAME_HEADER_SIZE;
+  int count = width * height;
+  size_t rawSize = count * 2;
+
+  payload[0] = tileX;
+  payload[1] = tileY;
+
+  // Try RLE first - BMO's flat colors usually collapse to a handful of runs
+  size_t dataSize = encodeRLE(payload + 3, rawSize, count);
+  if (dataSize > 0) {
+    payload[2] = MIRROR_ENCODING_RLE;
+  } else {
+    payload[2] = MIRROR_ENCODING_RAW;
+    for (int i = 0; i < count; i++) {
+      payload[3 + i * 2] = (uint8_t)(tilePixels[i] & 0xFF);
+      payload[4 + i * 2] = (uint8_t)(tilePixels[i] >> 8);
+    }
+    dataSize = rawSize;
+  }
+
+  packetLength = bmoFrameSeal(packet, FRAME_MIRROR_TILE, sequence++, 3 + dataSize);
+  packetOffset = 0;
+  stats.tilesSent++;
+}
+
+size_t BMOMirror::encodeRLE(uint8_t* out, size_t capacity, int count) {
+  // Returns 0 when RLE would not beat the raw encoding
+  size_t length = 0;
+  int i = 0;
+
+  while (i < count) {
+    uint16_t color = tilePixels[i];
+    int run = 1;
+    while (i + run < count && run < 256 && tilePixels[i + run] == color) {
+      run++;
+    }
+
+    if (length + 3 > capacity) return 0;
+    out[length++] = (uint8_t)(run - 1);
+    out[length++] = (uint8_t)(color & 0xFF);
+    out[length++] = (uint8_t)(color >> 8);
+    i += run;
+  }
+
+  return length;
+}
+
+uint32_t BMOMirror::hashPixels(const uint16_t* pixels, int count) {
+  // FNV-1a over the 16-bit pixels
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < count; i++) {
+    hash = (hash ^ pixels[i]) * 16777619u;
+  }
+  return hash;
+}
+
+void BMOMirror::printMirrorInfo() {
+  Serial.println("=== BMO Mirror Information ===");
+  Serial.printf("Status: %s\n", active ? "Active" : "Inactive");
+  Serial.printf("Scans: %u\n", (unsigned)stats.scans);
+  Serial.printf("Tiles checked/sent: %u/%u\n", (unsigned)stats.tilesChecked, (unsigned)stats.tilesSent);
+  Serial.printf("Bytes sent: %u\n", (unsigned)stats.bytesSent);
+  Serial.printf("Serial stalls: %u\n", (unsigned)stats.stalls);
+  Serial.println("==============================");
+}
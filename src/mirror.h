@@ -0,0 +1,132 @@
+/*
+ * BMO Display Mirror
+ *
+ * Streams what the panel is showing over the debug serial link so fielded
+ * units can be inspected without a camera
+ *
+ * Features:
+ * - Tile hashing against the previous scan (only changed tiles are sent)
+ * - Run-length encoded tiles with raw fallback
+ * - Framed, checksummed packets (see serial_frame.h)
+ * - Non-blocking background drain that never stalls rendering; packets go
+ *   to the port whole, so log lines written between them never split one
+ * - A tile's hash is kept only once its packet is out, so a tile whose
+ *   packet was dropped is sent again
+ *
+ * The port's transmit buffer must hold MIRROR_PACKET_SIZE bytes (setup()
+ * asks for MIRROR_TX_BUFFER), or the larger tiles never go out
+ *
+ * Use tools/mirror_viewer.py on the host to reconstruct the display
+ */
+
+#ifndef BMO_MIRROR_H
+#define BMO_MIRROR_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "serial_frame.h"
+#include "memory.h"
+#include "panel.h"
+
+// Mirroring is a debug feature, enable with -DBMO_ENABLE_MIRROR=1
+#ifndef BMO_ENABLE_MIRROR
+#define BMO_ENABLE_MIRROR 0
+#endif
+
+// Tile configuration (240x320 -> 15x20 tiles)
+#define MIRROR_WIDTH              (BMOActivePanel::WIDTH)
+#define MIRROR_HEIGHT             (BMOActivePanel::HEIGHT)
+#define MIRROR_TILE_SIZE          16
+#define MIRROR_TILE_PIXELS        (MIRROR_TILE_SIZE * MIRROR_TILE_SIZE)
+#define MIRROR_TILES_X            ((MIRROR_WIDTH + MIRROR_TILE_SIZE - 1) / MIRROR_TILE_SIZE)
+#define MIRROR_TILES_Y            ((MIRROR_HEIGHT + MIRROR_TILE_SIZE - 1) / MIRROR_TILE_SIZE)
+#define MIRROR_TILE_COUNT         (MIRROR_TILES_X * MIRROR_TILES_Y)
+
+// Scheduling
+#define MIRROR_TILES_PER_SERVICE  4       // Tiles hashed per service() call
+#define MIRROR_SERVICE_INTERVAL   20      // ms between service() calls from the event loop
+#define MIRROR_KEYFRAME_INTERVAL  10000   // Resend everything every 10s (late viewers, lost frames)
+
+// Tile encodings
+#define MIRROR_ENCODING_RAW       0       // RGB565 little-endian pixels
+#define MIRROR_ENCODING_RLE       1       // (count-1, color lo, color hi) triples
+
+// Largest packet: 3-byte tile header plus a raw tile
+#define MIRROR_MAX_PAYLOAD        (3 + MIRROR_TILE_PIXELS * 2)
+#define MIRROR_PACKET_SIZE        (MIRROR_MAX_PAYLOAD + BMO_FRAME_OVERHEAD)
+#define MIRROR_VALID_BYTES        ((MIRROR_TILE_COUNT + 7) / 8)
+#define MIRROR_ARENA_BYTES        (bmoArenaBytes(MIRROR_TILE_COUNT * sizeof(uint32_t)) + \
+                                   bmoArenaBytes(MIRROR_VALID_BYTES) + bmoArenaBytes(MIRROR_PACKET_SIZE) + \
+                                   bmoArenaBytes(MIRROR_TILE_PIXELS * sizeof(uint16_t)))
+#define MIRROR_TX_BUFFER          1024    // Serial TX buffer requested at startup
+
+// Mirror statistics
+struct MirrorStats {
+  uint32_t scans;          // Complete passes over the screen
+  uint32_t tilesChecked;   // Tiles read back and hashed
+  uint32_t tilesSent;      // Tiles that changed and were transmitted
+  uint32_t bytesSent;      // Bytes written to the serial port
+  uint32_t stalls;         // service() calls that found no room for the packet
+};
+
+class BMOMirror {
+public:
+  BMOMirror();
+  ~BMOMirror();
+
+  // Initialization
+  bool begin(TFT_eSPI* display, Stream* port = &Serial);
+  void end();
+  bool isActive() const { return active; }
+  bool isSending() const { return packetOffset < packetLength; }  // Mid-packet on the port
+
+  // Background drain - call whenever the render loop is idle
+  void service();
+
+  // Force every tile to be resent on the next scan
+  void requestKeyframe();
+
+  // Statistics
+  const MirrorStats& getStats() const { return stats; }
+  void printMirrorInfo();
+
+private:
+  TFT_eSPI* tft;
+  Stream* port;
+  bool active;
+
+  // Scan state
+  uint16_t tileCursor;
+  bool scanDirty;
+  bool helloPending;       // Control packets waiting to go ahead of the next tile
+  bool frameEndPending;
+  unsigned long lastKeyframe;
+  uint32_t* tileHash;       // MIRROR_TILE_COUNT entries (arena)
+  uint8_t* tileValid;       // One bit per tile (arena)
+  int16_t pendingTile;      // Tile in the outgoing packet, -1 for none
+  uint32_t pendingHash;     // Its hash, kept once the packet is out
+
+  // Outgoing packet (drained a little at a time)
+  uint8_t* packet;          // MIRROR_PACKET_SIZE bytes (arena)
+  size_t packetLength;
+  size_t packetOffset;
+  uint8_t sequence;
+
+  // Tile readback buffer
+  uint16_t* tilePixels;     // MIRROR_TILE_PIXELS entries (arena)
+
+  MirrorStats stats;
+
+  // Helpers
+  bool drainPacket();
+  void queueHello();
+  void queueFrameEnd();
+  void queueTile(uint8_t tileX, uint8_t tileY, int width, int height);
+  size_t encodeRLE(uint8_t* out, size_t capacity, int count);
+  static uint32_t hashPixels(const uint16_t* pixels, int count);
+};
+
+// Global mirror instance
+extern BMOMirror* g_bmoMirror;
+
+#endif // BMO_MIRROR_H
@@ -0,0 +1,131 @@
+/*
+ * BMO Panel Profiles
+ *
+ * Compile-time description of each supported LCD panel. BMOGraphics is
+ * templated on one of these, so every face coordinate is a constant and
+ * there is no runtime scaling math.
+ *
+ * Select a panel with a build flag (default is the Waveshare 2.4" 240x320):
+ *   -DBMO_PANEL_240X240   1.3"/1.54" ST7789 square panels
+ *   -DBMO_PANEL_320X480   3.5" ILI9488/ST7796 panels
+ * and set TFT_eSPI's TFT_WIDTH/TFT_HEIGHT to match.
+ *
+ * Color order isn't part of a profile: it belongs to the controller and the
+ * glass it drives, so it is picked once the controller is detected.
+ */
+
+#ifndef BMO_PANEL_H
+#define BMO_PANEL_H
+
+#include <Arduino.h>
+
+// Panel color order (MADCTL BGR bit)
+enum BMOColorOrder {
+  COLOR_ORDER_RGB = 0,
+  COLOR_ORDER_BGR
+};
+
+// Color order per controller, as the modules are wired: ILI9341 modules
+// behind BGR glass, ST7789 modules behind RGB glass. Override for other
+// glass, e.g. -DBMO_ST7789_COLOR_ORDER=COLOR_ORDER_BGR.
+#ifndef BMO_ILI9341_COLOR_ORDER
+#define BMO_ILI9341_COLOR_ORDER  COLOR_ORDER_BGR
+#endif
+#ifndef BMO_ST7789_COLOR_ORDER
+#define BMO_ST7789_COLOR_ORDER   COLOR_ORDER_RGB
+#endif
+
+// Waveshare 2.4" ILI9341/ST7789 (the reference BMO build)
+struct BMOPanel240x320 {
+  static constexpr int16_t WIDTH = 240;
+  static constexpr int16_t HEIGHT = 320;
+  static constexpr uint8_t ROTATION = 0;       // Portrait
+};
+
+// Square 240x240 ST7789 panels
+struct BMOPanel240x240 {
+  static constexpr int16_t WIDTH = 240;
+  static constexpr int16_t HEIGHT = 240;
+  static constexpr uint8_t ROTATION = 0;
+};
+
+// 3.5" 320x480 panels
+struct BMOPanel320x480 {
+  static constexpr int16_t WIDTH = 320;
+  static constexpr int16_t HEIGHT = 480;
+  static constexpr uint8_t ROTATION = 0;
+};
+
+// Panel selected for this build
+#if defined(BMO_PANEL_240X240)
+typedef BMOPanel240x240 BMOActivePanel;
+#elif defined(BMO_PANEL_320X480)
+typedef BMOPanel320x480 BMOActivePanel;
+#else
+typedef BMOPanel240x320 BMOActivePanel;
+#endif
+
+// Status panel of multi-panel builds (BMO_ENABLE_STATUS_PANEL in display.h).
+// Its own type, so its renderer is instantiated separately from the face's.
+#if defined(BMO_STATUS_PANEL_240X320)
+struct BMOStatusPanel : BMOPanel240x320 {};
+#else
+struct BMOStatusPanel : BMOPanel240x240 {};
+#endif
+
+// MADCTL value for a panel on a given controller.
+// Rotation bits follow each controller's scan direction (MY=0x80, MX=0x40, MV=0x20).
+constexpr uint8_t bmoMadctlILI9341(uint8_t rotation, BMOColorOrder order) {
+  return (rotation == 1 ? 0x20 : rotation == 2 ? 0x80 : rotation == 3 ? 0xE0 : 0x40) |
+         (order == COLOR_ORDER_BGR ? 0x08 : 0x00);
+}
+
+constexpr uint8_t bmoMadctlST7789(uint8_t rotation, BMOColorOrder order) {
+  return (rotation == 1 ? 0x60 : rotation == 2 ? 0xC0 : rotation == 3 ? 0xA0 : 0x00) |
+         (order == COLOR_ORDER_BGR ? 0x08 : 0x00);
+}
+
+/*
+ * Face geometry derived from a panel profile
+ *
+ * The face was designed for 240x320; other panels scale it uniformly by the
+ * tighter of the two axes (Q8 fixed point) and keep it centered.
+ */
+template <class Panel>
+struct BMOFaceGeometry {
+  // Uniform scale in 1/256 units
+  static constexpr int32_t SCALE_Q8 =
+    (Panel::WIDTH * 256 / 240 < Panel::HEIGHT * 256 / 320) ? Panel::WIDTH * 256 / 240
+                                                           : Panel::HEIGHT * 256 / 320;
+
+  // Scale a 240x320 design dimension for this panel
+  static constexpr int scale(int value) { return (int)(value * SCALE_Q8 / 256); }
+
+  // Face element dimensions
+  static constexpr int CENTER_X = Panel::WIDTH / 2;
+  static constexpr int CENTER_Y = Panel::HEIGHT / 2;
+  static constexpr int EYE_RADIUS = scale(25);
+  static constexpr int EYE_SEPARATION = scale(100);
+  static constexpr int EYE_Y_OFFSET = scale(-40);
+  static constexpr int MOUTH_Y_OFFSET = scale(30);
+  static constexpr int MOUTH_WIDTH = scale(60);
+  static constexpr int MOUTH_HEIGHT = scale(20);
+
+  // Mouth bounding box (covers every mouth variation, relative to mouth center)
+  static constexpr int MOUTH_BOX_LEFT = scale(-42);
+  static constexpr int MOUTH_BOX_TOP = scale(-22);
+  static constexpr int MOUTH_BOX_WIDTH = scale(85);
+  static constexpr int MOUTH_BOX_HEIGHT = scale(57);
+
+  // Frame
+  static constexpr int FRAME_THICKNESS = scale(6);
+  static constexpr int FRAME_CORNER_RADIUS = scale(12);
+  
+  // How far the eyes travel from center when BMO looks around
+  static constexpr int GAZE_RANGE = scale(8);
+};
+
+// Geometry of the panel selected for this build
+typedef BMOFaceGeometry<BMOActivePanel> BMOFace;
+
+#endif // BMO_PANEL_H
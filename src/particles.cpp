@@ -0,0 +1,336 @@
+/*
+ * BMO Particle Effects Implementation
+ *
+ * Integer-only simulation over a packed struct-of-arrays pool
+ * Drawing lives in BMOGraphicsT::drawParticles()
+ */
+
+#include "particles.h"
+
+// Global particle instance
+BMOParticles* g_bmoParticles = nullptr;
+
+// Sprite masks (MSB = left) and colors
+const BMOParticleSpriteDef PARTICLE_SPRITES[PARTICLE_SPRITE_COUNT] = {
+  { { 0x10, 0x10, 0x38, 0xFE, 0x38, 0x10, 0x10, 0x00 }, 0xFFFF },  // PARTICLE_SPRITE_SPARKLE
+  { { 0x00, 0x00, 0x10, 0x38, 0x10, 0x00, 0x00, 0x00 }, 0xFFFF },  // PARTICLE_SPRITE_TWINKLE
+  { { 0x6C, 0xFE, 0xFE, 0xFE, 0x7C, 0x38, 0x10, 0x00 }, 0xFB56 },  // PARTICLE_SPRITE_HEART (pink)
+  { { 0xFE, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFE, 0x00 }, 0x2945 }   // PARTICLE_SPRITE_Z (dark teal)
+};
+
+// Where particles may be: inside the frame and clear of the eyes and mouth
+// (boxes cover every eye state and mouth shape, so no expression is touched)
+static constexpr int FIELD_INSET = BMOFace::FRAME_THICKNESS + BMOFace::FRAME_CORNER_RADIUS + 1;
+static constexpr int FIELD_LEFT = FIELD_INSET;
+static constexpr int FIELD_TOP = FIELD_INSET;
+static constexpr int FIELD_RIGHT = BMOActivePanel::WIDTH - FIELD_INSET;
+static constexpr int FIELD_BOTTOM = BMOActivePanel::HEIGHT - FIELD_INSET;
+
+static constexpr int EYE_Y = BMOFace::CENTER_Y + BMOFace::EYE_Y_OFFSET;
+static constexpr int LEFT_EYE_X = BMOFace::CENTER_X - BMOFace::EYE_SEPARATION / 2;
+static constexpr int RIGHT_EYE_X = BMOFace::CENTER_X + BMOFace::EYE_SEPARATION / 2;
+static constexpr int EYE_KEEP_OUT =
+  BMOFace::EYE_RADIUS + BMOFace::scale(5) + BMOFace::GAZE_RANGE + 2;  // Wide eyes anywhere they look, plus a margin
+
+static constexpr int MOUTH_Y = BMOFace::CENTER_Y + BMOFace::MOUTH_Y_OFFSET;
+static constexpr int MOUTH_LEFT = BMOFace::CENTER_X + BMOFace::MOUTH_BOX_LEFT;
+static constexpr int MOUTH_TOP = MOUTH_Y + BMOFace::MOUTH_BOX_TOP;
+
+// Emitter tuning per effect: frames between spawns, lifetime range
+struct EmitterDef {
+  uint8_t interval;
+  uint8_t minLife;
+  uint8_t maxLife;
+};
+
+static const EmitterDef EMITTERS[PARTICLE_EFFECT_COUNT] = {
+  {  0,  0,  0 },  // PARTICLE_EFFECT_NONE
+  {  0, 16, 32 },  // PARTICLE_EFFECT_SPARKLES
+  {  8, 40, 60 },  // PARTICLE_EFFECT_HEARTS
+  { 20, 50, 70 }   // PARTICLE_EFFECT_SLEEP
+};
+
+static bool rectsOverlap(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+  return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+BMOParticles::BMOParticles()
+  : active(false)
+  , effect(PARTICLE_EFFECT_NONE)
+  , spawnTimer(0)
+  , density(256)
+  , liveLimit(PARTICLE_CAPACITY)
+  , redrawAll(false)
+  , rng(0x9E3779B9)
+  , liveCount(0)
+  , dirtyCount(0)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void BMOParticles::begin() {
+  liveCount = 0;
+  dirtyCount = 0;
+  effect = PARTICLE_EFFECT_NONE;
+  rng ^= micros();
+  if (rng == 0) rng = 0x9E3779B9;
+  memset(&stats, 0, sizeof(stats));
+
+  active = true;
+  g_bmoParticles = this;
+  Serial.printf("Particles ready (%d slots, %d fps)\n", PARTICLE_CAPACITY, PARTICLE_FPS);
+}
+
+void BMOParticles::end() {
+  if (active) {
+    clear();
+    effect = PARTICLE_EFFECT_NONE;
+    active = false;
+    g_bmoParticles = nullptr;
+    Serial.println("Particles stopped");
+  }
+}
+
+void BMOParticles::setEffect(BMOParticleEffect newEffect) {
+  if (newEffect >= PARTICLE_EFFECT_COUNT) newEffect = PARTICLE_EFFECT_NONE;
+  if (newEffect == effect) return;
+
+  // Particles already in flight finish their lives
+  effect = newEffect;
+  spawnTimer = 0;
+}
+
+void BMOParticles::burst(BMOParticleEffect kind, uint8_t count) {
+  if (!active || kind == PARTICLE_EFFECT_NONE || kind >= PARTICLE_EFFECT_COUNT) return;
+  if (count > 0) count = (uint8_t)((count * density + 255) >> 8);  // Rounded up
+  while (count-- > 0 && liveCount < liveLimit) {
+    spawn(kind);
+  }
+}
+
+void BMOParticles::setDensity(uint16_t newDensity) {
+  // Particles over the new limit finish their lives; only spawning stops
+  density = newDensity > 256 ? 256 : newDensity;
+  uint32_t limit = (PARTICLE_CAPACITY * density + 255) >> 8;
+  liveLimit = limit > 0 ? (uint8_t)limit : 1;
+}
+
+void BMOParticles::clear() {
+  liveCount = 0;
+  dirtyCount = 0;
+}
+
+void BMOParticles::invalidate() {
+  redrawAll = true;
+}
+
+bool BMOParticles::update() {
+  if (!active) return false;
+
+  dirtyCount = 0;
+  bool changed = false;
+  stats.frames++;
+
+  // Move everything; dead and culled particles leave their old box dirty
+  uint8_t i = 0;
+  while (i < liveCount) {
+    if (--life[i] == 0) {
+      kill(i);
+      changed = true;
+      continue;
+    }
+
+    int16_t vy = velY[i] + gravity[i];
+    velY[i] = (int8_t)(vy > 127 ? 127 : vy < -128 ? -128 : vy);
+    posX[i] += velX[i];
+    posY[i] += velY[i];
+
+    int16_t x = posX[i] >> PARTICLE_FRACTION_BITS;
+    int16_t y = posY[i] >> PARTICLE_FRACTION_BITS;
+    if (!isClear(x, y)) {
+      stats.culled++;
+      kill(i);
+      changed = true;
+      continue;
+    }
+
+    // Sparkles twinkle every four frames (same box, so the old one is restored)
+    bool twinkled = false;
+    if (sprite[i] <= PARTICLE_SPRITE_TWINKLE && (life[i] & 3) == 0) {
+      sprite[i] = (sprite[i] == PARTICLE_SPRITE_SPARKLE) ? PARTICLE_SPRITE_TWINKLE : PARTICLE_SPRITE_SPARKLE;
+      twinkled = true;
+    }
+
+    redraw[i] = false;
+    if (x != drawnX[i] || y != drawnY[i] || twinkled) {
+      addDirty(drawnX[i], drawnY[i], x, y);
+      drawnX[i] = x;
+      drawnY[i] = y;
+      redraw[i] = true;
+      changed = true;
+    }
+    i++;
+  }
+
+  // Still particles under someone else's dirty rect need drawing again too
+  for (uint8_t p = 0; p < liveCount; p++) {
+    if (redrawAll) {
+      redraw[p] = true;
+      changed = true;
+    }
+    if (redraw[p]) continue;
+    for (uint8_t d = 0; d < dirtyCount; d++) {
+      if (rectsOverlap(drawnX[p], drawnY[p], PARTICLE_SPRITE_SIZE, PARTICLE_SPRITE_SIZE,
+                       dirty[d].x, dirty[d].y, dirty[d].w, dirty[d].h)) {
+        redraw[p] = true;
+        break;
+      }
+    }
+  }
+
+  redrawAll = false;
+
+  // Emit
+  if (effect != PARTICLE_EFFECT_NONE) {
+    if (spawnTimer == 0) {
+      if (liveCount < liveLimit) {
+        spawn(effect);
+        changed = true;
+      }
+      spawnTimer = EMITTERS[effect].interval;
+    } else {
+      spawnTimer--;
+    }
+  }
+
+  if (liveCount > stats.peakLive) stats.peakLive = liveCount;
+  return changed;
+}
+
+void BMOParticles::spawn(BMOParticleEffect kind) {
+  int16_t x = 0, y = 0;
+  int8_t vx = 0, vy = 0, g = 0;
+  uint8_t shape = PARTICLE_SPRITE_SPARKLE;
+
+  // A few tries at a clear spot; give up rather than draw over the face
+  bool placed = false;
+  for (int attempt = 0; attempt < 4 && !placed; attempt++) {
+    switch (kind) {
+      case PARTICLE_EFFECT_SPARKLES:
+        // Anywhere around the eyes, drifting and falling gently
+        x = randomRange(FIELD_LEFT, FIELD_RIGHT - PARTICLE_SPRITE_SIZE);
+        y = randomRange(FIELD_TOP, MOUTH_TOP - PARTICLE_SPRITE_SIZE);
+        vx = (int8_t)randomRange(-8, 9);
+        vy = (int8_t)randomRange(-12, 1);
+        g = 1;
+        shape = PARTICLE_SPRITE_SPARKLE;
+        break;
+
+      case PARTICLE_EFFECT_HEARTS:
+        // From either cheek, floating up
+        x = (rng & 1) ? MOUTH_LEFT - PARTICLE_SPRITE_SIZE - randomRange(2, 16)
+                      : MOUTH_LEFT + BMOFace::MOUTH_BOX_WIDTH + randomRange(2, 16);
+        y = MOUTH_Y + randomRange(-8, 8);
+        vx = (int8_t)randomRange(-4, 5);
+        vy = (int8_t)randomRange(-14, -6);
+        g = 0;
+        shape = PARTICLE_SPRITE_HEART;
+        break;
+
+      case PARTICLE_EFFECT_SLEEP:
+        // Above and right of the right eye, rising and drifting right
+        x = RIGHT_EYE_X + EYE_KEEP_OUT / 2 + randomRange(0, 6);
+        y = EYE_Y - EYE_KEEP_OUT - PARTICLE_SPRITE_SIZE + randomRange(-4, 4);
+        vx = (int8_t)randomRange(2, 6);
+        vy = (int8_t)randomRange(-10, -6);
+        g = 0;
+        shape = PARTICLE_SPRITE_Z;
+        break;
+
+      default:
+        return;
+    }
+    placed = isClear(x, y);
+  }
+  if (!placed) return;
+
+  uint8_t slot = liveCount++;
+  posX[slot] = x << PARTICLE_FRACTION_BITS;
+  posY[slot] = y << PARTICLE_FRACTION_BITS;
+  velX[slot] = vx;
+  velY[slot] = vy;
+  gravity[slot] = g;
+  life[slot] = (uint8_t)randomRange(EMITTERS[kind].minLife, EMITTERS[kind].maxLife + 1);
+  sprite[slot] = shape;
+  drawnX[slot] = x;   // Drawn this frame, over plain background
+  drawnY[slot] = y;
+  redraw[slot] = true;
+  stats.spawned++;
+}
+
+void BMOParticles::kill(uint8_t index) {
+  addDirty(drawnX[index], drawnY[index], drawnX[index], drawnY[index]);
+
+  // Keep the pool packed: the last particle moves into the hole
+  uint8_t last = --liveCount;
+  if (index != last) {
+    posX[index] = posX[last];
+    posY[index] = posY[last];
+    velX[index] = velX[last];
+    velY[index] = velY[last];
+    gravity[index] = gravity[last];
+    life[index] = life[last];
+    sprite[index] = sprite[last];
+    drawnX[index] = drawnX[last];
+    drawnY[index] = drawnY[last];
+    redraw[index] = redraw[last];
+  }
+}
+
+void BMOParticles::addDirty(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  // Union of the sprite box at its old and new top-left corners
+  if (dirtyCount >= PARTICLE_CAPACITY) return;
+  BMOParticleRect& rect = dirty[dirtyCount++];
+  rect.x = x0 < x1 ? x0 : x1;
+  rect.y = y0 < y1 ? y0 : y1;
+  rect.w = (x0 > x1 ? x0 : x1) + PARTICLE_SPRITE_SIZE - rect.x;
+  rect.h = (y0 > y1 ? y0 : y1) + PARTICLE_SPRITE_SIZE - rect.y;
+  stats.dirtyPixels += (uint32_t)rect.w * rect.h;
+}
+
+int16_t BMOParticles::randomRange(int16_t low, int16_t high) {
+  // xorshift32 - cheap and plenty random for sparkles
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return low + (int16_t)(rng % (uint32_t)(high - low));
+}
+
+bool BMOParticles::isClear(int16_t x, int16_t y) {
+  const int size = PARTICLE_SPRITE_SIZE;
+  if (x < FIELD_LEFT || y < FIELD_TOP || x + size > FIELD_RIGHT || y + size > FIELD_BOTTOM) {
+    return false;
+  }
+  if (rectsOverlap(x, y, size, size, LEFT_EYE_X - EYE_KEEP_OUT, EYE_Y - EYE_KEEP_OUT,
+                   2 * EYE_KEEP_OUT + 1, 2 * EYE_KEEP_OUT + 1) ||
+      rectsOverlap(x, y, size, size, RIGHT_EYE_X - EYE_KEEP_OUT, EYE_Y - EYE_KEEP_OUT,
+                   2 * EYE_KEEP_OUT + 1, 2 * EYE_KEEP_OUT + 1) ||
+      rectsOverlap(x, y, size, size, MOUTH_LEFT, MOUTH_TOP,
+                   BMOFace::MOUTH_BOX_WIDTH, BMOFace::MOUTH_BOX_HEIGHT)) {
+    return false;
+  }
+  return true;
+}
+
+void BMOParticles::printParticleInfo() {
+  Serial.println("=== BMO Particles ===");
+  Serial.printf("Status: %s, effect %d\n", active ? "Active" : "Inactive", effect);
+  Serial.printf("Live: %u of %u (peak %u, density %u/256)\n", liveCount, liveLimit, (unsigned)stats.peakLive,
+                density);
+  Serial.printf("Frames: %u, spawned: %u, culled: %u\n",
+                (unsigned)stats.frames, (unsigned)stats.spawned, (unsigned)stats.culled);
+  if (stats.frames > 0) {
+    Serial.printf("Pixels restored per frame: %u\n", (unsigned)(stats.dirtyPixels / stats.frames));
+  }
+  Serial.println("=====================");
+}
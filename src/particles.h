@@ -0,0 +1,158 @@
+/*
+ * BMO Particle Effects
+ *
+ * Small sprites drifting around the face: sparkles when BMO is excited,
+ * hearts on request and a trail of Zzz when sleepy
+ *
+ * Features:
+ * - Fixed-capacity pool stored as struct-of-arrays (no heap, no arena)
+ * - Integer physics: Q4 fixed-point positions, velocities and gravity
+ * - Per-frame dirty rectangles (union of each particle's old and new bounds),
+ *   so a frame repaints only the pixels particles touched
+ * - Keep-out zones around the eyes, mouth and frame - the face itself is
+ *   never overdrawn or restored
+ * - 30 fps pacing shared with lip-sync
+ * - Density control (fewer live particles and smaller bursts), for the
+ *   quality governor
+ *
+ * The simulation is panel-agnostic; BMOGraphicsT::drawParticles() paints it
+ */
+
+#ifndef BMO_PARTICLES_H
+#define BMO_PARTICLES_H
+
+#include <Arduino.h>
+#include "panel.h"
+
+// Particles are optional, enable with -DBMO_ENABLE_PARTICLES=1
+#ifndef BMO_ENABLE_PARTICLES
+#define BMO_ENABLE_PARTICLES 0
+#endif
+
+// Pool and pacing
+#define PARTICLE_CAPACITY        48
+#define PARTICLE_FPS             30
+#define PARTICLE_FRAME_INTERVAL  (1000 / PARTICLE_FPS)  // 33ms per frame
+
+// Sprites are 8x8 one-bit masks
+#define PARTICLE_SPRITE_SIZE     8
+
+// Fixed point: positions and velocities in 1/16 pixel
+#define PARTICLE_FRACTION_BITS   4
+#define PARTICLE_ONE             (1 << PARTICLE_FRACTION_BITS)
+
+// Sprite shapes
+enum BMOParticleSprite {
+  PARTICLE_SPRITE_SPARKLE = 0,
+  PARTICLE_SPRITE_TWINKLE,      // Small sparkle, alternates with the big one
+  PARTICLE_SPRITE_HEART,
+  PARTICLE_SPRITE_Z,
+  PARTICLE_SPRITE_COUNT
+};
+
+// Continuous emitters
+enum BMOParticleEffect {
+  PARTICLE_EFFECT_NONE = 0,
+  PARTICLE_EFFECT_SPARKLES,     // Excited
+  PARTICLE_EFFECT_HEARTS,
+  PARTICLE_EFFECT_SLEEP,        // Zzz rising from beside the right eye
+  PARTICLE_EFFECT_COUNT
+};
+
+struct BMOParticleSpriteDef {
+  uint8_t rows[PARTICLE_SPRITE_SIZE];   // MSB is the leftmost pixel
+  uint16_t color;
+};
+
+// Sprite masks and colors, indexed by BMOParticleSprite
+extern const BMOParticleSpriteDef PARTICLE_SPRITES[PARTICLE_SPRITE_COUNT];
+
+// Screen region to repaint this frame
+struct BMOParticleRect {
+  int16_t x, y, w, h;
+};
+
+// Particle statistics
+struct ParticleStats {
+  uint32_t frames;        // Frames simulated
+  uint32_t spawned;
+  uint32_t culled;        // Died early on entering a keep-out zone
+  uint32_t peakLive;
+  uint32_t dirtyPixels;   // Pixels restored, summed over all frames
+};
+
+class BMOParticles {
+public:
+  BMOParticles();
+
+  // Initialization (particles live on the face panel, BMOActivePanel)
+  void begin();
+  void end();
+  bool isActive() const { return active; }
+
+  // Emitters
+  void setEffect(BMOParticleEffect effect);
+  BMOParticleEffect getEffect() const { return effect; }
+  void burst(BMOParticleEffect effect, uint8_t count);
+  void setDensity(uint16_t density);  // Of 256; scales the live limit and bursts
+  uint16_t getDensity() const { return density; }
+  void clear();       // Drop every particle without repainting
+  void invalidate();  // The face was repainted underneath - draw everything next frame
+
+  // Advance one frame - returns true when something needs repainting
+  bool update();
+  bool isIdle() const { return effect == PARTICLE_EFFECT_NONE && liveCount == 0 && dirtyCount == 0; }
+
+  // This frame's drawing: restore the dirty rects, then draw every particle
+  uint8_t getDirtyCount() const { return dirtyCount; }
+  const BMOParticleRect& getDirty(uint8_t index) const { return dirty[index]; }
+  uint8_t getLiveCount() const { return liveCount; }
+  int16_t getX(uint8_t index) const { return posX[index] >> PARTICLE_FRACTION_BITS; }
+  int16_t getY(uint8_t index) const { return posY[index] >> PARTICLE_FRACTION_BITS; }
+  uint8_t getSprite(uint8_t index) const { return sprite[index]; }
+  bool needsDraw(uint8_t index) const { return redraw[index]; }  // New, moved or under a dirty rect
+
+  // Statistics
+  const ParticleStats& getStats() const { return stats; }
+  void printParticleInfo();
+
+private:
+  bool active;
+  BMOParticleEffect effect;
+  uint8_t spawnTimer;         // Frames until the emitter fires again
+  uint16_t density;           // Of 256
+  uint8_t liveLimit;          // PARTICLE_CAPACITY scaled by density
+  bool redrawAll;
+  uint32_t rng;               // xorshift32 state
+
+  // Pool (struct-of-arrays; live particles are packed into [0, liveCount))
+  int16_t posX[PARTICLE_CAPACITY];     // Top-left corner, Q4
+  int16_t posY[PARTICLE_CAPACITY];
+  int8_t velX[PARTICLE_CAPACITY];      // Q4 pixels per frame
+  int8_t velY[PARTICLE_CAPACITY];
+  int8_t gravity[PARTICLE_CAPACITY];   // Q4 pixels per frame per frame (negative floats)
+  uint8_t life[PARTICLE_CAPACITY];     // Frames left
+  uint8_t sprite[PARTICLE_CAPACITY];
+  int16_t drawnX[PARTICLE_CAPACITY];   // Where the sprite is on screen now, -1 = not drawn
+  int16_t drawnY[PARTICLE_CAPACITY];
+  bool redraw[PARTICLE_CAPACITY];
+  uint8_t liveCount;
+
+  // Repaint list for the current frame
+  BMOParticleRect dirty[PARTICLE_CAPACITY];
+  uint8_t dirtyCount;
+
+  ParticleStats stats;
+
+  // Helpers
+  void spawn(BMOParticleEffect kind);
+  void kill(uint8_t index);
+  void addDirty(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+  int16_t randomRange(int16_t low, int16_t high);
+  static bool isClear(int16_t x, int16_t y);
+};
+
+// Global particle instance
+extern BMOParticles* g_bmoParticles;
+
+#endif // BMO_PARTICLES_H
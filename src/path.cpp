@@ -0,0 +1,315 @@
+/*
+ * BMO Vector Path Implementation
+ *
+ * Flattening and the active-edge-table scanline fill
+ */
+
+#include "path.h"
+
+// Sort keys for the edge table never exceed this many entries (plus the
+// implicit closing edge of an open contour)
+#define PATH_TABLE_SIZE (PATH_MAX_EDGES + 1)
+
+uint32_t bmoSqrt(uint32_t value) {
+  // Bit by bit, no FPU
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > value) bit >>= 2;
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Division rounding towards minus infinity (C++ truncates towards zero)
+static int32_t floorDiv(int32_t numerator, int32_t denominator) {
+  int32_t quotient = numerator / denominator;
+  if ((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0))) quotient--;
+  return quotient;
+}
+
+// ...and for products that outgrow 32 bits
+static int64_t floorDiv(int64_t numerator, int64_t denominator) {
+  int64_t quotient = numerator / denominator;
+  if ((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0))) quotient--;
+  return quotient;
+}
+
+BMOPath::BMOPath()
+  : edges()
+  , edgeCount(0)
+  , overflowed(false)
+  , tolerance(PATH_TOLERANCE)
+  , startX(0)
+  , startY(0)
+  , currentX(0)
+  , currentY(0)
+  , open(false)
+  , minX(INT32_MAX)
+  , minY(INT32_MAX)
+  , maxX(INT32_MIN)
+  , maxY(INT32_MIN)
+{
+}
+
+void BMOPath::clear() {
+  edgeCount = 0;
+  overflowed = false;
+  open = false;
+  currentX = currentY = startX = startY = 0;
+  minX = minY = INT32_MAX;
+  maxX = maxY = INT32_MIN;
+}
+
+bool BMOPath::getBounds(int& x, int& y, int& width, int& height) const {
+  if (minX > maxX) return false;
+
+  // Pixel centers sit half a pixel in, so this is one pixel generous at most
+  x = floorDiv(minX, PATH_ONE);
+  y = floorDiv(minY, PATH_ONE);
+  width = floorDiv(maxX, PATH_ONE) - x + 1;
+  height = floorDiv(maxY, PATH_ONE) - y + 1;
+  return true;
+}
+
+void BMOPath::moveTo(int32_t x, int32_t y) {
+  close();
+  startX = currentX = x;
+  startY = currentY = y;
+  open = true;
+}
+
+void BMOPath::lineTo(int32_t x, int32_t y) {
+  if (!open) moveTo(currentX, currentY);
+  addEdge(currentX, currentY, x, y);
+  currentX = x;
+  currentY = y;
+}
+
+void BMOPath::close() {
+  if (open && (currentX != startX || currentY != startY)) {
+    addEdge(currentX, currentY, startX, startY);
+  }
+  currentX = startX;
+  currentY = startY;
+  open = false;
+}
+
+uint8_t BMOPath::segmentsFor(uint32_t secondDifference, uint8_t degreeFactor) const {
+  // Wang's formula: n^2 = d(d-1)/8 * |max second difference| / tolerance
+  uint32_t squared = (degreeFactor * secondDifference + 8UL * tolerance - 1) / (8UL * tolerance);
+  uint32_t segments = bmoSqrt(squared);
+  if (segments * segments < squared) segments++;
+  if (segments < 1) segments = 1;
+  return segments > PATH_MAX_SEGMENTS ? PATH_MAX_SEGMENTS : (uint8_t)segments;
+}
+
+static uint32_t vectorLength(int32_t x, int32_t y) {
+  return bmoSqrt((uint32_t)(x * x) + (uint32_t)(y * y));
+}
+
+void BMOPath::quadTo(int32_t cx, int32_t cy, int32_t x, int32_t y) {
+  if (!open) moveTo(currentX, currentY);
+  int32_t x0 = currentX, y0 = currentY;
+
+  uint32_t n = segmentsFor(vectorLength(x0 - 2 * cx + x, y0 - 2 * cy + y), 2);
+
+  // Evaluate the Bernstein form exactly at t = i/n (integer weights over n^2)
+  int32_t n2 = n * n;
+  for (uint32_t i = 1; i < n; i++) {
+    int32_t a = (n - i) * (n - i), b = 2 * i * (n - i), c = i * i;
+    lineTo(floorDiv(a * x0 + b * cx + c * x + n2 / 2, n2), floorDiv(a * y0 + b * cy + c * y + n2 / 2, n2));
+  }
+  lineTo(x, y);
+}
+
+void BMOPath::cubicTo(int32_t c1x, int32_t c1y, int32_t c2x, int32_t c2y, int32_t x, int32_t y) {
+  if (!open) moveTo(currentX, currentY);
+  int32_t x0 = currentX, y0 = currentY;
+
+  uint32_t d1 = vectorLength(x0 - 2 * c1x + c2x, y0 - 2 * c1y + c2y);
+  uint32_t d2 = vectorLength(c1x - 2 * c2x + x, c1y - 2 * c2y + y);
+  uint32_t n = segmentsFor(d1 > d2 ? d1 : d2, 6);
+
+  // Weights over n^3 - 64-bit, as a 32-segment cubic's weights reach 2^15
+  int64_t n3 = (int64_t)n * n * n;
+  for (uint32_t i = 1; i < n; i++) {
+    int64_t u = n - i;
+    int64_t a = u * u * u, b = 3 * u * u * i, c = 3 * u * i * i, d = (int64_t)i * i * i;
+    lineTo((int32_t)floorDiv(a * x0 + b * c1x + c * c2x + d * x + n3 / 2, n3),
+           (int32_t)floorDiv(a * y0 + b * c1y + c * c2y + d * y + n3 / 2, n3));
+  }
+  lineTo(x, y);
+}
+
+void BMOPath::strokeQuad(int32_t x0, int32_t y0, int32_t cx, int32_t cy,
+                         int32_t x1, int32_t y1, int32_t width) {
+  int32_t half = width / 2;
+  if (half <= 0) return;
+
+  // Normals of the two control legs, half a pen wide (a leg of zero length
+  // borrows the other one's)
+  int32_t ax = cx - x0, ay = cy - y0;
+  int32_t bx = x1 - cx, by = y1 - cy;
+  uint32_t lengthA = vectorLength(ax, ay);
+  uint32_t lengthB = vectorLength(bx, by);
+  if (lengthA == 0 && lengthB == 0) return;
+  if (lengthA == 0) { ax = bx; ay = by; lengthA = lengthB; }
+  if (lengthB == 0) { bx = ax; by = ay; lengthB = lengthA; }
+  int32_t nax = -ay * half / (int32_t)lengthA, nay = ax * half / (int32_t)lengthA;
+  int32_t nbx = -by * half / (int32_t)lengthB, nby = bx * half / (int32_t)lengthB;
+
+  // The offset control point sits where the two offset legs meet
+  // (Tiller-Hanson); near a cusp the miter is capped
+  int64_t half2 = (int64_t)half * half;
+  int64_t denominator = half2 + (int64_t)nax * nbx + (int64_t)nay * nby;
+  if (denominator < half2 / 4) denominator = half2 / 4;
+  int32_t ox = (int32_t)((nax + nbx) * half2 / denominator);
+  int32_t oy = (int32_t)((nay + nby) * half2 / denominator);
+
+  // Out along one side, back along the other
+  moveTo(x0 + nax, y0 + nay);
+  quadTo(cx + ox, cy + oy, x1 + nbx, y1 + nby);
+  lineTo(x1 - nbx, y1 - nby);
+  quadTo(cx - ox, cy - oy, x0 - nax, y0 - nay);
+  close();
+}
+
+void BMOPath::addEdge(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  if (x0 < minX) minX = x0;
+  if (x0 > maxX) maxX = x0;
+  if (x1 < minX) minX = x1;
+  if (x1 > maxX) maxX = x1;
+  if (y0 < minY) minY = y0;
+  if (y0 > maxY) maxY = y0;
+  if (y1 < minY) minY = y1;
+  if (y1 > maxY) maxY = y1;
+
+  if (y0 == y1) return;  // Horizontal edges never cross a scanline center
+  if (edgeCount >= PATH_MAX_EDGES) {
+    overflowed = true;
+    return;
+  }
+
+  Edge& edge = edges[edgeCount++];
+  if (y0 < y1) {
+    edge.x0 = x0; edge.y0 = y0; edge.x1 = x1; edge.y1 = y1;
+    edge.winding = 1;
+  } else {
+    edge.x0 = x1; edge.y0 = y1; edge.x1 = x0; edge.y1 = y0;
+    edge.winding = -1;
+  }
+}
+
+uint16_t BMOPath::fill(BMOSpanSink sink, void* context, uint16_t color,
+                       BMOFillRule rule, int originX, int originY) const {
+  // An open contour closes back to its start
+  Edge closing = {};
+  uint8_t total = edgeCount;
+  if (open && currentY != startY) {
+    bool down = currentY < startY;
+    closing.x0 = down ? currentX : startX;
+    closing.y0 = down ? currentY : startY;
+    closing.x1 = down ? startX : currentX;
+    closing.y1 = down ? startY : currentY;
+    closing.winding = down ? 1 : -1;
+    total++;
+  }
+  if (total == 0) return 0;
+
+  // Edge table: indices sorted by top
+  uint8_t table[PATH_TABLE_SIZE];
+  for (uint8_t i = 0; i < total; i++) {
+    const Edge& edge = i < edgeCount ? edges[i] : closing;
+    uint8_t j = i;
+    while (j > 0) {
+      const Edge& previous = table[j - 1] < edgeCount ? edges[table[j - 1]] : closing;
+      if (previous.y0 <= edge.y0) break;
+      table[j] = table[j - 1];
+      j--;
+    }
+    table[j] = i;
+  }
+
+  int32_t top = (table[0] < edgeCount ? edges[table[0]] : closing).y0;
+  int32_t bottom = top;
+  for (uint8_t i = 0; i < total; i++) {
+    const Edge& edge = i < edgeCount ? edges[i] : closing;
+    if (edge.y1 > bottom) bottom = edge.y1;
+  }
+
+  // Sample each pixel row at its center; an edge covers samples in [y0, y1)
+  uint8_t active[PATH_TABLE_SIZE];
+  int32_t crossX[PATH_TABLE_SIZE];
+  int8_t crossWinding[PATH_TABLE_SIZE];
+  uint8_t activeCount = 0;
+  uint8_t nextEdge = 0;
+  uint16_t spans = 0;
+
+  const int32_t half = PATH_ONE / 2;
+  for (int32_t row = floorDiv(top - half + PATH_ONE - 1, PATH_ONE); row * PATH_ONE + half < bottom; row++) {
+    int32_t sampleY = row * PATH_ONE + half;
+
+    // Retire finished edges, then admit the ones starting at or above this row
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < activeCount; i++) {
+      const Edge& edge = active[i] < edgeCount ? edges[active[i]] : closing;
+      if (edge.y1 > sampleY) active[kept++] = active[i];
+    }
+    activeCount = kept;
+    while (nextEdge < total) {
+      const Edge& edge = table[nextEdge] < edgeCount ? edges[table[nextEdge]] : closing;
+      if (edge.y0 > sampleY) break;
+      if (edge.y1 > sampleY) active[activeCount++] = table[nextEdge];
+      nextEdge++;
+    }
+    if (activeCount == 0) continue;
+
+    // Crossings along the row, sorted left to right
+    for (uint8_t i = 0; i < activeCount; i++) {
+      const Edge& edge = active[i] < edgeCount ? edges[active[i]] : closing;
+      // Rounded; 64-bit, as an edge spanning the coordinate range takes
+      // the product past 2^32
+      int64_t height = edge.y1 - edge.y0;
+      int32_t x = edge.x0 + (int32_t)floorDiv((int64_t)(sampleY - edge.y0) * (edge.x1 - edge.x0) * 2 + height,
+                                              height * 2);
+      uint8_t j = i;
+      while (j > 0 && crossX[j - 1] > x) {
+        crossX[j] = crossX[j - 1];
+        crossWinding[j] = crossWinding[j - 1];
+        j--;
+      }
+      crossX[j] = x;
+      crossWinding[j] = edge.winding;
+    }
+
+    // Walk the crossings; pixels whose centers fall inside form a span
+    int32_t winding = 0;
+    int32_t spanStart = 0;
+    for (uint8_t i = 0; i < activeCount; i++) {
+      bool wasInside = rule == FILL_NONZERO ? winding != 0 : (winding & 1) != 0;
+      winding += crossWinding[i];
+      bool inside = rule == FILL_NONZERO ? winding != 0 : (winding & 1) != 0;
+
+      if (!wasInside && inside) {
+        spanStart = crossX[i];
+      } else if (wasInside && !inside) {
+        int32_t first = floorDiv(spanStart - half + PATH_ONE - 1, PATH_ONE);
+        int32_t end = floorDiv(crossX[i] - half + PATH_ONE - 1, PATH_ONE);
+        if (first < end) {
+          BMOSpan span = { (int16_t)(row + originY), (int16_t)(first + originX),
+                           (int16_t)(end - 1 + originX), color };
+          sink(span, context);
+          spans++;
+        }
+      }
+    }
+  }
+  return spans;
+}
@@ -0,0 +1,99 @@
+/*
+ * BMO Vector Paths
+ *
+ * Outlines built from move/line/quadratic/cubic commands and filled with a
+ * scanline rasterizer, for shapes that aren't worth a compile-time span
+ * table (see shapes.h) or that change at runtime
+ *
+ * Features:
+ * - Q4 fixed-point coordinates (1/16 pixel), no float
+ * - Curves flattened as they are added, with just enough segments to stay
+ *   within the tolerance (Wang's formula)
+ * - Active-edge-table scanline fill, non-zero and even-odd rules
+ * - Output as horizontal spans (BMOSpan) through a callback
+ * - Bounds tracked as points are added, for rejecting a fill up front
+ * - Fixed capacity, no heap
+ */
+
+#ifndef BMO_PATH_H
+#define BMO_PATH_H
+
+#include <Arduino.h>
+#include "shapes.h"
+
+// Fixed point: coordinates in 1/16 pixel (edges are stored in 16 bits, so
+// keep paths within +/-2047 pixels). Pixel centers sit at PATH_PX(x) + PATH_ONE / 2.
+#define PATH_FRACTION_BITS  4
+#define PATH_ONE            (1 << PATH_FRACTION_BITS)
+#define PATH_PX(value)      ((value) * PATH_ONE)   // Whole pixels to path units
+
+// Capacity and flattening
+#define PATH_MAX_EDGES      96   // Line segments after flattening
+#define PATH_MAX_SEGMENTS   32   // Per curve
+#define PATH_TOLERANCE      4    // Max distance from the true curve, path units (1/4 px)
+
+// Which regions of a self-overlapping outline are inside
+enum BMOFillRule {
+  FILL_NONZERO = 0,   // Inside where the outline winds around at all
+  FILL_EVEN_ODD       // Inside where it is crossed an odd number of times
+};
+
+// Integer square root (also used by the gaze renderer)
+uint32_t bmoSqrt(uint32_t value);
+
+// Receives each filled run; span.y and x0/x1 are in pixels
+typedef void (*BMOSpanSink)(const BMOSpan& span, void* context);
+
+class BMOPath {
+public:
+  BMOPath();
+
+  // Building (path units). Each moveTo starts a new contour; open contours
+  // are closed implicitly when filled.
+  void moveTo(int32_t x, int32_t y);
+  void lineTo(int32_t x, int32_t y);
+  void quadTo(int32_t cx, int32_t cy, int32_t x, int32_t y);
+  void cubicTo(int32_t c1x, int32_t c1y, int32_t c2x, int32_t c2y, int32_t x, int32_t y);
+  void close();
+  void clear();
+
+  // Outline of a quadratic curve drawn with a pen of the given width
+  // (a closed contour of its own, butt ends)
+  void strokeQuad(int32_t x0, int32_t y0, int32_t cx, int32_t cy, int32_t x1, int32_t y1, int32_t width);
+
+  void setTolerance(uint16_t tolerance) { this->tolerance = tolerance ? tolerance : 1; }
+
+  // Rasterize at a pixel offset - one span per filled run, top to bottom
+  uint16_t fill(BMOSpanSink sink, void* context, uint16_t color,
+                BMOFillRule rule = FILL_NONZERO, int originX = 0, int originY = 0) const;
+
+  // Pixels the fill can touch, at origin 0 (false for an empty path)
+  bool getBounds(int& x, int& y, int& width, int& height) const;
+
+  // State
+  uint8_t getEdgeCount() const { return edgeCount; }
+  bool isOverflowed() const { return overflowed; }  // Edges were dropped - the fill is incomplete
+
+private:
+  // One non-horizontal line segment, stored top to bottom
+  struct Edge {
+    int16_t x0, y0;   // Top
+    int16_t x1, y1;   // Bottom
+    int8_t winding;   // +1 drawn downwards, -1 upwards
+  };
+
+  Edge edges[PATH_MAX_EDGES];
+  uint8_t edgeCount;
+  bool overflowed;
+  uint16_t tolerance;
+
+  int32_t startX, startY;     // Current contour's first point
+  int32_t currentX, currentY;
+  bool open;                  // A contour has been started
+  int32_t minX, minY, maxX, maxY;  // Every point added
+
+  void addEdge(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+  uint8_t segmentsFor(uint32_t secondDifference, uint8_t degreeFactor) const;
+};
+
+#endif // BMO_PATH_H
@@ -0,0 +1,372 @@
+/*
+ * BMO Serial Command Protocol Implementation
+ *
+ * Byte-at-a-time frame receiver, command dispatch through the event loop
+ * and image upload streamed from the serial RX buffer to the panel
+ */
+
+#include "protocol.h"
+#include "display.h"
+#include "graphics.h"
+#include "events.h"
+#include "mirror.h"
+
+// Global protocol instance
+BMOProtocol* g_bmoProtocol = nullptr;
+
+BMOProtocol::BMOProtocol()
+  : port(nullptr)
+  , active(false)
+  , rxState(RX_SYNC1)
+  , header()
+  , headerCount(0)
+  , payloadLength(0)
+  , payloadCount(0)
+  , crc(0xFFFF)
+  , crcBytes()
+  , crcCount(0)
+  , command()
+  , lastSeqValid(false)
+  , lastSeq(0)
+  , lastCrc(0)
+  , tft(nullptr)
+  , imageOpen(false)
+  , imagePanel(0)
+  , imageX(0)
+  , imageY(0)
+  , imageW(0)
+  , imageH(0)
+  , imageOffset(0)
+  , pixelCarry(0)
+  , hasCarry(false)
+  , offsetBytes()
+  , response()
+  , responseLength(0)
+  , txSeq(0)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+bool BMOProtocol::begin(Stream* serialPort) {
+  port = serialPort;
+  if (!port) {
+    Serial.println("ERROR: Command protocol needs a serial port");
+    return false;
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  rxState = RX_SYNC1;
+  imageOpen = false;
+  lastSeqValid = false;
+  responseLength = 0;
+
+  active = true;
+  g_bmoProtocol = this;
+
+  Serial.println("Command protocol listening");
+  return true;
+}
+
+void BMOProtocol::end() {
+  if (active) {
+    active = false;
+    port = nullptr;
+    g_bmoProtocol = nullptr;
+    Serial.println("Command protocol stopped");
+  }
+}
+
+bool BMOProtocol::isBusy() const {
+  return active && (responseLength > 0 || port->available() > 0);
+}
+
+void BMOProtocol::service() {
+  if (!active) return;
+
+  // An ACK/NAK still waiting for room holds off further input, so the host
+  // sees every response in order
+  if (responseLength && !flushResponse()) return;
+
+  // Bounded per call; whatever is left waits for the next EVENT_SERIAL,
+  // after the timers and commands already queued
+  uint32_t bytesStart = stats.bytesIn;
+  uint32_t framesStart = stats.frames + stats.crcErrors;
+  while (port->available() > 0) {
+    if (stats.bytesIn - bytesStart >= PROTOCOL_SERVICE_BYTES) break;
+    if (stats.frames + stats.crcErrors - framesStart >= PROTOCOL_SERVICE_FRAMES) break;
+
+    // Image pixels go through in blocks, everything else byte by byte
+    if (rxState == RX_PAYLOAD && header[0] == CMD_IMAGE_DATA && payloadCount >= 4) {
+      receivePixels(PROTOCOL_SERVICE_BYTES - (stats.bytesIn - bytesStart));
+    } else {
+      int byte = port->read();
+      if (byte < 0) break;
+      stats.bytesIn++;
+      receiveByte((uint8_t)byte);
+    }
+
+    if (responseLength && !flushResponse()) return;
+  }
+}
+
+void BMOProtocol::receiveByte(uint8_t byte) {
+  switch (rxState) {
+    case RX_SYNC1:
+      if (byte == BMO_FRAME_SYNC1) rxState = RX_SYNC2;
+      break;
+
+    case RX_SYNC2:
+      if (byte == BMO_FRAME_SYNC2) {
+        rxState = RX_HEADER;
+        headerCount = 0;
+        crc = 0xFFFF;
+      } else if (byte != BMO_FRAME_SYNC1) {
+        rxState = RX_SYNC1;
+      }
+      break;
+
+    case RX_HEADER:
+      header[headerCount++] = byte;
+      crc = bmoCrc16(&byte, 1, crc);
+      if (headerCount == sizeof(header)) {
+        payloadLength = (uint16_t)(header[2] | (header[3] << 8));
+        payloadCount = 0;
+        hasCarry = false;
+        if (payloadLength > PROTOCOL_MAX_PAYLOAD) {
+          // Not a frame we could ever take - most likely a false sync
+          rxState = RX_SYNC1;
+        } else {
+          crcCount = 0;
+          rxState = payloadLength ? RX_PAYLOAD : RX_CRC;
+        }
+      }
+      break;
+
+    case RX_PAYLOAD:
+      crc = bmoCrc16(&byte, 1, crc);
+      if (header[0] == CMD_IMAGE_DATA) {
+        // Pixel offset; the pixels themselves take the block path
+        offsetBytes[payloadCount] = byte;
+        if (payloadCount == 3) {
+          imageOffset = (uint32_t)offsetBytes[0] | ((uint32_t)offsetBytes[1] << 8) |
+                        ((uint32_t)offsetBytes[2] << 16) | ((uint32_t)offsetBytes[3] << 24);
+        }
+      } else if (payloadCount < PROTOCOL_MAX_COMMAND) {
+        command[payloadCount] = byte;
+      }
+      if (++payloadCount == payloadLength) rxState = RX_CRC;
+      break;
+
+    case RX_CRC:
+      crcBytes[crcCount++] = byte;
+      if (crcCount == 2) {
+        frameComplete(crc == (uint16_t)(crcBytes[0] | (crcBytes[1] << 8)));
+        rxState = RX_SYNC1;
+      }
+      break;
+  }
+}
+
+void BMOProtocol::receivePixels(size_t limit) {
+  // Small aligned staging block between the RX buffer and the SPI FIFO;
+  // a byte left over from the previous block leads the next one
+  alignas(4) uint8_t block[PROTOCOL_PIXEL_BLOCK + 1];
+  size_t start = 0;
+  if (hasCarry) {
+    block[0] = pixelCarry;
+    hasCarry = false;
+    start = 1;
+  }
+
+  size_t wanted = payloadLength - payloadCount;
+  if (wanted > PROTOCOL_PIXEL_BLOCK) wanted = PROTOCOL_PIXEL_BLOCK;
+  if (wanted > limit) wanted = limit;
+  int available = port->available();
+  if ((int)wanted > available) wanted = available;
+
+  size_t got = port->readBytes(block + start, wanted);
+  crc = bmoCrc16(block + start, got, crc);
+  payloadCount += got;
+  stats.bytesIn += got;
+
+  size_t length = start + got;
+  if (length & 1) {
+    pixelCarry = block[length - 1];
+    hasCarry = true;
+    length--;
+  }
+  writePixels(block, length);
+
+  if (payloadCount == payloadLength) rxState = RX_CRC;
+}
+
+void BMOProtocol::writePixels(uint8_t* block, size_t length) {
+  if (!imageOpen || length == 0) return;
+
+  uint32_t total = (uint32_t)imageW * imageH;
+  uint32_t pixels = length / 2;
+  uint8_t* src = block;
+
+  // Blocks arrive in panel byte order, so they go out unswapped whatever
+  // the renderer left TFT_eSPI set to
+  bool swapBytes = tft->getSwapBytes();
+  tft->setSwapBytes(false);
+  g_bmoDisplay->selectPanel(imagePanel);
+  g_bmoDisplay->startWrite();
+  while (pixels > 0 && imageOffset < total) {
+    uint32_t row = imageOffset / imageW;
+    uint32_t col = imageOffset % imageW;
+    uint32_t run;
+
+    // Finish a partial row, then whole rows in one window, then a row head
+    if (col) {
+      run = imageW - col;
+      if (run > pixels) run = pixels;
+      tft->setAddrWindow(imageX + col, imageY + row, run, 1);
+    } else if (pixels >= (uint32_t)imageW) {
+      uint32_t rows = pixels / imageW;
+      if (rows > imageH - row) rows = imageH - row;
+      run = rows * imageW;
+      tft->setAddrWindow(imageX, imageY + row, imageW, rows);
+    } else {
+      run = pixels;
+      tft->setAddrWindow(imageX, imageY + row, run, 1);
+    }
+
+    // pushPixels reads whole words, so each run starts at the aligned block base
+    if (src != block) memmove(block, src, run * 2);
+    tft->pushPixels(block, run);
+    g_bmoDisplay->notePixels(1, run);
+
+    src += run * 2;
+    pixels -= run;
+    imageOffset += run;
+    stats.pixels += run;
+  }
+  g_bmoDisplay->endWrite();
+  tft->setSwapBytes(swapBytes);
+}
+
+void BMOProtocol::frameComplete(bool crcOk) {
+  uint8_t type = header[0];
+  uint8_t seq = header[1];
+
+  if (!crcOk) {
+    stats.crcErrors++;
+    queueResponse(FRAME_NAK, seq, PROTOCOL_ERROR_CRC);
+    return;
+  }
+  stats.frames++;
+
+  // Our ACK was lost and the host sent the same frame again (a new host
+  // session reusing the sequence number carries a different CRC)
+  if (lastSeqValid && seq == lastSeq && crc == lastCrc && type != CMD_IMAGE_DATA) {
+    stats.duplicates++;
+    queueResponse(FRAME_ACK, seq, PROTOCOL_OK);
+    return;
+  }
+
+  uint8_t code = executeCommand(type, command, payloadLength);
+  if (code == PROTOCOL_OK) {
+    lastSeq = seq;
+    lastCrc = crc;
+    lastSeqValid = true;
+    queueResponse(FRAME_ACK, seq, PROTOCOL_OK);
+  } else {
+    queueResponse(FRAME_NAK, seq, code);
+  }
+}
+
+uint8_t BMOProtocol::executeCommand(uint8_t type, const uint8_t* payload, uint16_t length) {
+  switch (type) {
+    case CMD_PING:
+      return PROTOCOL_OK;
+
+    case CMD_SET_EXPRESSION:
+      if (length != 2) return PROTOCOL_ERROR_LENGTH;
+      if (payload[0] >= EXPRESSION_COUNT) return PROTOCOL_ERROR_ARGUMENT;
+      if (payload[1] > EYES_WIDE && payload[1] != PROTOCOL_EYES_DEFAULT) return PROTOCOL_ERROR_ARGUMENT;
+      if (!g_bmoEvents || !g_bmoEvents->post(EVENT_COMMAND, type, payload[0] | (payload[1] << 8))) {
+        return PROTOCOL_ERROR_BUSY;
+      }
+      return PROTOCOL_OK;
+
+    case CMD_ANIMATE:
+      if (length != 1) return PROTOCOL_ERROR_LENGTH;
+      if (payload[0] >= ANIMATION_COUNT) return PROTOCOL_ERROR_ARGUMENT;
+      if (!g_bmoEvents || !g_bmoEvents->post(EVENT_COMMAND, type, payload[0])) {
+        return PROTOCOL_ERROR_BUSY;
+      }
+      return PROTOCOL_OK;
+
+    case CMD_BACKLIGHT:
+      if (length != 1) return PROTOCOL_ERROR_LENGTH;
+      if (!g_bmoEvents || !g_bmoEvents->post(EVENT_COMMAND, type, payload[0])) {
+        return PROTOCOL_ERROR_BUSY;
+      }
+      return PROTOCOL_OK;
+
+    case CMD_IMAGE_BEGIN: {
+      if (length != 9) return PROTOCOL_ERROR_LENGTH;
+      const BMOPanelState* panel = g_bmoDisplay ? g_bmoDisplay->getPanel(payload[0]) : nullptr;
+      int16_t x = (int16_t)(payload[1] | (payload[2] << 8));
+      int16_t y = (int16_t)(payload[3] | (payload[4] << 8));
+      int16_t w = (int16_t)(payload[5] | (payload[6] << 8));
+      int16_t h = (int16_t)(payload[7] | (payload[8] << 8));
+      if (!panel || x < 0 || y < 0 || w <= 0 || h <= 0 ||
+          x + w > panel->width || y + h > panel->height) {
+        return PROTOCOL_ERROR_ARGUMENT;
+      }
+      tft = g_bmoDisplay->getTFT();
+      imagePanel = payload[0];
+      imageX = x;
+      imageY = y;
+      imageW = w;
+      imageH = h;
+      imageOpen = true;
+      return PROTOCOL_OK;
+    }
+
+    case CMD_IMAGE_DATA:
+      // Pixels are already on the panel
+      if (length < 4) return PROTOCOL_ERROR_LENGTH;
+      return imageOpen ? PROTOCOL_OK : PROTOCOL_ERROR_NO_IMAGE;
+
+    case CMD_IMAGE_END:
+      if (!imageOpen) return PROTOCOL_ERROR_NO_IMAGE;
+      imageOpen = false;
+      return PROTOCOL_OK;
+
+    default:
+      return PROTOCOL_ERROR_UNKNOWN;
+  }
+}
+
+void BMOProtocol::queueResponse(uint8_t type, uint8_t seq, uint8_t code) {
+  if (type == FRAME_NAK) stats.naks++;
+
+  response[BMO_FRAME_HEADER_SIZE] = seq;
+  response[BMO_FRAME_HEADER_SIZE + 1] = code;
+  responseLength = bmoFrameSeal(response, type, txSeq++, 2);
+  flushResponse();
+}
+
+bool BMOProtocol::flushResponse() {
+  // Whole frames only, and never in the middle of a mirror packet
+  if (g_bmoMirror && g_bmoMirror->isSending()) return false;
+  if (port->availableForWrite() < (int)responseLength) return false;
+
+  port->write(response, responseLength);
+  responseLength = 0;
+  return true;
+}
+
+void BMOProtocol::printProtocolInfo() {
+  Serial.println("=== BMO Command Protocol ===");
+  Serial.printf("Status: %s\n", active ? "Listening" : "Inactive");
+  Serial.printf("Frames: %u, CRC errors: %u, ", (unsigned)stats.frames, (unsigned)stats.crcErrors);
+  Serial.printf("NAKs: %u, duplicates: %u\n", (unsigned)stats.naks, (unsigned)stats.duplicates);
+  Serial.printf("Bytes in: %u, pixels streamed: %u\n",
+                (unsigned)stats.bytesIn, (unsigned)stats.pixels);
+  Serial.println("============================");
+}
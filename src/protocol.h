@@ -0,0 +1,168 @@
+/*
+ * BMO Serial Command Protocol
+ *
+ * Host control over the serial link using the shared frame format
+ * (serial_frame.h): every command frame carries a sequence number and
+ * CRC and is answered with an ACK or NAK echoing that sequence number
+ *
+ * Features:
+ * - Expression / eye state, animation and backlight commands
+ * - Image upload streamed straight into a panel address window
+ *   (bytes go from the serial RX buffer to the panel, never a frame buffer)
+ * - Duplicate detection, so retransmitted commands are not re-run
+ * - Works over any Stream (native USB CDC, UART, or a pty in host builds)
+ *
+ * Image upload:
+ *   IMAGE_BEGIN  panel(1) x(2) y(2) w(2) h(2)
+ *   IMAGE_DATA   offset(4) pixels...   offset in pixels from the window start,
+ *                                      pixels big-endian RGB565 (panel order)
+ *   IMAGE_END    -> ACK status carries nothing, stats count the pixels
+ * IMAGE_DATA pixels reach the panel before the CRC arrives. A NAK means the
+ * chunk was damaged on the way; the host resends it at the same offset and
+ * the good copy overwrites it.
+ */
+
+#ifndef BMO_PROTOCOL_H
+#define BMO_PROTOCOL_H
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "serial_frame.h"
+
+// Protocol is optional, enable with -DBMO_ENABLE_PROTOCOL=1
+#ifndef BMO_ENABLE_PROTOCOL
+#define BMO_ENABLE_PROTOCOL 0
+#endif
+
+// Buffers and limits
+#define PROTOCOL_MAX_COMMAND     16     // Largest buffered (non-image) payload
+#define PROTOCOL_MAX_PAYLOAD     4096   // Largest frame accepted at all
+#define PROTOCOL_PIXEL_BLOCK     64     // Bytes moved from serial to SPI at a time
+#define PROTOCOL_RX_BUFFER       4096   // Serial RX buffer requested at startup
+#define PROTOCOL_SERVICE_BYTES   1024   // Most input taken per service() call...
+#define PROTOCOL_SERVICE_FRAMES  4      // ...and most frames completed (posted commands)
+#define PROTOCOL_RESPONSE_SIZE   (BMO_FRAME_OVERHEAD + 4)
+
+// Command frames (host -> device), extending BMOFrameType
+enum BMOCommandType {
+  CMD_PING = 0x20,            // -> ACK
+  CMD_SET_EXPRESSION = 0x21,  // expression(1) eyeState(1), PROTOCOL_EYES_DEFAULT for its own
+  CMD_ANIMATE = 0x22,         // animation(1)
+  CMD_BACKLIGHT = 0x23,       // level(1)
+  CMD_IMAGE_BEGIN = 0x24,     // panel(1) x(2) y(2) w(2) h(2)
+  CMD_IMAGE_DATA = 0x25,      // offset(4) pixels
+  CMD_IMAGE_END = 0x26,
+
+  // Responses (device -> host)
+  FRAME_ACK = 0x30,           // seq(1) status(1)
+  FRAME_NAK = 0x31            // seq(1) error(1)
+};
+
+// CMD_SET_EXPRESSION eye state meaning "the expression's default eyes"
+#define PROTOCOL_EYES_DEFAULT    0xFF
+
+// NAK reasons
+enum BMOProtocolError {
+  PROTOCOL_OK = 0,
+  PROTOCOL_ERROR_CRC,
+  PROTOCOL_ERROR_LENGTH,
+  PROTOCOL_ERROR_UNKNOWN,
+  PROTOCOL_ERROR_ARGUMENT,
+  PROTOCOL_ERROR_BUSY,        // Event queue full, try again
+  PROTOCOL_ERROR_NO_IMAGE     // IMAGE_DATA/END without IMAGE_BEGIN
+};
+
+// Animations for CMD_ANIMATE
+enum BMOAnimation {
+  ANIMATION_BLINK = 0,
+  ANIMATION_SURPRISE,
+  ANIMATION_HEARTS,           // Needs BMO_ENABLE_PARTICLES
+  ANIMATION_FADE,             // Face fades out to black, then comes back
+  ANIMATION_COUNT
+};
+
+// Protocol statistics
+struct ProtocolStats {
+  uint32_t frames;        // Frames received with a good CRC
+  uint32_t crcErrors;
+  uint32_t naks;
+  uint32_t duplicates;    // Retransmissions acknowledged without re-running
+  uint32_t pixels;        // Pixels streamed to the panel
+  uint32_t bytesIn;
+};
+
+class BMOProtocol {
+public:
+  BMOProtocol();
+
+  // Initialization (commands other than images are posted to the event loop
+  // as EVENT_COMMAND with id = command type and param = arguments)
+  bool begin(Stream* port = &Serial);
+  void end();
+
+  // Consume the bytes that have arrived, up to PROTOCOL_SERVICE_BYTES or
+  // PROTOCOL_SERVICE_FRAMES a call, so a burst can't hold the loop; never
+  // blocks. With more left, isBusy() stays true and the sketch comes back.
+  void service();
+  bool isBusy() const;  // Unread input or an unsent response left over
+
+  // Statistics
+  const ProtocolStats& getStats() const { return stats; }
+  void printProtocolInfo();
+
+private:
+  // Receive state
+  enum RxState {
+    RX_SYNC1 = 0,
+    RX_SYNC2,
+    RX_HEADER,
+    RX_PAYLOAD,
+    RX_CRC
+  };
+
+  Stream* port;
+  bool active;
+  RxState rxState;
+  uint8_t header[4];              // type, seq, length lo, length hi
+  uint8_t headerCount;
+  uint16_t payloadLength;
+  uint16_t payloadCount;
+  uint16_t crc;                   // Running CRC over header and payload
+  uint8_t crcBytes[2];
+  uint8_t crcCount;
+  uint8_t command[PROTOCOL_MAX_COMMAND];
+  bool lastSeqValid;
+  uint8_t lastSeq;                // Last frame acknowledged
+  uint16_t lastCrc;
+
+  // Image window being uploaded
+  TFT_eSPI* tft;
+  bool imageOpen;
+  uint8_t imagePanel;
+  int16_t imageX, imageY, imageW, imageH;
+  uint32_t imageOffset;           // Next pixel of the current IMAGE_DATA frame
+  uint8_t pixelCarry;             // Odd byte waiting for its partner
+  bool hasCarry;
+  uint8_t offsetBytes[4];
+
+  // Outgoing ACK/NAK
+  uint8_t response[PROTOCOL_RESPONSE_SIZE];
+  size_t responseLength;
+  uint8_t txSeq;
+
+  ProtocolStats stats;
+
+  // Helpers
+  void receiveByte(uint8_t byte);
+  void receivePixels(size_t limit);  // At most limit bytes
+  void frameComplete(bool crcOk);
+  uint8_t executeCommand(uint8_t type, const uint8_t* payload, uint16_t length);
+  void writePixels(uint8_t* block, size_t length);  // Reuses the block as scratch
+  void queueResponse(uint8_t type, uint8_t seq, uint8_t code);
+  bool flushResponse();
+};
+
+// Global protocol instance
+extern BMOProtocol* g_bmoProtocol;
+
+#endif // BMO_PROTOCOL_H
@@ -0,0 +1,231 @@
+/*
+ * BMO QOI Image Decoder Implementation
+ *
+ * The op decoder follows the reference implementation (qoi.h), with the
+ * whole-file buffer replaced by a refilled input chunk
+ */
+
+#include "qoi.h"
+#include <string.h>
+
+// Ops (qoiformat.org): the two 8-bit tags are checked before the 2-bit ones
+#define QOI_OP_INDEX  0x00  // 00xxxxxx
+#define QOI_OP_DIFF   0x40  // 01xxxxxx
+#define QOI_OP_LUMA   0x80  // 10xxxxxx
+#define QOI_OP_RUN    0xC0  // 11xxxxxx
+#define QOI_OP_RGB    0xFE
+#define QOI_OP_RGBA   0xFF
+#define QOI_MASK_2    0xC0
+
+#define QOI_MAX_OP_BYTES  5  // QOI_OP_RGBA
+
+// Packed RGBA (r | g << 8 | b << 16 | a << 24)
+#define QOI_R(px) ((uint8_t)(px))
+#define QOI_G(px) ((uint8_t)((px) >> 8))
+#define QOI_B(px) ((uint8_t)((px) >> 16))
+#define QOI_A(px) ((uint8_t)((px) >> 24))
+#define QOI_PACK(r, g, b, a) ((uint32_t)(r) | ((uint32_t)(g) << 8) | ((uint32_t)(b) << 16) | ((uint32_t)(a) << 24))
+#define QOI_HASH(px) ((QOI_R(px) * 3 + QOI_G(px) * 5 + QOI_B(px) * 7 + QOI_A(px) * 11) & 63)
+
+BMOQoiDecoder::BMOQoiDecoder()
+  : read(nullptr)
+  , context(nullptr)
+  , info()
+  , status(QOI_ERROR_HEADER)
+  , input()
+  , inputPos(0)
+  , inputLength(0)
+  , endOfFile(true)
+  , index()
+  , pixel(0)
+  , pixel565(0)
+  , run(0)
+  , remaining(0)
+  , decoded(0)
+  , bytesRead(0)
+  , backgroundR(0)
+  , backgroundG(0)
+  , backgroundB(0)
+{
+}
+
+BMOQoiStatus BMOQoiDecoder::begin(BMOImageRead read, void* context) {
+  this->read = read;
+  this->context = context;
+  memset(&info, 0, sizeof(info));
+  memset(index, 0, sizeof(index));
+  inputPos = 0;
+  inputLength = 0;
+  endOfFile = false;
+  pixel = QOI_PACK(0, 0, 0, 255);
+  pixel565 = to565(pixel);
+  run = 0;
+  remaining = 0;
+  decoded = 0;
+  bytesRead = 0;
+  status = QOI_OK;
+
+  // "qoif", width and height big-endian, channels, colorspace
+  uint8_t header[QOI_HEADER_SIZE];
+  if (!readBytes(header, QOI_HEADER_SIZE)) {
+    if (status == QOI_OK) status = QOI_ERROR_HEADER;
+    return status;
+  }
+  if (memcmp(header, "qoif", 4) != 0 || header[12] < 3 || header[12] > 4 || header[13] > 1) {
+    status = QOI_ERROR_HEADER;
+    return status;
+  }
+  info.width = ((uint32_t)header[4] << 24) | ((uint32_t)header[5] << 16) | ((uint32_t)header[6] << 8) | header[7];
+  info.height = ((uint32_t)header[8] << 24) | ((uint32_t)header[9] << 16) | ((uint32_t)header[10] << 8) | header[11];
+  info.channels = header[12];
+  info.colorspace = header[13];
+  if (info.width == 0 || info.height == 0 || info.height > QOI_MAX_PIXELS / info.width) {
+    status = QOI_ERROR_SIZE;
+    return status;
+  }
+
+  remaining = info.width * info.height;
+  return status;
+}
+
+void BMOQoiDecoder::setBackground(uint16_t color) {
+  // Expanded to 8 bits per channel, as the image's own colors are
+  backgroundR = (uint8_t)(((color >> 11) & 0x1F) * 255 / 31);
+  backgroundG = (uint8_t)(((color >> 5) & 0x3F) * 255 / 63);
+  backgroundB = (uint8_t)((color & 0x1F) * 255 / 31);
+  pixel565 = to565(pixel);
+}
+
+uint16_t BMOQoiDecoder::to565(uint32_t rgba) const {
+  uint32_t r = QOI_R(rgba), g = QOI_G(rgba), b = QOI_B(rgba), a = QOI_A(rgba);
+  if (a != 255) {
+    r = backgroundR + (((int32_t)r - backgroundR) * (int32_t)a + 127) / 255;
+    g = backgroundG + (((int32_t)g - backgroundG) * (int32_t)a + 127) / 255;
+    b = backgroundB + (((int32_t)b - backgroundB) * (int32_t)a + 127) / 255;
+  }
+  return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+bool BMOQoiDecoder::fill() {
+  if (endOfFile) return false;
+
+  // Keep the unread tail (part of an op) in front of the new bytes
+  uint16_t kept = inputLength - inputPos;
+  if (kept && inputPos) memmove(input, input + inputPos, kept);
+  inputPos = 0;
+  inputLength = kept;
+
+  int32_t got = read(input + kept, QOI_READ_CHUNK - kept, context);
+  if (got < 0) {
+    status = QOI_ERROR_READ;
+    endOfFile = true;
+    return false;
+  }
+  if (got == 0) {
+    endOfFile = true;
+    return false;
+  }
+  inputLength += (uint16_t)got;
+  bytesRead += (uint32_t)got;
+  return true;
+}
+
+bool BMOQoiDecoder::readBytes(uint8_t* out, uint8_t count) {
+  while (inputLength - inputPos < count) {
+    if (!fill()) return false;
+  }
+  memcpy(out, input + inputPos, count);
+  inputPos += count;
+  return true;
+}
+
+uint32_t BMOQoiDecoder::decode(uint16_t* out, uint32_t count) {
+  if (status != QOI_OK) return 0;
+  if (count > remaining) count = remaining;
+
+  // Working copies of the current color
+  uint32_t px = pixel;
+  uint16_t px565 = pixel565;
+  uint32_t produced = 0;
+
+  while (produced < count) {
+    // Repeats left over from a run that filled the last call's buffer
+    if (run) {
+      uint32_t n = count - produced < run ? count - produced : run;
+      run -= n;
+      for (uint32_t i = 0; i < n; i++) out[produced++] = px565;
+      continue;
+    }
+
+    // Every op fits once the chunk holds QOI_MAX_OP_BYTES (reads may come short)
+    while (inputLength - inputPos < QOI_MAX_OP_BYTES && fill()) {
+    }
+    uint32_t available = inputLength - inputPos;
+    if (available == 0) {
+      if (status == QOI_OK) status = QOI_ERROR_TRUNCATED;
+      break;
+    }
+
+    const uint8_t* p = input + inputPos;
+    uint8_t op = p[0];
+    uint32_t used = 1;
+
+    if (op == QOI_OP_RGB) {
+      used = 4;
+      if (available >= used) px = QOI_PACK(p[1], p[2], p[3], QOI_A(px));
+    } else if (op == QOI_OP_RGBA) {
+      used = 5;
+      if (available >= used) px = QOI_PACK(p[1], p[2], p[3], p[4]);
+    } else if ((op & QOI_MASK_2) == QOI_OP_INDEX) {
+      px = index[op];
+    } else if ((op & QOI_MASK_2) == QOI_OP_DIFF) {
+      uint8_t r = QOI_R(px) + ((op >> 4) & 0x03) - 2;
+      uint8_t g = QOI_G(px) + ((op >> 2) & 0x03) - 2;
+      uint8_t b = QOI_B(px) + (op & 0x03) - 2;
+      px = QOI_PACK(r, g, b, QOI_A(px));
+    } else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+      used = 2;
+      if (available >= used) {
+        int dg = (op & 0x3F) - 32;
+        uint8_t r = QOI_R(px) + dg - 8 + (p[1] >> 4);
+        uint8_t g = QOI_G(px) + dg;
+        uint8_t b = QOI_B(px) + dg - 8 + (p[1] & 0x0F);
+        px = QOI_PACK(r, g, b, QOI_A(px));
+      }
+    } else {
+      // Run of the current color: this pixel and (op & 0x3F) more
+      run = op & 0x3F;
+    }
+
+    if (available < used) {
+      if (status == QOI_OK) status = QOI_ERROR_TRUNCATED;
+      break;
+    }
+    inputPos += used;
+
+    // The reference decoder indexes after every op, runs included
+    index[QOI_HASH(px)] = px;
+    if (px != pixel) {
+      pixel = px;
+      px565 = to565(px);
+    }
+    out[produced++] = px565;
+  }
+
+  pixel = px;
+  pixel565 = px565;
+  remaining -= produced;
+  decoded += produced;
+  return produced;
+}
+
+const char* BMOQoiDecoder::statusName(BMOQoiStatus status) {
+  switch (status) {
+    case QOI_OK:              return "ok";
+    case QOI_ERROR_READ:      return "read error";
+    case QOI_ERROR_HEADER:    return "not a QOI file";
+    case QOI_ERROR_SIZE:      return "bad dimensions";
+    case QOI_ERROR_TRUNCATED: return "truncated";
+  }
+  return "unknown";
+}
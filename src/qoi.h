@@ -0,0 +1,92 @@
+/*
+ * BMO QOI Image Decoder
+ *
+ * Streaming decoder for QOI ("Quite OK Image", qoiformat.org) files, so
+ * faces and screens can ship as image files on flash (see
+ * BMOGraphics::drawImage() and tools/qoi_encode.py)
+ *
+ * Features:
+ * - Input pulled through a read callback in small chunks
+ * - Output as RGB565, any number of pixels per call (a band of rows)
+ * - Fixed memory: the read chunk and the 64-entry color index, whatever the
+ *   image size
+ * - Alpha blended over a background color
+ * - Truncated or corrupt files stop with an error, never read past the buffer
+ * - No Arduino dependencies, so tools/qoi_bench.cpp builds it on the host
+ */
+
+#ifndef BMO_QOI_H
+#define BMO_QOI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define QOI_READ_CHUNK    256        // Input bytes fetched per read callback
+#define QOI_HEADER_SIZE   14
+#define QOI_MAX_PIXELS    (4096u * 4096u)  // Sanity limit for the header
+
+// Reads up to length bytes; returns the count, 0 at end of file, < 0 on error
+typedef int32_t (*BMOImageRead)(uint8_t* buffer, uint32_t length, void* context);
+
+enum BMOQoiStatus {
+  QOI_OK = 0,
+  QOI_ERROR_READ,       // The read callback failed
+  QOI_ERROR_HEADER,     // Not a QOI file
+  QOI_ERROR_SIZE,       // Zero or absurd dimensions
+  QOI_ERROR_TRUNCATED   // The data ended before the last pixel
+};
+
+struct BMOQoiInfo {
+  uint32_t width;
+  uint32_t height;
+  uint8_t channels;     // 3 = RGB, 4 = RGBA
+  uint8_t colorspace;   // 0 = sRGB, 1 = linear (informational only)
+};
+
+class BMOQoiDecoder {
+public:
+  BMOQoiDecoder();
+
+  // Reads the header; pixels follow with decode()
+  BMOQoiStatus begin(BMOImageRead read, void* context);
+  const BMOQoiInfo& getInfo() const { return info; }
+
+  // Color under transparent pixels (RGB565, default black)
+  void setBackground(uint16_t color);
+
+  // Up to count pixels in raster order; fewer only at the end of the image
+  // or on an error (see getStatus())
+  uint32_t decode(uint16_t* out, uint32_t count);
+  bool isDone() const { return remaining == 0 || status != QOI_OK; }
+
+  BMOQoiStatus getStatus() const { return status; }
+  static const char* statusName(BMOQoiStatus status);
+  uint32_t getBytesRead() const { return bytesRead; }
+  uint32_t getPixelsDecoded() const { return decoded; }
+
+private:
+  BMOImageRead read;
+  void* context;
+  BMOQoiInfo info;
+  BMOQoiStatus status;
+
+  uint8_t input[QOI_READ_CHUNK];
+  uint16_t inputPos;
+  uint16_t inputLength;
+  bool endOfFile;
+
+  uint32_t index[64];       // Previously seen colors, RGBA packed as r | g << 8 | b << 16 | a << 24
+  uint32_t pixel;           // Current color, packed the same way
+  uint16_t pixel565;        // ...and as it is written out
+  uint8_t run;              // Repeats of pixel still owed
+  uint32_t remaining;       // Pixels left in the image
+  uint32_t decoded;
+  uint32_t bytesRead;
+  uint8_t backgroundR, backgroundG, backgroundB;
+
+  bool fill();              // Refill input; false at end of file or error
+  bool readBytes(uint8_t* out, uint8_t count);
+  uint16_t to565(uint32_t rgba) const;
+};
+
+#endif // BMO_QOI_H
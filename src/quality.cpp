@@ -0,0 +1,177 @@
+/*
+ * BMO Quality Governor Implementation
+ */
+
+#include "quality.h"
+#include "path.h"
+
+// Global governor instance
+BMOQualityGovernor* g_bmoQuality = nullptr;
+
+// Cheapest first. Coarser curves lose segments (Wang's formula scales with
+// 1/sqrt(tolerance)), hard-edged eyes skip the blend and the root, a sparser
+// gradient draws fewer lines, fewer particles repaint fewer rects.
+static const BMOQualitySettings QUALITY_TABLE[QUALITY_LEVELS] = {
+  { PATH_TOLERANCE * 8, false, 0,  64 },
+  { PATH_TOLERANCE * 4, false, 16, 128 },
+  { PATH_TOLERANCE * 2, true,  8,  192 },
+  { PATH_TOLERANCE,     true,  4,  256 }
+};
+
+BMOQualityGovernor::BMOQualityGovernor()
+  : active(false)
+  , budgetUs(QUALITY_BUDGET_US)
+  , level(QUALITY_LEVELS - 1)
+  , overRun(0)
+  , underRun(0)
+  , settle(0)
+  , frameRenderUs(0)
+  , frameFlushUs(0)
+  , frameDrawn(false)
+  , lastChange()
+  , listener(nullptr)
+  , listenerContext(nullptr)
+{
+  resetStats();
+}
+
+void BMOQualityGovernor::begin(uint32_t budgetUs) {
+  setBudget(budgetUs);
+  level = QUALITY_LEVELS - 1;
+  overRun = 0;
+  underRun = 0;
+  settle = 0;
+  frameRenderUs = 0;
+  frameFlushUs = 0;
+  frameDrawn = false;
+  memset(&lastChange, 0, sizeof(lastChange));
+  lastChange.from = lastChange.to = level;
+  resetStats();
+
+  active = true;
+  g_bmoQuality = this;
+  Serial.printf("Quality governor ready (%u us budget, %d levels)\n", (unsigned)this->budgetUs, QUALITY_LEVELS);
+}
+
+void BMOQualityGovernor::end() {
+  if (active) {
+    active = false;
+    g_bmoQuality = nullptr;
+    Serial.println("Quality governor stopped");
+  }
+}
+
+const BMOQualitySettings& BMOQualityGovernor::settingsFor(uint8_t level) {
+  return QUALITY_TABLE[level < QUALITY_LEVELS ? level : QUALITY_LEVELS - 1];
+}
+
+const BMOQualitySettings& BMOQualityGovernor::getSettings() const {
+  // Full quality while stopped
+  return settingsFor(active ? level : QUALITY_LEVELS - 1);
+}
+
+void BMOQualityGovernor::recordFrame(uint32_t renderUs, uint32_t flushUs) {
+  if (!active) return;
+
+  uint32_t frameUs = renderUs + flushUs;
+  stats.frames++;
+  stats.renderTime.record(renderUs);
+  stats.flushTime.record(flushUs);
+  if (frameUs > budgetUs) stats.overBudget++;
+
+  // Layers pick a new level up as they are redrawn; judge it once they have
+  if (settle > 0) {
+    settle--;
+    return;
+  }
+
+  if (frameUs > budgetUs) {
+    underRun = 0;
+    if (overRun < QUALITY_DOWN_FRAMES) overRun++;
+    if (overRun >= QUALITY_DOWN_FRAMES && level > 0) {
+      change(level - 1, QUALITY_REASON_OVER_BUDGET, frameUs);
+    }
+  } else if ((uint64_t)frameUs * 100 < (uint64_t)budgetUs * QUALITY_UP_PERCENT) {
+    overRun = 0;
+    if (underRun < QUALITY_UP_FRAMES) underRun++;
+    if (underRun >= QUALITY_UP_FRAMES && level < QUALITY_LEVELS - 1) {
+      change(level + 1, QUALITY_REASON_UNDER_BUDGET, frameUs);
+    }
+  } else {
+    // Inside the band between the thresholds: hold
+    overRun = 0;
+    underRun = 0;
+  }
+}
+
+void BMOQualityGovernor::addTime(uint32_t renderUs, uint32_t flushUs) {
+  frameRenderUs += renderUs;
+  frameFlushUs += flushUs;
+  frameDrawn = true;
+}
+
+void BMOQualityGovernor::endFrame() {
+  // A tick that drew nothing isn't a frame, fast or slow
+  if (!frameDrawn) return;
+  recordFrame(frameRenderUs, frameFlushUs);
+  frameRenderUs = 0;
+  frameFlushUs = 0;
+  frameDrawn = false;
+}
+
+void BMOQualityGovernor::setLevel(uint8_t newLevel) {
+  if (newLevel >= QUALITY_LEVELS) newLevel = QUALITY_LEVELS - 1;
+  if (newLevel != level) change(newLevel, QUALITY_REASON_MANUAL, 0);
+}
+
+void BMOQualityGovernor::change(uint8_t newLevel, BMOQualityReason reason, uint32_t frameUs) {
+  lastChange.timestamp = millis();
+  lastChange.from = level;
+  lastChange.to = newLevel;
+  lastChange.reason = reason;
+  lastChange.frameUs = frameUs;
+  lastChange.budgetUs = budgetUs;
+
+  if (newLevel < level) stats.stepsDown++;
+  else stats.stepsUp++;
+  level = newLevel;
+  overRun = 0;
+  underRun = 0;
+  settle = QUALITY_SETTLE_FRAMES;
+
+  if (listener) listener(lastChange, listenerContext);
+}
+
+void BMOQualityGovernor::setListener(BMOQualityListener listener, void* context) {
+  this->listener = listener;
+  listenerContext = context;
+}
+
+const char* BMOQualityGovernor::reasonName(BMOQualityReason reason) {
+  switch (reason) {
+    case QUALITY_REASON_NONE:         return "none";
+    case QUALITY_REASON_OVER_BUDGET:  return "over budget";
+    case QUALITY_REASON_UNDER_BUDGET: return "under budget";
+    case QUALITY_REASON_MANUAL:       return "manual";
+  }
+  return "unknown";
+}
+
+void BMOQualityGovernor::printQualityInfo() {
+  const BMOQualitySettings& settings = getSettings();
+  Serial.println("=== BMO Quality Governor ===");
+  Serial.printf("Status: %s, level %u of %d, budget %u us\n", active ? "Active" : "Inactive",
+                level, QUALITY_LEVELS - 1, (unsigned)budgetUs);
+  Serial.printf("Knobs: curve tolerance %u/16 px, anti-aliasing %s, gradient step %u (0 = flat), particles %u/256\n",
+                settings.curveTolerance, settings.antiAlias ? "on" : "off", settings.gradientStep,
+                settings.effectDensity);
+  Serial.printf("Frames: %u, over budget: %u, steps down: %u, up: %u\n", (unsigned)stats.frames,
+                (unsigned)stats.overBudget, (unsigned)stats.stepsDown, (unsigned)stats.stepsUp);
+  if (lastChange.reason != QUALITY_REASON_NONE) {
+    Serial.printf("Last change: %u -> %u at %u ms, %s (%u us frame)\n", lastChange.from, lastChange.to,
+                  (unsigned)lastChange.timestamp, reasonName(lastChange.reason), (unsigned)lastChange.frameUs);
+  }
+  stats.renderTime.print("Render time");
+  stats.flushTime.print("Flush time");
+  Serial.println("============================");
+}
@@ -0,0 +1,133 @@
+/*
+ * BMO Quality Governor
+ *
+ * Holds the frame budget when animations stack up (a blink during an
+ * expression change, particles on top of a gaze) by trading detail for time
+ *
+ * Features:
+ * - Render and flush time measured per frame against a budget; draw calls
+ *   add their time as they go and the loop closes the frame once per tick
+ * - Quality levels stepped down after a run of frames over budget and back
+ *   up after a longer run comfortably under it (hysteresis, plus a settling
+ *   period after each change)
+ * - Knobs per level: curve flattening (segments per curve), anti-aliased
+ *   eyes, background gradient resolution and particle density
+ * - The current level and the reason for each change are exposed, and a
+ *   listener hears about every change
+ *
+ * BMOGraphicsT feeds it (setGovernor()) and applies the knobs to each layer
+ * the next time that layer is drawn whole, so partial repaints always match
+ * what is on screen
+ */
+
+#ifndef BMO_QUALITY_H
+#define BMO_QUALITY_H
+
+#include <Arduino.h>
+#include "display.h"
+
+// The governor is optional, enable with -DBMO_ENABLE_QUALITY=1 (without it
+// everything renders at full quality)
+#ifndef BMO_ENABLE_QUALITY
+#define BMO_ENABLE_QUALITY 0
+#endif
+
+#define QUALITY_LEVELS         4       // 0 = cheapest ... QUALITY_LEVELS - 1 = full
+#define QUALITY_BUDGET_US      16667   // One frame at 60 fps (GAZE_FPS)
+#define QUALITY_DOWN_FRAMES    3       // Frames over budget in a row before stepping down
+#define QUALITY_UP_FRAMES      60      // Frames under QUALITY_UP_PERCENT in a row before stepping up
+#define QUALITY_UP_PERCENT     60      // Of the budget
+#define QUALITY_SETTLE_FRAMES  10      // Frames ignored after a change, while layers catch up
+
+// What one level costs; see QUALITY_TABLE in quality.cpp
+struct BMOQualitySettings {
+  uint16_t curveTolerance;  // Path flattening tolerance, 1/16 px (PATH_TOLERANCE at full)
+  bool antiAlias;           // Eyes with soft edges
+  uint8_t gradientStep;     // Background gradient on every Nth row, 0 = flat teal
+  uint16_t effectDensity;   // Particles, of 256
+};
+
+enum BMOQualityReason {
+  QUALITY_REASON_NONE = 0,
+  QUALITY_REASON_OVER_BUDGET,   // Frames kept missing the budget
+  QUALITY_REASON_UNDER_BUDGET,  // Frames kept well inside it
+  QUALITY_REASON_MANUAL         // setLevel()
+};
+
+struct BMOQualityChange {
+  uint32_t timestamp;       // millis()
+  uint8_t from;
+  uint8_t to;
+  BMOQualityReason reason;
+  uint32_t frameUs;         // Render + flush of the frame that triggered it
+  uint32_t budgetUs;
+};
+
+typedef void (*BMOQualityListener)(const BMOQualityChange& change, void* context);
+
+// Governor metrics (see getStats())
+struct BMOQualityStats {
+  uint32_t frames;
+  uint32_t overBudget;      // Frames that missed the budget
+  uint32_t stepsDown;
+  uint32_t stepsUp;
+  BMOHistogram renderTime;  // Drawing, per frame
+  BMOHistogram flushTime;   // Waiting for the bus to finish, per frame
+};
+
+class BMOQualityGovernor {
+public:
+  BMOQualityGovernor();
+
+  void begin(uint32_t budgetUs = QUALITY_BUDGET_US);
+  void end();
+  bool isActive() const { return active; }
+
+  // One rendered frame: drawing time, and time spent waiting for the bus
+  void recordFrame(uint32_t renderUs, uint32_t flushUs);
+
+  // A frame built up from its draw calls: addTime() from each, then
+  // endFrame() once per loop tick records the sum (nothing if nothing drew)
+  void addTime(uint32_t renderUs, uint32_t flushUs);
+  void endFrame();
+
+  // Budget and level
+  void setBudget(uint32_t budgetUs) { this->budgetUs = budgetUs ? budgetUs : 1; }
+  uint32_t getBudget() const { return budgetUs; }
+  uint8_t getLevel() const { return level; }
+  void setLevel(uint8_t newLevel);  // Manual override; adapting carries on from it
+  const BMOQualitySettings& getSettings() const;
+  static const BMOQualitySettings& settingsFor(uint8_t level);
+  static const char* reasonName(BMOQualityReason reason);
+
+  // Changes
+  void setListener(BMOQualityListener listener, void* context);
+  const BMOQualityChange& getLastChange() const { return lastChange; }
+
+  // Statistics
+  const BMOQualityStats& getStats() const { return stats; }
+  void resetStats() { memset(&stats, 0, sizeof(stats)); }
+  void printQualityInfo();
+
+private:
+  bool active;
+  uint32_t budgetUs;
+  uint8_t level;
+  uint8_t overRun;          // Consecutive frames over budget
+  uint8_t underRun;         // Consecutive frames under the step-up threshold
+  uint8_t settle;           // Frames left to ignore
+  uint32_t frameRenderUs;   // Added since the last endFrame()
+  uint32_t frameFlushUs;
+  bool frameDrawn;
+  BMOQualityChange lastChange;
+  BMOQualityListener listener;
+  void* listenerContext;
+  BMOQualityStats stats;
+
+  void change(uint8_t newLevel, BMOQualityReason reason, uint32_t frameUs);
+};
+
+// Global governor instance
+extern BMOQualityGovernor* g_bmoQuality;
+
+#endif // BMO_QUALITY_H
@@ -0,0 +1,35 @@
+/*
+ * BMO Serial Framing Implementation
+ *
+ * Frame sealing and checksums shared by all binary serial features
+ */
+
+#include "serial_frame.h"
+
+uint16_t bmoCrc16(const uint8_t* data, size_t length, uint16_t crc) {
+  // Bitwise CRC - frames are small and this keeps the table out of RAM
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t bmoFrameSeal(uint8_t* buffer, uint8_t type, uint8_t seq, uint16_t payloadLength) {
+  buffer[0] = BMO_FRAME_SYNC1;
+  buffer[1] = BMO_FRAME_SYNC2;
+  buffer[2] = type;
+  buffer[3] = seq;
+  buffer[4] = (uint8_t)(payloadLength & 0xFF);
+  buffer[5] = (uint8_t)(payloadLength >> 8);
+
+  // CRC covers everything after the sync bytes
+  uint16_t crc = bmoCrc16(buffer + 2, BMO_FRAME_HEADER_SIZE - 2 + payloadLength);
+  size_t crcOffset = BMO_FRAME_HEADER_SIZE + payloadLength;
+  buffer[crcOffset] = (uint8_t)(crc & 0xFF);
+  buffer[crcOffset + 1] = (uint8_t)(crc >> 8);
+
+  return crcOffset + BMO_FRAME_CRC_SIZE;
+}
@@ -0,0 +1,45 @@
+/*
+ * BMO Serial Framing
+ *
+ * Shared packet format for binary traffic on the debug serial link
+ * Binary frames can be interleaved with the normal text debug output;
+ * receivers resynchronise on the sync bytes and drop frames with bad CRCs
+ *
+ * Frame layout (little-endian):
+ *   [0]    0xB0         Sync 1
+ *   [1]    0x4D         Sync 2
+ *   [2]    type         BMOFrameType
+ *   [3]    seq          Rolling sequence number
+ *   [4-5]  length       Payload length
+ *   [6..]  payload
+ *   [+0-1] crc          CRC-16/CCITT-FALSE over type, seq, length and payload
+ */
+
+#ifndef BMO_SERIAL_FRAME_H
+#define BMO_SERIAL_FRAME_H
+
+#include <Arduino.h>
+
+// Frame constants
+#define BMO_FRAME_SYNC1         0xB0
+#define BMO_FRAME_SYNC2         0x4D
+#define BMO_FRAME_HEADER_SIZE   6
+#define BMO_FRAME_CRC_SIZE      2
+#define BMO_FRAME_OVERHEAD      (BMO_FRAME_HEADER_SIZE + BMO_FRAME_CRC_SIZE)
+
+// Frame types
+enum BMOFrameType {
+  // Display mirroring (device -> host)
+  FRAME_MIRROR_HELLO = 0x10,    // width(2) height(2) tileSize(1)
+  FRAME_MIRROR_TILE = 0x11,     // tileX(1) tileY(1) encoding(1) data
+  FRAME_MIRROR_FRAME_END = 0x12 // scan(4)
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t bmoCrc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+// Write header and CRC around a payload already placed at
+// buffer + BMO_FRAME_HEADER_SIZE. Returns the total frame size.
+size_t bmoFrameSeal(uint8_t* buffer, uint8_t type, uint8_t seq, uint16_t payloadLength);
+
+#endif // BMO_SERIAL_FRAME_H
@@ -0,0 +1,353 @@
+/*
+ * BMO Shape Span Tables
+ *
+ * The face is made of the same few shapes at fixed positions, so they are
+ * rasterized once at compile time into per-scanline spans. Drawing a shape
+ * is then a tight loop of horizontal fills - no float, no trigonometry.
+ *
+ * The compile-time rasterizer reproduces TFT_eSPI's own primitives
+ * (drawLine, fillEllipse, drawRoundRect, fillRect), so the tables paint
+ * exactly the pixels the original primitive calls did - tools/shapes_check.cpp
+ * compares the two on the host for every panel profile.
+ *
+ * Tables (relative to the shape's usual draw origin):
+ * - Smile (happy mouth) and excited grin with teeth
+ * - Surprised mouth ellipse
+ * - Half-closed eye
+ * - Rounded frame (one corner; drawn with 4-way symmetry)
+ */
+
+#ifndef BMO_SHAPES_H
+#define BMO_SHAPES_H
+
+#include <Arduino.h>
+#include "panel.h"
+
+// One run of a single color on one scanline
+struct BMOSpan {
+  int16_t y;       // Row, relative to the shape origin
+  int16_t x0;      // First pixel (inclusive)
+  int16_t x1;      // Last pixel (inclusive)
+  uint16_t color;  // RGB565
+};
+
+// Compile-time span table, with the bounds of its spans (inclusive) for
+// trivial rejection against a clip rectangle
+template <int N>
+struct BMOSpanTable {
+  static constexpr int COUNT = N;
+  BMOSpan spans[N];
+  int16_t left, top, right, bottom;
+};
+
+/*
+ * Small constexpr canvas used only while building tables
+ * Ports of the TFT_eSPI primitives write into it pixel by pixel
+ */
+template <int W, int H>
+struct BMOShapeCanvas {
+  static constexpr int WIDTH = W;
+  static constexpr int HEIGHT = H;
+
+  int originX;            // Canvas position of shape coordinate (0, 0)
+  int originY;
+  int clipped;            // Pixels that fell outside the canvas
+  bool painted[H][W];
+  uint16_t color[H][W];
+
+  constexpr BMOShapeCanvas(int ox, int oy)
+    : originX(ox), originY(oy), clipped(0), painted{}, color{} {}
+
+  constexpr void plot(int x, int y, uint16_t c) {
+    x += originX;
+    y += originY;
+    if (x < 0 || y < 0 || x >= W || y >= H) {
+      clipped++;
+      return;
+    }
+    painted[y][x] = true;
+    color[y][x] = c;
+  }
+
+  constexpr void hline(int x, int y, int w, uint16_t c) {
+    for (int i = 0; i < w; i++) plot(x + i, y, c);
+  }
+
+  constexpr void vline(int x, int y, int h, uint16_t c) {
+    for (int i = 0; i < h; i++) plot(x, y + i, c);
+  }
+
+  constexpr void fillRect(int x, int y, int w, int h, uint16_t c) {
+    for (int j = 0; j < h; j++) hline(x, y + j, w, c);
+  }
+
+  // TFT_eSPI::drawLine (Bresenham, steep lines transposed)
+  constexpr void line(int x0, int y0, int x1, int y1, uint16_t c) {
+    bool steep = (y1 > y0 ? y1 - y0 : y0 - y1) > (x1 > x0 ? x1 - x0 : x0 - x1);
+    if (steep) {
+      int t = x0; x0 = y0; y0 = t;
+      t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+      int t = x0; x0 = x1; x1 = t;
+      t = y0; y0 = y1; y1 = t;
+    }
+    int dx = x1 - x0;
+    int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+    int err = dx >> 1;
+    int ystep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) plot(y0, x0, c);
+      else plot(x0, y0, c);
+      err -= dy;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+
+  // BMOGraphics::drawThickLine
+  constexpr void thickLine(int x1, int y1, int x2, int y2, int thickness, uint16_t c) {
+    for (int i = 0; i < thickness; i++) {
+      for (int j = 0; j < thickness; j++) {
+        line(x1 + i - thickness / 2, y1 + j - thickness / 2,
+             x2 + i - thickness / 2, y2 + j - thickness / 2, c);
+      }
+    }
+  }
+
+  // BMOGraphics::drawCurve (upward smile, 20 segments, 3px pen)
+  constexpr void curve(int width, int height, uint16_t c) {
+    int segments = 20;
+    int startX = -width / 2;
+    int segmentWidth = width / segments;
+    for (int i = 0; i < segments; i++) {
+      int x1 = startX + (i * segmentWidth);
+      int x2 = startX + ((i + 1) * segmentWidth);
+      float t1 = (float)x1 / (width / 2);
+      float t2 = (float)x2 / (width / 2);
+      int y1 = (int)(height * (1 - t1 * t1));
+      int y2 = (int)(height * (1 - t2 * t2));
+      thickLine(x1, y1, x2, y2, 3, c);
+    }
+  }
+
+  // TFT_eSPI::fillEllipse (midpoint, two regions)
+  constexpr void fillEllipse(int x0, int y0, int rx, int ry, uint16_t c) {
+    if (rx < 2 || ry < 2) return;
+    int rx2 = rx * rx;
+    int ry2 = ry * ry;
+    int fx2 = 4 * rx2;
+    int fy2 = 4 * ry2;
+    int x = 0;
+    int y = ry;
+    int s = 2 * ry2 + rx2 * (1 - 2 * ry);
+    for (; ry2 * x <= rx2 * y; x++) {
+      hline(x0 - x, y0 - y, x + x + 1, c);
+      hline(x0 - x, y0 + y, x + x + 1, c);
+      if (s >= 0) {
+        s += fx2 * (1 - y);
+        y--;
+      }
+      s += ry2 * ((4 * x) + 6);
+    }
+    x = rx;
+    y = 0;
+    s = 2 * rx2 + ry2 * (1 - 2 * rx);
+    for (; rx2 * y <= ry2 * x; y++) {
+      hline(x0 - x, y0 - y, x + x + 1, c);
+      hline(x0 - x, y0 + y, x + x + 1, c);
+      if (s >= 0) {
+        s += fy2 * (1 - x);
+        x--;
+      }
+      s += rx2 * ((4 * y) + 6);
+    }
+  }
+
+  // TFT_eSPI::drawCircleHelper (run-length corner arcs)
+  constexpr void circleHelper(int x0, int y0, int rr, int corner, uint16_t c) {
+    if (rr <= 0) return;
+    int f = 1 - rr;
+    int ddF_x = 1;
+    int ddF_y = -2 * rr;
+    int xe = 0;
+    int xs = 0;
+    while (xe < rr--) {
+      while (f < 0) {
+        ++xe;
+        f += (ddF_x += 2);
+      }
+      f += (ddF_y += 2);
+
+      if (xe - xs == 1) {
+        if (corner & 0x1) { plot(x0 - xe, y0 - rr, c); plot(x0 - rr, y0 - xe, c); }
+        if (corner & 0x2) { plot(x0 + rr, y0 - xe, c); plot(x0 + xs + 1, y0 - rr, c); }
+        if (corner & 0x4) { plot(x0 + xs + 1, y0 + rr, c); plot(x0 + rr, y0 + xs + 1, c); }
+        if (corner & 0x8) { plot(x0 - rr, y0 + xs + 1, c); plot(x0 - xe, y0 + rr, c); }
+      } else {
+        int len = xe - xs++;
+        if (corner & 0x1) { hline(x0 - xe, y0 - rr, len, c); vline(x0 - rr, y0 - xe, len, c); }
+        if (corner & 0x2) { vline(x0 + rr, y0 - xe, len, c); hline(x0 + xs, y0 - rr, len, c); }
+        if (corner & 0x4) { hline(x0 + xs, y0 + rr, len, c); vline(x0 + rr, y0 + xs, len, c); }
+        if (corner & 0x8) { vline(x0 - rr, y0 + xs, len, c); hline(x0 - xe, y0 + rr, len, c); }
+      }
+      xs = xe;
+    }
+  }
+
+  // TFT_eSPI::drawRoundRect
+  constexpr void roundRect(int x, int y, int w, int h, int r, uint16_t c) {
+    hline(x + r, y, w - r - r, c);
+    hline(x + r, y + h - 1, w - r - r, c);
+    vline(x, y + r, h - r - r, c);
+    vline(x + w - 1, y + r, h - r - r, c);
+    circleHelper(x + r, y + r, r, 1, c);
+    circleHelper(x + w - r - 1, y + r, r, 2, c);
+    circleHelper(x + w - r - 1, y + h - r - 1, r, 4, c);
+    circleHelper(x + r, y + h - r - 1, r, 8, c);
+  }
+
+  // Number of same-color runs (the table size), optionally for a single row
+  constexpr int countSpans(int onlyRow = -1) const {
+    int count = 0;
+    for (int y = 0; y < H; y++) {
+      if (onlyRow >= 0 && y != onlyRow) continue;
+      for (int x = 0; x < W; x++) {
+        if (painted[y][x] && (x == 0 || !painted[y][x - 1] || color[y][x - 1] != color[y][x])) {
+          count++;
+        }
+      }
+    }
+    return count;
+  }
+
+  // Runs converted to spans in shape coordinates, top to bottom
+  template <int N>
+  constexpr BMOSpanTable<N> toSpans(int onlyRow = -1) const {
+    BMOSpanTable<N> table{};
+    int n = 0;
+    for (int y = 0; y < H; y++) {
+      if (onlyRow >= 0 && y != onlyRow) continue;
+      int x = 0;
+      while (x < W) {
+        if (!painted[y][x]) {
+          x++;
+          continue;
+        }
+        int start = x;
+        uint16_t c = color[y][x];
+        while (x < W && painted[y][x] && color[y][x] == c) x++;
+        table.spans[n].y = (int16_t)(y - originY);
+        table.spans[n].x0 = (int16_t)(start - originX);
+        table.spans[n].x1 = (int16_t)(x - 1 - originX);
+        table.spans[n].color = c;
+        if (n == 0 || table.spans[n].x0 < table.left) table.left = table.spans[n].x0;
+        if (n == 0 || table.spans[n].x1 > table.right) table.right = table.spans[n].x1;
+        if (n == 0) table.top = table.spans[n].y;
+        table.bottom = table.spans[n].y;
+        n++;
+      }
+    }
+    return table;
+  }
+};
+
+/*
+ * Span tables for one panel profile
+ * Sizes come from BMOFaceGeometry, so every panel gets its own exact tables
+ */
+template <class Panel>
+struct BMOShapeTables {
+  typedef BMOFaceGeometry<Panel> Face;
+
+  // Palette (kept local so this header doesn't depend on graphics.h)
+  static constexpr uint16_t BLACK = 0x0000;
+  static constexpr uint16_t WHITE = 0xFFFF;
+  static constexpr uint16_t TEAL = 0x4E6D;
+  static constexpr uint16_t DARK_TEAL = 0x2945;
+  static constexpr uint16_t LIGHT_TEAL = 0x6EDD;
+
+  // --- Smile: drawCurve(MOUTH_WIDTH, MOUTH_HEIGHT) ---
+  static constexpr int SMILE_W = Face::MOUTH_WIDTH + 8;
+  static constexpr int SMILE_H = Face::MOUTH_HEIGHT + 8;
+  typedef BMOShapeCanvas<SMILE_W, SMILE_H> SmileCanvas;
+  static constexpr SmileCanvas smileCanvas() {
+    SmileCanvas canvas(SMILE_W / 2, 4);
+    canvas.curve(Face::MOUTH_WIDTH, Face::MOUTH_HEIGHT, BLACK);
+    return canvas;
+  }
+  static constexpr SmileCanvas SMILE_CANVAS = smileCanvas();
+  static_assert(SMILE_CANVAS.clipped == 0, "smile canvas too small");
+  static constexpr auto SMILE = SMILE_CANVAS.template toSpans<SMILE_CANVAS.countSpans()>();
+
+  // --- Excited grin: wider, deeper curve plus four teeth ---
+  static constexpr int GRIN_WIDTH = Face::MOUTH_WIDTH + Face::scale(20);
+  static constexpr int GRIN_HEIGHT = Face::MOUTH_HEIGHT + Face::scale(10);
+  static constexpr int GRIN_W = GRIN_WIDTH + 8;
+  static constexpr int GRIN_H = GRIN_HEIGHT + 8;
+  typedef BMOShapeCanvas<GRIN_W, GRIN_H> GrinCanvas;
+  static constexpr GrinCanvas grinCanvas() {
+    GrinCanvas canvas(GRIN_W / 2, 4);
+    canvas.curve(GRIN_WIDTH, GRIN_HEIGHT, BLACK);
+    for (int i = 0; i < 4; i++) {
+      canvas.fillRect(-Face::scale(20) + (i * Face::scale(13)), Face::scale(8),
+                      Face::scale(3), Face::scale(8), WHITE);
+    }
+    return canvas;
+  }
+  static constexpr GrinCanvas GRIN_CANVAS = grinCanvas();
+  static_assert(GRIN_CANVAS.clipped == 0, "grin canvas too small");
+  static constexpr auto GRIN = GRIN_CANVAS.template toSpans<GRIN_CANVAS.countSpans()>();
+
+  // --- Surprised mouth: black ellipse with teal interior ---
+  static constexpr int SURPRISED_W = 2 * Face::scale(15) + 3;
+  static constexpr int SURPRISED_H = 2 * Face::scale(20) + 3;
+  typedef BMOShapeCanvas<SURPRISED_W, SURPRISED_H> SurprisedCanvas;
+  static constexpr SurprisedCanvas surprisedCanvas() {
+    SurprisedCanvas canvas(SURPRISED_W / 2, SURPRISED_H / 2);
+    canvas.fillEllipse(0, 0, Face::scale(15), Face::scale(20), BLACK);
+    canvas.fillEllipse(0, 0, Face::scale(10), Face::scale(15), TEAL);
+    return canvas;
+  }
+  static constexpr SurprisedCanvas SURPRISED_CANVAS = surprisedCanvas();
+  static_assert(SURPRISED_CANVAS.clipped == 0, "surprised canvas too small");
+  static constexpr auto SURPRISED = SURPRISED_CANVAS.template toSpans<SURPRISED_CANVAS.countSpans()>();
+
+  // --- Half-closed eye: EYE_RADIUS x EYE_RADIUS/2 ellipse ---
+  static constexpr int HALF_EYE_W = 2 * Face::EYE_RADIUS + 3;
+  static constexpr int HALF_EYE_H = Face::EYE_RADIUS + 3;
+  typedef BMOShapeCanvas<HALF_EYE_W, HALF_EYE_H> HalfEyeCanvas;
+  static constexpr HalfEyeCanvas halfEyeCanvas() {
+    HalfEyeCanvas canvas(HALF_EYE_W / 2, HALF_EYE_H / 2);
+    canvas.fillEllipse(0, 0, Face::EYE_RADIUS, Face::EYE_RADIUS / 2, BLACK);
+    return canvas;
+  }
+  static constexpr HalfEyeCanvas HALF_EYE_CANVAS = halfEyeCanvas();
+  static_assert(HALF_EYE_CANVAS.clipped == 0, "half-eye canvas too small");
+  static constexpr auto HALF_EYE = HALF_EYE_CANVAS.template toSpans<HALF_EYE_CANVAS.countSpans()>();
+
+  // --- Frame: top-left corner of the nested rounded rectangles ---
+  // Spans reaching the corner's right edge are the straight top/bottom lines;
+  // the corner's last row is the straight left/right edge pattern.
+  static constexpr int FRAME_CORNER = Face::FRAME_THICKNESS + Face::FRAME_CORNER_RADIUS + 1;
+  typedef BMOShapeCanvas<FRAME_CORNER, FRAME_CORNER> FrameCanvas;
+  static constexpr FrameCanvas frameCanvas() {
+    FrameCanvas canvas(0, 0);
+    for (int i = 0; i < Face::FRAME_THICKNESS; i++) {
+      canvas.roundRect(i, i, Panel::WIDTH - (i * 2), Panel::HEIGHT - (i * 2),
+                       Face::FRAME_CORNER_RADIUS, DARK_TEAL);
+    }
+    canvas.roundRect(Face::FRAME_THICKNESS, Face::FRAME_THICKNESS,
+                     Panel::WIDTH - (Face::FRAME_THICKNESS * 2), Panel::HEIGHT - (Face::FRAME_THICKNESS * 2),
+                     Face::FRAME_CORNER_RADIUS - Face::scale(2), LIGHT_TEAL);
+    return canvas;
+  }
+  static constexpr FrameCanvas FRAME_CANVAS = frameCanvas();
+  static constexpr auto FRAME = FRAME_CANVAS.template toSpans<FRAME_CANVAS.countSpans()>();
+  static constexpr auto FRAME_EDGE =
+    FRAME_CANVAS.template toSpans<FRAME_CANVAS.countSpans(FRAME_CORNER - 1)>(FRAME_CORNER - 1);
+};
+
+#endif // BMO_SHAPES_H
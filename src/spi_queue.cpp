@@ -0,0 +1,379 @@
+/*
+ * BMO Queued SPI Transactions Implementation
+ *
+ * Descriptor ring, fences and metrics, over the ESP32 SPI master driver or
+ * a simulated wire on the host
+ */
+
+#include "spi_queue.h"
+
+// Messages go to Serial on the device, stdout on the host
+#if defined(ESP32)
+#define SPI_QUEUE_LOG(...) Serial.printf(__VA_ARGS__)
+#else
+#include <stdio.h>
+#define SPI_QUEUE_LOG(...) printf(__VA_ARGS__)
+#endif
+
+#if defined(ESP32)
+#include <driver/gpio.h>
+
+// SPI peripheral TFT_eSPI was built for (the one its own initDMA() picks)
+#ifndef BMO_SPI_QUEUE_HOST
+#if CONFIG_IDF_TARGET_ESP32
+#ifdef USE_HSPI_PORT
+#define BMO_SPI_QUEUE_HOST HSPI_HOST
+#else
+#define BMO_SPI_QUEUE_HOST VSPI_HOST
+#endif
+#else
+#ifdef USE_HSPI_PORT
+#define BMO_SPI_QUEUE_HOST SPI3_HOST
+#else
+#define BMO_SPI_QUEUE_HOST SPI2_HOST
+#endif
+#endif
+#endif
+
+// DC for each transaction is set just before it starts clocking out
+static int8_t queueDcPin = -1;
+
+static void IRAM_ATTR setDataCommand(spi_transaction_t* transaction) {
+  gpio_set_level((gpio_num_t)queueDcPin, transaction->user ? 1 : 0);
+}
+#endif
+
+// MIPI DCS commands used for address windows
+#define DCS_CASET  0x2A
+#define DCS_RASET  0x2B
+#define DCS_RAMWR  0x2C
+
+BMOSpiQueue::BMOSpiQueue()
+  : ring()
+  , head(0)
+  , count(0)
+  , lastFence(0)
+  , completedFence(0)
+  , inFlightBytes(0)
+  , frequency(1)
+  , ready(false)
+  , stats()
+#if defined(ESP32)
+  , device(nullptr)
+  , ownsBus(false)
+#else
+  , now(0)
+  , wireFreeAt(0)
+  , wireRemainder(0)
+  , sink(nullptr)
+  , sinkContext(nullptr)
+#endif
+{
+}
+
+BMOSpiQueue::~BMOSpiQueue() {
+  end();
+}
+
+bool BMOSpiQueue::begin(uint32_t frequency, int8_t mosiPin, int8_t misoPin, int8_t sclkPin, int8_t dcPin) {
+  if (ready) return true;
+  this->frequency = frequency ? frequency : 1;
+
+#if defined(ESP32)
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = mosiPin;
+  bus.miso_io_num = misoPin;
+  bus.sclk_io_num = sclkPin;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = BMO_SPI_QUEUE_MAX_BYTES;
+  bus.flags = SPICOMMON_BUSFLAG_MASTER;
+
+  // The bus may already belong to the driver (TFT_eSPI's initDMA())
+  esp_err_t err = spi_bus_initialize(BMO_SPI_QUEUE_HOST, &bus, SPI_DMA_CH_AUTO);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+    SPI_QUEUE_LOG("SPI queue: bus init failed (%d)\n", err);
+    return false;
+  }
+  ownsBus = (err == ESP_OK);
+
+  // Same mode and clock as TFT_eSPI; chip select stays manual
+  spi_device_interface_config_t config = {};
+  config.mode = 0;
+  config.clock_speed_hz = this->frequency;
+  config.spics_io_num = -1;
+  config.flags = SPI_DEVICE_NO_DUMMY;
+  config.queue_size = BMO_SPI_QUEUE_DEPTH;
+  config.pre_cb = setDataCommand;
+
+  queueDcPin = dcPin;
+  err = spi_bus_add_device(BMO_SPI_QUEUE_HOST, &config, &device);
+  if (err != ESP_OK) {
+    SPI_QUEUE_LOG("SPI queue: add device failed (%d)\n", err);
+    if (ownsBus) spi_bus_free(BMO_SPI_QUEUE_HOST);
+    ownsBus = false;
+    return false;
+  }
+#else
+  (void)mosiPin;
+  (void)misoPin;
+  (void)sclkPin;
+  (void)dcPin;
+  wireFreeAt = now;
+  wireRemainder = 0;
+#endif
+
+  head = 0;
+  count = 0;
+  inFlightBytes = 0;
+  completedFence = lastFence;
+  resetStats();
+  ready = true;
+
+  SPI_QUEUE_LOG("SPI queue ready: %u descriptors, %u bytes per transfer\n",
+                (unsigned)BMO_SPI_QUEUE_DEPTH, (unsigned)BMO_SPI_QUEUE_MAX_BYTES);
+  return true;
+}
+
+void BMOSpiQueue::end() {
+  if (!ready) return;
+  drain();
+
+#if defined(ESP32)
+  spi_bus_remove_device(device);
+  device = nullptr;
+  if (ownsBus) spi_bus_free(BMO_SPI_QUEUE_HOST);
+  ownsBus = false;
+#endif
+  ready = false;
+}
+
+BMOSpiFence BMOSpiQueue::command(uint8_t command, const uint8_t* data, uint8_t length) {
+  BMOSpiFence fence = submit(false, &command, 1, nullptr, nullptr);
+  if (length > 0) fence = submit(true, data, length, nullptr, nullptr);
+  return fence;
+}
+
+BMOSpiFence BMOSpiQueue::window(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+  uint16_t x1 = x + width - 1;
+  uint16_t y1 = y + height - 1;
+  uint8_t columns[4] = { (uint8_t)(x >> 8), (uint8_t)x, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+  uint8_t rows[4] = { (uint8_t)(y >> 8), (uint8_t)y, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+
+  // Parameters are copied into the descriptors, so the locals can go
+  command(DCS_CASET, columns, 4);
+  command(DCS_RASET, rows, 4);
+  return command(DCS_RAMWR);
+}
+
+BMOSpiFence BMOSpiQueue::pixels(const uint16_t* data, uint32_t count, BMOSpiDone done, void* context) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint32_t remaining = count * 2;
+  BMOSpiFence fence = lastFence;
+
+  // The callback goes with the last piece
+  while (remaining > 0) {
+    uint32_t length = remaining > BMO_SPI_QUEUE_MAX_BYTES ? BMO_SPI_QUEUE_MAX_BYTES : remaining;
+    remaining -= length;
+    fence = submit(true, bytes, length, remaining ? nullptr : done, remaining ? nullptr : context);
+    bytes += length;
+  }
+  return fence;
+}
+
+BMOSpiFence BMOSpiQueue::pushImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t* data,
+                                   bool swapBytes, BMOSpiDone done, void* context) {
+  uint32_t count = (uint32_t)width * height;
+  if (count == 0) return lastFence;
+
+  if (swapBytes) {
+    for (uint32_t i = 0; i < count; i++) data[i] = (uint16_t)((data[i] << 8) | (data[i] >> 8));
+  }
+  window(x, y, width, height);
+  return pixels(data, count, done, context);
+}
+
+BMOSpiFence BMOSpiQueue::submit(bool isData, const uint8_t* data, uint32_t length,
+                                BMOSpiDone done, void* context) {
+  if (!ready || length == 0) return lastFence;
+
+  // A full ring waits for its oldest transaction
+  if (count == BMO_SPI_QUEUE_DEPTH) {
+    stats.stalls++;
+    uint32_t stallStart = clock();
+    retire(true);
+    stats.waitUs += clock() - stallStart;
+  }
+
+  uint32_t start = clock();
+  Transaction& transaction = ring[(head + count) % BMO_SPI_QUEUE_DEPTH];
+  if (length <= BMO_SPI_INLINE_BYTES) {
+    memcpy(transaction.bytes, data, length);
+    data = transaction.bytes;
+  }
+  transaction.data = data;
+  transaction.length = length;
+  transaction.isData = isData;
+  transaction.done = done;
+  transaction.context = context;
+
+  if (!transmit(transaction)) {
+    stats.errors++;
+    return lastFence;
+  }
+
+  // Fence 0 stays reserved for "nothing to wait for"
+  if (++lastFence == 0) lastFence = 1;
+  transaction.fence = lastFence;
+  count++;
+  inFlightBytes += length;
+
+  stats.transactions++;
+  stats.bytes += length;
+  if (count > stats.maxDepth) stats.maxDepth = count;
+  if (inFlightBytes > stats.maxInFlightBytes) stats.maxInFlightBytes = inFlightBytes;
+  stats.submitUs += clock() - start;
+  return lastFence;
+}
+
+#if defined(ESP32)
+
+uint32_t BMOSpiQueue::clock() {
+  return micros();
+}
+
+bool BMOSpiQueue::transmit(Transaction& transaction) {
+  spi_transaction_t& spi = transaction.spi;
+  memset(&spi, 0, sizeof(spi));
+  spi.length = transaction.length * 8;
+  spi.user = (void*)(uintptr_t)transaction.isData;
+  if (transaction.length <= BMO_SPI_INLINE_BYTES) {
+    spi.flags = SPI_TRANS_USE_TXDATA;
+    memcpy(spi.tx_data, transaction.data, transaction.length);
+  } else {
+    spi.tx_buffer = transaction.data;
+  }
+
+  // Never blocks: the driver's queue is as deep as the ring
+  return spi_device_queue_trans(device, &spi, 0) == ESP_OK;
+}
+
+bool BMOSpiQueue::retire(bool block) {
+  if (count == 0) return false;
+
+  spi_transaction_t* result = nullptr;
+  if (spi_device_get_trans_result(device, &result, block ? portMAX_DELAY : 0) != ESP_OK) return false;
+
+  // One device, so results come back in submission order
+  Transaction& transaction = ring[head];
+  head = (head + 1) % BMO_SPI_QUEUE_DEPTH;
+  count--;
+  inFlightBytes -= transaction.length;
+  completedFence = transaction.fence;
+  if (transaction.done) transaction.done(transaction.context);
+  return true;
+}
+
+#else
+
+uint32_t BMOSpiQueue::clock() {
+  return now;
+}
+
+bool BMOSpiQueue::transmit(Transaction& transaction) {
+  // The wire picks the transaction up when it's free, then takes its bit
+  // time; the part of a microsecond left over carries into the next one
+  if (count == 0 || (int32_t)(wireFreeAt - now) < 0) wireFreeAt = now;
+  uint64_t total = (uint64_t)transaction.length * 8 * 1000000 + wireRemainder;
+  wireFreeAt += (uint32_t)(total / frequency);
+  wireRemainder = (uint32_t)(total % frequency);
+  transaction.doneAt = wireFreeAt;
+  return true;
+}
+
+bool BMOSpiQueue::retire(bool block) {
+  if (count == 0) return false;
+
+  // Waiting is a jump of the simulated clock to when the wire is through
+  Transaction& transaction = ring[head];
+  if ((int32_t)(now - transaction.doneAt) < 0) {
+    if (!block) return false;
+    now = transaction.doneAt;
+  }
+
+  head = (head + 1) % BMO_SPI_QUEUE_DEPTH;
+  count--;
+  inFlightBytes -= transaction.length;
+  completedFence = transaction.fence;
+  if (sink) sink(transaction.isData, transaction.data, transaction.length, sinkContext);
+  if (transaction.done) transaction.done(transaction.context);
+  return true;
+}
+
+#endif
+
+void BMOSpiQueue::poll() {
+  while (retire(false)) {
+  }
+}
+
+bool BMOSpiQueue::isComplete(BMOSpiFence fence) {
+  // Fence 0 is never issued, so it can't be compared across the wraparound
+  if (fence == 0 || (int32_t)(fence - completedFence) <= 0 || count == 0) return true;
+  poll();
+  return (int32_t)(fence - completedFence) <= 0;
+}
+
+void BMOSpiQueue::wait(BMOSpiFence fence) {
+  if (isComplete(fence)) return;
+
+  uint32_t start = clock();
+  while ((int32_t)(fence - completedFence) > 0 && retire(true)) {
+  }
+  stats.waitUs += clock() - start;
+}
+
+void BMOSpiQueue::drain() {
+  if (count == 0) return;
+
+  uint32_t start = clock();
+  while (retire(true)) {
+  }
+  stats.waitUs += clock() - start;
+}
+
+uint64_t BMOSpiQueue::getWireUs() const {
+  return stats.bytes * 8 * 1000000 / frequency;
+}
+
+uint64_t BMOSpiQueue::getCpuSavedUs() const {
+  // Blocking writes would have spent the whole wire time; the queue spent
+  // only what it took to submit and what it waited
+  uint64_t spent = stats.submitUs + stats.waitUs;
+  uint64_t wire = getWireUs();
+  return wire > spent ? wire - spent : 0;
+}
+
+void BMOSpiQueue::resetStats() {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void BMOSpiQueue::printQueueInfo() {
+  SPI_QUEUE_LOG("=== BMO SPI Queue ===\n");
+  if (!ready) {
+    SPI_QUEUE_LOG("Not running\n");
+    SPI_QUEUE_LOG("=====================\n");
+    return;
+  }
+  SPI_QUEUE_LOG("Transactions: %u, bytes: %llu, errors: %u\n", (unsigned)stats.transactions,
+                (unsigned long long)stats.bytes, (unsigned)stats.errors);
+  SPI_QUEUE_LOG("Depth: %u now, %u max of %u, stalls: %u\n", (unsigned)count,
+                (unsigned)stats.maxDepth, (unsigned)BMO_SPI_QUEUE_DEPTH, (unsigned)stats.stalls);
+  SPI_QUEUE_LOG("In flight: %u bytes now, %u max\n",
+                (unsigned)inFlightBytes, (unsigned)stats.maxInFlightBytes);
+  SPI_QUEUE_LOG("Wire time: %llu us, submitting: %llu us, waiting: %llu us\n",
+                (unsigned long long)getWireUs(), (unsigned long long)stats.submitUs,
+                (unsigned long long)stats.waitUs);
+  SPI_QUEUE_LOG("CPU time saved: %llu us\n", (unsigned long long)getCpuSavedUs());
+  SPI_QUEUE_LOG("=====================\n");
+}
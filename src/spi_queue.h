@@ -0,0 +1,166 @@
+/*
+ * BMO Queued SPI Transactions
+ *
+ * Hands display traffic to the ESP32 SPI master's DMA queue so the CPU
+ * renders the next row while the previous one is still on the wire
+ *
+ * Features:
+ * - Command, address window and pixel buffer submissions that return at once
+ * - Fences: a submission's fence completes once its bytes have been clocked
+ *   out, so the buffer behind it may be reused
+ * - Optional completion callbacks, run in order from poll()/wait()
+ * - Fixed ring of transaction descriptors (no heap); a full ring stalls the
+ *   submitter until the oldest transaction completes
+ * - Queue depth, in-flight bytes and an estimate of CPU time saved
+ * - Host stand-in without the ESP32 driver or the Arduino core: a simulated
+ *   wire at the SPI clock on its own clock, which the caller advances, with
+ *   an optional sink that sees every transaction
+ *
+ * The queue shares the bus with TFT_eSPI the same way TFT_eSPI's own DMA
+ * does: submit only inside startWrite()/endWrite() with the panel selected,
+ * and drain() before TFT_eSPI touches the bus again. BMODisplay drains it
+ * at every panel switch, command and endWrite().
+ */
+
+#ifndef BMO_SPI_QUEUE_H
+#define BMO_SPI_QUEUE_H
+
+#if defined(ESP32)
+#include <Arduino.h>
+#include <driver/spi_master.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+// Queued transfers (-DBMO_ENABLE_DMA=1); without it every pixel goes
+// through TFT_eSPI's blocking writes
+#ifndef BMO_ENABLE_DMA
+#define BMO_ENABLE_DMA 0
+#endif
+
+#define BMO_SPI_QUEUE_DEPTH      24    // Descriptors - a pixel row with its window takes 6
+#define BMO_SPI_QUEUE_MAX_BYTES  4092  // Longest single DMA transfer; longer buffers are split
+#define BMO_SPI_INLINE_BYTES     4     // Commands and parameters this short are copied in
+
+// Completes when the transactions submitted up to it have been sent;
+// 0 is never issued and always complete
+typedef uint32_t BMOSpiFence;
+
+// Runs from poll()/wait() on the submitting task, never from an interrupt
+typedef void (*BMOSpiDone)(void* context);
+
+// Queue metrics (see getStats())
+struct BMOSpiQueueStats {
+  uint32_t transactions;       // Descriptors sent
+  uint64_t bytes;
+  uint32_t errors;             // Rejected by the driver (dropped)
+  uint32_t stalls;             // Submissions that found the ring full
+  uint8_t maxDepth;            // Most descriptors in flight at once
+  uint32_t maxInFlightBytes;
+  uint64_t submitUs;           // CPU time spent queueing
+  uint64_t waitUs;             // CPU time spent blocked on fences and stalls
+};
+
+class BMOSpiQueue {
+public:
+  BMOSpiQueue();
+  ~BMOSpiQueue();
+
+  // Attach to the bus TFT_eSPI drives (after tft.init(), same pins and
+  // clock); chip select stays with the caller, DC is switched per transaction
+  bool begin(uint32_t frequency, int8_t mosiPin, int8_t misoPin, int8_t sclkPin, int8_t dcPin);
+  void end();
+  bool isReady() const { return ready; }
+
+  // Submissions. Buffers are sent from where they are (DMA-capable RAM on
+  // the ESP32 - not flash, not PSRAM) and must stay untouched until the
+  // returned fence completes.
+  BMOSpiFence command(uint8_t command, const uint8_t* data = nullptr, uint8_t length = 0);
+  BMOSpiFence window(uint16_t x, uint16_t y, uint16_t width, uint16_t height);  // CASET, RASET, RAMWR
+  BMOSpiFence pixels(const uint16_t* data, uint32_t count,
+                     BMOSpiDone done = nullptr, void* context = nullptr);
+
+  // Window and pixels together, as TFT_eSPI's pushImage(). With swapBytes the
+  // buffer is converted to panel byte order in place first.
+  BMOSpiFence pushImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t* data,
+                        bool swapBytes, BMOSpiDone done = nullptr, void* context = nullptr);
+
+  // Completion
+  void poll();                        // Retire whatever has finished
+  bool isComplete(BMOSpiFence fence);
+  void wait(BMOSpiFence fence);
+  void drain();                       // Everything submitted so far
+  uint8_t getDepth() const { return count; }
+  uint32_t getInFlightBytes() const { return inFlightBytes; }
+
+  // Metrics
+  const BMOSpiQueueStats& getStats() const { return stats; }
+  uint64_t getWireUs() const;         // Time the bytes take at the SPI clock
+  uint64_t getCpuSavedUs() const;     // Wire time the CPU didn't spend waiting
+  void resetStats();
+  void printQueueInfo();
+
+#if !defined(ESP32)
+  // Host stand-in: every transaction as it completes (isData = DC high)
+  typedef void (*BMOSpiSink)(bool isData, const uint8_t* data, uint32_t length, void* context);
+  void setSink(BMOSpiSink sink, void* context) { this->sink = sink; sinkContext = context; }
+
+  // The simulated wire keeps its own time: it only moves when advanced here
+  // or when a blocking wait skips to the transaction it waits for
+  void advance(uint32_t us) { now += us; }
+  uint32_t getTime() const { return now; }
+
+  // Next fence issued is the one after this (empty queue only), so tests
+  // can reach the wraparound
+  void setLastFence(BMOSpiFence fence) {
+    if (count == 0) lastFence = completedFence = fence;
+  }
+#endif
+
+private:
+  struct Transaction {
+#if defined(ESP32)
+    spi_transaction_t spi;
+#else
+    uint32_t doneAt;              // Simulated time when the wire is through
+#endif
+    const uint8_t* data;
+    uint32_t length;
+    uint8_t bytes[BMO_SPI_INLINE_BYTES];  // Short writes are copied here
+    bool isData;
+    BMOSpiDone done;
+    void* context;
+    BMOSpiFence fence;
+  };
+
+  Transaction ring[BMO_SPI_QUEUE_DEPTH];
+  uint8_t head;                   // Oldest in flight
+  uint8_t count;
+  BMOSpiFence lastFence;          // Issued
+  BMOSpiFence completedFence;     // Retired
+  uint32_t inFlightBytes;
+  uint32_t frequency;
+  bool ready;
+  BMOSpiQueueStats stats;
+
+#if defined(ESP32)
+  spi_device_handle_t device;
+  bool ownsBus;                   // Bus initialized here, freed in end()
+#else
+  uint32_t now;                   // Simulated time, microseconds
+  uint32_t wireFreeAt;            // When the simulated wire goes idle
+  uint32_t wireRemainder;         // Bit time past wireFreeAt, in 1/frequency microseconds
+  BMOSpiSink sink;
+  void* sinkContext;
+#endif
+
+  BMOSpiFence submit(bool isData, const uint8_t* data, uint32_t length,
+                     BMOSpiDone done, void* context);
+  bool retire(bool block);        // Oldest transaction; false if it isn't done
+  bool transmit(Transaction& transaction);
+  uint32_t clock();               // micros() on the ESP32, simulated time on the host
+};
+
+#endif // BMO_SPI_QUEUE_H
@@ -0,0 +1,229 @@
+/*
+ * BMO Asset Pack Check
+ *
+ * Maps a pack built by tools/asset_pack.py with the firmware's own loader
+ * (src/assets.cpp mmaps the file on the host, as the ESP32 maps the
+ * partition) and tests it: the directory is validated, every sprite is
+ * looked up by name and by near-miss names, and sprites can be compared
+ * pixel for pixel with their source images. Lookup and read rates are timed.
+ * Before any of that, small packs with one broken entry each (an offset or
+ * length past the end, a misaligned offset) must be rejected.
+ *
+ * Build and run:
+ *   g++ -O2 -std=gnu++17 -Isrc tools/asset_check.cpp src/assets.cpp src/qoi.cpp -o asset_check
+ *   ./asset_check                                   # broken packs only
+ *   ./asset_check assets.bin                        # ...then lookups and decoding
+ *   ./asset_check assets.bin face=face.ppm          # ...and face's pixels
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "assets.h"
+#include "qoi.h"
+
+#define CHECK_MIN_SECONDS  0.25   // Timed loops repeat at least this long
+
+struct MappedRead {
+  const uint8_t* data;
+  uint32_t length;
+  uint32_t pos;
+};
+
+static int32_t readMapped(uint8_t* buffer, uint32_t length, void* context) {
+  MappedRead* mapped = static_cast<MappedRead*>(context);
+  uint32_t count = mapped->length - mapped->pos;
+  if (count > length) count = length;
+  memcpy(buffer, mapped->data + mapped->pos, count);
+  mapped->pos += count;
+  return (int32_t)count;
+}
+
+// A sprite's pixels as native RGB565 (QOI alpha over black, as drawImage())
+static bool spritePixels(const BMOAssetPack& pack, const BMOAssetEntry* sprite, std::vector<uint16_t>& out) {
+  const uint8_t* data = pack.getData(sprite);
+  uint32_t pixels = (uint32_t)sprite->width * sprite->height;
+  out.resize(pixels);
+  if (sprite->format == ASSET_FORMAT_RGB565) {
+    for (uint32_t i = 0; i < pixels; i++) out[i] = (uint16_t)(data[i * 2] << 8 | data[i * 2 + 1]);
+    return true;
+  }
+
+  static BMOQoiDecoder decoder;
+  MappedRead mapped = { data, sprite->length, 0 };
+  if (decoder.begin(readMapped, &mapped) != QOI_OK) return false;
+  const BMOQoiInfo& info = decoder.getInfo();
+  if (info.width != sprite->width || info.height != sprite->height) return false;
+  return decoder.decode(out.data(), pixels) == pixels && decoder.getStatus() == QOI_OK;
+}
+
+// Binary PPM (P6) as RGB565
+static bool readPpm(const char* path, uint32_t& width, uint32_t& height, std::vector<uint16_t>& out) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  unsigned w = 0, h = 0, maxval = 0;
+  bool ok = fscanf(f, "P6 %u %u %u", &w, &h, &maxval) == 3 && maxval == 255 && fgetc(f) != EOF;
+  std::vector<uint8_t> rgb((size_t)w * h * 3);
+  ok = ok && fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+  fclose(f);
+  if (!ok) return false;
+  width = w;
+  height = h;
+  out.resize((size_t)w * h);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = (uint16_t)(((rgb[i * 3] & 0xF8) << 8) | ((rgb[i * 3 + 1] & 0xFC) << 3) | (rgb[i * 3 + 2] >> 3));
+  }
+  return true;
+}
+
+// One 2x1 raw sprite, with its offset and length as given (0: where they
+// belong), mapped through the loader
+static BMOAssetStatus checkPack(uint32_t offset, uint32_t length) {
+  std::vector<uint8_t> file(sizeof(BMOAssetHeader) + sizeof(BMOAssetEntry) + 4);
+  BMOAssetHeader* header = reinterpret_cast<BMOAssetHeader*>(file.data());
+  BMOAssetEntry* entry = reinterpret_cast<BMOAssetEntry*>(file.data() + sizeof(BMOAssetHeader));
+  memcpy(header->magic, ASSET_MAGIC, 4);
+  header->version = ASSET_VERSION;
+  header->count = 1;
+  header->size = (uint32_t)file.size();
+  strcpy(entry->name, "sprite");
+  entry->width = 2;
+  entry->height = 1;
+  entry->format = ASSET_FORMAT_RGB565;
+  entry->offset = offset ? offset : sizeof(BMOAssetHeader) + sizeof(BMOAssetEntry);
+  entry->length = length ? length : 4;
+
+  char path[] = "/tmp/bmo_packXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return ASSET_ERROR_NOT_FOUND;
+  bool written = write(fd, file.data(), file.size()) == (ssize_t)file.size();
+  close(fd);
+  BMOAssetPack pack;
+  BMOAssetStatus status = written ? pack.begin(path) : ASSET_ERROR_NOT_FOUND;
+  pack.end();
+  unlink(path);
+  return status;
+}
+
+// Packs the loader must take, and packs it must turn away
+static int checkBrokenPacks() {
+  struct Case {
+    const char* name;
+    uint32_t offset, length;
+    BMOAssetStatus expected;
+  };
+  const uint32_t size = sizeof(BMOAssetHeader) + sizeof(BMOAssetEntry) + 4;
+  const Case cases[] = {
+    { "Well-formed pack", 0, 0, ASSET_OK },
+    { "Offset far past the end", 0x10000000, 0, ASSET_ERROR_DIRECTORY },
+    { "Offset at the end", size, 0, ASSET_ERROR_DIRECTORY },
+    { "Length past the end", size - 2, 0, ASSET_ERROR_DIRECTORY },
+    { "Misaligned offset", size - 3, 0, ASSET_ERROR_DIRECTORY },
+  };
+  int failures = 0;
+  for (const Case& c : cases) {
+    BMOAssetStatus status = checkPack(c.offset, c.length);
+    if (status != c.expected) {
+      printf("%s: %s, expected %s\n", c.name, BMOAssetPack::statusName(status),
+             BMOAssetPack::statusName(c.expected));
+      failures++;
+    }
+  }
+  printf("Broken packs: %d of %d handled wrong\n", failures, (int)(sizeof(cases) / sizeof(cases[0])));
+  return failures;
+}
+
+template <class Work>
+static double timePerRun(Work work) {
+  auto start = std::chrono::steady_clock::now();
+  double seconds = 0;
+  uint32_t runs = 0;
+  do {
+    work();
+    runs++;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (seconds < CHECK_MIN_SECONDS);
+  return seconds / runs;
+}
+
+int main(int argc, char** argv) {
+  int failures = checkBrokenPacks();
+  if (argc < 2) {
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+  }
+
+  BMOAssetPack pack;
+  BMOAssetStatus status = pack.begin(argv[1]);
+  if (status != ASSET_OK) {
+    printf("%s: %s\n", argv[1], BMOAssetPack::statusName(status));
+    return 1;
+  }
+  printf("%s: %u sprites, %u bytes\n", argv[1], pack.getCount(), (unsigned)pack.getSize());
+
+  // Every name finds its own entry; names next to it find nothing
+  std::vector<uint16_t> pixels;
+  for (uint16_t i = 0; i < pack.getCount(); i++) {
+    const BMOAssetEntry* entry = pack.getEntry(i);
+    std::string name = entry->name;
+    bool found = pack.find(name.c_str()) == entry;
+    bool missed = !pack.find((name + "_").c_str()) && !pack.find(name.substr(0, name.size() - 1).c_str()) &&
+                  !pack.find((std::string("~") + name).c_str());
+    bool decoded = spritePixels(pack, entry, pixels);
+    printf("  %-16s %4ux%-4u %-6s %s%s%s\n", entry->name, entry->width, entry->height,
+           BMOAssetPack::formatName(entry->format), found ? "found" : "NOT FOUND",
+           missed ? "" : ", FALSE MATCH", decoded ? "" : ", UNREADABLE");
+    if (!found || !missed || !decoded) failures++;
+  }
+
+  // Sprites against the images they were packed from
+  for (int arg = 2; arg < argc; arg++) {
+    std::string spec = argv[arg];
+    size_t split = spec.find('=');
+    std::string name = spec.substr(0, split);
+    const BMOAssetEntry* entry = split == std::string::npos ? nullptr : pack.find(name.c_str());
+    uint32_t width, height;
+    std::vector<uint16_t> expected;
+    if (!entry || !readPpm(spec.c_str() + split + 1, width, height, expected)) {
+      printf("%s: no such sprite or unreadable image\n", spec.c_str());
+      failures++;
+      continue;
+    }
+    uint32_t matched = 0;
+    if (width == entry->width && height == entry->height && spritePixels(pack, entry, pixels)) {
+      for (size_t i = 0; i < expected.size(); i++) matched += pixels[i] == expected[i];
+    }
+    printf("%s: %u of %u pixels match\n", name.c_str(), (unsigned)matched, (unsigned)expected.size());
+    if (matched != expected.size()) failures++;
+  }
+
+  // Lookup rate over every name, and raw sprite bytes read from the mapping
+  double lookup = timePerRun([&]() {
+    for (uint16_t i = 0; i < pack.getCount(); i++) {
+      if (!pack.find(pack.getEntry(i)->name)) abort();
+    }
+  });
+  uint64_t rawBytes = 0;
+  for (uint16_t i = 0; i < pack.getCount(); i++) {
+    if (pack.getEntry(i)->format == ASSET_FORMAT_RGB565) rawBytes += pack.getEntry(i)->length;
+  }
+  volatile uint32_t sink = 0;
+  double read = timePerRun([&]() {
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < pack.getCount(); i++) {
+      const BMOAssetEntry* entry = pack.getEntry(i);
+      if (entry->format != ASSET_FORMAT_RGB565) continue;
+      const uint32_t* words = reinterpret_cast<const uint32_t*>(pack.getData(entry));
+      for (uint32_t w = 0; w < entry->length / 4; w++) sum += words[w];
+    }
+    sink = sink + sum;
+  });
+  printf("Lookups: %.0f ns each; raw sprites: %.0f MB/s from the mapping\n",
+         pack.getCount() ? lookup / pack.getCount() * 1e9 : 0.0, rawBytes / read / 1e6);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+BMO Asset Packer
+
+Builds the sprite pack for the "assets" flash partition (src/assets.h), which
+BMOGraphics::drawSprite() blits from without copying. The pack is flashed on
+its own, so new art doesn't need a firmware rebuild.
+
+Usage:
+  python3 tools/asset_pack.py -o assets.bin splash.ppm heart=sprites/heart.ppm
+  python3 tools/asset_pack.py -o assets.bin --qoi backdrop.ppm   # compressed
+  python3 tools/asset_pack.py --list assets.bin
+
+Sprites are named after their file (or name=path) and stored as raw RGB565
+in panel byte order by default - the fastest to draw, sent straight from
+flash. --qoi stores them compressed instead (decoded while drawing, like
+drawImage()). PAM images with alpha and .qoi files are always stored as QOI.
+The partition's offset and size come from config/partitions.csv, and the
+command to flash the pack is printed at the end.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from bmo_ctl import rgb565_be
+from qoi_encode import decode as qoi_decode, encode as qoi_encode, read_image
+
+MAGIC = b"BMOA"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII")        # BMOAssetHeader
+ENTRY = struct.Struct("<16sHHB3xII")     # BMOAssetEntry
+NAME_LENGTH = 16
+ALIGN = 4
+
+FORMAT_RGB565 = 0
+FORMAT_QOI = 1
+FORMAT_NAMES = {FORMAT_RGB565: "RGB565", FORMAT_QOI: "QOI"}
+
+PARTITIONS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "config", "partitions.csv")
+PARTITION_LABEL = "assets"
+
+
+def read_partition(path, label):
+    """(offset, size) of a partition in an ESP-IDF partition table."""
+    with open(path) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == label:
+                return int(fields[3], 0), int(fields[4], 0)
+    raise ValueError("%s: no '%s' partition" % (path, label))
+
+
+def load_sprite(path, compress):
+    """Image file -> (width, height, format, data)."""
+    if path.endswith(".qoi"):
+        with open(path, "rb") as f:
+            data = f.read()
+        width, height, _, _ = qoi_decode(data)
+        return width, height, FORMAT_QOI, data
+    width, height, channels, pixels = read_image(path)
+    if channels == 3 and not compress:
+        return width, height, FORMAT_RGB565, rgb565_be(pixels)
+    return width, height, FORMAT_QOI, qoi_encode(width, height, channels, pixels)
+
+
+def build(sprites):
+    """[(name, width, height, format, data)] -> pack bytes."""
+    sprites = sorted(sprites, key=lambda sprite: sprite[0].encode())
+    offset = HEADER.size + ENTRY.size * len(sprites)
+    directory = bytearray()
+    data = bytearray()
+    for name, width, height, fmt, payload in sprites:
+        offset += -offset % ALIGN
+        data += b"\0" * (-len(data) % ALIGN)
+        directory += ENTRY.pack(name.encode(), width, height, fmt, offset, len(payload))
+        data += payload
+        offset += len(payload)
+    size = HEADER.size + len(directory) + len(data)
+    return HEADER.pack(MAGIC, VERSION, len(sprites), size, 0) + bytes(directory) + bytes(data)
+
+
+def list_pack(path):
+    with open(path, "rb") as f:
+        pack = f.read()
+    magic, version, count, size, _ = HEADER.unpack_from(pack)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("%s: not a version %d asset pack" % (path, VERSION))
+    print("%s: %d sprites, %d bytes" % (path, count, size))
+    for i in range(count):
+        name, width, height, fmt, offset, length = ENTRY.unpack_from(pack, HEADER.size + i * ENTRY.size)
+        print("  %-16s %4dx%-4d %-6s %8d bytes at 0x%06X" % (
+            name.rstrip(b"\0").decode(), width, height, FORMAT_NAMES.get(fmt, "?"), length, offset))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the BMO sprite pack")
+    parser.add_argument("images", nargs="*", help="PPM, PAM or QOI images, optionally as name=path")
+    parser.add_argument("-o", "--output", help="pack file to write")
+    parser.add_argument("--qoi", action="store_true", help="store every sprite QOI compressed")
+    parser.add_argument("--list", metavar="PACK", help="print a pack's directory and exit")
+    parser.add_argument("--partitions", default=PARTITIONS, help="partition table (default: %(default)s)")
+    args = parser.parse_args()
+
+    if args.list:
+        list_pack(args.list)
+        return 0
+    if not args.output or not args.images:
+        parser.error("images and an output file are needed")
+
+    sprites = []
+    names = set()
+    for image in args.images:
+        name, _, path = image.rpartition("=")
+        if not name:
+            name = os.path.splitext(os.path.basename(path))[0]
+        if not 0 < len(name.encode()) < NAME_LENGTH:
+            parser.error("'%s': names are 1-%d characters" % (name, NAME_LENGTH - 1))
+        if name in names:
+            parser.error("'%s' is in the pack twice" % name)
+        names.add(name)
+        width, height, fmt, data = load_sprite(path, args.qoi)
+        if width > 0xFFFF or height > 0xFFFF:
+            parser.error("%s: %dx%d is too large" % (path, width, height))
+        sprites.append((name, width, height, fmt, data))
+
+    pack = build(sprites)
+    offset, size = read_partition(args.partitions, PARTITION_LABEL)
+    if len(pack) > size:
+        print("error: the pack is %d bytes, the partition %d" % (len(pack), size), file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(pack)
+    list_pack(args.output)
+    print("%.1f%% of the partition. Flash it with:" % (100.0 * len(pack) / size))
+    print("  python3 -m esptool --chip esp32s3 write_flash 0x%x %s" % (offset, args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+BMO Command Tool
+
+Sends commands to a device built with BMO_ENABLE_PROTOCOL=1 (src/protocol.cpp).
+Every command is one framed packet that waits for its ACK/NAK and is retried
+on a NAK or timeout; the device recognises a retry it already ran and just
+acknowledges it again. Debug text and mirror packets on the same port are
+skipped.
+
+Usage:
+  python3 tools/bmo_ctl.py /dev/ttyACM0 ping
+  python3 tools/bmo_ctl.py /dev/ttyACM0 expression surprised --eyes wide
+  python3 tools/bmo_ctl.py /dev/ttyACM0 animate blink
+  python3 tools/bmo_ctl.py /dev/ttyACM0 backlight 128
+  python3 tools/bmo_ctl.py /dev/ttyACM0 image picture.ppm --x 20 --y 40
+
+Images are binary PPM (P6), e.g. from `convert picture.png picture.ppm`.
+Requires pyserial (pip install pyserial).
+"""
+
+import argparse
+import random
+import struct
+import sys
+import time
+
+from expression_compiler import CompileError, expression_names
+from mirror_viewer import SYNC, FrameParser, crc16
+
+CMD_PING = 0x20
+CMD_SET_EXPRESSION = 0x21
+CMD_ANIMATE = 0x22
+CMD_BACKLIGHT = 0x23
+CMD_IMAGE_BEGIN = 0x24
+CMD_IMAGE_DATA = 0x25
+CMD_IMAGE_END = 0x26
+
+FRAME_ACK = 0x30
+FRAME_NAK = 0x31
+
+# Expression ids follow expressions/expressions.txt (the firmware's build)
+try:
+    EXPRESSIONS = expression_names()
+except (CompileError, OSError):
+    EXPRESSIONS = ["happy", "surprised", "sleepy", "excited", "confused"]
+EYES = ["open", "closed", "half", "wide"]
+EYES_DEFAULT = 0xFF  # PROTOCOL_EYES_DEFAULT: the expression's own eyes
+ANIMATIONS = ["blink", "surprise", "hearts", "fade"]
+
+ERRORS = ["ok", "crc", "length", "unknown command", "bad argument", "busy", "no image open"]
+
+# Pixels per IMAGE_DATA frame (PROTOCOL_MAX_PAYLOAD minus the offset, in whole pixels)
+CHUNK_PIXELS = 2046
+
+
+class CommandError(Exception):
+    pass
+
+
+class BMOLink:
+    """Stop-and-wait command link: one frame in flight, retried until acknowledged."""
+
+    def __init__(self, port, timeout=1.0, retries=5):
+        self.port = port
+        self.timeout = timeout
+        self.retries = retries
+        self.seq = random.randrange(256)  # Unlikely to match the previous session's last frame
+        self.frames = FrameParser()
+        self.pending = []
+        self.resends = 0
+
+    def frame(self, ftype, payload=b""):
+        body = struct.pack("<BBH", ftype, self.seq, len(payload)) + payload
+        return SYNC + body + struct.pack("<H", crc16(body))
+
+    def _response(self, seq):
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            while self.pending:
+                ftype, _seq, payload = self.pending.pop(0)
+                if ftype in (FRAME_ACK, FRAME_NAK) and len(payload) >= 2 and payload[0] == seq:
+                    return ftype, payload[1]
+            data = self.port.read(256)
+            if data:
+                self.pending.extend(self.frames.feed(data))
+        return None, None
+
+    def send(self, ftype, payload=b""):
+        packet = self.frame(ftype, payload)
+        seq = self.seq
+        self.seq = (self.seq + 1) & 0xFF
+
+        code = None
+        for attempt in range(self.retries + 1):
+            if attempt:
+                self.resends += 1
+            self.port.write(packet)
+            self.port.flush()
+            response, code = self._response(seq)
+            if response == FRAME_ACK:
+                return
+            # CRC damage and a busy event queue are worth another try
+            if response == FRAME_NAK and code not in (1, 5):
+                break
+        reason = ERRORS[code] if code is not None and code < len(ERRORS) else "no response"
+        raise CommandError("command 0x%02X failed: %s" % (ftype, reason))
+
+
+def read_ppm(path):
+    """Binary PPM -> (width, height, RGB888 bytes)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        raise ValueError("%s: only 8-bit binary PPM (P6) is supported" % path)
+    width, height = int(fields[1]), int(fields[2])
+    pos += 1
+    return width, height, data[pos:pos + width * height * 3]
+
+
+def rgb565_be(rgb):
+    """RGB888 -> big-endian RGB565, the byte order the panel takes."""
+    out = bytearray(len(rgb) // 3 * 2)
+    for i in range(len(rgb) // 3):
+        r, g, b = rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]
+        struct.pack_into(">H", out, i * 2, ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+    return bytes(out)
+
+
+def upload_image(link, path, panel, x, y):
+    width, height, rgb = read_ppm(path)
+    pixels = rgb565_be(rgb)
+    start = time.monotonic()
+
+    link.send(CMD_IMAGE_BEGIN, struct.pack("<BHHHH", panel, x, y, width, height))
+    total = width * height
+    for offset in range(0, total, CHUNK_PIXELS):
+        count = min(CHUNK_PIXELS, total - offset)
+        link.send(CMD_IMAGE_DATA, struct.pack("<I", offset) + pixels[offset * 2:(offset + count) * 2])
+    link.send(CMD_IMAGE_END)
+
+    elapsed = time.monotonic() - start
+    print("%dx%d image in %.2fs (%.1f kB/s, %d resends)" %
+          (width, height, elapsed, len(pixels) / 1024.0 / elapsed, link.resends), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Send commands to BMO over the serial protocol")
+    parser.add_argument("port", help="serial port (or pty)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to wait for an ACK")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    commands.add_parser("ping")
+    expression = commands.add_parser("expression")
+    expression.add_argument("name", choices=EXPRESSIONS)
+    expression.add_argument("--eyes", choices=EYES, help="default: the expression's own")
+    animate = commands.add_parser("animate")
+    animate.add_argument("name", choices=ANIMATIONS)
+    backlight = commands.add_parser("backlight")
+    backlight.add_argument("level", type=int, choices=range(256), metavar="0-255")
+    image = commands.add_parser("image")
+    image.add_argument("path", help="binary PPM (P6)")
+    image.add_argument("--panel", type=int, default=0)
+    image.add_argument("--x", type=int, default=0)
+    image.add_argument("--y", type=int, default=0)
+    args = parser.parse_args()
+
+    import serial  # pyserial
+    link = BMOLink(serial.Serial(args.port, args.baud, timeout=0.05), args.timeout)
+
+    try:
+        if args.command == "ping":
+            start = time.monotonic()
+            link.send(CMD_PING)
+            print("pong in %.1f ms" % ((time.monotonic() - start) * 1000.0))
+        elif args.command == "expression":
+            link.send(CMD_SET_EXPRESSION,
+                      bytes([EXPRESSIONS.index(args.name),
+                             EYES.index(args.eyes) if args.eyes else EYES_DEFAULT]))
+        elif args.command == "animate":
+            link.send(CMD_ANIMATE, bytes([ANIMATIONS.index(args.name)]))
+        elif args.command == "backlight":
+            link.send(CMD_BACKLIGHT, bytes([args.level]))
+        elif args.command == "image":
+            upload_image(link, args.path, args.panel, args.x, args.y)
+    except CommandError as error:
+        print(error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,206 @@
+/*
+ * BMO Ordered Dither Benchmark
+ *
+ * Runs the firmware's dither stage (src/dither.h) on the host. It checks that
+ * exact RGB565 colors pass through untouched, that every fraction averages
+ * out over the tile, and that the background gradient loses its bands. It
+ * then times each scanline conversion against plain truncation.
+ *
+ * Build and run:
+ *   g++ -O2 -std=gnu++17 -Isrc tools/dither_bench.cpp -o dither_bench
+ *   ./dither_bench          # 240 pixel scanlines
+ *   ./dither_bench 320      # landscape panel
+ *   g++ -O2 -std=gnu++17 -Isrc -DDITHER_SIZE=4 tools/dither_bench.cpp -o dither_bench4
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "dither.h"
+
+#define BENCH_MIN_SECONDS  0.25     // Timed loops repeat at least this long
+#define BENCH_ROWS         320      // Scanlines per timed run (one screen)
+#define BENCH_TEAL         0x4E6D   // BMO_TEAL in graphics.h
+#define BENCH_LIGHT_TEAL   0x6EDD   // BMO_LIGHT_TEAL
+
+template <class Work>
+static double timePerRun(Work work) {
+  auto start = std::chrono::steady_clock::now();
+  double seconds = 0;
+  uint32_t runs = 0;
+  do {
+    work();
+    runs++;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (seconds < BENCH_MIN_SECONDS);
+  return seconds / runs;
+}
+
+// graphics.cpp's blendColors(), the float path the dither stage replaces
+static uint16_t blendFloat(uint16_t color1, uint16_t color2, float ratio) {
+  int r1 = (color1 >> 8) & 0xF8, g1 = (color1 >> 3) & 0xFC, b1 = (color1 << 3) & 0xF8;
+  int r2 = (color2 >> 8) & 0xF8, g2 = (color2 >> 3) & 0xFC, b2 = (color2 << 3) & 0xF8;
+  int r = r1 + (int)((r2 - r1) * ratio);
+  int g = g1 + (int)((g2 - g1) * ratio);
+  int b = b1 + (int)((b2 - b1) * ratio);
+  return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+static uint32_t checkExact() {
+  // Every RGB565 color, spanning every tile row and column
+  uint32_t failures = 0;
+  uint16_t line[DITHER_SIZE * 2];
+  for (uint32_t color = 0; color < 0x10000; color++) {
+    for (int y = 0; y < DITHER_SIZE; y++) {
+      bmoDitherSpan(line, 3, y, DITHER_SIZE * 2, bmoColorQ8((uint16_t)color));
+      for (int i = 0; i < DITHER_SIZE * 2; i++) failures += line[i] != color;
+    }
+    failures += bmoDitherBlend((uint16_t)color, 0xFFFF, 0, 0x80) != color;
+    failures += bmoDitherBlend(0xFFFF, (uint16_t)color, 256, 0x80) != color;
+  }
+  return failures;
+}
+
+static uint32_t checkAverages(uint32_t& worst) {
+  // Each fraction of a level rounds up on that share of the tile, within
+  // one threshold step; the top level never carries into the next channel
+  uint32_t failures = 0;
+  worst = 0;
+  for (uint32_t level = 0; level < 63; level++) {
+    for (uint32_t fraction = 0; fraction < 256; fraction++) {
+      uint16_t value = (uint16_t)(level << 8 | fraction);
+      uint16_t rb = level < 31 ? value : (uint16_t)(31 << 8);
+      BMOColorQ8 color = { rb, value, rb };
+      uint32_t ups = 0;
+      for (int y = 0; y < DITHER_SIZE; y++) {
+        for (int x = 0; x < DITHER_SIZE; x++) {
+          uint16_t out = bmoDither565(color, bmoDitherRow(y)[x]);
+          uint32_t g = (out >> 5) & 0x3F;
+          if (g != level && g != level + 1) failures++;
+          ups += g - level;
+          if (level >= 31 && (out >> 11 != 31 || (out & 0x1F) != 31)) failures++;
+        }
+      }
+      uint32_t mean = ups * 256 / (DITHER_SIZE * DITHER_SIZE);
+      uint32_t error = mean > fraction ? mean - fraction : fraction - mean;
+      if (error > worst) worst = error;
+      if (error > 256 / (DITHER_SIZE * DITHER_SIZE)) failures++;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  int width = argc > 1 ? atoi(argv[1]) : 240;
+  if (width < 1 || width > 4096) {
+    fprintf(stderr, "usage: %s [scanline width]\n", argv[0]);
+    return 2;
+  }
+  printf("%dx%d ordered dither, %d pixel scanlines\n", DITHER_SIZE, DITHER_SIZE, width);
+  printf("Thresholds:\n");
+  for (int y = 0; y < DITHER_SIZE; y++) {
+    printf("  ");
+    for (int x = 0; x < DITHER_SIZE; x++) printf(" %3u", bmoDitherRow(y)[x]);
+    printf("\n");
+  }
+
+  int failures = 0;
+  uint32_t changed = checkExact();
+  printf("Exact colors: %s\n", changed ? "CHANGED" : "unchanged");
+  if (changed) failures++;
+  uint32_t worst = 0;
+  uint32_t wrong = checkAverages(worst);
+  printf("Tile averages: %s, worst %u/256 of a level off\n", wrong ? "WRONG" : "ok", (unsigned)worst);
+  if (wrong) failures++;
+
+  // The background gradient (every row, 10% of the way to light teal at the
+  // bottom, as renderBackgroundRow()): the bands it falls into when
+  // truncated, and how far each tile's average blue strays from the mix
+  uint32_t bands = 1, run = 1, longest = 1;
+  double tileError = 0;
+  uint16_t last = 0;
+  std::vector<uint16_t> line(DITHER_SIZE);
+  for (int top = 0; top < BENCH_ROWS; top += DITHER_SIZE) {
+    double dithered = 0, exact = 0;
+    for (int y = top; y < top + DITHER_SIZE; y++) {
+      BMOColorQ8 color = bmoMixQ8(BENCH_TEAL, BENCH_LIGHT_TEAL, (uint32_t)y * 65536 / (BENCH_ROWS * 10));
+      uint16_t truncated = bmoTruncate565(color);
+      if (y > 0 && truncated != last) {
+        bands++;
+        run = 0;
+      }
+      if (++run > longest) longest = run;
+      last = truncated;
+      bmoDitherSpan(line.data(), 0, y, DITHER_SIZE, color);
+      for (int i = 0; i < DITHER_SIZE; i++) dithered += line[i] & 0x1F;
+      exact += color.b / 256.0 * DITHER_SIZE;
+    }
+    double error = (dithered - exact) / (DITHER_SIZE * DITHER_SIZE);
+    if (error < 0) error = -error;
+    if (error > tileError) tileError = error;
+  }
+  printf("Gradient: %u bands truncated (up to %u rows tall); dithered tiles within %.3f of a blue level\n",
+         (unsigned)bands, (unsigned)longest, tileError);
+
+  // Timed over a screen of scanlines
+  std::vector<uint16_t> out(width);
+  std::vector<uint16_t> below(width);
+  std::vector<uint32_t> coverage(width);
+  for (int i = 0; i < width; i++) {
+    below[i] = (uint16_t)(i * 2654435761u >> 16);
+    coverage[i] = (uint32_t)(i * 97 % 257);
+  }
+  volatile uint32_t sink = 0;
+  auto flush = [&]() { sink = sink + out[width - 1] + out[width / 2]; };
+
+  double truncSpan = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      uint16_t color = bmoTruncate565(bmoMixQ8(BENCH_TEAL, BENCH_LIGHT_TEAL, (uint32_t)y * 205));
+      for (int i = 0; i < width; i++) out[i] = color;
+      flush();
+    }
+  });
+  double ditherSpan = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      bmoDitherSpan(out.data(), 0, y, width, bmoMixQ8(BENCH_TEAL, BENCH_LIGHT_TEAL, (uint32_t)y * 205));
+      flush();
+    }
+  });
+  double floatSpan = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      uint16_t color = blendFloat(BENCH_TEAL, BENCH_LIGHT_TEAL, (float)y / BENCH_ROWS * 0.1f);
+      for (int i = 0; i < width; i++) out[i] = color;
+      flush();
+    }
+  });
+  double truncBlend = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      for (int i = 0; i < width; i++) out[i] = bmoTruncate565(bmoBlendQ8(below[i], 0xFFFF, coverage[i]));
+      flush();
+    }
+  });
+  double ditherBlend = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      const uint8_t* row = bmoDitherRow(y);
+      for (int i = 0; i < width; i++) {
+        out[i] = bmoDitherBlend(below[i], 0xFFFF, coverage[i], row[i & DITHER_MASK]);
+      }
+      flush();
+    }
+  });
+  double floatBlend = timePerRun([&]() {
+    for (int y = 0; y < BENCH_ROWS; y++) {
+      for (int i = 0; i < width; i++) out[i] = blendFloat(below[i], 0xFFFF, coverage[i] / 256.0f);
+      flush();
+    }
+  });
+
+  printf("Per scanline (ns)      truncated   dithered   float\n");
+  printf("  one color (gradient)  %8.1f   %8.1f   %6.1f\n", truncSpan / BENCH_ROWS * 1e9,
+         ditherSpan / BENCH_ROWS * 1e9, floatSpan / BENCH_ROWS * 1e9);
+  printf("  blend per pixel (AA)  %8.1f   %8.1f   %6.1f\n", truncBlend / BENCH_ROWS * 1e9,
+         ditherBlend / BENCH_ROWS * 1e9, floatBlend / BENCH_ROWS * 1e9);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,375 @@
+#!/usr/bin/env python3
+"""
+BMO Expression Compiler
+
+Compiles expressions/expressions.txt into the bytecode display lists that
+BMOGraphics interprets (format in src/expression_ops.h). Writes
+src/expressions.h (the BMOExpression enum) and src/expressions.cpp (the
+program and its per-expression table: offset, bounds, default eyes).
+
+Usage:
+  python3 tools/expression_compiler.py            # regenerate the sources
+  python3 tools/expression_compiler.py --check    # fail if they are stale
+  python3 tools/expression_compiler.py --list     # names and bounds
+
+Bounds are worked out here so the device can repaint just the old and new
+mouth when only the expression changes; anything reaching outside the mouth
+box is rejected.
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "expressions", "expressions.txt")
+HEADER = os.path.join(ROOT, "src", "expressions.h")
+TABLES = os.path.join(ROOT, "src", "expressions.cpp")
+
+FORMAT_VERSION = 1  # EXPRESSION_FORMAT_VERSION in src/expression_ops.h
+
+# Opcodes, in BMOExpressionOp order
+OP_END, OP_COLOR, OP_SHAPE, OP_RECT, OP_ELLIPSE, OP_LINE, OP_CURVE, \
+    OP_MOVE, OP_LINE_TO, OP_QUAD_TO, OP_CUBIC_TO, OP_CLOSE, OP_FILL = range(13)
+
+EYES = {"open": 0, "closed": 1, "half": 2, "wide": 3}
+FILL_RULES = {"nonzero": 0, "evenodd": 1}
+
+PALETTE = {
+    "black": 0x0000, "white": 0xFFFF, "teal": 0x4E6D, "dark_teal": 0x2945,
+    "light_teal": 0x6EDD, "gray": 0x7BEF, "blue_tint": 0x4E7D,
+}
+
+# BMOExpressionShape ids and the pixels each span table covers on the
+# 240x320 design (left, top, right, bottom, inclusive; see shapes.h)
+SHAPES = {
+    "smile": (0, (-31, -1, 31, 21)),
+    "grin": (1, (-41, -1, 41, 31)),
+    "surprised": (2, (-15, -20, 15, 20)),
+}
+
+# Face::MOUTH_BOX_* on the design (panel.h), inclusive
+MOUTH_BOX = (-42, -22, 42, 34)
+
+# Operand counts for the drawing commands (after the keyword)
+OPERANDS = {
+    "rect": (OP_RECT, 4, 4), "ellipse": (OP_ELLIPSE, 4, 4),
+    "line": (OP_LINE, 4, 5), "curve": (OP_CURVE, 6, 7),
+    "move": (OP_MOVE, 2, 2), "lineto": (OP_LINE_TO, 2, 2),
+    "quad": (OP_QUAD_TO, 4, 4), "cubic": (OP_CUBIC_TO, 6, 6),
+}
+
+DEFAULT_PEN = 3  # Face::scale(3), the thickness the mouths were drawn with
+
+NAME = re.compile(r"^[a-z][a-z0-9_]*$")
+
+
+class CompileError(Exception):
+    pass
+
+
+class Expression:
+    def __init__(self, name, eyes, line):
+        self.name = name
+        self.eyes = eyes
+        self.line = line
+        self.code = bytearray()
+        self.bounds = None   # left, top, right, bottom
+        self.path_open = False
+        self.last_point = (0, 0)
+
+    def cover(self, left, top, right, bottom):
+        if self.bounds is None:
+            self.bounds = [left, top, right, bottom]
+        else:
+            self.bounds[0] = min(self.bounds[0], left)
+            self.bounds[1] = min(self.bounds[1], top)
+            self.bounds[2] = max(self.bounds[2], right)
+            self.bounds[3] = max(self.bounds[3], bottom)
+
+    def cover_points(self, points, reach):
+        xs = [x for x, _ in points]
+        ys = [y for _, y in points]
+        self.cover(math.floor(min(xs)) - reach, math.floor(min(ys)) - reach,
+                   math.ceil(max(xs)) + reach, math.ceil(max(ys)) + reach)
+
+
+def coordinate(text, where):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise CompileError("%s: '%s' is not a number" % (where, text))
+    if not -128 <= value <= 127:
+        raise CompileError("%s: %d is out of range (-128..127)" % (where, value))
+    return value
+
+
+def size(text, where):
+    try:
+        value = int(text, 0)
+    except ValueError:
+        raise CompileError("%s: '%s' is not a number" % (where, text))
+    if not 0 < value <= 255:
+        raise CompileError("%s: %d is out of range (1..255)" % (where, value))
+    return value
+
+
+def quad_points(p0, c, p1, steps=32):
+    return [(((1 - t) ** 2) * p0[0] + 2 * (1 - t) * t * c[0] + (t ** 2) * p1[0],
+             ((1 - t) ** 2) * p0[1] + 2 * (1 - t) * t * c[1] + (t ** 2) * p1[1])
+            for t in (i / steps for i in range(steps + 1))]
+
+
+def cubic_points(p0, c1, c2, p1, steps=32):
+    points = []
+    for i in range(steps + 1):
+        t = i / steps
+        u = 1 - t
+        points.append((u ** 3 * p0[0] + 3 * u * u * t * c1[0] + 3 * u * t * t * c2[0] + t ** 3 * p1[0],
+                       u ** 3 * p0[1] + 3 * u * u * t * c1[1] + 3 * u * t * t * c2[1] + t ** 3 * p1[1]))
+    return points
+
+
+def signed(value):
+    return value & 0xFF
+
+
+def compile_command(expression, words, where, pen):
+    keyword = words[0]
+
+    if keyword == "color":
+        if len(words) != 2:
+            raise CompileError("%s: color takes one value" % where)
+        if words[1] in PALETTE:
+            color = PALETTE[words[1]]
+        else:
+            try:
+                color = int(words[1], 0)
+            except ValueError:
+                raise CompileError("%s: unknown color '%s'" % (where, words[1]))
+            if not 0 <= color <= 0xFFFF:
+                raise CompileError("%s: colors are RGB565 (0..0xFFFF)" % where)
+        expression.code += bytes([OP_COLOR, color & 0xFF, color >> 8])
+        return
+
+    if keyword == "shape":
+        if len(words) != 2 or words[1] not in SHAPES:
+            raise CompileError("%s: shape is one of %s" % (where, ", ".join(SHAPES)))
+        shape, bounds = SHAPES[words[1]]
+        expression.code += bytes([OP_SHAPE, shape])
+        expression.cover(*bounds)
+        return
+
+    if keyword == "close":
+        if len(words) != 1:
+            raise CompileError("%s: close takes no operands" % where)
+        expression.code.append(OP_CLOSE)
+        return
+
+    if keyword == "fill":
+        rule = words[1] if len(words) > 1 else "nonzero"
+        if len(words) > 2 or rule not in FILL_RULES:
+            raise CompileError("%s: fill rule is nonzero or evenodd" % where)
+        if not expression.path_open:
+            raise CompileError("%s: nothing to fill (start the outline with move)" % where)
+        expression.code += bytes([OP_FILL, FILL_RULES[rule]])
+        expression.path_open = False
+        return
+
+    if keyword not in OPERANDS:
+        raise CompileError("%s: unknown command '%s'" % (where, keyword))
+    op, least, most = OPERANDS[keyword]
+    operands = words[1:]
+    if not least <= len(operands) <= most:
+        expected = str(least) if least == most else "%d or %d" % (least, most)
+        raise CompileError("%s: %s takes %s operands" % (where, keyword, expected))
+
+    if op == OP_RECT:
+        x, y = coordinate(operands[0], where), coordinate(operands[1], where)
+        w, h = size(operands[2], where), size(operands[3], where)
+        expression.code += bytes([op, signed(x), signed(y), w, h])
+        expression.cover_points([(x, y), (x + w - 1, y + h - 1)], 0)
+    elif op == OP_ELLIPSE:
+        cx, cy = coordinate(operands[0], where), coordinate(operands[1], where)
+        rx, ry = size(operands[2], where), size(operands[3], where)
+        expression.code += bytes([op, signed(cx), signed(cy), rx, ry])
+        expression.cover_points([(cx - rx, cy - ry), (cx + rx, cy + ry)], 0)
+    elif op == OP_LINE:
+        points = [coordinate(value, where) for value in operands[:4]]
+        thickness = size(operands[4], where) if len(operands) > 4 else pen
+        expression.code += bytes([op] + [signed(value) for value in points] + [thickness])
+        expression.cover_points([(points[0], points[1]), (points[2], points[3])], thickness)
+    elif op == OP_CURVE:
+        points = [coordinate(value, where) for value in operands[:6]]
+        width = size(operands[6], where) if len(operands) > 6 else pen
+        expression.code += bytes([op] + [signed(value) for value in points] + [width])
+        curve = quad_points(points[0:2], points[2:4], points[4:6])
+        expression.cover_points(curve, (width + 1) // 2 + 1)
+    else:
+        points = [coordinate(value, where) for value in operands]
+        if op == OP_MOVE:
+            expression.path_open = True
+        elif not expression.path_open:
+            raise CompileError("%s: %s before move" % (where, keyword))
+        expression.code += bytes([op] + [signed(value) for value in points])
+        if op == OP_QUAD_TO:
+            curve = quad_points(expression.last_point, points[0:2], points[2:4])
+        elif op == OP_CUBIC_TO:
+            curve = cubic_points(expression.last_point, points[0:2], points[2:4], points[4:6])
+        else:
+            curve = [tuple(points[-2:])]
+        expression.cover_points(curve, 0)
+        expression.last_point = tuple(points[-2:])
+
+
+def parse(path):
+    expressions = []
+    current = None
+    with open(path) as source:
+        for number, raw in enumerate(source, 1):
+            where = "%s:%d" % (os.path.relpath(path, ROOT), number)
+            words = raw.split("#", 1)[0].split()
+            if not words:
+                continue
+
+            if words[0] == "expression":
+                if current is not None and current.path_open:
+                    raise CompileError("%s: expression '%s' has an unfilled path" % (where, current.name))
+                if len(words) < 2 or not NAME.match(words[1]):
+                    raise CompileError("%s: expression needs a lower-case name" % where)
+                if any(existing.name == words[1] for existing in expressions):
+                    raise CompileError("%s: expression '%s' is defined twice" % (where, words[1]))
+                eyes = "open"
+                for option in words[2:]:
+                    key, _, value = option.partition("=")
+                    if key != "eyes" or value not in EYES:
+                        raise CompileError("%s: expected eyes=%s" % (where, "|".join(EYES)))
+                    eyes = value
+                current = Expression(words[1], eyes, where)
+                expressions.append(current)
+                continue
+
+            if current is None:
+                raise CompileError("%s: '%s' outside an expression" % (where, words[0]))
+            compile_command(current, words, where, DEFAULT_PEN)
+
+    if current is not None and current.path_open:
+        raise CompileError("%s: expression '%s' has an unfilled path" % (current.line, current.name))
+    if not expressions:
+        raise CompileError("%s: no expressions" % os.path.relpath(path, ROOT))
+    if len(expressions) > 255:
+        raise CompileError("too many expressions (the protocol addresses 255)")
+
+    for expression in expressions:
+        if expression.bounds is None:
+            raise CompileError("%s: expression '%s' draws nothing" % (expression.line, expression.name))
+        left, top, right, bottom = expression.bounds
+        box_left, box_top, box_right, box_bottom = MOUTH_BOX
+        if left < box_left or top < box_top or right > box_right or bottom > box_bottom:
+            raise CompileError("%s: expression '%s' reaches (%d, %d)-(%d, %d), outside the mouth box "
+                               "(%d, %d)-(%d, %d)" % ((expression.line, expression.name) +
+                                                      tuple(expression.bounds) + MOUTH_BOX))
+        expression.code.append(OP_END)
+    return expressions
+
+
+def generate(expressions):
+    source = os.path.relpath(SOURCE, ROOT)
+    banner = ("// Generated by tools/expression_compiler.py from %s - do not edit.\n"
+              "// Rerun the compiler after changing the expressions.\n" % source)
+
+    header = [banner, "#ifndef BMO_EXPRESSIONS_H", "#define BMO_EXPRESSIONS_H", "",
+              "#include <Arduino.h>", '#include "expression_ops.h"', "",
+              "#define EXPRESSION_FORMAT %d" % FORMAT_VERSION, "",
+              "// Expression types (in expressions.txt order)", "enum BMOExpression {"]
+    for index, expression in enumerate(expressions):
+        suffix = " = 0," if index == 0 else ","
+        header.append("  EXPRESSION_%s%s" % (expression.name.upper(), suffix))
+    header += ["  EXPRESSION_COUNT", "};", "",
+               "// Display lists, back to back, and where each one starts (const, so in flash)",
+               "extern const uint8_t bmoExpressionProgram[];",
+               "extern const uint16_t bmoExpressionProgramSize;",
+               "extern const BMOExpressionInfo bmoExpressionTable[EXPRESSION_COUNT];",
+               "", "#endif // BMO_EXPRESSIONS_H", ""]
+
+    tables = [banner, '#include "expressions.h"', "",
+              "const uint8_t bmoExpressionProgram[] = {"]
+    offsets = []
+    offset = 0
+    for expression in expressions:
+        offsets.append(offset)
+        tables.append("  // %s" % expression.name)
+        code = expression.code
+        for start in range(0, len(code), 16):
+            tables.append("  " + " ".join("0x%02X," % byte for byte in code[start:start + 16]))
+        offset += len(code)
+    if offset > 0xFFFF:
+        raise CompileError("program is %d bytes, offsets are 16-bit" % offset)
+    tables += ["};", "",
+               "const uint16_t bmoExpressionProgramSize = sizeof(bmoExpressionProgram);", "",
+               "const BMOExpressionInfo bmoExpressionTable[EXPRESSION_COUNT] = {",
+               "  // offset, left, top, width, height, eyes"]
+    for expression, start in zip(expressions, offsets):
+        left, top, right, bottom = expression.bounds
+        tables.append("  { %4d, %4d, %4d, %3d, %3d, %d },  // %s" %
+                      (start, left, top, right - left + 1, bottom - top + 1,
+                       EYES[expression.eyes], expression.name))
+    tables += ["};", ""]
+
+    return "\n".join(header), "\n".join(tables)
+
+
+def expression_names(path=SOURCE):
+    """Expression names in id order (used by bmo_ctl.py)."""
+    return [expression.name for expression in parse(path)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile BMO expressions into bytecode")
+    parser.add_argument("--source", default=SOURCE)
+    parser.add_argument("--check", action="store_true", help="fail if the generated sources are stale")
+    parser.add_argument("--list", action="store_true", help="print each expression and its bounds")
+    args = parser.parse_args()
+
+    try:
+        expressions = parse(args.source)
+        header, tables = generate(expressions)
+    except (CompileError, OSError) as error:
+        print(error, file=sys.stderr)
+        return 1
+
+    if args.list:
+        for index, expression in enumerate(expressions):
+            left, top, right, bottom = expression.bounds
+            print("%3d %-12s eyes=%-6s %3d bytes  (%d, %d)-(%d, %d)" %
+                  (index, expression.name, expression.eyes, len(expression.code), left, top, right, bottom))
+        return 0
+
+    outputs = [(HEADER, header), (TABLES, tables)]
+    if args.check:
+        stale = []
+        for path, text in outputs:
+            try:
+                with open(path) as existing:
+                    if existing.read() == text:
+                        continue
+            except OSError:
+                pass
+            stale.append(os.path.relpath(path, ROOT))
+        if stale:
+            print("stale: %s (run tools/expression_compiler.py)" % ", ".join(stale), file=sys.stderr)
+            return 1
+        return 0
+
+    for path, text in outputs:
+        with open(path, "w") as output:
+            output.write(text)
+    size = sum(len(expression.code) for expression in expressions)
+    print("%d expressions, %d bytes of bytecode" % (len(expressions), size))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,408 @@
+/*
+ * BMO Graphics Check
+ *
+ * Runs the firmware's renderer on the host against the simulated panel in
+ * tools/host/ and checks what the panel would show. Pixel buffers go
+ * through the same byte-order rules as on the ESP32, so a row pushed in the
+ * wrong order shows up with the wrong colors here too. It checks that the
+ * background around the eyes matches the gradient, that the eyes repainted
+ * step by step while the gaze moves end up where a full redraw puts them,
+ * that QOI images land pixel for pixel whether they are inside the clip or
+ * cut by it, that raw sprites do too without a 32-bit FIFO load from a
+ * misaligned row, that a fade goes out a band per slice without holding the
+ * loop, that both controllers show true colors, that paths fill right
+ * out to the coordinate limit and the same wherever they sit, and how long
+ * a face takes on the bus.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_ASSETS=1 tools/graphics_check.cpp tools/host/*.cpp src/*.cpp -o graphics_check
+//   ./graphics_check
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_ASSETS=1 -DBMO_ENABLE_DITHER=1 tools/graphics_check.cpp tools/host/*.cpp src/*.cpp -o graphics_check_dither
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_ASSETS=1 -DBMO_ENABLE_DMA=1 tools/graphics_check.cpp tools/host/*.cpp src/*.cpp -o graphics_check_dma
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "path.h"
+
+#if !BMO_ENABLE_ASSETS
+#error "graphics_check draws images and sprites: build with -DBMO_ENABLE_ASSETS=1"
+#endif
+
+typedef BMOGraphics::Face Face;
+
+static int failures = 0;
+
+static void report(const char* name, uint32_t bad, uint32_t total) {
+  printf("%s: %u of %u pixels wrong\n", name, (unsigned)bad, (unsigned)total);
+  if (bad) failures++;
+}
+
+static std::vector<uint16_t> capture() {
+  std::vector<uint16_t> screen((size_t)BMOActivePanel::WIDTH * BMOActivePanel::HEIGHT);
+  for (int y = 0; y < BMOActivePanel::HEIGHT; y++) {
+    for (int x = 0; x < BMOActivePanel::WIDTH; x++) {
+      screen[(size_t)y * BMOActivePanel::WIDTH + x] = hostPanelColor(0, x, y);
+    }
+  }
+  return screen;
+}
+
+// Reference image: a pattern with different red, green and blue at every
+// pixel (so a swapped byte shows), with a transparent hole in the middle
+#define IMAGE_WIDTH   37        // Odd, so clipped rows start at odd addresses
+#define IMAGE_HEIGHT  50
+
+static uint8_t imageAlpha(int x, int y) {
+  int dx = x - IMAGE_WIDTH / 2, dy = y - IMAGE_HEIGHT / 2;
+  return dx * dx + dy * dy < 36 ? 0 : 255;
+}
+
+static void imageRgb(int x, int y, uint8_t& r, uint8_t& g, uint8_t& b) {
+  r = (uint8_t)(x * 7);
+  g = (uint8_t)(y * 5);
+  b = (uint8_t)(255 - ((x ^ y) * 6));
+}
+
+static std::vector<uint8_t> encodeImage() {
+  // Every pixel as a QOI_OP_RGBA, which any decoder must take
+  std::vector<uint8_t> file = { 'q', 'o', 'i', 'f', 0, 0, 0, IMAGE_WIDTH, 0, 0, 0, IMAGE_HEIGHT, 4, 0 };
+  for (int y = 0; y < IMAGE_HEIGHT; y++) {
+    for (int x = 0; x < IMAGE_WIDTH; x++) {
+      uint8_t r, g, b;
+      imageRgb(x, y, r, g, b);
+      file.insert(file.end(), { 0xFF, r, g, b, imageAlpha(x, y) });
+    }
+  }
+  file.insert(file.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+  return file;
+}
+
+struct MemoryRead {
+  const std::vector<uint8_t>* data;
+  size_t pos;
+};
+
+static int32_t readMemory(uint8_t* buffer, uint32_t length, void* context) {
+  MemoryRead* file = static_cast<MemoryRead*>(context);
+  size_t count = file->data->size() - file->pos;
+  if (count > length) count = length;
+  memcpy(buffer, file->data->data() + file->pos, count);
+  file->pos += count;
+  return (int32_t)count;
+}
+
+// Counts the pixels that differ from the reference image drawn at x, y
+// inside the clip (transparent ones as the background, or ignored with
+// alpha off as a raw sprite has none), or were touched outside it
+static uint32_t countImageErrors(BMOGraphics& graphics, int x, int y, bool alpha, uint32_t& total) {
+  const BMOClipRect& clip = graphics.getClip();
+  uint32_t bad = 0;
+  for (int py = 0; py < BMOActivePanel::HEIGHT; py++) {
+    for (int px = 0; px < BMOActivePanel::WIDTH; px++) {
+      int ix = px - x, iy = py - y;
+      bool inImage = ix >= 0 && iy >= 0 && ix < IMAGE_WIDTH && iy < IMAGE_HEIGHT;
+      bool inClip = px >= clip.x0 && py >= clip.y0 && px < clip.x1 && py < clip.y1;
+      if (!inImage || !inClip) {
+        if (hostPanelWritten(0, px, py)) bad++;
+        continue;
+      }
+      uint8_t r, g, b;
+      imageRgb(ix, iy, r, g, b);
+      uint16_t expected = !alpha || imageAlpha(ix, iy) ? (uint16_t)((r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3)
+                                                       : (uint16_t)BMO_TEAL;
+      total++;
+      if (hostPanelColor(0, px, py) != expected) bad++;
+    }
+  }
+  return bad;
+}
+
+// Draws the image at x, y over a cleared panel and checks it
+static void checkImage(BMOGraphics& graphics, const std::vector<uint8_t>& file, const char* name,
+                       int x, int y) {
+  hostPanelClear(0);
+  MemoryRead read = { &file, 0 };
+  bool drawn = graphics.drawImage(readMemory, &read, x, y, BMO_TEAL);
+  uint32_t total = 0;
+  uint32_t bad = countImageErrors(graphics, x, y, true, total) + (drawn ? 0 : 1);
+  report(name, bad, total);
+}
+
+// A pack with the reference image as one raw sprite (panel byte order),
+// mapped by the firmware's loader from a temporary file
+static bool writeSpritePack(BMOAssetPack& pack) {
+  std::vector<uint8_t> file(sizeof(BMOAssetHeader) + sizeof(BMOAssetEntry));
+  BMOAssetHeader* header = reinterpret_cast<BMOAssetHeader*>(file.data());
+  BMOAssetEntry* entry = reinterpret_cast<BMOAssetEntry*>(file.data() + sizeof(BMOAssetHeader));
+  memcpy(header->magic, ASSET_MAGIC, 4);
+  header->version = ASSET_VERSION;
+  header->count = 1;
+  strcpy(entry->name, "pattern");
+  entry->width = IMAGE_WIDTH;
+  entry->height = IMAGE_HEIGHT;
+  entry->format = ASSET_FORMAT_RGB565;
+  entry->offset = (uint32_t)file.size();
+  entry->length = IMAGE_WIDTH * IMAGE_HEIGHT * 2;
+  for (int y = 0; y < IMAGE_HEIGHT; y++) {
+    for (int x = 0; x < IMAGE_WIDTH; x++) {
+      uint8_t r, g, b;
+      imageRgb(x, y, r, g, b);
+      uint16_t color = (uint16_t)((r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3);
+      file.insert(file.end(), { (uint8_t)(color >> 8), (uint8_t)color });
+    }
+  }
+  reinterpret_cast<BMOAssetHeader*>(file.data())->size = (uint32_t)file.size();
+
+  char path[] = "/tmp/bmo_spritesXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return false;
+  bool written = write(fd, file.data(), file.size()) == (ssize_t)file.size();
+  close(fd);
+  bool mapped = written && pack.begin(path) == ASSET_OK;
+  unlink(path);
+  return mapped;
+}
+
+// Draws the raw sprite at x, y over a cleared panel; rows must reach the
+// FIFO from word-aligned addresses however the clip cuts them
+static void checkSprite(BMOGraphics& graphics, const char* name, int x, int y) {
+  hostPanelClear(0);
+  uint32_t unaligned = hostUnalignedReads();
+  bool drawn = graphics.drawSprite("pattern", x, y);
+  uint32_t total = 0;
+  uint32_t bad = countImageErrors(graphics, x, y, false, total) + (drawn ? 0 : 1);
+  report(name, bad, total);
+  if (hostUnalignedReads() != unaligned) {
+    printf("  %u unaligned FIFO loads\n", (unsigned)(hostUnalignedReads() - unaligned));
+    failures++;
+  }
+}
+
+// Pixels around an eye, outside its anti-aliased edge, show the gradient
+static uint32_t checkEyeSurround(BMOGraphics& graphics, int centerX, int centerY, uint32_t& total) {
+  int reach = Face::EYE_RADIUS + 6;
+  int outside = (Face::EYE_RADIUS + 3) * (Face::EYE_RADIUS + 3);
+  uint16_t row[BMOActivePanel::WIDTH];
+  uint32_t bad = 0;
+  for (int y = centerY - reach; y <= centerY + reach; y++) {
+    graphics.renderBackgroundRow(row, 0, BMOActivePanel::WIDTH, y);
+    for (int x = centerX - reach; x <= centerX + reach; x++) {
+      int dx = x - centerX, dy = y - centerY;
+      if (dx * dx + dy * dy <= outside) continue;
+      total++;
+      if (hostPanelColor(0, x, y) != row[x]) bad++;
+    }
+  }
+  return bad;
+}
+
+// Path fills, collected span by span
+static void collectSpan(const BMOSpan& span, void* context) {
+  static_cast<std::vector<BMOSpan>*>(context)->push_back(span);
+}
+
+// A closed quadratic (kind 0) or cubic (kind 1) moved by a number of path
+// units, its control points off the pixel grid
+static std::vector<BMOSpan> fillCurve(int kind, int32_t shift) {
+  BMOPath path;
+  path.setTolerance(1);  // Every segment it may take
+  path.moveTo(PATH_PX(20) + 3 + shift, PATH_PX(60) + 5 + shift);
+  if (kind == 0) {
+    path.quadTo(PATH_PX(70) + 7 + shift, PATH_PX(5) + 1 + shift, PATH_PX(130) + 11 + shift, PATH_PX(70) + 9 + shift);
+  } else {
+    path.cubicTo(PATH_PX(40) + 13 + shift, PATH_PX(2) + 6 + shift, PATH_PX(110) + 2 + shift,
+                 PATH_PX(130) + 15 + shift, PATH_PX(130) + 7 + shift, PATH_PX(40) + 3 + shift);
+  }
+  path.close();
+  std::vector<BMOSpan> spans;
+  path.fill(collectSpan, &spans, BMO_BLACK);
+  return spans;
+}
+
+static void checkPaths() {
+  // A triangle from corner to corner of the coordinate range: its
+  // crossings' products outgrow 32 bits. Row by row it runs from the
+  // diagonal to the right edge.
+  const int limit = 2040;
+  BMOPath path;
+  path.moveTo(PATH_PX(-limit), PATH_PX(-limit));
+  path.lineTo(PATH_PX(limit), PATH_PX(limit));
+  path.lineTo(PATH_PX(limit), PATH_PX(-limit));
+  path.close();
+  std::vector<BMOSpan> spans;
+  path.fill(collectSpan, &spans, BMO_BLACK);
+  uint32_t bad = spans.size() != 2 * limit;
+  for (const BMOSpan& span : spans) bad += span.x0 != span.y || span.x1 != limit - 1;
+  report("Path at the coordinate limit", bad, 2 * limit);
+
+  // Curves moved by whole pixels into negative coordinates fill the same
+  // spans, moved: their points round the same way on both sides of zero
+  const int shift = -400;
+  for (int kind = 0; kind < 2; kind++) {
+    std::vector<BMOSpan> expected = fillCurve(kind, 0);
+    std::vector<BMOSpan> moved = fillCurve(kind, PATH_PX(shift));
+    bad = expected.size() != moved.size();
+    for (size_t i = 0; i < expected.size() && i < moved.size(); i++) {
+      bad += moved[i].y != expected[i].y + shift || moved[i].x0 != expected[i].x0 + shift ||
+             moved[i].x1 != expected[i].x1 + shift;
+    }
+    report(kind == 0 ? "Quadratic moved below zero" : "Cubic moved below zero", bad, (uint32_t)expected.size());
+  }
+}
+
+int main() {
+  checkPaths();
+
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    printf("display: begin failed\nFAILED\n");
+    return 1;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+#if BMO_ENABLE_DMA
+  // Queued rows reach the panels through the queue's sink
+  if (display.getSpiQueue()) display.getSpiQueue()->setSink(hostSpiSink, nullptr);
+#endif
+
+  // Eye rows carry their background, so they show a byte order mistake
+  // first; the gradient between the eyes is drawn by restoreBackground()
+  uint32_t start = micros();
+  graphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  uint32_t faceUs = micros() - start;
+  int eyeY = Face::CENTER_Y + Face::EYE_Y_OFFSET;
+  int leftX = Face::CENTER_X - Face::EYE_SEPARATION / 2;
+  int rightX = Face::CENTER_X + Face::EYE_SEPARATION / 2;
+  uint32_t total = 0;
+  uint32_t bad = checkEyeSurround(graphics, leftX, eyeY, total);
+  bad += checkEyeSurround(graphics, rightX, eyeY, total);
+  report("Eye background", bad, total);
+
+  uint16_t row[BMOActivePanel::WIDTH];
+  bad = 0;
+  total = 0;
+  for (int y = eyeY - Face::EYE_RADIUS; y <= eyeY + Face::EYE_RADIUS; y++) {
+    graphics.renderBackgroundRow(row, 0, BMOActivePanel::WIDTH, y);
+    total++;
+    if (hostPanelColor(0, Face::CENTER_X, y) != row[Face::CENTER_X]) bad++;
+  }
+  report("Gradient between the eyes", bad, total);
+
+  // The eye center is black, its highlight white
+  bad = hostPanelColor(0, leftX + Face::scale(6), eyeY + Face::scale(6)) != BMO_BLACK;
+  bad += hostPanelColor(0, leftX - Face::scale(8), eyeY - Face::scale(8)) != BMO_WHITE;
+  report("Eye colors", bad, 2);
+
+  // Gaze repaints send only the runs that changed; after a glance the panel
+  // must hold what a full redraw at the final gaze draws
+  graphics.lookAt(100, -60);
+  int steps = 0;
+  while (graphics.updateGaze() && steps < 200) {
+    hostAdvance(GAZE_FRAME_INTERVAL * 1000);
+    steps++;
+  }
+  std::vector<uint16_t> repainted = capture();
+  hostPanelClear(0);
+  graphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  std::vector<uint16_t> redrawn = capture();
+  bad = 0;
+  for (size_t i = 0; i < redrawn.size(); i++) bad += repainted[i] != redrawn[i];
+  report("Gaze repaint against full redraw", bad, (uint32_t)redrawn.size());
+
+  // Inside the clip an image is one window filled band by band; cut by the
+  // panel edge or a narrower clip it goes through pushImage() per band
+  std::vector<uint8_t> image = encodeImage();
+  checkImage(graphics, image, "Image inside the clip", 20, 30);
+  checkImage(graphics, image, "Image cut by the panel edge", -11, BMOActivePanel::HEIGHT - 23);
+  if (graphics.pushClip(40, 40, 21, 33)) {
+    checkImage(graphics, image, "Image cut by a clip", 31, 29);
+    graphics.popClip();
+  }
+
+  // Raw sprites go straight from the mapped pack while every row starts
+  // word aligned, through a line buffer when the clip cuts them mid-word
+  BMOAssetPack pack;
+  if (writeSpritePack(pack)) {
+    graphics.setAssets(&pack);
+    checkSprite(graphics, "Sprite inside the clip", 20, 30);
+    checkSprite(graphics, "Sprite cut at the top", 20, -7);
+    checkSprite(graphics, "Sprite cut by the panel edge", -11, BMOActivePanel::HEIGHT - 23);
+    if (graphics.pushClip(40, 40, 21, 33)) {
+      checkSprite(graphics, "Sprite cut by a clip", 31, 29);
+      graphics.popClip();
+    }
+    graphics.setAssets(nullptr);
+  } else {
+    printf("Sprite pack: can't write or map it\n");
+    failures++;
+  }
+
+  // A fade is a scheduled job: a band per slice, each step on its way from
+  // teal to black in every channel, and no time spent but the bus's
+  hostPanelClear(0);
+  const int fadeSteps = 4;
+  graphics.fadeTransition(BMO_TEAL, BMO_BLACK, fadeSteps);
+  int slices = 0;
+  uint32_t fadeStart = micros();
+  uint32_t firstStepUs = 0;
+  bad = 0;
+  total = 0;
+  while (display.isPanelBusy(0) && slices < 1000) {
+    display.serviceJobs();
+    slices++;
+    if (slices * FACE_BAND_ROWS < BMOActivePanel::HEIGHT) continue;
+    if (firstStepUs) continue;
+    firstStepUs = micros() - fadeStart;
+    for (int y = 0; y < BMOActivePanel::HEIGHT; y++) {
+      for (int x = 0; x < BMOActivePanel::WIDTH; x++) {
+        uint16_t color = hostPanelColor(0, x, y);
+        bool between = (color >> 11) <= (BMO_TEAL >> 11) && ((color >> 5) & 0x3F) <= ((BMO_TEAL >> 5) & 0x3F) &&
+                       (color & 0x1F) <= (BMO_TEAL & 0x1F);
+        total++;
+        if (!between || color == BMO_TEAL || color == BMO_BLACK) bad++;
+      }
+    }
+  }
+  uint32_t fadeUs = micros() - fadeStart;
+  report("Fade first step", bad, total);
+  bad = 0;
+  for (int y = 0; y < BMOActivePanel::HEIGHT; y++) {
+    for (int x = 0; x < BMOActivePanel::WIDTH; x++) bad += hostPanelColor(0, x, y) != BMO_BLACK;
+  }
+  report("Fade end", bad, BMOActivePanel::WIDTH * BMOActivePanel::HEIGHT);
+  int bands = (BMOActivePanel::HEIGHT + FACE_BAND_ROWS - 1) / FACE_BAND_ROWS;
+  if (slices != fadeSteps * bands || fadeUs > firstStepUs * fadeSteps * 3 / 2) {
+    printf("Fade: %d slices (expected %d), %u us for steps of %u us\n", slices, fadeSteps * bands,
+           (unsigned)fadeUs, (unsigned)firstStepUs);
+    failures++;
+  }
+  printf("Fade: %d slices, %.2f ms\n", slices, fadeUs / 1000.0);
+
+  // Color order comes with the controller: the same profile on an ST7789
+  // (RGB glass) shows the colors an ILI9341 (BGR glass) does
+  for (uint8_t controller = HOST_ILI9341; controller <= HOST_ST7789; controller++) {
+    hostResetPanels();
+    hostAddPanel(BMO_FACE_CS, controller);
+    BMODisplay other;
+    BMOGraphics otherGraphics;
+    bad = 1;
+    if (other.begin()) {
+      otherGraphics.begin(&other);
+      otherGraphics.fillBlended(0, 0, 8, 8, BMO_TEAL, BMO_TEAL, 0);
+      bad = hostPanelColor(0, 4, 4) != BMO_TEAL;
+    }
+    report(controller == HOST_ST7789 ? "Colors on an ST7789" : "Colors on an ILI9341", bad, 1);
+  }
+
+  printf("Face: %.2f ms on the bus, gaze settled in %d steps\n", faceUs / 1000.0, steps);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * BMO Host Arduino Stand-in
+ *
+ * Just enough of the Arduino core for the firmware sources in src/ to build
+ * and run on Linux, for the host check harnesses in tools/. Together with the
+ * TFT_eSPI stand-in next to it, the sketch's modules run unchanged against
+ * a simulated panel.
+ *
+ * Features:
+ * - Simulated clock: micros()/millis() only move when delay() is called,
+ *   the simulated SPI bus sends bytes (see TFT_eSPI.h), or a test advances
+ *   it (host.h), so every run is repeatable
+ * - Serial as a Stream: output is captured (with an optional echo to
+ *   stdout), input is injected by the test, and the USB CDC transmit buffer
+ *   drains at a set rate so availableForWrite() behaves like the device's
+ * - Pin levels recorded, so the panel model can follow chip selects
+ * - Any file descriptor (a pty, a pipe) wrapped as a Stream
+ *
+ * A harness builds from the repository root with every .cpp file in src/ and
+ * tools/host/ - see the build line at the top of each check.
+ */
+
+#ifndef BMO_HOST_ARDUINO_H
+#define BMO_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define ARDUINO 10800
+
+#define INPUT    0x00
+#define OUTPUT   0x03
+#define LOW      0
+#define HIGH     1
+
+#define PROGMEM
+#define IRAM_ATTR
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Time (simulated, see host.h)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Pins
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogWriteFrequency(uint8_t pin, uint32_t frequency);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+template <class T>
+T constrain(T value, T low, T high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t byte) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char* text) { return write(text); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value);
+  size_t print(unsigned int value);
+  size_t print(long value);
+  size_t print(unsigned long value);
+  size_t print(double value, int digits = 2);
+  size_t println() { return write("\r\n"); }
+  template <class T>
+  size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  size_t readBytes(uint8_t* buffer, size_t length);
+  size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
+protected:
+  unsigned long timeout = 1000;
+};
+
+// The sketch's Serial (native USB CDC on the device)
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  void setRxBufferSize(size_t size) { (void)size; }
+  void setTxBufferSize(size_t size);
+  operator bool() const { return true; }
+
+  size_t write(uint8_t byte) override { return write(&byte, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int availableForWrite() override;
+  void flush() override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  using Print::write;
+};
+
+extern HostSerial Serial;
+
+// A file descriptor as a Stream - the slave side of a pty, a pipe. Reads
+// never block; writes block until the descriptor takes everything.
+class HostFdStream : public Stream {
+public:
+  explicit HostFdStream(int fd = -1) : fd(fd), peeked(-1) {}
+  void attach(int fd) { this->fd = fd; peeked = -1; }
+  int getFd() const { return fd; }
+
+  size_t write(uint8_t byte) override { return write(&byte, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int availableForWrite() override { return fd >= 0 ? 4096 : 0; }
+  int available() override;
+  int read() override;
+  int peek() override;
+  using Print::write;
+
+private:
+  int fd;
+  int peeked;
+};
+
+// Heap figures (the host reports what the allocator counted, see memory.h)
+class EspClass {
+public:
+  uint32_t getHeapSize() { return 320 * 1024; }
+  uint32_t getFreeHeap() { return 256 * 1024; }
+  uint32_t getMinFreeHeap() { return 256 * 1024; }
+  uint32_t getMaxAllocHeap() { return 128 * 1024; }
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
+
+#endif // BMO_HOST_ARDUINO_H
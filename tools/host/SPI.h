@@ -0,0 +1,48 @@
+/*
+ * BMO Host SPI Stand-in
+ *
+ * The firmware includes SPI.h for TFT_eSPI, and reads registers TFT_eSPI
+ * can't through TFT_eSPI's SPIClass. Transfers go to the simulated bus in
+ * the TFT_eSPI stand-in, command or data by the DC pin's level.
+ */
+
+#ifndef BMO_HOST_SPI_H
+#define BMO_HOST_SPI_H
+
+#include <Arduino.h>
+
+#define SPI_MODE0  0
+#define SPI_MODE3  3
+#ifndef MSBFIRST
+#define MSBFIRST   1
+#endif
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+    : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+  uint32_t clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+  }
+  void end() {}
+  void beginTransaction(SPISettings settings) { clock = settings.clock; }
+  void endTransaction() {}
+  uint8_t transfer(uint8_t data);  // What the selected panel drives on MISO meanwhile
+
+private:
+  uint32_t clock = 1000000;
+};
+
+extern SPIClass SPI;
+
+#endif // BMO_HOST_SPI_H
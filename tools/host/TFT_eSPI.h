@@ -0,0 +1,103 @@
+/*
+ * BMO Host TFT_eSPI Stand-in
+ *
+ * The subset of TFT_eSPI the firmware calls, driving the simulated panels
+ * in host.h instead of an SPI peripheral. Primitives rasterize the way
+ * TFT_eSPI 2.5 does (same algorithms, same horizontal/vertical runs), the
+ * viewport clips them, and pixel buffers honor setSwapBytes() exactly as the
+ * ESP32 build does. Every byte is charged to the simulated clock at the SPI
+ * clock rate, so timings measured by the firmware are bus-bound as on the
+ * device.
+ */
+
+#ifndef BMO_HOST_TFT_ESPI_H
+#define BMO_HOST_TFT_ESPI_H
+
+#include <Arduino.h>
+#include <SPI.h>
+
+// Built like a multi-panel setup: BMODisplay drives every chip select, so
+// the panel model sees which panels each transfer reaches
+#ifndef TFT_CS
+#define TFT_CS  -1
+#endif
+#ifndef TFT_WIDTH
+#define TFT_WIDTH  240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t width = TFT_WIDTH, int16_t height = TFT_HEIGHT);
+
+  void init(uint8_t tabColor = 0);
+  void begin(uint8_t tabColor = 0) { init(tabColor); }
+  void setRotation(uint8_t rotation);
+  uint8_t getRotation() { return rotation; }
+  int16_t width() { return _width; }
+  int16_t height() { return _height; }
+
+  // Controller access
+  void writecommand(uint8_t command);
+  void writedata(uint8_t data);
+  uint8_t readcommand8(uint8_t command, uint8_t index = 0);
+  static SPIClass& getSPIinstance() { return SPI; }
+
+  // Transactions (nothing to hold on the host)
+  void startWrite() {}
+  void endWrite() {}
+
+  // Primitives
+  void fillScreen(uint32_t color);
+  void drawPixel(int32_t x, int32_t y, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void drawCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t cornername, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color);
+
+  // Pixel streams
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+  void pushPixels(const void* data, uint32_t length);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() { return _swapBytes; }
+  void readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data);
+
+  // Viewport (vpDatum false: screen coordinates kept, only clipping)
+  void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+  void resetViewport();
+
+  size_t write(uint8_t) override { return 1; }
+
+private:
+  int16_t _init_width, _init_height;
+  int16_t _width, _height;
+  uint8_t rotation;
+  bool _swapBytes;
+
+  // Viewport clip, screen coordinates (x0 <= x < x1), and datum offset
+  int32_t vpX0, vpY0, vpX1, vpY1;
+  int32_t datumX, datumY;
+
+  // Address window and write position, screen coordinates
+  int32_t winX0, winY0, winX1, winY1;
+  int32_t curX, curY;
+
+  // Command being received and its parameter count so far
+  uint8_t command;
+  uint8_t parameter;
+
+  void window(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+  void span(int32_t x, int32_t y, int32_t w, uint16_t color);  // Unclipped run, one window
+};
+
+#endif // BMO_HOST_TFT_ESPI_H
@@ -0,0 +1,309 @@
+/*
+ * BMO Host Arduino Stand-in Implementation
+ *
+ * Simulated clock, Serial with a draining transmit buffer, pins and
+ * descriptor streams
+ */
+
+#include "host.h"
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <deque>
+
+HostSerial Serial;
+EspClass ESP;
+
+// --- Clock ---
+
+static uint64_t clockUs = 0;
+static uint32_t autoAdvanceUs = 0;
+static uint64_t busRemainder = 0;  // Bit-time left over from the last charge, in bits * 1e6
+
+unsigned long micros() {
+  clockUs += autoAdvanceUs;
+  return (unsigned long)(uint32_t)clockUs;
+}
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(micros() / 1000);
+}
+
+void delay(unsigned long ms) {
+  clockUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  clockUs += us;
+}
+
+void yield() {
+  clockUs++;
+}
+
+void hostAdvance(uint32_t us) {
+  clockUs += us;
+}
+
+void hostSetAutoAdvance(uint32_t us) {
+  autoAdvanceUs = us;
+}
+
+void hostChargeBus(uint64_t bits, uint32_t hz) {
+  uint64_t total = bits * 1000000 + busRemainder;
+  clockUs += total / hz;
+  busRemainder = total % hz;
+}
+
+// --- Serial ---
+
+static std::deque<uint8_t> serialInput;
+static std::string serialOutput;
+static int serialEcho = -1;           // -1: from BMO_HOST_ECHO in the environment
+static uint32_t serialRate = 0;       // Transmit buffer drain, bytes per second (0: instant)
+static uint32_t serialQueued = 0;
+static uint32_t serialBuffer = HOST_SERIAL_TX_BUFFER;
+static uint64_t serialDrainedAt = 0;  // Clock when serialQueued was last brought up to date
+
+static void drainSerial() {
+  if (serialRate == 0) {
+    serialQueued = 0;
+    serialDrainedAt = clockUs;
+    return;
+  }
+  uint64_t sent = (clockUs - serialDrainedAt) * serialRate / 1000000;
+  if (sent == 0) return;
+  serialQueued = sent >= serialQueued ? 0 : serialQueued - (uint32_t)sent;
+  serialDrainedAt += sent * 1000000 / serialRate;
+  if (serialQueued == 0) serialDrainedAt = clockUs;
+}
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialEcho < 0) serialEcho = getenv("BMO_HOST_ECHO") ? 1 : 0;
+  if (serialEcho) fwrite(buffer, 1, size, stdout);
+  serialOutput.append((const char*)buffer, size);
+
+  // A full buffer blocks the writer until the host reads enough, as the
+  // USB CDC driver does
+  for (size_t i = 0; i < size; i++) {
+    drainSerial();
+    if (serialRate && serialQueued >= serialBuffer) {
+      clockUs += 1000000 / serialRate + 1;
+      drainSerial();
+    }
+    if (serialRate) serialQueued++;
+  }
+  return size;
+}
+
+void HostSerial::setTxBufferSize(size_t size) {
+  serialBuffer = size ? (uint32_t)size : HOST_SERIAL_TX_BUFFER;
+}
+
+int HostSerial::availableForWrite() {
+  drainSerial();
+  return (int)serialBuffer - (int)serialQueued;
+}
+
+void HostSerial::flush() {
+  drainSerial();
+  if (serialQueued) {
+    clockUs += (uint64_t)serialQueued * 1000000 / serialRate + 1;
+    drainSerial();
+  }
+}
+
+int HostSerial::available() {
+  return (int)serialInput.size();
+}
+
+int HostSerial::read() {
+  if (serialInput.empty()) return -1;
+  int byte = serialInput.front();
+  serialInput.pop_front();
+  return byte;
+}
+
+int HostSerial::peek() {
+  return serialInput.empty() ? -1 : serialInput.front();
+}
+
+void hostSerialInject(const uint8_t* data, size_t length) {
+  serialInput.insert(serialInput.end(), data, data + length);
+}
+
+std::string& hostSerialOutput() {
+  return serialOutput;
+}
+
+void hostSerialEcho(bool echo) {
+  serialEcho = echo ? 1 : 0;
+}
+
+void hostSerialSetRate(uint32_t bytesPerSecond) {
+  drainSerial();
+  serialRate = bytesPerSecond;
+  serialDrainedAt = clockUs;
+}
+
+uint32_t hostSerialTxQueued() {
+  drainSerial();
+  return serialQueued;
+}
+
+// --- Print and Stream ---
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (size--) written += write(*buffer++);
+  return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char text[64];  // The Arduino core's stack buffer
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(text)) return write((const uint8_t*)text, length);
+
+  // Longer than the stack buffer, as the Arduino core falls back to the heap
+  char* longText = (char*)malloc(length + 1);
+  if (!longText) return 0;
+  va_start(args, format);
+  vsnprintf(longText, length + 1, format, args);
+  va_end(args);
+  size_t written = write((const uint8_t*)longText, length);
+  free(longText);
+  return written;
+}
+
+size_t Print::print(int value) { return printf("%d", value); }
+size_t Print::print(unsigned int value) { return printf("%u", value); }
+size_t Print::print(long value) { return printf("%ld", value); }
+size_t Print::print(unsigned long value) { return printf("%lu", value); }
+size_t Print::print(double value, int digits) { return printf("%.*f", digits, value); }
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  // Nothing arrives while a host check waits, so no timeout is spent
+  size_t count = 0;
+  while (count < length) {
+    int byte = read();
+    if (byte < 0) break;
+    buffer[count++] = (uint8_t)byte;
+  }
+  return count;
+}
+
+// --- Descriptor streams ---
+
+size_t HostFdStream::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (fd >= 0 && written < size) {
+    ssize_t n = ::write(fd, buffer + written, size - written);
+    if (n > 0) {
+      written += (size_t)n;
+    } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+      break;
+    } else {
+      struct pollfd ready = { fd, POLLOUT, 0 };
+      poll(&ready, 1, 100);
+    }
+  }
+  return written;
+}
+
+int HostFdStream::available() {
+  if (fd < 0) return 0;
+  if (peeked >= 0) return 1;
+  // What's buffered, as the core's available() reports it
+  int count = 0;
+  if (ioctl(fd, FIONREAD, &count) == 0 && count > 0) return count;
+  struct pollfd ready = { fd, POLLIN, 0 };
+  return poll(&ready, 1, 0) > 0 && (ready.revents & POLLIN) ? 1 : 0;
+}
+
+int HostFdStream::read() {
+  if (peeked >= 0) {
+    int byte = peeked;
+    peeked = -1;
+    return byte;
+  }
+  if (!available()) return -1;
+  uint8_t byte;
+  return ::read(fd, &byte, 1) == 1 ? byte : -1;
+}
+
+int HostFdStream::peek() {
+  if (peeked < 0) peeked = read();
+  return peeked;
+}
+
+// --- Pins ---
+
+static uint8_t pinLevels[256];
+static int analogLevels[256];
+static bool pinsSet = false;
+
+static void initPins() {
+  // Everything idles high (chip selects and reset have pull-ups)
+  if (pinsSet) return;
+  memset(pinLevels, HIGH, sizeof(pinLevels));
+  pinsSet = true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  initPins();
+  uint8_t level = value ? HIGH : LOW;
+  if (pinLevels[pin] == level) return;
+  pinLevels[pin] = level;
+  hostPinChanged(pin, level);
+}
+
+int digitalRead(uint8_t pin) {
+  initPins();
+  return pinLevels[pin];
+}
+
+int hostPinLevel(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+void analogWrite(uint8_t pin, int value) {
+  analogLevels[pin] = value;
+}
+
+void analogWriteFrequency(uint8_t pin, uint32_t frequency) {
+  (void)pin;
+  (void)frequency;
+}
+
+int hostAnalogLevel(uint8_t pin) {
+  return analogLevels[pin];
+}
+
+// --- Random ---
+
+static uint32_t randomState = 1;
+
+long random(long max) {
+  if (max <= 0) return 0;
+  randomState = randomState * 1664525u + 1013904223u;
+  return (long)((randomState >> 8) % (uint32_t)max);
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  randomState = (uint32_t)seed ? (uint32_t)seed : 1;
+}
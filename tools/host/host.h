@@ -0,0 +1,120 @@
+/*
+ * BMO Host Harness Controls
+ *
+ * What a host check can do to the world the firmware runs in: move the
+ * clock, feed and read Serial, and look at (or break) the simulated panels
+ * behind the TFT_eSPI stand-in.
+ *
+ * The panel model keeps each panel's memory as the controller decoded it
+ * from the bus: fills and primitives arrive as the color given, pixel
+ * buffers arrive in memory byte order unless TFT_eSPI was told to swap them
+ * - the same as on the ESP32, where a little-endian RGB565 buffer pushed
+ * without setSwapBytes(true) shows up byte-swapped. It also keeps the
+ * registers the watchdog reads back, so faults can be injected.
+ */
+
+#ifndef BMO_HOST_H
+#define BMO_HOST_H
+
+#include <Arduino.h>
+#include <string>
+
+#define HOST_PANELS            4      // Simulated panels on the bus
+#define HOST_PANEL_PIXELS      480    // Panel memory is this square (any rotation fits)
+#define HOST_SPI_HZ            27000000
+#define HOST_SERIAL_TX_BUFFER  256    // USB CDC transmit buffer (bytes) until setTxBufferSize()
+#define HOST_RESET_PIN         9      // TFT_RST in display.h, wired to every panel
+#define HOST_DC_PIN            8      // TFT_DC in display.h, for transfers through SPIClass
+#define HOST_BUS_LOG_SIZE      65536  // Transfers kept by hostBusRecord()
+
+// Clock
+void hostAdvance(uint32_t us);
+void hostSetAutoAdvance(uint32_t us);  // Added on every micros() call, for busy-wait loops
+
+// Serial
+void hostSerialInject(const uint8_t* data, size_t length);
+std::string& hostSerialOutput();           // Everything written so far
+void hostSerialEcho(bool echo);            // Copy output to stdout as well
+void hostSerialSetRate(uint32_t bytesPerSecond);  // Transmit buffer drain rate (0: instant)
+uint32_t hostSerialTxQueued();             // Bytes in the transmit buffer now
+
+// Pins
+int hostPinLevel(uint8_t pin);
+int hostAnalogLevel(uint8_t pin);
+
+// Controllers the model answers as (RDDID)
+enum BMOHostController {
+  HOST_ILI9341 = 0,
+  HOST_ST7789
+};
+
+// One bus transfer seen by a panel
+enum BMOHostBusKind {
+  HOST_BUS_COMMAND = 0,
+  HOST_BUS_WINDOW,
+  HOST_BUS_PIXELS
+};
+
+struct BMOHostBusRecord {
+  uint32_t timestamp;  // micros() when it started
+  uint8_t panels;      // Bitmask of the panels selected
+  uint8_t kind;        // BMOHostBusKind
+  uint32_t count;      // Command byte, or pixels
+};
+
+struct BMOHostPanel {
+  int8_t cs;                 // Chip select pin (-1: always selected)
+  uint8_t controller;        // BMOHostController
+  bool bgrGlass;             // Subpixels wired BGR: MADCTL's BGR bit must be set for true color
+
+  // Registers
+  bool awake;                // Sleep Out
+  bool displayOn;
+  bool configured;           // Power, VCOM, gamma and frame rate set by the init sequence
+  uint8_t madctl;
+  uint8_t colmod;
+
+  // Memory, as the controller decoded it (0x0000-0xFFFF RGB565 from the bus)
+  uint16_t pixels[HOST_PANEL_PIXELS][HOST_PANEL_PIXELS];
+  bool written[HOST_PANEL_PIXELS][HOST_PANEL_PIXELS];
+
+  // Traffic
+  uint32_t commands;
+  uint32_t windows;
+  uint64_t pixelCount;
+  uint32_t resets;           // Hardware resets and brown-outs
+};
+
+// Add a simulated panel on a chip select pin, wired as the modules are: an
+// ILI9341 behind BGR glass, an ST7789 behind RGB glass. Returns its index.
+int hostAddPanel(int8_t cs, uint8_t controller);
+BMOHostPanel* hostPanel(uint8_t index);
+uint8_t hostPanelCount();
+void hostResetPanels();  // Back to no panels, fresh model
+
+// The color a pixel shows (RGB565, red and blue exchanged when MADCTL's BGR
+// bit doesn't match the glass); 0 if never written
+uint16_t hostPanelColor(uint8_t index, int x, int y);
+bool hostPanelWritten(uint8_t index, int x, int y);
+void hostPanelClear(uint8_t index);  // Forget memory contents, keep registers
+
+// Faults: a brown-out puts every register back to its power-on value and
+// leaves memory as garbage; a glitch corrupts one register and nothing else
+void hostPanelBrownOut(uint8_t index);
+void hostPanelGlitch(uint8_t index, uint8_t command, uint8_t value);
+
+// Bus log (off until enabled; recording stops when the log is full)
+void hostBusRecord(bool enable);
+uint32_t hostBusLog(const BMOHostBusRecord** records);
+uint32_t hostUnalignedReads();  // 32-bit FIFO loads from an address that wasn't word aligned
+
+// Raw bus traffic, as BMOSpiQueue's host sink delivers it (isData = DC high):
+// queue->setSink(hostSpiSink, nullptr) puts queued transfers on the panels
+void hostSpiSink(bool isData, const uint8_t* data, uint32_t length, void* context);
+
+// Used by the stand-ins: time the bus takes for a number of bits, and a
+// pin's new level for the panel model
+void hostChargeBus(uint64_t bits, uint32_t hz);
+void hostPinChanged(uint8_t pin, int level);
+
+#endif // BMO_HOST_H
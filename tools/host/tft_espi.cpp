@@ -0,0 +1,859 @@
+/*
+ * BMO Host TFT_eSPI Stand-in Implementation
+ *
+ * TFT_eSPI's drawing calls over a model of the MIPI DCS panels on the bus:
+ * chip selects decide which panels hear a transfer, CASET/RASET/RAMWR fill
+ * each panel's memory, and the registers the firmware reads back follow
+ * what was written to them
+ */
+
+#include "host.h"
+#include <TFT_eSPI.h>
+#include <SPI.h>
+
+SPIClass SPI;
+
+// MIPI DCS commands the model understands
+#define DCS_SWRESET   0x01
+#define DCS_RDDID     0x04
+#define DCS_RDDST     0x09
+#define DCS_RDDPM     0x0A
+#define DCS_RDDMADCTL 0x0B
+#define DCS_RDDCOLMOD 0x0C
+#define DCS_SLPIN     0x10
+#define DCS_SLPOUT    0x11
+#define DCS_DISPOFF   0x28
+#define DCS_DISPON    0x29
+#define DCS_CASET     0x2A
+#define DCS_RASET     0x2B
+#define DCS_RAMWR     0x2C
+#define DCS_MADCTL    0x36
+#define DCS_COLMOD    0x3A
+#define ILI9341_INDEX 0xD9  // Undocumented: which byte of the next read to return
+
+#define HOST_SPI_READ_HZ  20000000
+#define MADCTL_BGR        0x08
+
+// Per-panel bus state behind the registers in BMOHostPanel
+struct PanelBus {
+  int32_t x0, y0, x1, y1;  // Address window (inclusive)
+  int32_t x, y;            // Next pixel
+  uint8_t command;         // Last command, and its parameter bytes so far
+  uint8_t parameter;
+  uint8_t params[4];
+  uint8_t readIndex;       // ILI9341 0xD9 index, 0 when unset
+};
+
+static BMOHostPanel panels[HOST_PANELS];
+static PanelBus buses[HOST_PANELS];
+static uint8_t panelCount = 0;
+static bool recording = false;
+static BMOHostBusRecord busLog[HOST_BUS_LOG_SIZE];
+static uint32_t busLogCount = 0;
+static uint32_t unalignedReads = 0;
+static uint32_t garbageSeed = 12345;
+static bool sinkLowByte = false;     // Raw bus traffic: second byte of a pixel is next
+static uint8_t sinkHighByte = 0;
+
+static void powerOnPanel(BMOHostPanel& panel, PanelBus& bus) {
+  // Register defaults after reset: asleep, display off, 18-bit pixels
+  panel.awake = false;
+  panel.displayOn = false;
+  panel.configured = false;
+  panel.madctl = 0x00;
+  panel.colmod = 0x66;
+  memset(&bus, 0, sizeof(bus));
+}
+
+static void scramblePanel(BMOHostPanel& panel) {
+  // Memory comes up as whatever the cells held
+  for (int y = 0; y < HOST_PANEL_PIXELS; y++) {
+    for (int x = 0; x < HOST_PANEL_PIXELS; x++) {
+      garbageSeed = garbageSeed * 1103515245u + 12345u;
+      panel.pixels[y][x] = (uint16_t)(garbageSeed >> 16);
+    }
+  }
+}
+
+int hostAddPanel(int8_t cs, uint8_t controller) {
+  if (panelCount >= HOST_PANELS) return -1;
+  BMOHostPanel& panel = panels[panelCount];
+  memset(&panel, 0, sizeof(panel));
+  panel.cs = cs;
+  panel.controller = controller;
+  panel.bgrGlass = controller == HOST_ILI9341;
+  powerOnPanel(panel, buses[panelCount]);
+  return panelCount++;
+}
+
+BMOHostPanel* hostPanel(uint8_t index) {
+  return index < panelCount ? &panels[index] : nullptr;
+}
+
+uint8_t hostPanelCount() {
+  return panelCount;
+}
+
+void hostResetPanels() {
+  panelCount = 0;
+  busLogCount = 0;
+  unalignedReads = 0;
+}
+
+uint16_t hostPanelColor(uint8_t index, int x, int y) {
+  if (index >= panelCount || x < 0 || y < 0 || x >= HOST_PANEL_PIXELS || y >= HOST_PANEL_PIXELS) return 0;
+  const BMOHostPanel& panel = panels[index];
+  if (!panel.written[y][x]) return 0;
+  uint16_t color = panel.pixels[y][x];
+  if (((panel.madctl & MADCTL_BGR) != 0) != panel.bgrGlass) {
+    color = (uint16_t)((color & 0x07E0) | (color >> 11) | ((color & 0x1F) << 11));
+  }
+  return color;
+}
+
+bool hostPanelWritten(uint8_t index, int x, int y) {
+  if (index >= panelCount || x < 0 || y < 0 || x >= HOST_PANEL_PIXELS || y >= HOST_PANEL_PIXELS) return false;
+  return panels[index].written[y][x];
+}
+
+void hostPanelClear(uint8_t index) {
+  if (index >= panelCount) return;
+  memset(panels[index].written, 0, sizeof(panels[index].written));
+}
+
+void hostPanelBrownOut(uint8_t index) {
+  if (index >= panelCount) return;
+  powerOnPanel(panels[index], buses[index]);
+  scramblePanel(panels[index]);
+  panels[index].resets++;
+}
+
+void hostPanelGlitch(uint8_t index, uint8_t command, uint8_t value) {
+  if (index >= panelCount) return;
+  BMOHostPanel& panel = panels[index];
+  switch (command) {
+    case DCS_MADCTL: panel.madctl = value; break;
+    case DCS_COLMOD: panel.colmod = value; break;
+    case DCS_SLPIN:  panel.awake = false; break;
+    case DCS_DISPOFF: panel.displayOn = false; break;
+  }
+}
+
+void hostBusRecord(bool enable) {
+  recording = enable;
+  if (enable) busLogCount = 0;
+}
+
+uint32_t hostBusLog(const BMOHostBusRecord** records) {
+  *records = busLog;
+  return busLogCount;
+}
+
+uint32_t hostUnalignedReads() {
+  return unalignedReads;
+}
+
+// --- The bus ---
+
+static void ensurePanel() {
+  // A harness that added no panels gets the face panel on its default pin
+  if (panelCount == 0) hostAddPanel(10, HOST_ILI9341);
+}
+
+static bool isSelected(const BMOHostPanel& panel) {
+  return panel.cs < 0 || hostPinLevel(panel.cs) == LOW;
+}
+
+static void record(uint8_t kind, uint32_t count) {
+  if (!recording || busLogCount >= HOST_BUS_LOG_SIZE) return;
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (isSelected(panels[i])) mask |= 1 << i;
+  }
+  if (!mask) return;
+  BMOHostBusRecord& entry = busLog[busLogCount++];
+  entry.timestamp = (uint32_t)micros();
+  entry.panels = mask;
+  entry.kind = kind;
+  entry.count = count;
+}
+
+void hostPinChanged(uint8_t pin, int level) {
+  // The shared reset line: every panel resets when it is pulled low
+  if (pin == HOST_RESET_PIN && level == LOW) {
+    for (uint8_t i = 0; i < panelCount; i++) {
+      powerOnPanel(panels[i], buses[i]);
+      scramblePanel(panels[i]);
+      panels[i].resets++;
+    }
+  }
+}
+
+static void busCommand(uint8_t command) {
+  ensurePanel();
+  hostChargeBus(8, HOST_SPI_HZ);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    BMOHostPanel& panel = panels[i];
+    if (!isSelected(panel)) continue;
+    PanelBus& bus = buses[i];
+    bus.command = command;
+    bus.parameter = 0;
+    panel.commands++;
+    switch (command) {
+      case DCS_SWRESET:
+        powerOnPanel(panel, bus);
+        break;
+      case DCS_SLPIN:   panel.awake = false; break;
+      case DCS_SLPOUT:  panel.awake = true; break;
+      case DCS_DISPOFF: panel.displayOn = false; break;
+      case DCS_DISPON:  panel.displayOn = true; break;
+      case DCS_RAMWR:
+        bus.x = bus.x0;
+        bus.y = bus.y0;
+        panel.windows++;
+        break;
+    }
+  }
+  if (command == DCS_RAMWR) record(HOST_BUS_WINDOW, 0);
+  else if (command != DCS_CASET && command != DCS_RASET) record(HOST_BUS_COMMAND, command);
+}
+
+static void busData(uint8_t data) {
+  hostChargeBus(8, HOST_SPI_HZ);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    BMOHostPanel& panel = panels[i];
+    if (!isSelected(panel)) continue;
+    PanelBus& bus = buses[i];
+    uint8_t n = bus.parameter < 4 ? bus.parameter : 3;
+    bus.params[n] = data;
+    bus.parameter++;
+    switch (bus.command) {
+      case DCS_MADCTL: if (bus.parameter == 1) panel.madctl = data; break;
+      case DCS_COLMOD: if (bus.parameter == 1) panel.colmod = data; break;
+      case ILI9341_INDEX: if (bus.parameter == 1) bus.readIndex = data; break;
+      case DCS_CASET:
+        if (bus.parameter == 4) {
+          bus.x0 = bus.params[0] << 8 | bus.params[1];
+          bus.x1 = bus.params[2] << 8 | bus.params[3];
+        }
+        break;
+      case DCS_RASET:
+        if (bus.parameter == 4) {
+          bus.y0 = bus.params[0] << 8 | bus.params[1];
+          bus.y1 = bus.params[2] << 8 | bus.params[3];
+        }
+        break;
+    }
+  }
+}
+
+static void busPixels(const uint16_t* colors, uint32_t count, bool swap) {
+  // Each selected panel writes at its own cursor, wrapping in its window
+  hostChargeBus((uint64_t)count * 16, HOST_SPI_HZ);
+  for (uint8_t i = 0; i < panelCount; i++) {
+    BMOHostPanel& panel = panels[i];
+    if (!isSelected(panel)) continue;
+    PanelBus& bus = buses[i];
+    if (bus.command != DCS_RAMWR) continue;
+    for (uint32_t n = 0; n < count; n++) {
+      uint16_t color = swap ? (uint16_t)(colors[n] << 8 | colors[n] >> 8) : colors[n];
+      if (bus.y > bus.y1) break;
+      if (bus.x >= 0 && bus.y >= 0 && bus.x < HOST_PANEL_PIXELS && bus.y < HOST_PANEL_PIXELS) {
+        panel.pixels[bus.y][bus.x] = color;
+        panel.written[bus.y][bus.x] = true;
+      }
+      if (++bus.x > bus.x1) {
+        bus.x = bus.x0;
+        bus.y++;
+      }
+    }
+    panel.pixelCount += count;
+  }
+  record(HOST_BUS_PIXELS, count);
+}
+
+static void busWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  uint8_t columns[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1 };
+  uint8_t rows[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1 };
+  busCommand(DCS_CASET);
+  for (int i = 0; i < 4; i++) busData(columns[i]);
+  busCommand(DCS_RASET);
+  for (int i = 0; i < 4; i++) busData(rows[i]);
+  busCommand(DCS_RAMWR);
+}
+
+static uint8_t readResponse(const BMOHostPanel& panel, uint8_t command, uint8_t index) {
+  // Byte 0 is the dummy clock of a read; the rest as the datasheets list them
+  switch (command) {
+    case DCS_RDDID:
+      if (panel.controller == HOST_ST7789) {
+        const uint8_t id[] = { 0x00, 0x85, 0x85, 0x52 };
+        return index < 4 ? id[index] : 0;
+      } else {
+        const uint8_t id[] = { 0x00, 0x00, 0x93, 0x41 };
+        return index < 4 ? id[index] : 0;
+      }
+    case DCS_RDDST:
+      switch (index) {
+        case 1: return (uint8_t)((panel.awake ? 0x80 : 0) | ((panel.madctl >> 1) & 0x7C));
+        case 2: return (uint8_t)((panel.colmod & 0x70) | (panel.awake ? 0x02 : 0) | 0x01);
+        case 3: return (uint8_t)(panel.displayOn ? 0x04 : 0);
+        default: return 0;
+      }
+    case DCS_RDDPM:
+      return index == 1 ? (uint8_t)((panel.awake ? 0x90 : 0) | 0x08 | (panel.displayOn ? 0x04 : 0)) : 0;
+    case DCS_RDDMADCTL:
+      return index == 1 ? panel.madctl : 0;
+    case DCS_RDDCOLMOD:
+      return index == 1 ? panel.colmod : 0;
+    default:
+      return 0;
+  }
+}
+
+void hostSpiSink(bool isData, const uint8_t* data, uint32_t length, void* context) {
+  (void)context;
+  if (!isData) {
+    sinkLowByte = false;
+    for (uint32_t i = 0; i < length; i++) busCommand(data[i]);
+    return;
+  }
+
+  // Pixel data goes high byte first, like the panel reads it off the wire
+  uint16_t colors[64];
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < length; i++) {
+    bool pixels = false;
+    for (uint8_t p = 0; p < panelCount; p++) {
+      if (isSelected(panels[p]) && buses[p].command == DCS_RAMWR) pixels = true;
+    }
+    if (!pixels) {
+      busData(data[i]);
+      continue;
+    }
+    if (!sinkLowByte) {
+      sinkHighByte = data[i];
+      sinkLowByte = true;
+      continue;
+    }
+    sinkLowByte = false;
+    colors[count++] = (uint16_t)(sinkHighByte << 8 | data[i]);
+    if (count == 64) {
+      busPixels(colors, count, false);
+      count = 0;
+    }
+  }
+  if (count) busPixels(colors, count, false);
+}
+
+// --- TFT_eSPI ---
+
+TFT_eSPI::TFT_eSPI(int16_t width, int16_t height)
+  : _init_width(width)
+  , _init_height(height)
+  , _width(width)
+  , _height(height)
+  , rotation(0)
+  , _swapBytes(false)
+  , vpX0(0), vpY0(0), vpX1(width), vpY1(height)
+  , datumX(0), datumY(0)
+  , winX0(0), winY0(0), winX1(0), winY1(0)
+  , curX(0), curY(0)
+  , command(0)
+  , parameter(0)
+{
+}
+
+void TFT_eSPI::init(uint8_t tabColor) {
+  (void)tabColor;
+  ensurePanel();
+
+  // Hardware reset, then the controller's init sequence to whatever is
+  // selected: power, VCOM, gamma and frame rate, then pixel format, sleep
+  // out and display on
+  digitalWrite(HOST_RESET_PIN, HIGH);
+  delay(5);
+  digitalWrite(HOST_RESET_PIN, LOW);
+  delay(20);
+  digitalWrite(HOST_RESET_PIN, HIGH);
+  delay(150);
+
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (isSelected(panels[i])) panels[i].configured = true;
+  }
+  hostChargeBus(80 * 8, HOST_SPI_HZ);
+  writecommand(DCS_COLMOD);
+  writedata(0x55);
+  writecommand(DCS_SLPOUT);
+  delay(120);
+  writecommand(DCS_DISPON);
+
+  setRotation(rotation);
+  resetViewport();
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+  // TFT_eSPI's ILI9341 rotation table (BGR color order)
+  static const uint8_t madctl[4] = { 0x48, 0x28, 0x88, 0xE8 };
+  rotation = r & 3;
+  writecommand(DCS_MADCTL);
+  writedata(madctl[rotation]);
+  _width = (rotation & 1) ? _init_height : _init_width;
+  _height = (rotation & 1) ? _init_width : _init_height;
+  resetViewport();
+}
+
+void TFT_eSPI::writecommand(uint8_t c) {
+  command = c;
+  parameter = 0;
+  busCommand(c);
+}
+
+void TFT_eSPI::writedata(uint8_t d) {
+  parameter++;
+  busData(d);
+}
+
+uint8_t TFT_eSPI::readcommand8(uint8_t cmd, uint8_t index) {
+  // The ILI9341 picks the byte through its 0xD9 register; a controller
+  // without it answers with the first byte whatever the index
+  ensurePanel();
+  writecommand(ILI9341_INDEX);
+  writedata((uint8_t)(0x10 + (index & 0x0F)));
+  writecommand(cmd);
+  hostChargeBus(8, HOST_SPI_READ_HZ);
+
+  uint8_t value = 0xFF;  // MISO floats high when nothing answers
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (!isSelected(panels[i])) continue;
+    const BMOHostPanel& panel = panels[i];
+    value = readResponse(panel, cmd, panel.controller == HOST_ILI9341 ? index : 1);
+    break;
+  }
+  return value;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  // DC low: a command. DC high after a read command: the first selected
+  // panel answers a byte at a time (no dummy byte before the one-byte
+  // registers), without any 0xD9 index. Otherwise a parameter.
+  ensurePanel();
+  if (hostPinLevel(HOST_DC_PIN) == LOW) {
+    busCommand(data);
+    return 0xFF;
+  }
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (!isSelected(panels[i])) continue;
+    PanelBus& bus = buses[i];
+    switch (bus.command) {
+      case DCS_RDDID: case DCS_RDDST: case DCS_RDDPM: case DCS_RDDMADCTL: case DCS_RDDCOLMOD:
+        hostChargeBus(8, clock);
+        return readResponse(panels[i], bus.command, ++bus.parameter);
+    }
+    break;
+  }
+  busData(data);
+  return 0xFF;
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+  // Clipped to the screen, like TFT_eSPI's own
+  vpX0 = x < 0 ? 0 : x;
+  vpY0 = y < 0 ? 0 : y;
+  vpX1 = x + w > _width ? _width : x + w;
+  vpY1 = y + h > _height ? _height : y + h;
+  datumX = vpDatum ? x : 0;
+  datumY = vpDatum ? y : 0;
+}
+
+void TFT_eSPI::resetViewport() {
+  vpX0 = 0;
+  vpY0 = 0;
+  vpX1 = _width;
+  vpY1 = _height;
+  datumX = 0;
+  datumY = 0;
+}
+
+void TFT_eSPI::window(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+  winX0 = x0;
+  winY0 = y0;
+  winX1 = x1;
+  winY1 = y1;
+  curX = x0;
+  curY = y0;
+  busWindow(x0, y0, x1, y1);
+}
+
+void TFT_eSPI::span(int32_t x, int32_t y, int32_t w, uint16_t color) {
+  // Solid runs are streamed in chunks (TFT_eSPI's pushBlock)
+  window(x, y, x + w - 1, y);
+  uint16_t block[64];
+  for (int i = 0; i < 64; i++) block[i] = color;
+  while (w > 0) {
+    int32_t n = w < 64 ? w : 64;
+    busPixels(block, n, false);
+    w -= n;
+  }
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+  fillRect(0, 0, _width, _height, color);
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  x += datumX;
+  y += datumY;
+  if (x < vpX0 || y < vpY0 || x >= vpX1 || y >= vpY1) return;
+  span(x, y, 1, (uint16_t)color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  x += datumX;
+  y += datumY;
+  if (y < vpY0 || y >= vpY1) return;
+  if (x < vpX0) {
+    w += x - vpX0;
+    x = vpX0;
+  }
+  if (x + w > vpX1) w = vpX1 - x;
+  if (w < 1) return;
+  span(x, y, w, (uint16_t)color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  x += datumX;
+  y += datumY;
+  if (x < vpX0) {
+    w += x - vpX0;
+    x = vpX0;
+  }
+  if (y < vpY0) {
+    h += y - vpY0;
+    y = vpY0;
+  }
+  if (x + w > vpX1) w = vpX1 - x;
+  if (y + h > vpY1) h = vpY1 - y;
+  if (w < 1 || h < 1) return;
+
+  window(x, y, x + w - 1, y + h - 1);
+  uint16_t block[64];
+  for (int i = 0; i < 64; i++) block[i] = (uint16_t)color;
+  uint32_t remaining = (uint32_t)w * h;
+  while (remaining > 0) {
+    uint32_t n = remaining < 64 ? remaining : 64;
+    busPixels(block, n, false);
+    remaining -= n;
+  }
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  // Bresenham, emitting each straight run as one fast line
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    int32_t t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    int32_t t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  int32_t dx = x1 - x0, dy = abs(y1 - y0);
+  int32_t err = dx >> 1, ystep = -1, xs = x0, dlen = 0;
+  if (y0 < y1) ystep = 1;
+
+  for (; x0 <= x1; x0++) {
+    dlen++;
+    err -= dy;
+    if (err < 0) {
+      if (steep) {
+        if (dlen == 1) drawPixel(y0, xs, color);
+        else drawFastVLine(y0, xs, dlen, color);
+      } else {
+        if (dlen == 1) drawPixel(xs, y0, color);
+        else drawFastHLine(xs, y0, dlen, color);
+      }
+      dlen = 0;
+      y0 += ystep;
+      xs = x0 + 1;
+      err += dx;
+    }
+  }
+  if (dlen) {
+    if (steep) drawFastVLine(y0, xs, dlen, color);
+    else drawFastHLine(xs, y0, dlen, color);
+  }
+}
+
+void TFT_eSPI::drawCircleHelper(int32_t x0, int32_t y0, int32_t rr, uint8_t cornername, uint32_t color) {
+  if (rr <= 0) return;
+  int32_t f = 1 - rr;
+  int32_t ddF_x = 1;
+  int32_t ddF_y = -2 * rr;
+  int32_t xe = 0;
+  int32_t xs = 0;
+  int32_t len = 0;
+
+  while (xe < rr--) {
+    while (f < 0) {
+      ++xe;
+      f += (ddF_x += 2);
+    }
+    f += (ddF_y += 2);
+
+    if (xe - xs == 1) {
+      if (cornername & 0x1) {
+        drawPixel(x0 - xe, y0 - rr, color);
+        drawPixel(x0 - rr, y0 - xe, color);
+      }
+      if (cornername & 0x2) {
+        drawPixel(x0 + rr, y0 - xe, color);
+        drawPixel(x0 + xs + 1, y0 - rr, color);
+      }
+      if (cornername & 0x4) {
+        drawPixel(x0 + xs + 1, y0 + rr, color);
+        drawPixel(x0 + rr, y0 + xs + 1, color);
+      }
+      if (cornername & 0x8) {
+        drawPixel(x0 - rr, y0 + xs + 1, color);
+        drawPixel(x0 - xe, y0 + rr, color);
+      }
+    } else {
+      len = xe - xs++;
+      if (cornername & 0x1) {
+        drawFastHLine(x0 - xe, y0 - rr, len, color);
+        drawFastVLine(x0 - rr, y0 - xe, len, color);
+      }
+      if (cornername & 0x2) {
+        drawFastVLine(x0 + rr, y0 - xe, len, color);
+        drawFastHLine(x0 + xs, y0 - rr, len, color);
+      }
+      if (cornername & 0x4) {
+        drawFastHLine(x0 + xs, y0 + rr, len, color);
+        drawFastVLine(x0 + rr, y0 + xs, len, color);
+      }
+      if (cornername & 0x8) {
+        drawFastVLine(x0 - rr, y0 + xs, len, color);
+        drawFastHLine(x0 - xe, y0 + rr, len, color);
+      }
+    }
+    xs = xe;
+  }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+  drawFastHLine(x + r, y, w - r - r, color);
+  drawFastHLine(x + r, y + h - 1, w - r - r, color);
+  drawFastVLine(x, y + r, h - r - r, color);
+  drawFastVLine(x + w - 1, y + r, h - r - r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  // Midpoint circle, eight octants
+  if (r <= 0) return;
+  int32_t f = 1 - r;
+  int32_t ddF_y = -2 * r;
+  int32_t ddF_x = 1;
+  int32_t xs = -1;
+  int32_t xe = 0;
+  int32_t len = 0;
+  bool first = true;
+  do {
+    while (f < 0) {
+      ++xe;
+      f += (ddF_x += 2);
+    }
+    f += (ddF_y += 2);
+
+    if (xe - xs > 1) {
+      if (first) {
+        len = 2 * (xe - xs) - 1;
+        drawFastHLine(x0 - xe, y0 + r, len, color);
+        drawFastHLine(x0 - xe, y0 - r, len, color);
+        drawFastVLine(x0 + r, y0 - xe, len, color);
+        drawFastVLine(x0 - r, y0 - xe, len, color);
+        first = false;
+      } else {
+        len = xe - xs++;
+        drawFastHLine(x0 - xe, y0 + r, len, color);
+        drawFastHLine(x0 - xe, y0 - r, len, color);
+        drawFastHLine(x0 + xs, y0 - r, len, color);
+        drawFastHLine(x0 + xs, y0 + r, len, color);
+        drawFastVLine(x0 + r, y0 + xs, len, color);
+        drawFastVLine(x0 + r, y0 - xe, len, color);
+        drawFastVLine(x0 - r, y0 - xe, len, color);
+        drawFastVLine(x0 - r, y0 + xs, len, color);
+      }
+    } else {
+      ++xs;
+      drawPixel(x0 - xe, y0 + r, color);
+      drawPixel(x0 - xe, y0 - r, color);
+      drawPixel(x0 + xs, y0 - r, color);
+      drawPixel(x0 + xs, y0 + r, color);
+      drawPixel(x0 + r, y0 + xs, color);
+      drawPixel(x0 + r, y0 - xe, color);
+      drawPixel(x0 - r, y0 - xe, color);
+      drawPixel(x0 - r, y0 + xs, color);
+    }
+    xs = xe;
+  } while (xe < --r);
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t x = 0;
+  int32_t dx = 1;
+  int32_t dy = r + r;
+  int32_t p = -(r >> 1);
+
+  drawFastHLine(x0 - r, y0, dy + 1, color);
+  while (x < r) {
+    if (p >= 0) {
+      drawFastHLine(x0 - x, y0 + r, 2 * x + 1, color);
+      drawFastHLine(x0 - x, y0 - r, 2 * x + 1, color);
+      dy -= 2;
+      p -= dy;
+      r--;
+    }
+    dx += 2;
+    p += dx;
+    x++;
+    drawFastHLine(x0 - r, y0 + x, 2 * r + 1, color);
+    drawFastHLine(x0 - r, y0 - x, 2 * r + 1, color);
+  }
+}
+
+void TFT_eSPI::fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color) {
+  if (rx < 2 || ry < 2) return;
+  int32_t x, y;
+  int32_t rx2 = rx * rx;
+  int32_t ry2 = ry * ry;
+  int32_t fx2 = 4 * rx2;
+  int32_t fy2 = 4 * ry2;
+  int32_t s;
+
+  for (x = 0, y = ry, s = 2 * ry2 + rx2 * (1 - 2 * ry); ry2 * x <= rx2 * y; x++) {
+    drawFastHLine(x0 - x, y0 - y, x + x + 1, color);
+    drawFastHLine(x0 - x, y0 + y, x + x + 1, color);
+    if (s >= 0) {
+      s += fx2 * (1 - y);
+      y--;
+    }
+    s += ry2 * ((4 * x) + 6);
+  }
+
+  for (x = rx, y = 0, s = 2 * rx2 + ry2 * (1 - 2 * rx); rx2 * y <= ry2 * x; y++) {
+    drawFastHLine(x0 - x, y0 - y, x + x + 1, color);
+    drawFastHLine(x0 - x, y0 + y, x + x + 1, color);
+    if (s >= 0) {
+      s += fy2 * (1 - x);
+      x--;
+    }
+    s += rx2 * ((4 * y) + 6);
+  }
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+  window(x + datumX, y + datumY, x + datumX + w - 1, y + datumY + h - 1);
+}
+
+void TFT_eSPI::pushPixels(const void* data, uint32_t length) {
+  // Unswapped, the ESP32 loads the SPI FIFO a 32-bit word at a time straight
+  // from the buffer; a load from an address that isn't word aligned drops
+  // the low address bits (so the stream starts a pixel early). Swapped, the
+  // pixels are read and converted one at a time.
+  const uint16_t* pixels = (const uint16_t*)data;
+  if (!_swapBytes && ((uintptr_t)data & 3)) {
+    unalignedReads++;
+    pixels = (const uint16_t*)((uintptr_t)data & ~(uintptr_t)3);
+  }
+
+  // Memory order goes on the wire, so the panel sees a little-endian value
+  // byte-swapped unless TFT_eSPI swaps it back
+  busPixels(pixels, length, !_swapBytes);
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+  // Cropped to the viewport; a cropped image goes a row at a time from
+  // inside the caller's buffer
+  x += datumX;
+  y += datumY;
+  int32_t dx = 0, dy = 0, dw = w, dh = h;
+  if (x < vpX0) { dx = vpX0 - x; dw -= dx; x = vpX0; }
+  if (y < vpY0) { dy = vpY0 - y; dh -= dy; y = vpY0; }
+  if (x + dw > vpX1) dw = vpX1 - x;
+  if (y + dh > vpY1) dh = vpY1 - y;
+  if (dw < 1 || dh < 1) return;
+
+  window(x, y, x + dw - 1, y + dh - 1);
+  data += dx + dy * w;
+  if (dw == w) {
+    pushPixels(data, dw * dh);
+  } else {
+    while (dh--) {
+      pushPixels(data, dw);
+      data += w;
+    }
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  // Read-only (PROGMEM) images are copied a line at a time into a RAM buffer
+  x += datumX;
+  y += datumY;
+  int32_t dx = 0, dy = 0, dw = w, dh = h;
+  if (x < vpX0) { dx = vpX0 - x; dw -= dx; x = vpX0; }
+  if (y < vpY0) { dy = vpY0 - y; dh -= dy; y = vpY0; }
+  if (x + dw > vpX1) dw = vpX1 - x;
+  if (y + dh > vpY1) dh = vpY1 - y;
+  if (dw < 1 || dh < 1) return;
+
+  window(x, y, x + dw - 1, y + dh - 1);
+  data += dx + dy * w;
+  uint16_t buffer[HOST_PANEL_PIXELS + 1];
+  uint16_t* line = (uint16_t*)(((uintptr_t)buffer + 3) & ~(uintptr_t)3);
+  while (dh--) {
+    for (int32_t i = 0; i < dw; i++) line[i] = pgm_read_word(&data[i]);
+    pushPixels(line, dw);
+    data += w;
+  }
+}
+
+void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data) {
+  // TFT_eSPI returns colors byte-swapped, ready for pushImage() unswapped
+  ensurePanel();
+  window(x, y, x + w - 1, y + h - 1);
+  hostChargeBus((uint64_t)w * h * 24, HOST_SPI_READ_HZ);
+  uint8_t panel = 0;
+  for (uint8_t i = 0; i < panelCount; i++) {
+    if (isSelected(panels[i])) {
+      panel = i;
+      break;
+    }
+  }
+  for (int32_t j = 0; j < h; j++) {
+    for (int32_t i = 0; i < w; i++) {
+      int px = x + i, py = y + j;
+      uint16_t color = 0;
+      if (px >= 0 && py >= 0 && px < HOST_PANEL_PIXELS && py < HOST_PANEL_PIXELS) {
+        color = panels[panel].pixels[py][px];
+      }
+      *data++ = (uint16_t)(color << 8 | color >> 8);
+    }
+  }
+}
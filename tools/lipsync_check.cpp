@@ -0,0 +1,184 @@
+/*
+ * BMO Lip-Sync Check
+ *
+ * Replays a WAV image through the lip-sync engine (src/lipsync.cpp) on the
+ * host's simulated clock, driven the way the sketch drives it: update() on
+ * a repeating LIPSYNC_FRAME_INTERVAL timer, and drawTalkingMouth() on the
+ * simulated panel whenever it asks for a repaint. It checks the frame
+ * timing - a frame every interval, none late - that audio reaches the
+ * mouth within one frame of being captured, that a repaint fits in a frame
+ * on the bus, and that the mouth opens on every burst of speech and closes
+ * after the audio ends.
+ *
+ * Without an argument it replays a synthesized clip: bursts of a tone with
+ * silences between them. Given a WAV file (16-bit PCM) it replays that and
+ * checks the timing only.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_LIPSYNC=1 tools/lipsync_check.cpp tools/host/*.cpp src/*.cpp -o lipsync_check
+//   ./lipsync_check [speech.wav]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "lipsync.h"
+
+#define CLIP_BURSTS     8
+#define BURST_MS        300       // Tone, then...
+#define GAP_MS          200       // ...silence
+#define BURST_LEVEL     16000     // Peak; the mean level opens the mouth fully
+#define TAIL_MS         1500      // Replayed past the end, for the mouth to close
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+static void put16(std::vector<uint8_t>& wav, uint16_t value) {
+  wav.push_back((uint8_t)value);
+  wav.push_back((uint8_t)(value >> 8));
+}
+
+static void put32(std::vector<uint8_t>& wav, uint32_t value) {
+  put16(wav, (uint16_t)value);
+  put16(wav, (uint16_t)(value >> 16));
+}
+
+// Mono 16-bit WAV at LIPSYNC_SAMPLE_RATE: bursts of a 220 Hz tone
+static std::vector<uint8_t> synthesizeClip() {
+  const uint32_t burst = LIPSYNC_SAMPLE_RATE / 1000 * BURST_MS;
+  const uint32_t gap = LIPSYNC_SAMPLE_RATE / 1000 * GAP_MS;
+  const uint32_t samples = CLIP_BURSTS * (burst + gap);
+  std::vector<uint8_t> wav = { 'R', 'I', 'F', 'F' };
+  put32(wav, 36 + samples * 2);
+  wav.insert(wav.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+  put32(wav, 16);
+  put16(wav, 1);                          // PCM
+  put16(wav, 1);                          // Mono
+  put32(wav, LIPSYNC_SAMPLE_RATE);
+  put32(wav, LIPSYNC_SAMPLE_RATE * 2);    // Bytes per second
+  put16(wav, 2);                          // Bytes per frame
+  put16(wav, 16);
+  wav.insert(wav.end(), { 'd', 'a', 't', 'a' });
+  put32(wav, samples * 2);
+  for (uint32_t i = 0; i < samples; i++) {
+    bool speaking = i % (burst + gap) < burst;
+    double sample = speaking ? BURST_LEVEL * sin(2 * M_PI * 220 * i / LIPSYNC_SAMPLE_RATE) : 0;
+    put16(wav, (uint16_t)(int16_t)sample);
+  }
+  return wav;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+  FILE* file = fopen(path, "rb");
+  if (!file) return false;
+  uint8_t buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + count);
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  std::vector<uint8_t> wav;
+  bool synthesized = argc < 2;
+  if (synthesized) {
+    wav = synthesizeClip();
+  } else if (!readFile(argv[1], wav)) {
+    printf("%s: can't read it\nFAILED\n", argv[1]);
+    return 1;
+  }
+
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    printf("display: begin failed\nFAILED\n");
+    return 1;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+  graphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+
+  BMOLipSync lipSync;
+  if (!lipSync.begin(LIPSYNC_SOURCE_PCM)) {
+    printf("lipsync: begin failed (built without -DBMO_ENABLE_LIPSYNC=1?)\nFAILED\n");
+    return 1;
+  }
+  if (!lipSync.playWav(wav.data(), wav.size())) {
+    printf("FAILED\n");
+    return 1;
+  }
+
+  // The sketch's repeating timer: due every interval, a missed one skipped,
+  // with the repaint's time on the bus spent inside the tick
+  printf("Replay\n");
+  unsigned long start = millis();
+  unsigned long deadline = start + LIPSYNC_FRAME_INTERVAL;
+  unsigned long endTime = 0;
+  uint32_t repaints = 0, maxRepaintUs = 0;
+  std::vector<uint8_t> opens;
+  while (lipSync.isPlaying() || millis() - endTime < TAIL_MS) {
+    if ((long)(deadline - millis()) > 0) hostAdvance((deadline - millis()) * 1000);
+    deadline += LIPSYNC_FRAME_INTERVAL;
+    if ((long)(millis() - deadline) >= 0) deadline = millis() + LIPSYNC_FRAME_INTERVAL;
+
+    if (lipSync.update(millis())) {
+      LipSyncMouth mouth = lipSync.getMouth();
+      uint32_t repaintStart = micros();
+      graphics.drawTalkingMouth(mouth.open, mouth.width);
+      uint32_t repaintUs = micros() - repaintStart;
+      if (repaintUs > maxRepaintUs) maxRepaintUs = repaintUs;
+      repaints++;
+    }
+    if (lipSync.isPlaying()) endTime = millis();
+    opens.push_back(lipSync.getMouth().open);
+  }
+
+  const LipSyncStats& stats = lipSync.getStats();
+  uint32_t elapsed = millis() - start;
+  uint32_t expected = elapsed / LIPSYNC_FRAME_INTERVAL;
+  printf("  %u ms: %u frames (%u late), %u repaints, gaps up to %u ms, latency up to %u ms\n",
+         (unsigned)elapsed, (unsigned)stats.frames, (unsigned)stats.lateFrames, (unsigned)repaints,
+         (unsigned)stats.maxIntervalMs, (unsigned)stats.maxLatencyMs);
+  printf("  %u us per repaint at most (frame %d ms)\n", (unsigned)maxRepaintUs, LIPSYNC_FRAME_INTERVAL);
+  expect(stats.frames + 1 >= expected && stats.frames <= expected + 1, "not a frame every interval");
+  expect(stats.lateFrames == 0, "late frames");
+  expect(stats.maxIntervalMs <= LIPSYNC_FRAME_INTERVAL + 1, "a gap longer than a frame");
+  expect(stats.maxLatencyMs > 0, "audio reached the mouth before it was captured");
+  expect(stats.maxLatencyMs <= LIPSYNC_FRAME_INTERVAL, "audio took longer than a frame to reach the mouth");
+  expect(maxRepaintUs < LIPSYNC_FRAME_INTERVAL * 1000, "a repaint doesn't fit in a frame");
+  expect(opens.back() == 0, "mouth still open after the audio ended");
+
+  // Open on every burst, at most half as open by the end of each silence
+  if (synthesized) {
+    const uint32_t period = BURST_MS + GAP_MS;
+    for (int burst = 0; burst < CLIP_BURSTS; burst++) {
+      uint8_t peak = 0, closing = 255;
+      for (size_t frame = 0; frame < opens.size(); frame++) {
+        uint32_t at = (uint32_t)(frame + 1) * LIPSYNC_FRAME_INTERVAL;
+        if (at < burst * period || at >= (burst + 1) * period) continue;
+        if (at < burst * period + BURST_MS) {
+          if (opens[frame] > peak) peak = opens[frame];
+        } else {
+          closing = opens[frame];
+        }
+      }
+      if (peak < 192 || closing > peak / 2) {
+        printf("  burst %d: opened to %u, %u at the end of the silence\n", burst, peak, closing);
+        failures++;
+      }
+    }
+  }
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * BMO Memory Check
+ *
+ * Runs setup() and loop() work on the host and checks the zero-heap claim
+ * in src/memory.h. It sets up the display and renderer as the sketch does,
+ * seals the arena, and then runs what the loop runs - queued face redraws,
+ * blinks, lip-sync mouths, a fade, glances and the stats reports. It
+ * checks that none of this allocates, and that setup took exactly the
+ * arena the enabled features budget for. It also checks that the counter sees
+ * every way there is to allocate: each form of operator new (plain, array,
+ * nothrow, aligned), malloc, calloc and realloc, and a Serial.printf() too
+ * long for the core's stack buffer. A sealed arena must refuse
+ * allocations.
+ *
+ * The malloc family is only counted with BMO_TRACK_MALLOC and the linker
+ * wraps, as config/platformio.ini sets them for the device.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_TRACK_MALLOC=1 -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc tools/memory_check.cpp tools/host/*.cpp src/*.cpp -o memory_check
+//   ./memory_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "events.h"
+#include "memory.h"
+#include "lipsync.h"
+
+#define SERIAL_RESERVE  (1 << 20)   // Captured output, reserved so it never grows
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+struct alignas(64) Aligned {
+  uint8_t bytes[64];
+};
+
+// Where each allocation is kept, so the compiler can't drop a new/delete
+// or malloc/free pair
+static void* volatile kept;
+
+// One allocation of each kind, counted exactly once
+static void checkCounted(const char* name, uint32_t before) {
+  uint32_t counted = bmoHeapAllocationCount() - before;
+  if (counted != 1) {
+    printf("  %s: counted %u times\n", name, (unsigned)counted);
+    failures++;
+  }
+}
+
+static void checkForms() {
+  printf("Allocations counted\n");
+  uint32_t before = bmoHeapAllocationCount();
+  int* plain = new int(1);
+  kept = plain;
+  checkCounted("new", before);
+  delete plain;
+
+  before = bmoHeapAllocationCount();
+  int* array = new int[16];
+  kept = array;
+  checkCounted("new[]", before);
+  delete[] array;
+
+  before = bmoHeapAllocationCount();
+  int* nothrow = new (std::nothrow) int(2);
+  kept = nothrow;
+  checkCounted("new (nothrow)", before);
+  delete nothrow;
+
+  before = bmoHeapAllocationCount();
+  int* nothrowArray = new (std::nothrow) int[16];
+  kept = nothrowArray;
+  checkCounted("new[] (nothrow)", before);
+  delete[] nothrowArray;
+
+  before = bmoHeapAllocationCount();
+  Aligned* aligned = new Aligned();
+  kept = aligned;
+  checkCounted("new (aligned)", before);
+  expect(((uintptr_t)aligned & 63) == 0, "aligned new not aligned");
+  delete aligned;
+
+  before = bmoHeapAllocationCount();
+  Aligned* alignedArray = new Aligned[4];
+  kept = alignedArray;
+  checkCounted("new[] (aligned)", before);
+  expect(((uintptr_t)alignedArray & 63) == 0, "aligned new[] not aligned");
+  delete[] alignedArray;
+
+  before = bmoHeapAllocationCount();
+  Aligned* alignedNothrow = new (std::nothrow) Aligned();
+  kept = alignedNothrow;
+  checkCounted("new (aligned, nothrow)", before);
+  delete alignedNothrow;
+
+#if BMO_TRACK_MALLOC
+  before = bmoHeapAllocationCount();
+  void* block = malloc(100);
+  kept = block;
+  checkCounted("malloc", before);
+  before = bmoHeapAllocationCount();
+  block = realloc(block, 4000);
+  kept = block;
+  checkCounted("realloc", before);
+  free(block);
+
+  before = bmoHeapAllocationCount();
+  block = calloc(10, 10);
+  kept = block;
+  checkCounted("calloc", before);
+  free(block);
+
+  // What the core does with printf output past its stack buffer
+  before = bmoHeapAllocationCount();
+  Serial.printf("%s\n", "A line short enough for the stack buffer");
+  expect(bmoHeapAllocationCount() == before, "a short printf allocated");
+  Serial.printf("%s %s\n", "A line long enough that the core has to take a buffer",
+                "from the heap to format it");
+  checkCounted("long printf", before);
+#else
+  printf("  malloc family not counted (build with BMO_TRACK_MALLOC=1)\n");
+#endif
+}
+
+int main() {
+  hostSerialOutput().reserve(SERIAL_RESERVE);
+
+  // setup(): everything allocated here, then the arena is sealed
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    printf("display: begin failed\nFAILED\n");
+    return 1;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+  BMOEventLoop events;
+  events.begin();
+  graphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  size_t budget = BMOGraphics::ARENA_BYTES;
+#if BMO_ENABLE_IMAGES || BMO_ENABLE_ASSETS
+  budget += IMAGE_ARENA_BYTES;
+#endif
+#if BMO_ENABLE_LIPSYNC
+  BMOLipSync lipSync;
+  lipSync.begin(LIPSYNC_SOURCE_PCM);
+  budget += LIPSYNC_ARENA_BYTES;
+#endif
+  bmoArena.seal();
+  printf("Setup: %u heap allocations, %u of %u arena bytes\n", (unsigned)bmoHeapAllocationCount(),
+         (unsigned)bmoArena.getUsed(), (unsigned)bmoArena.getCapacity());
+  expect(bmoArena.getUsed() == budget, "arena use isn't what the owners budget for");
+  expect(bmoArena.getCapacity() == budget, "arena not sized to the enabled features");
+
+  // loop(): nothing from here on may touch the heap
+  printf("Loop work after setup\n");
+  for (int pass = 0; pass < 20; pass++) {
+    graphics.requestFace(pass & 1 ? EXPRESSION_SURPRISED : EXPRESSION_HAPPY, pass & 2 ? EYES_CLOSED : EYES_OPEN);
+    while (display.hasPendingJobs()) display.serviceJobs();
+    for (int frame = 0; frame < 8; frame++) graphics.drawTalkingMouth((uint8_t)(frame * 32), 180);
+    graphics.lookAt(pass * 10 - 100, 40 - pass * 4);
+    for (int step = 0; step < 30 && graphics.updateGaze(); step++) hostAdvance(GAZE_FRAME_INTERVAL * 1000);
+    events.printEventInfo();
+    display.printDisplayInfo();
+    graphics.printGraphicsInfo();
+    bmoPrintMemoryReport();
+    hostSerialOutput().clear();
+  }
+  graphics.fadeTransition(BMO_TEAL, BMO_BLACK);
+  while (display.hasPendingJobs()) display.serviceJobs();
+  expect(bmoHeapAllocationsSinceSeal() == 0, "the loop allocated");
+  printf("  %u heap allocations since setup\n", (unsigned)bmoHeapAllocationsSinceSeal());
+
+  // The sealed arena refuses, and says so
+  uint32_t refused = bmoArena.getFailedAllocations();
+  expect(bmoArena.allocate(16, BMO_ARENA_ALIGN, "memory_check") == nullptr, "sealed arena allocated");
+  expect(bmoArena.getFailedAllocations() == refused + 1, "refusal not counted");
+  expect(strstr(hostSerialOutput().c_str(), "after setup") != nullptr, "refusal not reported");
+
+  checkForms();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
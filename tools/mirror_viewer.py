@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+BMO Display Mirror Viewer
+
+Reconstructs BMO's screen from the mirror packets sent by src/mirror.cpp.
+Text debug output on the same port is skipped; packets are validated with
+their CRC and dropped if corrupted (the device resends everything on its
+next keyframe).
+
+Usage:
+  python3 tools/mirror_viewer.py /dev/ttyACM0            # live serial port
+  python3 tools/mirror_viewer.py capture.bin --out bmo.ppm
+  python3 tools/mirror_viewer.py /dev/ttyACM0 --show     # Tk window
+
+Requires pyserial for serial ports (pip install pyserial).
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+SYNC = b"\xB0\x4D"
+HEADER_SIZE = 6
+CRC_SIZE = 2
+
+FRAME_MIRROR_HELLO = 0x10
+FRAME_MIRROR_TILE = 0x11
+FRAME_MIRROR_FRAME_END = 0x12
+
+ENCODING_RAW = 0
+ENCODING_RLE = 1
+
+MAX_PAYLOAD = 4096
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, matches bmoCrc16() on the device."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class FrameParser:
+    """Pulls framed packets out of a byte stream that also carries text."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                # Keep a trailing sync byte in case the pair is split
+                del self.buffer[:-1]
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                return
+            ftype, seq, length = struct.unpack_from("<BBH", self.buffer, 2)
+            if length > MAX_PAYLOAD:
+                del self.buffer[:2]
+                continue
+            total = HEADER_SIZE + length + CRC_SIZE
+            if len(self.buffer) < total:
+                return
+            body = bytes(self.buffer[2:HEADER_SIZE + length])
+            (crc,) = struct.unpack_from("<H", self.buffer, HEADER_SIZE + length)
+            if crc16(body) != crc:
+                self.crc_errors += 1
+                del self.buffer[:2]
+                continue
+            del self.buffer[:total]
+            yield ftype, seq, body[4:]
+
+
+class MirrorScreen:
+    """RGB888 copy of the panel, updated tile by tile."""
+
+    def __init__(self, swap_bytes=False):
+        self.width = 240
+        self.height = 320
+        self.tile = 16
+        self.swap = swap_bytes
+        self.pixels = bytearray(self.width * self.height * 3)
+        self.tiles = 0
+        self.frames = 0
+
+    def hello(self, payload):
+        self.width, self.height, self.tile = struct.unpack_from("<HHB", payload)
+        self.pixels = bytearray(self.width * self.height * 3)
+
+    def _rgb(self, color):
+        if self.swap:
+            color = ((color & 0xFF) << 8) | (color >> 8)
+        r = (color >> 8) & 0xF8
+        g = (color >> 3) & 0xFC
+        b = (color << 3) & 0xF8
+        return r | (r >> 5), g | (g >> 6), b | (b >> 5)
+
+    def tile_update(self, payload):
+        tx, ty, encoding = payload[0], payload[1], payload[2]
+        data = payload[3:]
+        x0, y0 = tx * self.tile, ty * self.tile
+        w = min(self.tile, self.width - x0)
+        h = min(self.tile, self.height - y0)
+
+        colors = []
+        if encoding == ENCODING_RLE:
+            for i in range(0, len(data) - 2, 3):
+                colors.extend([data[i + 1] | (data[i + 2] << 8)] * (data[i] + 1))
+        else:
+            colors = [data[i] | (data[i + 1] << 8) for i in range(0, len(data) - 1, 2)]
+
+        for i, color in enumerate(colors[:w * h]):
+            px = x0 + i % w
+            py = y0 + i // w
+            offset = (py * self.width + px) * 3
+            self.pixels[offset:offset + 3] = bytes(self._rgb(color))
+        self.tiles += 1
+
+    def ppm(self):
+        return b"P6\n%d %d\n255\n" % (self.width, self.height) + bytes(self.pixels)
+
+    def save(self, path):
+        tmp = path + ".tmp"
+        with open(tmp, "wb") as f:
+            f.write(self.ppm())
+        os.replace(tmp, path)
+
+
+def open_source(path, baud):
+    if os.path.isfile(path):
+        return open(path, "rb")
+    import serial  # pyserial
+    return serial.Serial(path, baud, timeout=0.1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reconstruct BMO's display from mirror packets")
+    parser.add_argument("source", help="serial port (or pty) or a captured byte stream")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--out", default="bmo_mirror.ppm", help="PPM written after each complete scan")
+    parser.add_argument("--swap", action="store_true", help="byte-swap pixels (panel readback order)")
+    parser.add_argument("--show", action="store_true", help="display in a Tk window")
+    args = parser.parse_args()
+
+    source = open_source(args.source, args.baud)
+    frames = FrameParser()
+    screen = MirrorScreen(args.swap)
+
+    window = label = None
+    if args.show:
+        import tkinter
+        window = tkinter.Tk()
+        window.title("BMO mirror")
+        label = tkinter.Label(window)
+        label.pack()
+
+    def on_frame_end():
+        screen.frames += 1
+        screen.save(args.out)
+        print("scan %d: %d tiles, %d CRC errors" % (screen.frames, screen.tiles, frames.crc_errors),
+              file=sys.stderr)
+        if window is not None:
+            import tkinter
+            image = tkinter.PhotoImage(data=screen.ppm(), format="PPM")
+            label.configure(image=image)
+            label.image = image
+
+    try:
+        while True:
+            data = source.read(4096)
+            if not data:
+                if os.path.isfile(args.source):
+                    break
+                if window is not None:
+                    window.update()
+                continue
+            for ftype, _seq, payload in frames.feed(data):
+                if ftype == FRAME_MIRROR_HELLO:
+                    screen.hello(payload)
+                elif ftype == FRAME_MIRROR_TILE:
+                    screen.tile_update(payload)
+                elif ftype == FRAME_MIRROR_FRAME_END:
+                    on_frame_end()
+            if window is not None:
+                window.update()
+    except KeyboardInterrupt:
+        pass
+
+    screen.save(args.out)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+/*
+ * BMO Panel Check
+ *
+ * Runs the display driver's health watchdog (BMODisplay::checkPanels())
+ * against simulated panels that fault the way real ones do: a register
+ * glitch that leaves everything else alone, a panel put to sleep, and a
+ * brown-out that resets a panel to its power-on defaults and garbage memory.
+ * It checks that each fault is found, that a glitch is fixed by writing the
+ * registers back while a sleeping or reset panel gets the whole init
+ * sequence again, that only the panels that lost their contents are
+ * reported, and that the ILI9341-only 0xD9 read index never reaches an
+ * ST7789. It then times a health check.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host tools/panel_check.cpp tools/host/*.cpp src/*.cpp -o panel_check
+//   ./panel_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "host.h"
+#include "display.h"
+
+#define FACE_CS    10
+#define STATUS_CS  11
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+// Commands a panel received while the bus log was recording
+static uint32_t countCommands(uint8_t panel, uint8_t command) {
+  const BMOHostBusRecord* records;
+  uint32_t count = hostBusLog(&records);
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (records[i].kind == HOST_BUS_COMMAND && records[i].count == command && (records[i].panels & (1 << panel))) {
+      found++;
+    }
+  }
+  return found;
+}
+
+// One fault on one panel, then a watchdog pass
+static void checkFault(BMODisplay& display, uint8_t panel, const char* name, bool full, uint8_t command,
+                       uint8_t value) {
+  printf("%s on panel %u\n", name, panel);
+  BMODisplayStats before = display.getStats();
+  if (command) hostPanelGlitch(panel, command, value);
+  else hostPanelBrownOut(panel);
+  uint32_t resets = hostPanel(panel)->resets;  // The brown-out's included
+
+  uint8_t lost = display.checkPanels();
+  const BMODisplayStats& after = display.getStats();
+  expect(after.panelFaults == before.panelFaults + 1, "fault not found");
+  expect(display.checkPanelHealth(panel) == PANEL_HEALTH_OK, "panel not healthy after recovery");
+  expect(hostPanel(panel)->configured, "panel recovered without its init sequence");
+  if (full) {
+    expect(after.fullRecoveries == before.fullRecoveries + 1, "not recovered with the init sequence");
+    expect(hostPanel(panel)->resets > resets, "reset line not pulsed");
+    expect(lost == (uint8_t)((1u << hostPanelCount()) - 1), "every panel on the reset line must be redrawn");
+  } else {
+    expect(after.quickRecoveries == before.quickRecoveries + 1, "not recovered by restoring registers");
+    expect(lost == 1 << panel, "lost panels wrong after a register restore");
+  }
+  expect(display.checkPanels() == 0, "fault still there on the next pass");
+}
+
+static void checkPanels(uint8_t faceController, uint8_t statusController) {
+  hostResetPanels();
+  hostAddPanel(FACE_CS, faceController);
+  hostAddPanel(STATUS_CS, statusController);
+  BMODisplay display;
+  BMOPanelPins facePins = { FACE_CS, -1, -1 };
+  BMOPanelPins statusPins = { STATUS_CS, -1, -1 };
+  display.addPanel<BMOActivePanel>(facePins);
+  display.addPanel<BMOStatusPanel>(statusPins);
+  if (!display.begin()) {
+    expect(false, "display: begin failed");
+    return;
+  }
+  for (uint8_t i = 0; i < 2; i++) expect(display.getPanel(i)->monitored, "panel not monitored");
+  expect(display.checkPanels() == 0, "healthy panels reported lost");
+
+  // Register glitches: written back, nothing else touched
+  checkFault(display, 1, "MADCTL glitch", false, 0x36, 0x60);  // Rotated a quarter turn
+  checkFault(display, 0, "COLMOD glitch", false, 0x3A, 0x66);
+
+  // Asleep means a reset got there first: the whole init sequence
+  checkFault(display, 1, "Sleep", true, 0x10, 0);
+  checkFault(display, 0, "Brown-out", true, 0, 0);
+  checkFault(display, 1, "Brown-out", true, 0, 0);
+
+  // Health checks read an ST7789 without the ILI9341's read index
+  for (uint8_t i = 0; i < 2; i++) {
+    if (hostPanel(i)->controller != HOST_ST7789) continue;
+    hostBusRecord(true);
+    for (int pass = 0; pass < 10; pass++) display.checkPanels();
+    hostBusRecord(false);
+    expect(countCommands(i, 0xD9) == 0, "0xD9 sent to an ST7789 by a health check");
+  }
+}
+
+int main() {
+  printf("ILI9341 face, ST7789 status panel\n");
+  checkPanels(HOST_ILI9341, HOST_ST7789);
+  printf("ST7789 face, ILI9341 status panel\n");
+  checkPanels(HOST_ST7789, HOST_ILI9341);
+
+  // What a watchdog pass costs with both panels healthy
+  hostResetPanels();
+  hostAddPanel(FACE_CS, HOST_ILI9341);
+  hostAddPanel(STATUS_CS, HOST_ST7789);
+  BMODisplay display;
+  BMOPanelPins facePins = { FACE_CS, -1, -1 };
+  BMOPanelPins statusPins = { STATUS_CS, -1, -1 };
+  display.addPanel<BMOActivePanel>(facePins);
+  display.addPanel<BMOStatusPanel>(statusPins);
+  if (display.begin()) {
+    uint32_t start = micros();
+    for (int pass = 0; pass < 100; pass++) display.checkPanels();
+    printf("Health check: %.1f us on the bus for two panels\n", (micros() - start) / 100.0);
+  }
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * BMO Panel Jobs Check
+ *
+ * Runs two panels on one bus the way the sketch's loop does - a face panel
+ * and a status panel, each with a queued face redraw, and one
+ * serviceJobs() per loop tick - and records what every panel received tick
+ * by tick. It checks that the redraws interleave (both panels get a slice
+ * every tick while both are busy, neither finishes in one tick), that no
+ * slice spills onto the other panel, and that each panel ends up showing
+ * what a direct redraw on it alone shows.
+ *
+ * With a directory argument it also writes each panel's recording there:
+ * panel<N>.csv with one line per transfer (tick, microseconds, kind,
+ * command or pixel count) and panel<N>.ppm with the final screen.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_STATUS_PANEL=1 tools/panel_jobs_check.cpp tools/host/*.cpp src/*.cpp -o panel_jobs_check
+//   ./panel_jobs_check [recording directory]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+
+#define FACE_CS    10
+#define STATUS_CS  11
+#define PANELS     2
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+struct Transfer {
+  uint32_t tick;
+  BMOHostBusRecord record;
+};
+
+static std::vector<uint16_t> capture(uint8_t panel, int width, int height) {
+  std::vector<uint16_t> screen((size_t)width * height);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) screen[(size_t)y * width + x] = hostPanelColor(panel, x, y);
+  }
+  return screen;
+}
+
+static void writeRecording(const char* directory, uint8_t panel, const std::vector<Transfer>& transfers,
+                           const std::vector<uint16_t>& screen, int width, int height) {
+  static const char* const kinds[] = { "command", "window", "pixels" };
+  char path[512];
+  snprintf(path, sizeof(path), "%s/panel%u.csv", directory, panel);
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    expect(false, "can't write the recording");
+    return;
+  }
+  fprintf(file, "tick,us,kind,count\n");
+  for (const Transfer& transfer : transfers) {
+    if (!(transfer.record.panels & (1 << panel))) continue;
+    fprintf(file, "%u,%u,%s,%u\n", (unsigned)transfer.tick, (unsigned)transfer.record.timestamp,
+            kinds[transfer.record.kind], (unsigned)transfer.record.count);
+  }
+  fclose(file);
+
+  snprintf(path, sizeof(path), "%s/panel%u.ppm", directory, panel);
+  file = fopen(path, "wb");
+  if (!file) {
+    expect(false, "can't write the recording");
+    return;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", width, height);
+  for (uint16_t color : screen) {
+    uint8_t rgb[3] = { (uint8_t)((color >> 8) & 0xF8), (uint8_t)((color >> 3) & 0xFC), (uint8_t)(color << 3) };
+    fwrite(rgb, 1, 3, file);
+  }
+  fclose(file);
+}
+
+int main(int argc, char** argv) {
+  hostAddPanel(FACE_CS, HOST_ILI9341);
+  hostAddPanel(STATUS_CS, HOST_ST7789);
+  BMODisplay display;
+  BMOPanelPins facePins = { FACE_CS, -1, -1 };
+  BMOPanelPins statusPins = { STATUS_CS, -1, -1 };
+  display.addPanel<BMOActivePanel>(facePins);
+  display.addPanel<BMOStatusPanel>(statusPins);
+  if (!display.begin()) {
+    printf("display: begin failed\nFAILED\n");
+    return 1;
+  }
+  BMOGraphics face;
+  BMOGraphicsT<BMOStatusPanel> status;
+  face.begin(&display, 0);
+  status.begin(&display, 1);
+  const int widths[PANELS] = { BMOActivePanel::WIDTH, BMOStatusPanel::WIDTH };
+  const int heights[PANELS] = { BMOActivePanel::HEIGHT, BMOStatusPanel::HEIGHT };
+
+  // What each panel shows after a redraw on its own
+  std::vector<uint16_t> reference[PANELS];
+  face.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  status.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+  for (uint8_t i = 0; i < PANELS; i++) {
+    reference[i] = capture(i, widths[i], heights[i]);
+    hostPanelClear(i);
+  }
+
+  // The loop: one serviceJobs() a tick, each tick's transfers kept
+  printf("Two queued redraws\n");
+  face.requestFace(EXPRESSION_HAPPY, EYES_OPEN);
+  status.requestFace(EXPRESSION_HAPPY, EYES_OPEN);
+  std::vector<Transfer> transfers;
+  uint32_t ticks = 0, bothBusy = 0;
+  bool interleaved = true;
+  hostBusRecord(true);
+  while (display.hasPendingJobs() && ticks < 10000) {
+    bool busy[PANELS] = { display.isPanelBusy(0), display.isPanelBusy(1) };
+    const BMOHostBusRecord* records;
+    uint32_t first = hostBusLog(&records);
+    display.serviceJobs();
+    uint32_t count = hostBusLog(&records);
+    ticks++;
+
+    // Every panel busy at the start of the tick gets something in it
+    bool reached[PANELS] = { false, false };
+    for (uint32_t n = first; n < count; n++) {
+      transfers.push_back({ ticks, records[n] });
+      for (uint8_t i = 0; i < PANELS; i++) reached[i] |= (records[n].panels & (1 << i)) != 0;
+      if (records[n].kind == HOST_BUS_PIXELS && records[n].panels == (1 << PANELS) - 1) {
+        expect(false, "pixels sent to both panels at once");
+      }
+    }
+    for (uint8_t i = 0; i < PANELS; i++) {
+      if (busy[i] && !reached[i]) interleaved = false;
+    }
+    if (busy[0] && busy[1]) bothBusy++;
+  }
+  hostBusRecord(false);
+  expect(!display.hasPendingJobs(), "redraws never finished");
+  expect(bothBusy > 1, "a redraw finished in one tick");
+  expect(interleaved, "a busy panel went a tick without a slice");
+  printf("  %u ticks, %u with both panels busy, %u transfers\n", (unsigned)ticks, (unsigned)bothBusy,
+         (unsigned)transfers.size());
+
+  for (uint8_t i = 0; i < PANELS; i++) {
+    std::vector<uint16_t> screen = capture(i, widths[i], heights[i]);
+    uint32_t bad = 0;
+    for (size_t p = 0; p < screen.size(); p++) bad += screen[p] != reference[i][p];
+    printf("Panel %u against its own redraw: %u of %u pixels wrong\n", i, (unsigned)bad, (unsigned)screen.size());
+    if (bad) failures++;
+    if (argc > 1) writeRecording(argv[1], i, transfers, screen, widths[i], heights[i]);
+  }
+  if (argc > 1) printf("Recordings in %s\n", argv[1]);
+
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * BMO Protocol Check
+ *
+ * Runs the command protocol (src/protocol.cpp) on the host over a real
+ * pseudo-terminal, with the sketch's loop around it: the event loop polls
+ * the pty, EVENT_SERIAL runs one service() and comes back while isBusy(),
+ * and posted commands are taken off the queue as the sketch takes them.
+ * The device end is the pty master; the host side opens the slave, as
+ * bmo_ctl.py would, and writes frames as fast as the kernel takes them.
+ * It checks that no service() call takes more than PROTOCOL_SERVICE_BYTES
+ * of input or completes more than PROTOCOL_SERVICE_FRAMES frames, that a
+ * burst of commands is all acknowledged in order without the event queue
+ * overflowing, that an uploaded image lands pixel for pixel, that a
+ * damaged chunk is NAKed and its resend repairs the panel, and that a
+ * repeated frame is acknowledged without running twice.
+ *
+ * With "serve" it prints the pty's name and runs the loop until stopped,
+ * so tools/bmo_ctl.py can drive it: ./bmo_ctl.py /dev/pts/N ping
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host -DBMO_ENABLE_PROTOCOL=1 tools/protocol_check.cpp tools/host/*.cpp src/*.cpp -o protocol_check
+//   ./protocol_check [serve]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "events.h"
+#include "protocol.h"
+
+#define TIMER_HOST       1          // The host side's turn to write and read
+#define BURST_COMMANDS   40
+#define IMAGE_X          30
+#define IMAGE_Y          40
+#define IMAGE_W          97         // Odd, so chunks split pixels across frames
+#define IMAGE_H          61
+#define CHUNK_BYTES      1000       // Pixel bytes per IMAGE_DATA frame
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+// The host end of the pty: frames queued for writing, responses parsed
+struct Host {
+  int fd;
+  std::vector<uint8_t> out;
+  size_t outPos;
+  std::vector<uint8_t> in;
+  std::vector<uint8_t> acked;       // Sequence numbers, in the order answered
+  std::vector<uint8_t> naked;
+  uint8_t seq;
+};
+
+static uint16_t imagePixel(int x, int y) {
+  return (uint16_t)((x * 2113 + y * 977) ^ (x << 11));
+}
+
+static uint8_t sendFrame(Host& host, uint8_t type, const uint8_t* payload, uint16_t length) {
+  uint8_t frame[BMO_FRAME_OVERHEAD + PROTOCOL_MAX_PAYLOAD];
+  if (length) memcpy(frame + BMO_FRAME_HEADER_SIZE, payload, length);
+  uint8_t seq = host.seq++;
+  size_t size = bmoFrameSeal(frame, type, seq, length);
+  host.out.insert(host.out.end(), frame, frame + size);
+  return seq;
+}
+
+static void pumpHost(Host& host) {
+  // As much as the pty takes now, the rest next turn
+  if (host.outPos < host.out.size()) {
+    ssize_t n = write(host.fd, host.out.data() + host.outPos, host.out.size() - host.outPos);
+    if (n > 0) host.outPos += (size_t)n;
+  }
+  uint8_t buffer[256];
+  ssize_t n;
+  while ((n = read(host.fd, buffer, sizeof(buffer))) > 0) host.in.insert(host.in.end(), buffer, buffer + n);
+
+  // ACK/NAK frames: sync, type, seq, length, then seq(1) code(1) and the CRC
+  const size_t size = BMO_FRAME_OVERHEAD + 2;
+  while (host.in.size() >= size) {
+    if (host.in[0] != BMO_FRAME_SYNC1 || host.in[1] != BMO_FRAME_SYNC2) {
+      host.in.erase(host.in.begin());
+      continue;
+    }
+    uint8_t type = host.in[2];
+    uint8_t answered = host.in[BMO_FRAME_HEADER_SIZE];
+    if (type == FRAME_ACK) host.acked.push_back(answered);
+    if (type == FRAME_NAK) host.naked.push_back(answered);
+    host.in.erase(host.in.begin(), host.in.begin() + size);
+  }
+}
+
+struct Loop {
+  BMOEventLoop* events;
+  BMOProtocol* protocol;
+  Host* host;
+  uint32_t services;
+  uint32_t maxBytes;                // Most input one service() took
+  uint32_t maxFrames;
+  uint32_t commands;
+  bool echo;                        // Print commands (serve mode)
+};
+
+// One pass of the sketch's loop()
+static void loopOnce(Loop& loop) {
+  BMOEvent event;
+  if (!loop.events->wait(&event)) return;
+  switch (event.type) {
+    case EVENT_TIMER:
+      if (loop.host) pumpHost(*loop.host);
+      break;
+
+    case EVENT_SERIAL: {
+      const ProtocolStats& stats = loop.protocol->getStats();
+      uint32_t bytes = stats.bytesIn, frames = stats.frames + stats.crcErrors;
+      loop.protocol->service();
+      if (loop.protocol->isBusy()) loop.events->notifySerial();
+      loop.services++;
+      if (stats.bytesIn - bytes > loop.maxBytes) loop.maxBytes = stats.bytesIn - bytes;
+      if (stats.frames + stats.crcErrors - frames > loop.maxFrames) {
+        loop.maxFrames = stats.frames + stats.crcErrors - frames;
+      }
+      break;
+    }
+
+    case EVENT_COMMAND:
+      loop.commands++;
+      if (loop.echo) {
+        printf("Command 0x%02X, param 0x%04X\n", event.id, event.param);
+        fflush(stdout);
+      }
+      break;
+  }
+}
+
+// Runs the loop until every frame is answered (or it gives up)
+static void runUntilAnswered(Loop& loop, size_t answers) {
+  Host& host = *loop.host;
+  for (int pass = 0; pass < 200000; pass++) {
+    if (host.acked.size() + host.naked.size() >= answers && host.outPos == host.out.size()) return;
+    loopOnce(loop);
+  }
+  expect(false, "frames left unanswered");
+}
+
+static uint32_t imageErrors() {
+  uint32_t bad = 0;
+  for (int y = 0; y < IMAGE_H; y++) {
+    for (int x = 0; x < IMAGE_W; x++) bad += hostPanelColor(0, IMAGE_X + x, IMAGE_Y + y) != imagePixel(x, y);
+  }
+  return bad;
+}
+
+static void sendImage(Host& host, int damagedChunk, uint8_t* damagedSeq) {
+  uint8_t begin[9] = { 0, IMAGE_X, 0, IMAGE_Y, 0, IMAGE_W, 0, IMAGE_H, 0 };
+  sendFrame(host, CMD_IMAGE_BEGIN, begin, sizeof(begin));
+  std::vector<uint8_t> pixels;
+  for (int y = 0; y < IMAGE_H; y++) {
+    for (int x = 0; x < IMAGE_W; x++) {
+      uint16_t color = imagePixel(x, y);
+      pixels.push_back((uint8_t)(color >> 8));
+      pixels.push_back((uint8_t)color);
+    }
+  }
+  int chunk = 0;
+  for (size_t pos = 0; pos < pixels.size(); pos += CHUNK_BYTES, chunk++) {
+    size_t length = pixels.size() - pos < CHUNK_BYTES ? pixels.size() - pos : CHUNK_BYTES;
+    uint8_t payload[4 + CHUNK_BYTES];
+    uint32_t offset = (uint32_t)(pos / 2);
+    memcpy(payload, &offset, 4);
+    memcpy(payload + 4, pixels.data() + pos, length);
+    uint8_t seq = sendFrame(host, CMD_IMAGE_DATA, payload, (uint16_t)(4 + length));
+    if (chunk == damagedChunk) {
+      // Flipped on the wire after the CRC was worked out
+      host.out[host.out.size() - BMO_FRAME_CRC_SIZE - 7] ^= 0x5A;
+      *damagedSeq = seq;
+    }
+  }
+  sendFrame(host, CMD_IMAGE_END, nullptr, 0);
+}
+
+static int openPty(char* name, size_t size) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+  snprintf(name, size, "%s", ptsname(master));
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  return master;
+}
+
+static int openSlave(const char* name) {
+  // Raw, as pyserial opens a port: no echo, no line editing, no CR/LF mapping
+  int slave = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (slave < 0) return -1;
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  return slave;
+}
+
+int main(int argc, char** argv) {
+  bool serve = argc > 1 && strcmp(argv[1], "serve") == 0;
+  char name[128];
+  int master = openPty(name, sizeof(name));
+  if (master < 0) {
+    printf("pty: can't open one\nFAILED\n");
+    return 1;
+  }
+  HostFdStream port(master);
+
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    printf("display: begin failed\nFAILED\n");
+    return 1;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+  BMOEventLoop events;
+  events.begin();
+  BMOProtocol protocol;
+  protocol.begin(&port);
+  events.watchSerial(&port);
+
+  int slave = serve ? -1 : openSlave(name);
+  Host host = { slave, {}, 0, {}, {}, {}, 0 };
+  Loop loop = { &events, &protocol, serve ? nullptr : &host, 0, 0, 0, 0, serve };
+  if (serve) {
+    // The host side is whoever opens the slave; the clock follows real time
+    printf("Listening on %s (Ctrl-C to stop)\n", name);
+    fflush(stdout);
+    uint32_t pixels = 0;
+    for (;;) {
+      usleep(1000);
+      hostAdvance(1000);
+      if (port.available()) loopOnce(loop);
+      if (protocol.getStats().pixels != pixels) {
+        pixels = protocol.getStats().pixels;
+        printf("Pixels streamed: %u\n", (unsigned)pixels);
+        fflush(stdout);
+      }
+    }
+  }
+  if (slave < 0) {
+    printf("pty: can't open %s\nFAILED\n", name);
+    return 1;
+  }
+  events.startTimer(TIMER_HOST, 1, 1);
+
+  // A burst of commands in one write: all answered, in order, a few a call
+  printf("Command burst\n");
+  std::vector<uint8_t> sent;
+  for (int i = 0; i < BURST_COMMANDS; i++) {
+    uint8_t expression[2] = { (uint8_t)(i % EXPRESSION_COUNT), PROTOCOL_EYES_DEFAULT };
+    sent.push_back(i & 1 ? sendFrame(host, CMD_SET_EXPRESSION, expression, 2) : sendFrame(host, CMD_PING, nullptr, 0));
+  }
+  runUntilAnswered(loop, sent.size());
+  expect(host.acked == sent, "commands not all acknowledged in order");
+  expect(host.naked.empty(), "commands refused");
+  expect(loop.commands == BURST_COMMANDS / 2, "commands not all posted");
+  expect(loop.services >= BURST_COMMANDS / PROTOCOL_SERVICE_FRAMES, "more frames per call than the cap");
+  printf("  %u frames in %u service() calls, at most %u a call\n", (unsigned)sent.size(),
+         (unsigned)loop.services, (unsigned)loop.maxFrames);
+
+  // An image streamed in chunks, one damaged on the way and resent
+  printf("Image upload\n");
+  host.acked.clear();
+  host.naked.clear();
+  uint32_t servicesBefore = loop.services;
+  uint32_t bytesBefore = protocol.getStats().bytesIn;
+  uint8_t damagedSeq = 0;
+  size_t frames = 2 + (IMAGE_W * IMAGE_H * 2 + CHUNK_BYTES - 1) / CHUNK_BYTES;
+  sendImage(host, 3, &damagedSeq);
+  runUntilAnswered(loop, frames);
+  expect(host.naked.size() == 1 && host.naked[0] == damagedSeq, "damaged chunk not NAKed");
+  expect(imageErrors() > 0, "damaged chunk left no mark");
+  sendImage(host, -1, &damagedSeq);
+  runUntilAnswered(loop, frames * 2);
+  uint32_t bad = imageErrors();
+  printf("  %u of %u pixels wrong, %u bytes in %u service() calls\n", (unsigned)bad, IMAGE_W * IMAGE_H,
+         (unsigned)(protocol.getStats().bytesIn - bytesBefore), (unsigned)(loop.services - servicesBefore));
+  if (bad) failures++;
+
+  // The same frame twice (its ACK lost): acknowledged both times, run once
+  printf("Repeated frame\n");
+  host.acked.clear();
+  uint32_t commands = loop.commands;
+  uint8_t expression[2] = { EXPRESSION_HAPPY, PROTOCOL_EYES_DEFAULT };
+  uint8_t seq = sendFrame(host, CMD_SET_EXPRESSION, expression, 2);
+  std::vector<uint8_t> repeat(host.out.end() - (BMO_FRAME_OVERHEAD + 2), host.out.end());
+  host.out.insert(host.out.end(), repeat.begin(), repeat.end());
+  runUntilAnswered(loop, 2);
+  expect(host.acked.size() == 2 && host.acked[0] == seq && host.acked[1] == seq, "repeat not acknowledged");
+  expect(loop.commands == commands + 1, "repeat ran twice");
+  expect(protocol.getStats().duplicates == 1, "repeat not counted");
+
+  printf("Bounded service(): at most %u bytes (cap %d) and %u frames (cap %d) a call\n", (unsigned)loop.maxBytes,
+         PROTOCOL_SERVICE_BYTES, (unsigned)loop.maxFrames, PROTOCOL_SERVICE_FRAMES);
+  expect(loop.maxBytes <= PROTOCOL_SERVICE_BYTES, "a call took more input than the cap");
+  expect(loop.maxFrames <= PROTOCOL_SERVICE_FRAMES, "a call completed more frames than the cap");
+  expect(loop.maxBytes == PROTOCOL_SERVICE_BYTES, "the image never filled a call");
+
+  close(slave);
+  close(master);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
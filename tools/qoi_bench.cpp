@@ -0,0 +1,187 @@
+/*
+ * BMO QOI Decoder Benchmark
+ *
+ * Runs the firmware's streaming decoder (src/qoi.cpp) on the host against
+ * reference images: every file is checked pixel for pixel against a plain
+ * whole-buffer decode, with several read chunk and band sizes, then timed.
+ *
+ * Build and run:
+ *   g++ -O2 -std=gnu++17 -Isrc tools/qoi_bench.cpp src/qoi.cpp -o qoi_bench
+ *   ./qoi_bench data/splash.qoi data/face.qoi
+ *
+ * Reference images come from tools/qoi_encode.py (or any QOI encoder).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "qoi.h"
+
+#define BENCH_MIN_SECONDS  0.25   // Timed decodes repeat at least this long
+#define BENCH_BAND_PIXELS  1024   // IMAGE_BAND_PIXELS in graphics.h
+
+// In-memory file, handed out in pieces of at most chunk bytes
+struct MemoryFile {
+  const uint8_t* data;
+  uint32_t size;
+  uint32_t pos;
+  uint32_t chunk;
+};
+
+static int32_t readMemory(uint8_t* buffer, uint32_t length, void* context) {
+  MemoryFile* file = static_cast<MemoryFile*>(context);
+  uint32_t count = file->size - file->pos;
+  if (count > length) count = length;
+  if (count > file->chunk) count = file->chunk;
+  memcpy(buffer, file->data + file->pos, count);
+  file->pos += count;
+  return (int32_t)count;
+}
+
+// Whole-buffer decode after the reference implementation, straight to the
+// RGB565 the firmware shows (alpha over black)
+static bool referenceDecode(const std::vector<uint8_t>& file, uint32_t& width, uint32_t& height,
+                            std::vector<uint16_t>& out) {
+  if (file.size() < 22 || memcmp(file.data(), "qoif", 4) != 0) return false;
+  const uint8_t* p = file.data();
+  width = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+  height = (uint32_t)p[8] << 24 | (uint32_t)p[9] << 16 | (uint32_t)p[10] << 8 | p[11];
+  out.assign((size_t)width * height, 0);
+
+  uint8_t index[64][4] = {};
+  uint8_t px[4] = { 0, 0, 0, 255 };
+  size_t pos = 14, end = file.size() - 8;
+  int run = 0;
+  for (size_t i = 0; i < out.size(); i++) {
+    if (run > 0) {
+      run--;
+    } else if (pos < end) {
+      uint8_t op = p[pos++];
+      if (op == 0xFE) {
+        px[0] = p[pos]; px[1] = p[pos + 1]; px[2] = p[pos + 2]; pos += 3;
+      } else if (op == 0xFF) {
+        memcpy(px, p + pos, 4); pos += 4;
+      } else if ((op & 0xC0) == 0x00) {
+        memcpy(px, index[op], 4);
+      } else if ((op & 0xC0) == 0x40) {
+        px[0] += ((op >> 4) & 3) - 2; px[1] += ((op >> 2) & 3) - 2; px[2] += (op & 3) - 2;
+      } else if ((op & 0xC0) == 0x80) {
+        int dg = (op & 0x3F) - 32, extra = p[pos++];
+        px[0] += dg - 8 + (extra >> 4); px[1] += dg; px[2] += dg - 8 + (extra & 0x0F);
+      } else {
+        run = op & 0x3F;
+      }
+      memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+    }
+    int r = (px[0] * px[3] + 127) / 255, g = (px[1] * px[3] + 127) / 255, b = (px[2] * px[3] + 127) / 255;
+    out[i] = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+  }
+  return true;
+}
+
+// Streaming decode of the whole file in bands; returns pixels that match
+static uint32_t streamDecode(const std::vector<uint8_t>& file, uint32_t chunk, uint32_t band,
+                             const std::vector<uint16_t>* expected, BMOQoiStatus& status) {
+  static BMOQoiDecoder decoder;
+  static uint16_t buffer[BENCH_BAND_PIXELS];
+  MemoryFile memory = { file.data(), (uint32_t)file.size(), 0, chunk };
+  status = decoder.begin(readMemory, &memory);
+  if (status != QOI_OK) return 0;
+
+  uint32_t matched = 0, position = 0;
+  while (!decoder.isDone()) {
+    uint32_t count = decoder.decode(buffer, band);
+    if (expected) {
+      for (uint32_t i = 0; i < count; i++) matched += buffer[i] == (*expected)[position + i];
+    }
+    position += count;
+    if (count == 0) break;
+  }
+  status = decoder.getStatus();
+  return expected ? matched : position;
+}
+
+static bool loadFile(const char* path, std::vector<uint8_t>& data) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  fseek(f, 0, SEEK_END);
+  data.resize((size_t)ftell(f));
+  fseek(f, 0, SEEK_SET);
+  bool ok = fread(data.data(), 1, data.size(), f) == data.size();
+  fclose(f);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s image.qoi...\n", argv[0]);
+    return 2;
+  }
+
+  int failures = 0;
+  for (int arg = 1; arg < argc; arg++) {
+    std::vector<uint8_t> file;
+    std::vector<uint16_t> expected;
+    uint32_t width, height;
+    if (!loadFile(argv[arg], file) || !referenceDecode(file, width, height, expected)) {
+      printf("%s: can't read as QOI\n", argv[arg]);
+      failures++;
+      continue;
+    }
+    uint32_t pixels = width * height;
+    uint32_t rowBand = (BENCH_BAND_PIXELS / width) * width;
+    if (rowBand == 0) {
+      printf("%s: %ux%u is wider than the %u pixel band\n", argv[arg], width, height, BENCH_BAND_PIXELS);
+      failures++;
+      continue;
+    }
+
+    // Pixel for pixel, with reads and bands that split ops and runs
+    const uint32_t chunks[] = { 1, 3, 7, 64, QOI_READ_CHUNK, 1u << 20 };
+    const uint32_t bands[] = { 1, 61, width, rowBand };
+    bool correct = true;
+    for (uint32_t chunk : chunks) {
+      for (uint32_t band : bands) {
+        BMOQoiStatus status;
+        uint32_t matched = streamDecode(file, chunk, band, &expected, status);
+        if (matched != pixels || status != QOI_OK) {
+          printf("%s: chunk %u band %u: %u of %u pixels match (%s)\n", argv[arg], chunk, band,
+                 matched, pixels, BMOQoiDecoder::statusName(status));
+          correct = false;
+        }
+      }
+    }
+
+    // A cut-off file must stop with an error, not run past its data
+    std::vector<uint8_t> cut(file.begin(), file.begin() + file.size() / 2);
+    BMOQoiStatus cutStatus;
+    streamDecode(cut, QOI_READ_CHUNK, rowBand, nullptr, cutStatus);
+    if (cutStatus != QOI_ERROR_TRUNCATED && file.size() / 2 > QOI_HEADER_SIZE + 8) {
+      printf("%s: truncated copy decoded as '%s'\n", argv[arg], BMOQoiDecoder::statusName(cutStatus));
+      correct = false;
+    }
+
+    // Throughput as the firmware runs it: read chunk, row bands
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0;
+    uint32_t runs = 0;
+    do {
+      BMOQoiStatus status;
+      streamDecode(file, QOI_READ_CHUNK, rowBand, nullptr, status);
+      runs++;
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < BENCH_MIN_SECONDS);
+
+    double perRun = seconds / runs;
+    printf("%s: %ux%u, %zu bytes (%.2f bytes/px), %s, %.1f Mpx/s, %.1f MB/s in, %.2f ms/image\n",
+           argv[arg], width, height, file.size(), (double)file.size() / pixels,
+           correct ? "exact" : "MISMATCH", pixels / perRun / 1e6, file.size() / perRun / 1e6, perRun * 1e3);
+    if (!correct) failures++;
+  }
+
+  printf("RAM per decoder: %zu bytes (+ %u byte band)\n", sizeof(BMOQoiDecoder),
+         (unsigned)(BENCH_BAND_PIXELS * sizeof(uint16_t)));
+  return failures ? 1 : 0;
+}
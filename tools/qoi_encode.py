@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""
+BMO QOI Encoder
+
+Converts images to QOI (qoiformat.org) for BMOGraphics::drawImage(), which
+streams them from the LittleFS partition (src/qoi.h). Put the results in
+data/ and upload it with `pio run -t uploadfs`; data/splash.qoi is shown at
+boot when the firmware is built with -DBMO_ENABLE_IMAGES=1.
+
+Usage:
+  python3 tools/qoi_encode.py face.ppm data/face.qoi
+  python3 tools/qoi_encode.py sticker.pam data/sticker.qoi   # with alpha
+  python3 tools/qoi_encode.py --info data/face.qoi
+
+Input is binary PPM (P6), e.g. from `convert face.png face.ppm`, or PAM (P7,
+RGB_ALPHA) for transparency, from `convert sticker.png sticker.pam`. Every
+file written is decoded again and compared before it is kept.
+"""
+
+import argparse
+import struct
+import sys
+
+from bmo_ctl import read_ppm
+
+MAGIC = b"qoif"
+END_MARKER = b"\x00" * 7 + b"\x01"
+
+OP_INDEX = 0x00
+OP_DIFF = 0x40
+OP_LUMA = 0x80
+OP_RUN = 0xC0
+OP_RGB = 0xFE
+OP_RGBA = 0xFF
+
+
+def read_pam(path):
+    """PAM (P7) -> (width, height, channels, bytes)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    header_end = data.index(b"ENDHDR\n")
+    fields = {}
+    for line in data[:header_end].split(b"\n")[1:]:
+        if line and not line.startswith(b"#"):
+            key, _, value = line.partition(b" ")
+            fields[key] = value.strip()
+    depth = int(fields[b"DEPTH"])
+    if int(fields.get(b"MAXVAL", b"255")) != 255 or depth not in (3, 4):
+        raise ValueError("%s: only 8-bit RGB or RGB_ALPHA PAM is supported" % path)
+    width, height = int(fields[b"WIDTH"]), int(fields[b"HEIGHT"])
+    start = header_end + len(b"ENDHDR\n")
+    return width, height, depth, data[start:start + width * height * depth]
+
+
+def read_image(path):
+    with open(path, "rb") as f:
+        magic = f.read(2)
+    if magic == b"P7":
+        return read_pam(path)
+    width, height, rgb = read_ppm(path)
+    return width, height, 3, rgb
+
+
+def color_hash(r, g, b, a):
+    return (r * 3 + g * 5 + b * 7 + a * 11) % 64
+
+
+def encode(width, height, channels, pixels):
+    """Raw RGB/RGBA bytes -> QOI file bytes (the reference encoder's choices)."""
+    out = bytearray(MAGIC + struct.pack(">IIBB", width, height, channels, 0))
+    index = [(0, 0, 0, 0)] * 64
+    prev = (0, 0, 0, 255)
+    run = 0
+    count = width * height
+    for i in range(count):
+        p = pixels[i * channels:(i + 1) * channels]
+        px = (p[0], p[1], p[2], p[3] if channels == 4 else prev[3])
+        if px == prev:
+            run += 1
+            if run == 62 or i == count - 1:
+                out.append(OP_RUN | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+        slot = color_hash(*px)
+        if index[slot] == px:
+            out.append(OP_INDEX | slot)
+        else:
+            index[slot] = px
+            if px[3] == prev[3]:
+                dr = (px[0] - prev[0] + 128) % 256 - 128
+                dg = (px[1] - prev[1] + 128) % 256 - 128
+                db = (px[2] - prev[2] + 128) % 256 - 128
+                dr_dg, db_dg = dr - dg, db - dg
+                if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                    out.append(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))
+                elif -32 <= dg <= 31 and -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                    out += bytes([OP_LUMA | (dg + 32), (dr_dg + 8) << 4 | (db_dg + 8)])
+                else:
+                    out += bytes([OP_RGB, px[0], px[1], px[2]])
+            else:
+                out += bytes([OP_RGBA, px[0], px[1], px[2], px[3]])
+        prev = px
+    return bytes(out + END_MARKER)
+
+
+def decode(data):
+    """QOI file bytes -> (width, height, channels, RGBA bytes)."""
+    if data[:4] != MAGIC:
+        raise ValueError("not a QOI file")
+    width, height, channels, _ = struct.unpack(">IIBB", data[4:14])
+    out = bytearray(width * height * 4)
+    index = [(0, 0, 0, 0)] * 64
+    px = (0, 0, 0, 255)
+    pos = 14
+    run = 0
+    for i in range(width * height):
+        if run:
+            run -= 1
+        else:
+            op = data[pos]
+            pos += 1
+            if op == OP_RGB:
+                px = (data[pos], data[pos + 1], data[pos + 2], px[3])
+                pos += 3
+            elif op == OP_RGBA:
+                px = tuple(data[pos:pos + 4])
+                pos += 4
+            elif op & 0xC0 == OP_INDEX:
+                px = index[op]
+            elif op & 0xC0 == OP_DIFF:
+                px = ((px[0] + (op >> 4 & 3) - 2) % 256, (px[1] + (op >> 2 & 3) - 2) % 256,
+                      (px[2] + (op & 3) - 2) % 256, px[3])
+            elif op & 0xC0 == OP_LUMA:
+                dg = (op & 0x3F) - 32
+                extra = data[pos]
+                pos += 1
+                px = ((px[0] + dg - 8 + (extra >> 4)) % 256, (px[1] + dg) % 256,
+                      (px[2] + dg - 8 + (extra & 0x0F)) % 256, px[3])
+            else:
+                run = op & 0x3F
+            index[color_hash(*px)] = px
+        out[i * 4:i * 4 + 4] = bytes(px)
+    return width, height, channels, bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert PPM/PAM images to QOI for BMO")
+    parser.add_argument("input", help="PPM (P6) or PAM (P7) image, or a .qoi with --info")
+    parser.add_argument("output", nargs="?", help="QOI file to write")
+    parser.add_argument("--info", action="store_true", help="print a QOI file's header and exit")
+    args = parser.parse_args()
+
+    if args.info:
+        with open(args.input, "rb") as f:
+            data = f.read()
+        width, height, channels, _ = decode(data)
+        print("%s: %dx%d, %s, %d bytes (%.2f bytes/pixel)" % (
+            args.input, width, height, "RGBA" if channels == 4 else "RGB",
+            len(data), len(data) / float(width * height)))
+        return 0
+    if not args.output:
+        parser.error("an output file is needed")
+
+    width, height, channels, pixels = read_image(args.input)
+    data = encode(width, height, channels, pixels)
+
+    # Round trip before anything is written
+    _, _, _, rgba = decode(data)
+    for i in range(width * height):
+        expected = pixels[i * channels:i * channels + 3]
+        if rgba[i * 4:i * 4 + 3] != expected or (channels == 4 and rgba[i * 4 + 3] != pixels[i * 4 + 3]):
+            print("error: pixel %d did not survive encoding" % i, file=sys.stderr)
+            return 1
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("%s: %dx%d -> %d bytes (%.1f%% of RGB565)" % (
+        args.output, width, height, len(data), 100.0 * len(data) / (width * height * 2)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,152 @@
+/*
+ * BMO Quality Check
+ *
+ * Runs the quality governor (src/quality.cpp) on the host. It checks the
+ * hysteresis - a level down only after QUALITY_DOWN_FRAMES frames over the
+ * budget in a row, back up only after QUALITY_UP_FRAMES comfortably under
+ * it, runs broken by frames in between, and QUALITY_SETTLE_FRAMES ignored
+ * after every change - and that the renderer's draw calls within a loop
+ * tick reach the governor as one frame, so a tick that is over budget
+ * counts even when each call on its own is under it.
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host tools/quality_check.cpp tools/host/*.cpp src/*.cpp -o quality_check
+//   ./quality_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "quality.h"
+
+#define CHECK_BUDGET_US  10000
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+static int changes = 0;
+
+static void onChange(const BMOQualityChange& change, void* context) {
+  (void)change;
+  (void)context;
+  changes++;
+}
+
+// Frames of one duration; false if the level moved before the last of them
+static bool frames(BMOQualityGovernor& governor, int count, uint32_t us) {
+  uint8_t level = governor.getLevel();
+  for (int i = 0; i < count - 1; i++) {
+    governor.recordFrame(us, 0);
+    if (governor.getLevel() != level) return false;
+  }
+  governor.recordFrame(us, 0);
+  return true;
+}
+
+static void checkHysteresis() {
+  printf("Hysteresis\n");
+  BMOQualityGovernor governor;
+  governor.begin(CHECK_BUDGET_US);
+  governor.setListener(onChange, nullptr);
+  const uint32_t over = CHECK_BUDGET_US + 1;
+  const uint32_t under = CHECK_BUDGET_US * QUALITY_UP_PERCENT / 100 - 1;
+  const uint32_t between = CHECK_BUDGET_US * 4 / 5;
+  const uint8_t full = QUALITY_LEVELS - 1;
+
+  // A frame in the band or under it breaks a run over the budget
+  frames(governor, QUALITY_DOWN_FRAMES - 1, over);
+  governor.recordFrame(between, 0);
+  frames(governor, QUALITY_DOWN_FRAMES - 1, over);
+  governor.recordFrame(under, 0);
+  expect(governor.getLevel() == full, "stepped down on a broken run");
+
+  // An unbroken run steps down once, on its last frame
+  expect(frames(governor, QUALITY_DOWN_FRAMES, over), "stepped down before the run was complete");
+  expect(governor.getLevel() == full - 1, "no step down after a run over budget");
+  expect(governor.getLastChange().reason == QUALITY_REASON_OVER_BUDGET, "wrong reason");
+  expect(governor.getLastChange().frameUs == over, "wrong frame time in the change");
+
+  // Frames right after a change are ignored, however slow
+  expect(frames(governor, QUALITY_SETTLE_FRAMES, CHECK_BUDGET_US * 10), "changed while settling");
+  expect(governor.getLevel() == full - 1, "changed while settling");
+  frames(governor, QUALITY_DOWN_FRAMES, over);
+  expect(governor.getLevel() == full - 2, "no second step down after settling");
+
+  // Coming back up takes the long run, and a frame in the band restarts it
+  frames(governor, QUALITY_SETTLE_FRAMES, under);
+  expect(frames(governor, QUALITY_UP_FRAMES - 1, under), "stepped up early");
+  governor.recordFrame(between, 0);
+  expect(frames(governor, QUALITY_UP_FRAMES - 1, under), "stepped up on a broken run");
+  expect(governor.getLevel() == full - 2, "stepped up on a broken run");
+  governor.recordFrame(under, 0);
+  expect(governor.getLevel() == full - 1, "no step up after a run under the threshold");
+  expect(governor.getLastChange().reason == QUALITY_REASON_UNDER_BUDGET, "wrong reason");
+
+  // Never below the cheapest level or above full
+  for (int i = 0; i < QUALITY_LEVELS + 1; i++) frames(governor, QUALITY_SETTLE_FRAMES + QUALITY_DOWN_FRAMES, over);
+  expect(governor.getLevel() == 0, "not at the cheapest level");
+  for (int i = 0; i < QUALITY_LEVELS + 1; i++) frames(governor, QUALITY_SETTLE_FRAMES + QUALITY_UP_FRAMES, under);
+  expect(governor.getLevel() == full, "not back at full quality");
+  expect(changes == (int)(governor.getStats().stepsDown + governor.getStats().stepsUp), "listener missed changes");
+  printf("  %u frames, %u steps down, %u up\n", (unsigned)governor.getStats().frames,
+         (unsigned)governor.getStats().stepsDown, (unsigned)governor.getStats().stepsUp);
+}
+
+static void checkFrames() {
+  printf("Draw calls per frame\n");
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    expect(false, "display: begin failed");
+    return;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+  graphics.drawBMOFace(EXPRESSION_HAPPY, EYES_OPEN);
+
+  // What one mouth repaint costs on the bus, without a governor
+  uint32_t start = micros();
+  graphics.drawTalkingMouth(8, 20);
+  uint32_t mouthUs = micros() - start;
+  expect(mouthUs > 0, "mouth repaint took no time");
+
+  // A budget each call fits in, but not three of them
+  BMOQualityGovernor governor;
+  governor.begin(mouthUs * 2);
+  graphics.setGovernor(&governor);
+  governor.endFrame();
+  expect(governor.getStats().frames == 0, "a tick without drawing counted as a frame");
+
+  for (int tick = 0; tick < QUALITY_DOWN_FRAMES; tick++) {
+    for (int call = 0; call < 3; call++) graphics.drawTalkingMouth((uint8_t)(call * 4), 20);
+    expect(governor.getStats().frames == (uint32_t)tick, "a draw call recorded a frame");
+    governor.endFrame();
+  }
+  const BMOQualityStats& stats = governor.getStats();
+  expect(stats.frames == QUALITY_DOWN_FRAMES, "one frame per tick not recorded");
+  expect(stats.overBudget == QUALITY_DOWN_FRAMES, "ticks over budget not counted");
+  expect(governor.getLevel() == QUALITY_LEVELS - 2, "no step down on ticks over budget");
+
+  // Render and flush add up to the tick, the flush counted once
+  uint64_t frameUs = stats.renderTime.totalUs + stats.flushTime.totalUs;
+  expect(frameUs >= (uint64_t)QUALITY_DOWN_FRAMES * mouthUs * 2, "ticks shorter than their calls");
+  expect(frameUs <= (uint64_t)QUALITY_DOWN_FRAMES * mouthUs * 4, "ticks longer than their calls");
+  printf("  %u us per mouth repaint, %u us per tick\n", (unsigned)mouthUs,
+         (unsigned)(frameUs / QUALITY_DOWN_FRAMES));
+  graphics.setGovernor(nullptr);
+}
+
+int main() {
+  checkHysteresis();
+  checkFrames();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
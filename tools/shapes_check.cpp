@@ -0,0 +1,264 @@
+/*
+ * BMO Shapes Check
+ *
+ * Checks the span tables in src/shapes.h pixel for pixel against the
+ * primitive calls they replaced: the 20-segment float parabola stroked
+ * with drawLine (smile, excited grin and its teeth), fillEllipse
+ * (surprised mouth, half-closed eye) and the nested drawRoundRect loop
+ * (frame). For every panel profile each shape is drawn both ways on a
+ * simulated panel - where the face puts it, somewhere off its grid, and
+ * hanging over the panel's edge - and the two screens compared. For the
+ * panel this build selects it also checks the renderer itself
+ * (drawSpans(), drawFrame()).
+ */
+
+// Build and run:
+//   g++ -O2 -std=gnu++17 -Isrc -Itools/host tools/shapes_check.cpp tools/host/*.cpp src/*.cpp -o shapes_check
+//   ./shapes_check
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <functional>
+#include <vector>
+#include "host.h"
+#include "display.h"
+#include "graphics.h"
+#include "shapes.h"
+
+#define SHAPE_POSITIONS  3
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+/*
+ * The calls the tables replaced (graphics.cpp before shapes.h), on the
+ * host's TFT_eSPI primitives
+ */
+template <class Panel>
+struct OldShapes {
+  typedef BMOFaceGeometry<Panel> Face;
+
+  static void thickLine(TFT_eSPI& tft, int x1, int y1, int x2, int y2, int thickness, uint16_t color) {
+    for (int i = 0; i < thickness; i++) {
+      for (int j = 0; j < thickness; j++) {
+        tft.drawLine(x1 + i - thickness/2, y1 + j - thickness/2,
+                     x2 + i - thickness/2, y2 + j - thickness/2, color);
+      }
+    }
+  }
+
+  static void curve(TFT_eSPI& tft, int centerX, int centerY, int width, int height, uint16_t color) {
+    int segments = 20;
+    int startX = centerX - width/2;
+    int segmentWidth = width / segments;
+    for (int i = 0; i < segments; i++) {
+      int x1 = startX + (i * segmentWidth);
+      int x2 = startX + ((i + 1) * segmentWidth);
+      float t1 = (float)(x1 - centerX) / (width/2);
+      float t2 = (float)(x2 - centerX) / (width/2);
+      int y1 = centerY + (int)(height * (1 - t1 * t1));
+      int y2 = centerY + (int)(height * (1 - t2 * t2));
+      thickLine(tft, x1, y1, x2, y2, 3, color);
+    }
+  }
+
+  static void smile(TFT_eSPI& tft, int centerX, int centerY) {
+    curve(tft, centerX, centerY, Face::MOUTH_WIDTH, Face::MOUTH_HEIGHT, BMO_BLACK);
+  }
+
+  static void grin(TFT_eSPI& tft, int centerX, int centerY) {
+    curve(tft, centerX, centerY, Face::MOUTH_WIDTH + Face::scale(20), Face::MOUTH_HEIGHT + Face::scale(10),
+          BMO_BLACK);
+    for (int i = 0; i < 4; i++) {
+      int toothX = centerX - Face::scale(20) + (i * Face::scale(13));
+      tft.fillRect(toothX, centerY + Face::scale(8), Face::scale(3), Face::scale(8), BMO_WHITE);
+    }
+  }
+
+  static void surprised(TFT_eSPI& tft, int centerX, int centerY) {
+    tft.fillEllipse(centerX, centerY, Face::scale(15), Face::scale(20), BMO_BLACK);
+    tft.fillEllipse(centerX, centerY, Face::scale(10), Face::scale(15), BMO_TEAL);
+  }
+
+  static void halfEye(TFT_eSPI& tft, int centerX, int centerY) {
+    tft.fillEllipse(centerX, centerY, Face::EYE_RADIUS, Face::EYE_RADIUS / 2, BMO_BLACK);
+  }
+
+  static void frame(TFT_eSPI& tft) {
+    for (int i = 0; i < Face::FRAME_THICKNESS; i++) {
+      tft.drawRoundRect(i, i, Panel::WIDTH - (i * 2), Panel::HEIGHT - (i * 2), Face::FRAME_CORNER_RADIUS,
+                        BMO_DARK_TEAL);
+    }
+    tft.drawRoundRect(Face::FRAME_THICKNESS, Face::FRAME_THICKNESS,
+                      Panel::WIDTH - (Face::FRAME_THICKNESS * 2), Panel::HEIGHT - (Face::FRAME_THICKNESS * 2),
+                      Face::FRAME_CORNER_RADIUS - Face::scale(2), BMO_LIGHT_TEAL);
+  }
+};
+
+// Each pixel's color, and whether it was written at all
+static std::vector<uint32_t> capture(int width, int height) {
+  std::vector<uint32_t> screen((size_t)width * height);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      screen[(size_t)y * width + x] = hostPanelColor(0, x, y) | (hostPanelWritten(0, x, y) ? 0x10000 : 0);
+    }
+  }
+  return screen;
+}
+
+// One shape drawn both ways on a blank panel
+static void compare(const char* name, int width, int height, const std::function<void()>& before,
+                    const std::function<void()>& after) {
+  hostPanelClear(0);
+  before();
+  std::vector<uint32_t> expected = capture(width, height);
+  hostPanelClear(0);
+  after();
+  std::vector<uint32_t> actual = capture(width, height);
+
+  uint32_t bad = 0, painted = 0;
+  for (size_t p = 0; p < expected.size(); p++) {
+    bad += expected[p] != actual[p];
+    painted += (expected[p] & 0x10000) != 0;
+  }
+  if (bad || !painted) {
+    printf("  %s: %u of %u pixels wrong\n", name, (unsigned)bad, (unsigned)painted);
+    failures++;
+  }
+}
+
+// A table replayed as drawSpans() does, one horizontal fill per span
+template <int N>
+static void replay(TFT_eSPI& tft, const BMOSpanTable<N>& table, int originX, int originY) {
+  for (int i = 0; i < N; i++) {
+    const BMOSpan& span = table.spans[i];
+    tft.drawFastHLine(originX + span.x0, originY + span.y, span.x1 - span.x0 + 1, span.color);
+  }
+}
+
+// The frame corner mirrored four ways, as drawFrame() does
+template <class Panel>
+static void replayFrame(TFT_eSPI& tft) {
+  typedef BMOShapeTables<Panel> Shapes;
+  const int corner = Shapes::FRAME_CORNER;
+  const int right = Panel::WIDTH - 1;
+  const int bottom = Panel::HEIGHT - 1;
+  for (int i = 0; i < Shapes::FRAME.COUNT; i++) {
+    const BMOSpan& span = Shapes::FRAME.spans[i];
+    int width = span.x1 - span.x0 + 1;
+    if (span.x1 == corner - 1) {
+      tft.drawFastHLine(span.x0, span.y, Panel::WIDTH - (span.x0 * 2), span.color);
+      tft.drawFastHLine(span.x0, bottom - span.y, Panel::WIDTH - (span.x0 * 2), span.color);
+    } else {
+      tft.drawFastHLine(span.x0, span.y, width, span.color);
+      tft.drawFastHLine(right - span.x1, span.y, width, span.color);
+      tft.drawFastHLine(span.x0, bottom - span.y, width, span.color);
+      tft.drawFastHLine(right - span.x1, bottom - span.y, width, span.color);
+    }
+  }
+  for (int i = 0; i < Shapes::FRAME_EDGE.COUNT; i++) {
+    const BMOSpan& span = Shapes::FRAME_EDGE.spans[i];
+    int width = span.x1 - span.x0 + 1;
+    tft.fillRect(span.x0, corner, width, Panel::HEIGHT - (corner * 2), span.color);
+    tft.fillRect(right - span.x1, corner, width, Panel::HEIGHT - (corner * 2), span.color);
+  }
+}
+
+// Where each shape is drawn: the face's own spot, off its grid, over the edge
+template <class Panel>
+static void shapePositions(int originY, int xs[SHAPE_POSITIONS], int ys[SHAPE_POSITIONS]) {
+  typedef BMOFaceGeometry<Panel> Face;
+  xs[0] = Face::CENTER_X;
+  ys[0] = Face::CENTER_Y + originY;
+  xs[1] = Face::CENTER_X - 37;
+  ys[1] = Face::CENTER_Y + originY + 13;
+  xs[2] = 3;
+  ys[2] = 3;
+}
+
+// Every table for one panel profile, replayed on a bare TFT_eSPI
+template <class Panel>
+static void checkProfile() {
+  typedef BMOFaceGeometry<Panel> Face;
+  typedef BMOShapeTables<Panel> Shapes;
+  typedef OldShapes<Panel> Old;
+  printf("Tables for %dx%d\n", Panel::WIDTH, Panel::HEIGHT);
+  TFT_eSPI tft(Panel::WIDTH, Panel::HEIGHT);
+  tft.init();
+
+  int xs[SHAPE_POSITIONS], ys[SHAPE_POSITIONS];
+  shapePositions<Panel>(Face::MOUTH_Y_OFFSET, xs, ys);
+  for (int i = 0; i < SHAPE_POSITIONS; i++) {
+    int x = xs[i], y = ys[i];
+    compare("smile", Panel::WIDTH, Panel::HEIGHT, [&] { Old::smile(tft, x, y); },
+            [&] { replay(tft, Shapes::SMILE, x, y); });
+    compare("grin", Panel::WIDTH, Panel::HEIGHT, [&] { Old::grin(tft, x, y); },
+            [&] { replay(tft, Shapes::GRIN, x, y); });
+    compare("surprised", Panel::WIDTH, Panel::HEIGHT, [&] { Old::surprised(tft, x, y); },
+            [&] { replay(tft, Shapes::SURPRISED, x, y); });
+  }
+  shapePositions<Panel>(Face::EYE_Y_OFFSET, xs, ys);
+  xs[0] -= Face::EYE_SEPARATION / 2;
+  for (int i = 0; i < SHAPE_POSITIONS; i++) {
+    int x = xs[i], y = ys[i];
+    compare("half-closed eye", Panel::WIDTH, Panel::HEIGHT, [&] { Old::halfEye(tft, x, y); },
+            [&] { replay(tft, Shapes::HALF_EYE, x, y); });
+  }
+  compare("frame", Panel::WIDTH, Panel::HEIGHT, [&] { Old::frame(tft); }, [&] { replayFrame<Panel>(tft); });
+}
+
+// The renderer's own drawing of the tables, for this build's panel
+static void checkRenderer() {
+  typedef BMOGraphics::Face Face;
+  typedef BMOGraphics::Shapes Shapes;
+  typedef OldShapes<BMOActivePanel> Old;
+  printf("Renderer on %dx%d\n", BMOActivePanel::WIDTH, BMOActivePanel::HEIGHT);
+  hostResetPanels();
+  hostAddPanel(BMO_FACE_CS, HOST_ILI9341);
+  BMODisplay display;
+  if (!display.begin()) {
+    expect(false, "display: begin failed");
+    return;
+  }
+  BMOGraphics graphics;
+  graphics.begin(&display);
+  TFT_eSPI& tft = *display.getTFT();
+  const int width = BMOActivePanel::WIDTH, height = BMOActivePanel::HEIGHT;
+
+  int xs[SHAPE_POSITIONS], ys[SHAPE_POSITIONS];
+  shapePositions<BMOActivePanel>(Face::MOUTH_Y_OFFSET, xs, ys);
+  for (int i = 0; i < SHAPE_POSITIONS; i++) {
+    int x = xs[i], y = ys[i];
+    compare("smile", width, height, [&] { Old::smile(tft, x, y); },
+            [&] { graphics.drawSpans(Shapes::SMILE, x, y); });
+    compare("grin", width, height, [&] { Old::grin(tft, x, y); },
+            [&] { graphics.drawSpans(Shapes::GRIN, x, y); });
+    compare("surprised", width, height, [&] { Old::surprised(tft, x, y); },
+            [&] { graphics.drawSpans(Shapes::SURPRISED, x, y); });
+  }
+  shapePositions<BMOActivePanel>(Face::EYE_Y_OFFSET, xs, ys);
+  xs[0] -= Face::EYE_SEPARATION / 2;
+  for (int i = 0; i < SHAPE_POSITIONS; i++) {
+    int x = xs[i], y = ys[i];
+    compare("half-closed eye", width, height, [&] { Old::halfEye(tft, x, y); },
+            [&] { graphics.drawSpans(Shapes::HALF_EYE, x, y); });
+  }
+  compare("frame", width, height, [&] { Old::frame(tft); }, [&] { graphics.drawFrame(); });
+}
+
+int main() {
+  // One panel, always selected, for the bare TFT_eSPI passes
+  hostAddPanel(-1, HOST_ST7789);
+  checkProfile<BMOPanel240x320>();
+  checkProfile<BMOPanel240x240>();
+  checkProfile<BMOPanel320x480>();
+  checkRenderer();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
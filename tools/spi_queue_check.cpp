@@ -0,0 +1,234 @@
+/*
+ * BMO SPI Queue Check
+ *
+ * Runs the firmware's transaction queue (src/spi_queue.cpp) on its host
+ * stand-in, which needs neither the ESP32 driver nor the Arduino core. It
+ * checks that fences complete in submission order and only once their bytes
+ * are through, that callbacks and the wire see transactions in that order,
+ * that a full ring stalls the submitter for exactly one transaction, and
+ * that fences and the ring index survive their wraparounds. It then times a
+ * submission.
+ *
+ * Build and run:
+ *   g++ -O2 -std=gnu++17 -Isrc tools/spi_queue_check.cpp src/spi_queue.cpp -o spi_queue_check
+ *   ./spi_queue_check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "spi_queue.h"
+
+#define CHECK_MIN_SECONDS  0.25       // Timed loops repeat at least this long
+#define CHECK_SPI_HZ       27000000   // SPI_FREQUENCY in display.h
+#define CHECK_PIXELS       100        // One eye row
+
+template <class Work>
+static double timePerRun(Work work) {
+  auto start = std::chrono::steady_clock::now();
+  double seconds = 0;
+  uint32_t runs = 0;
+  do {
+    work();
+    runs++;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (seconds < CHECK_MIN_SECONDS);
+  return seconds / runs;
+}
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("  %s\n", what);
+    failures++;
+  }
+}
+
+// What reached the wire and the callbacks, in order
+struct Recorder {
+  std::vector<uint8_t> wire;        // Every byte; commands and data alike
+  std::vector<uint32_t> lengths;    // Per transaction
+  std::vector<int> done;            // Callback tags
+};
+
+static void sink(bool isData, const uint8_t* data, uint32_t length, void* context) {
+  (void)isData;
+  Recorder* recorder = static_cast<Recorder*>(context);
+  recorder->wire.insert(recorder->wire.end(), data, data + length);
+  recorder->lengths.push_back(length);
+}
+
+struct Tag {
+  Recorder* recorder;
+  int value;
+};
+
+static void onDone(void* context) {
+  Tag* tag = static_cast<Tag*>(context);
+  tag->recorder->done.push_back(tag->value);
+}
+
+static bool startQueue(BMOSpiQueue& queue, Recorder& recorder) {
+  if (!queue.begin(CHECK_SPI_HZ, -1, -1, -1, -1)) return false;
+  queue.setSink(sink, &recorder);
+  return true;
+}
+
+static void checkOrdering() {
+  printf("Fence ordering\n");
+  BMOSpiQueue queue;
+  Recorder recorder;
+  if (!startQueue(queue, recorder)) {
+    expect(false, "begin failed");
+    return;
+  }
+
+  // Rows of different lengths, each with its window and a callback
+  static uint16_t rows[4][CHECK_PIXELS];
+  Tag tags[4];
+  BMOSpiFence fences[4];
+  for (int i = 0; i < 4; i++) {
+    for (int p = 0; p < CHECK_PIXELS; p++) rows[i][p] = (uint16_t)(i << 8 | p);
+    tags[i] = { &recorder, i };
+    fences[i] = queue.pushImage(0, i, CHECK_PIXELS - i * 10, 1, rows[i], false, onDone, &tags[i]);
+  }
+  expect(fences[0] != 0, "fence 0 issued");
+  for (int i = 1; i < 4; i++) expect((int32_t)(fences[i] - fences[i - 1]) > 0, "fences not increasing");
+  expect(queue.isComplete(0), "fence 0 not complete");
+  expect(!queue.isComplete(fences[0]), "first row complete before any time passed");
+  expect(recorder.wire.size() < 11, "pixels on the wire before they were through");
+
+  // Enough time for the first row only: 11 window bytes and its pixels
+  uint32_t firstUs = (uint32_t)(((11 + CHECK_PIXELS * 2) * 8 * 1000000ull + CHECK_SPI_HZ - 1) / CHECK_SPI_HZ);
+  queue.advance(firstUs + 1);
+  expect(queue.isComplete(fences[0]), "first row not complete after its wire time");
+  expect(!queue.isComplete(fences[1]), "second row complete early");
+  expect(recorder.done.size() == 1 && recorder.done[0] == 0, "first callback missing");
+
+  // Waiting on the last retires everything before it, in order
+  queue.wait(fences[3]);
+  expect(queue.getDepth() == 0, "transactions left after waiting on the last fence");
+  expect(recorder.done.size() == 4, "callbacks missing");
+  for (size_t i = 0; i < recorder.done.size(); i++) expect(recorder.done[i] == (int)i, "callbacks out of order");
+
+  // The wire carried each window, then its pixels in memory order
+  size_t pos = 0;
+  bool inOrder = true;
+  for (int i = 0; i < 4 && inOrder; i++) {
+    pos += 11;
+    for (int p = 0; p < CHECK_PIXELS - i * 10; p++, pos += 2) {
+      if (pos + 1 >= recorder.wire.size()) {
+        inOrder = false;
+        break;
+      }
+      uint16_t value = (uint16_t)(recorder.wire[pos] | recorder.wire[pos + 1] << 8);
+      if (value != rows[i][p]) inOrder = false;
+    }
+  }
+  expect(inOrder && pos == recorder.wire.size(), "wire bytes out of order");
+  expect(queue.getStats().waitUs > 0, "waiting not counted");
+
+  // Swapped rows go high byte first and are converted in place
+  uint16_t row[2] = { 0x1234, 0xABCD };
+  recorder.wire.clear();
+  queue.wait(queue.pushImage(0, 0, 2, 1, row, true));
+  size_t n = recorder.wire.size();
+  expect(n >= 4 && recorder.wire[n - 4] == 0x12 && recorder.wire[n - 3] == 0x34 &&
+         recorder.wire[n - 2] == 0xAB && recorder.wire[n - 1] == 0xCD, "swapped row not in panel order");
+}
+
+static void checkFullQueue() {
+  printf("Full queue\n");
+  BMOSpiQueue queue;
+  Recorder recorder;
+  if (!startQueue(queue, recorder)) {
+    expect(false, "begin failed");
+    return;
+  }
+
+  // Five more transactions than descriptors, with no time passing between
+  // them: each extra one waits for the oldest to finish
+  const int extra = 5;
+  static uint8_t bytes[BMO_SPI_QUEUE_DEPTH + extra][8];
+  std::vector<Tag> tags(BMO_SPI_QUEUE_DEPTH + extra);
+  BMOSpiFence last = 0;
+  for (int i = 0; i < BMO_SPI_QUEUE_DEPTH + extra; i++) {
+    for (int b = 0; b < 8; b++) bytes[i][b] = (uint8_t)(i * 8 + b);
+    tags[i] = { &recorder, i };
+    last = queue.pixels(reinterpret_cast<const uint16_t*>(bytes[i]), 4, onDone, &tags[i]);
+    if (i < BMO_SPI_QUEUE_DEPTH) {
+      expect(recorder.done.empty(), "retired before the ring was full");
+    } else {
+      expect((int)recorder.done.size() == i - BMO_SPI_QUEUE_DEPTH + 1, "stall retired more than one");
+    }
+  }
+  const BMOSpiQueueStats& stats = queue.getStats();
+  expect(stats.stalls == extra, "stalls not counted");
+  expect(stats.maxDepth == BMO_SPI_QUEUE_DEPTH, "ring not filled");
+  expect(queue.getDepth() == BMO_SPI_QUEUE_DEPTH, "ring not full after the stalls");
+
+  queue.wait(last);
+  expect((int)recorder.done.size() == BMO_SPI_QUEUE_DEPTH + extra, "callbacks missing");
+  bool inOrder = recorder.wire.size() == (size_t)(BMO_SPI_QUEUE_DEPTH + extra) * 8;
+  for (size_t i = 0; inOrder && i < recorder.wire.size(); i++) inOrder = recorder.wire[i] == (uint8_t)i;
+  expect(inOrder, "wire bytes out of order");
+  printf("  %u stalls, %llu us waiting for %llu us on the wire\n", (unsigned)stats.stalls,
+         (unsigned long long)stats.waitUs, (unsigned long long)queue.getWireUs());
+}
+
+static void checkWraparound() {
+  printf("Wraparound\n");
+  BMOSpiQueue queue;
+  Recorder recorder;
+  if (!startQueue(queue, recorder)) {
+    expect(false, "begin failed");
+    return;
+  }
+
+  // Fences count through 0 (skipped, it means "nothing to wait for") and
+  // the simulated clock through its own wrap, while the ring index cycles
+  queue.setLastFence(0xFFFFFFF0u);
+  queue.advance(0xFFFFFFF0u);
+  uint8_t byte = 0x2C;
+  BMOSpiFence previous = queue.command(byte);
+  queue.wait(previous);
+  for (int i = 0; i < 3 * BMO_SPI_QUEUE_DEPTH; i++) {
+    BMOSpiFence fence = queue.command(byte);
+    expect(fence != 0, "fence 0 issued");
+    expect((int32_t)(fence - previous) > 0, "fence went backwards");
+    expect(!queue.isComplete(fence) || queue.getDepth() == 0, "fence complete while queued");
+    expect(queue.isComplete(0), "fence 0 not complete while transactions queued");
+    if (i % 7 == 0) {
+      queue.wait(previous);
+      expect(queue.isComplete(previous), "waited fence not complete");
+    }
+    previous = fence;
+  }
+  queue.drain();
+  expect(queue.isComplete(previous), "last fence not complete after drain");
+  expect(recorder.lengths.size() == 3 * BMO_SPI_QUEUE_DEPTH + 1, "transactions lost");
+  expect(queue.getTime() < 0x1000, "clock didn't wrap");
+}
+
+int main() {
+  checkOrdering();
+  checkFullQueue();
+  checkWraparound();
+
+  // Submission cost: a row's window and pixels, retired as it goes
+  BMOSpiQueue queue;
+  queue.begin(CHECK_SPI_HZ, -1, -1, -1, -1);
+  static uint16_t row[CHECK_PIXELS];
+  double submit = timePerRun([&]() {
+    for (int i = 0; i < 1000; i++) {
+      queue.pushImage(0, 0, CHECK_PIXELS, 1, row, false);
+      queue.advance(60);
+      queue.poll();
+    }
+  });
+  printf("Row submission: %.0f ns\n", submit / 1000 * 1e9);
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}